@@ -151,6 +151,8 @@ void AssImp::build(const File& path)
 
   compiler.beginModel();
 
+  compiler.enable(Compiler::UNIQUE);
+
   for (uint i = 0; i < scene->mNumMeshes; ++i) {
     const aiMesh*     mesh      = scene->mMeshes[i];
     const aiMaterial* material  = scene->mMaterials[mesh->mMaterialIndex];
@@ -24,16 +24,18 @@
 #include <builder/BSP.hh>
 
 #include <builder/Context.hh>
+#include <client/OcclusionBuffer.hh>
 
 namespace oz
 {
 namespace builder
 {
 
-const float BSP::DEFAULT_SCALE      = 0.01f;
-const float BSP::DEFAULT_LIFE       = 10000.0f;
-const float BSP::DEFAULT_RESISTANCE = 400.0f;
-const float BSP::DEFAULT_MARGIN     = 0.1f;
+const float BSP::DEFAULT_SCALE         = 0.01f;
+const float BSP::DEFAULT_LIFE          = 10000.0f;
+const float BSP::DEFAULT_RESISTANCE    = 400.0f;
+const float BSP::DEFAULT_MARGIN        = 0.1f;
+const float BSP::DEFAULT_OCCLUDER_SIZE = 2.0f;
 
 const float BSP::LIQUID_ALPHA       = 0.75f;
 const float BSP::LIQUID_SPECULAR    = 0.50f;
@@ -74,6 +76,7 @@ void BSP::load()
 
   demolishSound = config["demolishSound"].get("");
   groundOffset  = config["groundOffset"].get(0.0f);
+  occluderSize  = config["occluderSize"].get(DEFAULT_OCCLUDER_SIZE);
 
   mins = Point(-Math::INF, -Math::INF, -Math::INF);
   maxs = Point(+Math::INF, +Math::INF, +Math::INF);
@@ -321,6 +324,7 @@ void BSP::load()
   }
 
   brushes.resize(lumps[QBSPLump::BRUSHES].length / sizeof(QBSPBrush));
+  brushTextures.resize(brushes.length());
 
   if (brushes.length() > oz::BSP::MAX_BRUSHES) {
     OZ_ERROR("Too many brushes %d, maximum is %d", brushes.length(), oz::BSP::MAX_BRUSHES);
@@ -336,6 +340,8 @@ void BSP::load()
 
     int texture = is.readInt();
 
+    brushTextures[i] = texture;
+
     if (textures[texture].flags & QBSP_NONSOLID_FLAG_BIT) {
       if (textures[texture].flags & QBSP_LADDER_FLAG_BIT) {
         brushes[i].flags |= Medium::LADDER_BIT;
@@ -487,301 +493,216 @@ void BSP::load()
   config.clear(true);
 }
 
-void BSP::optimise()
+// Hash for exact plane matching. Adding 0.0f turns -0.0f into +0.0f, so both zeros hash equally.
+struct PlaneHash
 {
-  Log::println("Optimising BSP structure {");
-  Log::indent();
-
-  // remove brushes that lay out of boundaries
-  for (int i = 0; i < brushes.length();) {
-    hard_assert(brushes[i].nSides >= 0);
+  int operator () (const Plane& plane) const
+  {
+    float fields[] = { plane.n.x, plane.n.y, plane.n.z, plane.d };
+    uint  value    = 2166136261u;
 
-    if (brushes[i].nSides != 0) {
-      ++i;
-      continue;
+    for (float field : fields) {
+      value = (value ^ Math::toBits(field + 0.0f)) * 16777619u;
     }
+    return int(value);
+  }
+};
 
-    brushes.erase(i);
-    Log::print("Outside brush removed ");
+// Replace empty leaves by 0 and nodes with an empty side by their other side. Index 0 marks an
+// empty subtree as the root cannot be referenced. Returns the reference that replaces `ref`.
+static int pruneNode(List<oz::BSP::Node>* nodes, const List<oz::BSP::Leaf>& leaves, int ref)
+{
+  if (ref < 0) {
+    return leaves[~ref].nBrushes == 0 ? 0 : ref;
+  }
 
-    // adjust brush references (for leaves)
-    for (int j = 0; j < leafBrushes.length();) {
-      if (leafBrushes[j] < i) {
-        ++j;
-      }
-      else if (i < leafBrushes[j]) {
-        --leafBrushes[j];
-        ++j;
-      }
-      else {
-        leafBrushes.erase(j);
-        Log::printRaw(".");
+  int front = pruneNode(nodes, leaves, (*nodes)[ref].front);
+  int back  = pruneNode(nodes, leaves, (*nodes)[ref].back);
 
-        for (int k = 0; k < leaves.length(); ++k) {
-          if (j < leaves[k].firstBrush) {
-            --leaves[k].firstBrush;
-          }
-          else if (j < leaves[k].firstBrush + leaves[k].nBrushes) {
-            hard_assert(leaves[k].nBrushes > 0);
+  (*nodes)[ref].front = front;
+  (*nodes)[ref].back  = back;
 
-            --leaves[k].nBrushes;
-          }
-        }
-      }
-    }
-    // adjust brush references (for models)
-    for (int j = 0; j < models.length(); ++j) {
-      if (i < models[j].firstBrush) {
-        --models[j].firstBrush;
-      }
-      else if (i < models[j].firstBrush + models[j].nBrushes) {
-        hard_assert(models[j].nBrushes > 0);
+  return front == 0 ? back : back == 0 ? front : ref;
+}
 
-        --models[j].nBrushes;
-      }
-    }
-    Log::println();
-  }
+// Append a pruned subtree in depth-first order, so each node is directly followed by its front
+// subtree. Leaf brush indices are gathered in the same order. Returns the new reference.
+static int emitNode(const List<oz::BSP::Node>& nodes, const List<oz::BSP::Leaf>& leaves,
+                    const List<int>& leafBrushes, int ref, List<oz::BSP::Node>* newNodes,
+                    List<oz::BSP::Leaf>* newLeaves, List<int>* newLeafBrushes)
+{
+  if (ref < 0) {
+    const oz::BSP::Leaf& leaf = leaves[~ref];
 
-  // remove model brushes from the static tree (WTF Quake BSP puts them there?)
-  Log::print("Removing model brush references ");
+    newLeaves->add(oz::BSP::Leaf{ newLeafBrushes->length(), leaf.nBrushes });
+    newLeafBrushes->addAll(&leafBrushes[leaf.firstBrush], leaf.nBrushes);
 
-  for (int i = 0; i < models.length(); ++i) {
-    for (int j = 0; j < models[i].nBrushes; ++j) {
-      int brush = models[i].firstBrush + j;
+    return ~(newLeaves->length() - 1);
+  }
 
-      for (int k = 0; k < leafBrushes.length();) {
-        if (leafBrushes[k] != brush) {
-          ++k;
-          continue;
-        }
+  int index = newNodes->length();
+  newNodes->add(nodes[ref]);
 
-        leafBrushes.erase(k);
-        Log::printRaw(".");
+  int front = emitNode(nodes, leaves, leafBrushes, nodes[ref].front, newNodes, newLeaves,
+                       newLeafBrushes);
+  int back  = emitNode(nodes, leaves, leafBrushes, nodes[ref].back, newNodes, newLeaves,
+                       newLeafBrushes);
 
-        // adjust leaf references
-        for (int l = 0; l < leaves.length(); ++l) {
-          if (k < leaves[l].firstBrush) {
-            --leaves[l].firstBrush;
-          }
-          else if (k < leaves[l].firstBrush + leaves[l].nBrushes) {
-            hard_assert(leaves[l].nBrushes > 0);
+  (*newNodes)[index].front = front;
+  (*newNodes)[index].back  = back;
 
-            --leaves[l].nBrushes;
-          }
-        }
-      }
-    }
-  }
+  return index;
+}
 
-  Log::printEnd(" OK");
+void BSP::optimise()
+{
+  Log::println("Optimising BSP structure {");
+  Log::indent();
 
-  // remove unreferenced leaves
-  Log::print("Removing unreferenced and empty leaves ");
+  uint startTime = Time::clock();
 
-  for (int i = 0; i < leaves.length();) {
-    bool isReferenced = false;
+  int nOldNodes      = nodes.length();
+  int nOldLeaves     = leaves.length();
+  int nOldBrushes    = brushes.length();
+  int nOldBrushSides = brushSides.length();
+  int nOldPlanes     = planes.length();
 
-    for (int j = 0; j < nodes.length(); ++j) {
-      if (nodes[j].front == ~i || nodes[j].back == ~i) {
-        isReferenced = true;
-        break;
-      }
-    }
+  // Brushes with no sides lay out of boundaries and are removed. brushIndices[i] is the number of
+  // kept brushes before brush i, i.e. its new index if it is kept.
+  List<int> brushIndices(brushes.length() + 1);
+  int       nBrushes = 0;
 
-    if (isReferenced && leaves[i].nBrushes != 0) {
-      ++i;
-      continue;
-    }
+  for (int i = 0; i < brushes.length(); ++i) {
+    hard_assert(brushes[i].nSides >= 0);
 
-    leaves.erase(i);
-    Log::printRaw(".");
+    brushIndices[i] = nBrushes;
 
-    // update references and tag unnecessary nodes, will be removed in the next pass (index 0 is
-    // invalid as the root cannot be referenced)
-    for (int j = 0; j < nodes.length(); ++j) {
-      if (~nodes[j].front == i) {
-        nodes[j].front = 0;
-      }
-      else if (~nodes[j].front > i) {
-        ++nodes[j].front;
-      }
-
-      if (~nodes[j].back == i) {
-        nodes[j].back = 0;
-      }
-      else if (~nodes[j].back > i) {
-        ++nodes[j].back;
-      }
+    if (brushes[i].nSides != 0) {
+      ++nBrushes;
     }
   }
+  brushIndices[brushes.length()] = nBrushes;
 
-  Log::printEnd(" OK");
-
-  // collapse unnecessary nodes
-  Log::print("Collapsing nodes ");
-
-  bool hasCollapsed;
-  do {
-    hasCollapsed = false;
+  // Quake BSP also puts model brushes into the static tree, they must be removed from leaves.
+  Bitset modelBrushes(brushes.length());
 
-    for (int i = 0; i < nodes.length();) {
-      if (nodes[i].front != 0 && nodes[i].back != 0) {
-        ++i;
-        continue;
-      }
-      if (i == 0) {
-        // change root node for one of its children, and set i to that child index, so it will
-        // be removed instead of root
-        if (nodes[0].front == 0) {
-          i = nodes[0].back;
-        }
-        else if (nodes[0].back == 0) {
-          i = nodes[0].front;
-        }
-        else {
-          hard_assert(false);
-        }
-        nodes[0] = nodes[i];
+  for (Model& model : models) {
+    for (int i = 0; i < model.nBrushes; ++i) {
+      modelBrushes.set(model.firstBrush + i);
+    }
 
-        Log::printRaw("x");
-      }
-      else {
-        // find parent
-        int* parentsRef = nullptr;
-        for (int j = 0; j < nodes.length(); ++j) {
-          if (nodes[j].front == i) {
-            hard_assert(parentsRef == nullptr);
+    int firstBrush = brushIndices[model.firstBrush];
 
-            parentsRef = &nodes[j].front;
-          }
-          if (nodes[j].back == i) {
-            hard_assert(parentsRef == nullptr);
+    model.nBrushes   = brushIndices[model.firstBrush + model.nBrushes] - firstBrush;
+    model.firstBrush = firstBrush;
+  }
 
-            parentsRef = &nodes[j].back;
-          }
-        }
-        hard_assert(parentsRef != nullptr);
+  List<int> keptLeafBrushes;
+  keptLeafBrushes.reserve(leafBrushes.length());
 
-        if (nodes[i].front == 0) {
-          *parentsRef = nodes[i].back;
-        }
-        else if (nodes[i].back == 0) {
-          *parentsRef = nodes[i].front;
-        }
-        else {
-          hard_assert(false);
-        }
-      }
+  for (oz::BSP::Leaf& leaf : leaves) {
+    int firstBrush = keptLeafBrushes.length();
 
-      nodes.erase(i);
+    for (int i = leaf.firstBrush; i < leaf.firstBrush + leaf.nBrushes; ++i) {
+      int brush = leafBrushes[i];
 
-      for (int j = 0; j < nodes.length(); ++j) {
-        hard_assert(nodes[j].front != i);
-        hard_assert(nodes[j].back != i);
+      if (brushes[brush].nSides != 0 && !modelBrushes.get(brush)) {
+        keptLeafBrushes.add(brushIndices[brush]);
       }
+    }
 
-      // shift nodes' references
-      for (int j = 0; j < nodes.length(); ++j) {
-        if (nodes[j].front > i) {
-          --nodes[j].front;
-        }
-        if (nodes[j].back > i) {
-          --nodes[j].back;
-        }
-      }
+    leaf.firstBrush = firstBrush;
+    leaf.nBrushes   = keptLeafBrushes.length() - firstBrush;
+  }
 
-      Log::printRaw(".");
-      hasCollapsed = true;
+  for (int i = 0; i < brushes.length(); ++i) {
+    if (brushes[i].nSides != 0) {
+      brushes[brushIndices[i]]       = brushes[i];
+      brushTextures[brushIndices[i]] = brushTextures[i];
     }
   }
-  while (hasCollapsed);
+  brushes.resize(nBrushes, true);
+  brushTextures.resize(nBrushes, true);
 
-  Log::printEnd(" OK");
+  // Empty leaves are removed and nodes left with a single child are collapsed into it. The rest of
+  // the tree is written out depth-first, which also drops unreferenced leaves.
+  int root = pruneNode(&nodes, leaves, 0);
 
-  // remove unused brush sides
-  Log::print("Removing unused brush sides ");
+  if (root < 0 || nodes[root].front == 0 || nodes[root].back == 0) {
+    OZ_ERROR("BSP static tree has less than two non-empty leaves");
+  }
 
-  List<bool> usedBrushSides(brushSides.length());
-  Arrays::clear(usedBrushSides.begin(), usedBrushSides.length());
+  List<oz::BSP::Node> newNodes;
+  List<oz::BSP::Leaf> newLeaves;
+  List<int>           newLeafBrushes;
 
-  for (int i = 0; i < brushes.length(); ++i) {
-    for (int j = 0; j < brushes[i].nSides; ++j) {
-      usedBrushSides[brushes[i].firstSide + j] = true;
-    }
-  }
+  newNodes.reserve(nodes.length());
+  newLeaves.reserve(leaves.length());
+  newLeafBrushes.reserve(keptLeafBrushes.length());
 
-  for (int i = 0; i < brushSides.length();) {
-    if (usedBrushSides[i]) {
-      ++i;
-      continue;
-    }
+  emitNode(nodes, leaves, keptLeafBrushes, root, &newNodes, &newLeaves, &newLeafBrushes);
 
-    brushSides.erase(i);
-    usedBrushSides.erase(i);
-    Log::printRaw(".");
+  nodes       = static_cast<List<oz::BSP::Node>&&>(newNodes);
+  leaves      = static_cast<List<oz::BSP::Leaf>&&>(newLeaves);
+  leafBrushes = static_cast<List<int>&&>(newLeafBrushes);
 
-    for (int j = 0; j < brushes.length(); ++j) {
-      if (i < brushes[j].firstSide) {
-        --brushes[j].firstSide;
-      }
-      else if (i < brushes[j].firstSide + brushes[j].nSides) {
-        // removed brush side shouldn't be referenced by any brush
-        hard_assert(false);
-      }
-    }
-  }
+  // Brush sides are gathered in brush order, which drops sides of removed brushes.
+  List<int> newBrushSides;
+  newBrushSides.reserve(brushSides.length());
 
-  usedBrushSides.clear();
-  usedBrushSides.trim();
+  for (oz::BSP::Brush& brush : brushes) {
+    int firstSide = newBrushSides.length();
 
-  Log::printEnd(" OK");
+    newBrushSides.addAll(&brushSides[brush.firstSide], brush.nSides);
+    brush.firstSide = firstSide;
+  }
 
-  // remove unused planes
-  Log::print("Removing unused planes ");
+  brushSides = static_cast<List<int>&&>(newBrushSides);
 
-  List<bool> usedPlanes;
-  usedPlanes.resize(planes.length());
-  Arrays::fill(usedPlanes.begin(), planes.length(), false);
+  // Unused planes are removed and identical ones merged. Opposite planes are different half-spaces
+  // and are kept separate.
+  List<int> planeIndices(planes.length());
+  Arrays::fill(planeIndices.begin(), planeIndices.length(), -1);
 
-  for (int i = 0; i < nodes.length(); ++i) {
-    usedPlanes[nodes[i].plane] = true;
+  for (const oz::BSP::Node& node : nodes) {
+    planeIndices[node.plane] = 0;
   }
-  for (int i = 0; i < brushSides.length(); ++i) {
-    usedPlanes[brushSides[i]] = true;
+  for (int brushSide : brushSides) {
+    planeIndices[brushSide] = 0;
   }
 
-  for (int i = 0; i < planes.length();) {
-    if (usedPlanes[i]) {
-      ++i;
+  FlatHashMap<Plane, int, PlaneHash> uniquePlanes(planes.length());
+  int                                nPlanes = 0;
+
+  for (int i = 0; i < planes.length(); ++i) {
+    if (planeIndices[i] < 0) {
       continue;
     }
 
-    planes.erase(i);
-    usedPlanes.erase(i);
-    Log::printRaw(".");
+    planeIndices[i] = uniquePlanes.include(planes[i], nPlanes).value;
 
-    // adjust plane references
-    for (int j = 0; j < nodes.length(); ++j) {
-      hard_assert(nodes[j].plane != i);
-
-      if (nodes[j].plane > i) {
-        --nodes[j].plane;
-      }
+    if (planeIndices[i] == nPlanes) {
+      planes[nPlanes] = planes[i];
+      ++nPlanes;
     }
-    for (int j = 0; j < brushSides.length(); ++j) {
-      hard_assert(brushSides[j] != i);
+  }
+  planes.resize(nPlanes, true);
 
-      if (brushSides[j] > i) {
-        --brushSides[j];
-      }
-    }
+  for (oz::BSP::Node& node : nodes) {
+    node.plane = planeIndices[node.plane];
+  }
+  for (int& brushSide : brushSides) {
+    brushSide = planeIndices[brushSide];
   }
 
-  usedPlanes.clear();
-  usedPlanes.trim();
+  uint endTime = Time::clock();
 
-  Log::printEnd(" OK");
+  Log::println("Nodes        %5d -> %5d", nOldNodes,      nodes.length());
+  Log::println("Leaves       %5d -> %5d", nOldLeaves,     leaves.length());
+  Log::println("Brushes      %5d -> %5d", nOldBrushes,    brushes.length());
+  Log::println("Brush sides  %5d -> %5d", nOldBrushSides, brushSides.length());
+  Log::println("Planes       %5d -> %5d", nOldPlanes,     planes.length());
+  Log::println("Time         %5d ms", int(endTime - startTime));
 
   // optimise bounds
   Log::print("Fitting bounds: ");
@@ -822,31 +743,34 @@ void BSP::optimise()
   Log::println("Optimising BSP model {");
   Log::indent();
 
-  // remove faces that lay out of boundaries
-  for (int i = 0; i < faces.length();) {
+  // Faces that lay out of boundaries have no indices and are removed. faceIndices[i] is the number
+  // of kept faces before face i.
+  List<int> faceIndices(faces.length() + 1);
+  int       nFaces = 0;
+
+  for (int i = 0; i < faces.length(); ++i) {
     hard_assert(faces[i].nVertices > 0 && faces[i].nIndices >= 0);
 
+    faceIndices[i] = nFaces;
+
     if (faces[i].nIndices != 0) {
-      ++i;
-      continue;
+      faces[nFaces] = faces[i];
+      ++nFaces;
     }
+  }
+  faceIndices[faces.length()] = nFaces;
 
-    faces.erase(i);
-    Log::println("Outside face removed");
-
-    // adjust face references
-    for (int j = 0; j < models.length() + 1; ++j) {
-      if (i < modelFaces[j].firstFace) {
-        --modelFaces[j].firstFace;
-      }
-      else if (i < modelFaces[j].firstFace + modelFaces[j].nFaces) {
-        hard_assert(modelFaces[j].nFaces > 0);
+  for (ModelFaces& model : modelFaces) {
+    int firstFace = faceIndices[model.firstFace];
 
-        --modelFaces[j].nFaces;
-      }
-    }
+    model.nFaces    = faceIndices[model.firstFace + model.nFaces] - firstFace;
+    model.firstFace = firstFace;
   }
 
+  Log::println("Faces        %5d -> %5d", faces.length(), nFaces);
+
+  faces.resize(nFaces, true);
+
   Log::unindent();
   Log::println("}");
 }
@@ -964,6 +888,149 @@ void BSP::check() const
   Log::println("}");
 }
 
+void BSP::buildOccluders()
+{
+  Log::print("Building occluders ...");
+
+  Bitset modelBrushes(brushes.length());
+
+  for (int i = 0; i < models.length(); ++i) {
+    for (int j = 0; j < models[i].nBrushes; ++j) {
+      modelBrushes.set(models[i].firstBrush + j);
+    }
+  }
+
+  int nOccluders = 0;
+
+  for (int i = 0; i < brushes.length(); ++i) {
+    const oz::BSP::Brush& brush = brushes[i];
+    const Texture&        tex   = textures[brushTextures[i]];
+
+    // Only static brushes that are solid and completely opaque are conservative occluders.
+    if (modelBrushes.get(i) || !(brush.flags & Material::STRUCT_BIT) ||
+        !(tex.type & QBSP_SOLID_TYPE_BIT) || (tex.type & QBSP_ALPHA_TYPE_BIT) ||
+        (tex.flags & QBSP_NODRAW_FLAG_BIT) || tex.name.isEmpty())
+    {
+      continue;
+    }
+
+    // Brush corners are intersections of side plane triples that lie inside all other sides.
+    List<Point> corners;
+
+    for (int j = 0; j < brush.nSides; ++j) {
+      const Plane& p0 = planes[brushSides[brush.firstSide + j]];
+
+      for (int k = j + 1; k < brush.nSides; ++k) {
+        const Plane& p1 = planes[brushSides[brush.firstSide + k]];
+
+        for (int l = k + 1; l < brush.nSides; ++l) {
+          const Plane& p2 = planes[brushSides[brush.firstSide + l]];
+
+          float det = p0.n * (p1.n ^ p2.n);
+          if (abs(det) < EPSILON) {
+            continue;
+          }
+
+          Point corner = Point::ORIGIN + (p0.d * (p1.n ^ p2.n) + p1.d * (p2.n ^ p0.n) +
+                                          p2.d * (p0.n ^ p1.n)) / det;
+          bool  isInside = true;
+
+          for (int m = 0; m < brush.nSides && isInside; ++m) {
+            isInside = corner * planes[brushSides[brush.firstSide + m]] <= 4.0f * EPSILON;
+          }
+
+          bool isDuplicate = false;
+
+          for (const Point& c : corners) {
+            isDuplicate |= (c - corner).sqN() < 16.0f * EPSILON * EPSILON;
+          }
+
+          if (isInside && !isDuplicate) {
+            corners.add(corner);
+          }
+        }
+      }
+    }
+
+    if (corners.length() < 4) {
+      continue;
+    }
+
+    Bounds bounds(corners[0], corners[0]);
+
+    for (const Point& c : corners) {
+      bounds.mins = Point(min(bounds.mins.x, c.x), min(bounds.mins.y, c.y),
+                          min(bounds.mins.z, c.z));
+      bounds.maxs = Point(max(bounds.maxs.x, c.x), max(bounds.maxs.y, c.y),
+                          max(bounds.maxs.z, c.z));
+    }
+
+    // Skip brushes that are not large in at least two dimensions, they hardly occlude anything.
+    Vec3 size   = bounds.maxs - bounds.mins;
+    int  nLarge = (size.x >= occluderSize) + (size.y >= occluderSize) +
+                  (size.z >= occluderSize);
+
+    if (nLarge < 2) {
+      continue;
+    }
+    if (occluderVertices.length() + corners.length() > USHRT_MAX) {
+      Log::printRaw(" vertex limit reached ...");
+      break;
+    }
+
+    int firstVertex = occluderVertices.length();
+    occluderVertices.addAll(corners.begin(), corners.length());
+
+    // Each side is a convex polygon; sort its corners by angle and triangulate it as a fan.
+    for (int j = 0; j < brush.nSides; ++j) {
+      const Plane& plane = planes[brushSides[brush.firstSide + j]];
+
+      List<int> polygon;
+      Point     centre = Point::ORIGIN;
+
+      for (int k = 0; k < corners.length(); ++k) {
+        if (abs(corners[k] * plane) <= 4.0f * EPSILON) {
+          polygon.add(k);
+          centre += corners[k] - Point::ORIGIN;
+        }
+      }
+
+      if (polygon.length() < 3) {
+        continue;
+      }
+
+      centre = Point::ORIGIN + (centre - Point::ORIGIN) / float(polygon.length());
+
+      Vec3 u = ~(corners[polygon[0]] - centre);
+      Vec3 v = plane.n ^ u;
+
+      List<float> angles;
+
+      for (int k : polygon) {
+        Vec3 d = corners[k] - centre;
+        angles.add(Math::atan2(d * v, d * u));
+      }
+
+      for (int k = 1; k < polygon.length(); ++k) {
+        for (int l = k; l > 0 && angles[l] < angles[l - 1]; --l) {
+          swap(angles[l], angles[l - 1]);
+          swap(polygon[l], polygon[l - 1]);
+        }
+      }
+
+      for (int k = 2; k < polygon.length(); ++k) {
+        occluderIndices.add(ushort(firstVertex + polygon[0]));
+        occluderIndices.add(ushort(firstVertex + polygon[k - 1]));
+        occluderIndices.add(ushort(firstVertex + polygon[k]));
+      }
+    }
+
+    ++nOccluders;
+  }
+
+  Log::printEnd(" %d brushes, %d triangles OK", nOccluders, occluderIndices.length() / 3);
+}
+
 void BSP::saveMatrix()
 {
   File destFile = "bsp/" + name + ".ozBSP";
@@ -1177,8 +1244,23 @@ void BSP::saveClient()
   Stream os(0, Endian::LITTLE);
 
   compiler.writeModel(&os, true);
+
+  int occludersPos = os.tell();
+
+  os.writeInt(occluderVertices.length());
+  for (const Point& p : occluderVertices) {
+    os.writePoint(p);
+  }
+
+  os.writeInt(occluderIndices.length());
+  for (ushort i : occluderIndices) {
+    os.writeUShort(i);
+  }
+
   os.writeVec4(waterFogColour);
   os.writeVec4(lavaFogColour);
+  os.writeInt(occludersPos);
+  os.writeInt(client::OcclusionBuffer::OCCLUDER_MAGIC);
 
   Log::print("Writing BSP model to '%s' ...", destFile.c());
 
@@ -1199,6 +1281,7 @@ void BSP::build(const char* name_)
   load();
   optimise();
   check();
+  buildOccluders();
   saveMatrix();
   saveClient();
 
@@ -1220,6 +1303,8 @@ void BSP::build(const char* name_)
   models.clear();
   brushes.clear();
   brushes.trim();
+  brushTextures.clear();
+  brushTextures.trim();
   brushSides.clear();
   brushSides.trim();
   modelFaces.clear();
@@ -1227,6 +1312,10 @@ void BSP::build(const char* name_)
   indices.clear();
   faces.clear();
   faces.trim();
+  occluderVertices.clear();
+  occluderVertices.trim();
+  occluderIndices.clear();
+  occluderIndices.trim();
   boundObjects.clear();
   boundObjects.trim();
 
@@ -36,7 +36,8 @@ namespace builder
  * BSP builder.
  *
  * Reads Quake 3 BSP & configuration file and prebuilds both matrix (.ozBSP) and client (.ozcModel)
- * BSPs. It also strips bounding shell and performs some BSP optimisation.
+ * BSPs. It also strips bounding shell and performs some BSP optimisation. Large opaque static
+ * brushes are written to the client BSP as an occluder mesh for software occlusion culling.
  */
 class BSP : public Bounds
 {
@@ -46,6 +47,7 @@ private:
   static const float DEFAULT_LIFE;
   static const float DEFAULT_RESISTANCE;
   static const float DEFAULT_MARGIN;
+  static const float DEFAULT_OCCLUDER_SIZE;
 
   static const float LIQUID_ALPHA;
   static const float LIQUID_SPECULAR;
@@ -55,7 +57,9 @@ private:
   // Quake
   static const int   QBSP_SLICK_FLAG_BIT    = 0x00000002;
   static const int   QBSP_LADDER_FLAG_BIT   = 0x00000008;
+  static const int   QBSP_NODRAW_FLAG_BIT   = 0x00000080;
   static const int   QBSP_NONSOLID_FLAG_BIT = 0x00004000;
+  static const int   QBSP_SOLID_TYPE_BIT    = 0x00000001;
   static const int   QBSP_LAVA_TYPE_BIT     = 0x00000008;
   static const int   QBSP_SEA_TYPE_BIT      = 0x00000010;
   static const int   QBSP_WATER_TYPE_BIT    = 0x00000020;
@@ -278,6 +282,7 @@ private:
   List<oz::BSP::Leaf>  leaves;
   List<int>            leafBrushes;
   List<oz::BSP::Brush> brushes;
+  List<int>            brushTextures;
   List<int>            brushSides;
   List<Model>          models;
   List<ModelFaces>     modelFaces;
@@ -297,9 +302,14 @@ private:
   Vec4                 waterFogColour;
   Vec4                 lavaFogColour;
 
+  float                occluderSize;
+  List<Point>          occluderVertices;
+  List<ushort>         occluderIndices;
+
   void load();
   void optimise();
   void check() const;
+  void buildOccluders();
   void saveMatrix();
   void saveClient();
 
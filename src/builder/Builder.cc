@@ -34,6 +34,8 @@
 #include <builder/MD2.hh>
 #include <builder/MD3.hh>
 
+#include <matrix/Liber.hh>
+
 #include <unistd.h>
 
 namespace oz
@@ -528,6 +530,175 @@ void Builder::buildMissions()
   Log::println("}");
 }
 
+// Write a resource list and a perfect hash of resource names to a catalogue.
+static void writeResources(Stream* os, const List<Liber::Resource>& resources, const char* type)
+{
+  List<const char*> names;
+  PerfectHash       index;
+
+  os->writeInt(resources.length());
+
+  for (const Liber::Resource& resource : resources) {
+    os->writeString(resource.name);
+    os->writeString(resource.path);
+
+    names.add(resource.name);
+  }
+
+  if (!index.build(names.begin(), names.length())) {
+    OZ_ERROR("Hash collision in %s names", type);
+  }
+
+  for (int i = 0; i < names.length(); ++i) {
+    int first = index.index(names[i]);
+
+    if (first != i) {
+      OZ_ERROR("Duplicated %s '%s' (%s, %s)", type, names[i], resources[first].path.c(),
+               resources[i].path.c());
+    }
+  }
+
+  index.write(os);
+}
+
+// Add files in a built data directory that have a given extension.
+static void listFiles(const File& dir, const char* ext, List<Liber::Resource>* resources)
+{
+  for (const File& file : dir.list()) {
+    if (file.hasExtension(ext)) {
+      resources->add(Liber::Resource{ file.baseName(), "@" + file });
+    }
+  }
+}
+
+// Add music tracks in a built data directory and its subdirectories.
+static void listMusic(const File& dir, List<Liber::Resource>* resources)
+{
+  for (const File& file : dir.list()) {
+    if (file.isDirectory()) {
+      listMusic(file, resources);
+    }
+    else if (file.hasExtension("oga") || file.hasExtension("ogg")) {
+      resources->add(Liber::Resource{ file.baseName(), "@" + file });
+    }
+  }
+}
+
+void Builder::buildCatalogue(const char* name)
+{
+  File destFile = String::format("%s.ozLiber", name);
+
+  Log::print("Writing resource catalogue '%s' ...", destFile.c());
+
+  List<Liber::Resource> shaders;
+  List<Liber::Resource> textures;
+  List<Liber::Resource> sounds;
+  List<Liber::Resource> caela;
+  List<Liber::Resource> terrae;
+  List<Liber::Resource> models;
+  List<Liber::Resource> musicTracks;
+  List<Liber::Resource> parts;
+
+  // Resources are listed by the same rules as `Liber` uses for scanning directories.
+  listFiles("glsl", "json", &shaders);
+
+  for (const File& subDir : File("tex").list()) {
+    for (const File& file : subDir.list()) {
+      if (file.hasExtension("dds") && !file.endsWith("_m.dds") && !file.endsWith("_n.dds")) {
+        String textureName = subDir.name() + "/" + file.baseName();
+
+        textures.add(Liber::Resource{ textureName, "@tex/" + textureName });
+      }
+    }
+  }
+
+  for (const File& subDir : File("snd").list()) {
+    for (const File& file : subDir.list()) {
+      if (file.hasExtension("wav") || file.hasExtension("oga") || file.hasExtension("ogg")) {
+        sounds.add(Liber::Resource{ subDir.name() + "/" + file.baseName(), "@" + file });
+      }
+    }
+  }
+
+  for (const File& subDir : File("caelum").list()) {
+    if (subDir.isDirectory()) {
+      caela.add(Liber::Resource{ subDir.baseName(), "@" + subDir });
+    }
+  }
+
+  listFiles("terra", "ozTerra", &terrae);
+
+  for (const File& subDir : File("mdl").list()) {
+    File file = subDir / "data.ozcModel";
+
+    if (file.isFile()) {
+      models.add(Liber::Resource{ subDir.name(), "@" + file });
+    }
+  }
+
+  listMusic("music", &musicTracks);
+  listFiles("part", "json", &parts);
+
+  Stream os(0, Endian::LITTLE);
+
+  os.writeInt(Liber::CATALOGUE_MAGIC);
+  os.writeInt(Liber::CATALOGUE_VERSION);
+
+  writeResources(&os, shaders, "shader");
+  writeResources(&os, textures, "texture");
+  writeResources(&os, sounds, "sound");
+  writeResources(&os, caela, "caelum");
+  writeResources(&os, terrae, "terra");
+  writeResources(&os, models, "model");
+  writeResources(&os, musicTracks, "music track");
+  writeResources(&os, parts, "particle class");
+
+  // Descriptions are stored parsed, in binary encoding.
+  const char* descriptionDirs[] = { "frag", "class" };
+
+  for (const char* dirName : descriptionDirs) {
+    List<File> files;
+
+    for (const File& file : File(dirName).list()) {
+      if (file.hasExtension("json")) {
+        files.add(file);
+      }
+    }
+
+    os.writeInt(files.length());
+
+    for (const File& file : files) {
+      Json config;
+      if (!config.load(file)) {
+        OZ_ERROR("Failed to read '%s'", file.c());
+      }
+
+      os.writeString(file.baseName());
+      config.write(&os);
+    }
+  }
+
+  List<String> bsps;
+
+  for (const File& file : File("bsp").list()) {
+    if (file.hasExtension("ozBSP")) {
+      bsps.add(file.baseName());
+    }
+  }
+
+  os.writeInt(bsps.length());
+
+  for (const String& bsp : bsps) {
+    os.writeString(bsp);
+  }
+
+  if (!destFile.write(os.begin(), os.tell())) {
+    OZ_ERROR("Failed to write '%s'", destFile.c());
+  }
+
+  Log::printEnd(" OK");
+}
+
 void Builder::packArchive(const char* name, bool useCompression, bool use7zip)
 {
   Log::println("Packing archive {");
@@ -831,6 +1002,7 @@ int Builder::main(int argc, char** argv)
     buildMissions();
   }
 
+  buildCatalogue(pkgName);
   packArchive(pkgName, useCompression, use7zip);
 
   uint endTime = Time::clock();
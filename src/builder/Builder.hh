@@ -50,6 +50,7 @@ private:
   void copySounds();
   void checkLua(const File& dir);
   void buildMissions();
+  void buildCatalogue(const char* name);
   void packArchive(const char* name, bool useCompresion, bool use7zip);
 
 public:
@@ -24,6 +24,7 @@
 #include <builder/Compiler.hh>
 
 #include <builder/Context.hh>
+#include <builder/MeshOptimiser.hh>
 
 using oz::client::Animation;
 
@@ -92,14 +93,21 @@ struct Vertex
   }
 };
 
-struct Triangle
+struct VertexHash
 {
-  float depth;
-  int   index;
-
-  bool operator < (const Triangle& t) const
+  // Only fields that are set before welding are hashed. Adding 0.0f turns -0.0f into +0.0f, so
+  // both zeros, which compare equal, also hash equally.
+  int operator () (const Vertex& v) const
   {
-    return depth < t.depth;
+    float fields[] = {
+      v.pos.x, v.pos.y, v.pos.z, v.texCoord.u, v.texCoord.v, v.normal.x, v.normal.y, v.normal.z
+    };
+    uint  value    = 2166136261u;
+
+    for (float field : fields) {
+      value = (value ^ Math::toBits(field + 0.0f)) * 16777619u;
+    }
+    return int(value);
   }
 };
 
@@ -111,7 +119,20 @@ struct Mesh
 
   int          firstIndex;
   int          nIndices;
-  List<ushort> indices;
+  int          firstMeshlet;
+  int          nMeshlets;
+  List<uint>   indices;
+};
+
+static const int MESHLET_TRIANGLES    = 256;
+static const int MESHLET_MIN_MESHLETS = 4;
+
+struct Meshlet
+{
+  int   firstIndex;
+  int   nIndices;
+  Point centre;
+  float radius;
 };
 
 struct Light : client::Light
@@ -161,6 +182,8 @@ static List<Light>        lights;
 static List<Node*>        nodes;
 static List<Animation>    animations;
 
+static FlatHashMap<Vertex, int, VertexHash> vertexIndices;
+
 static Bounds             bounds;
 
 static Vertex             vert;
@@ -178,7 +201,7 @@ static int                nFrames;
 static int                nFramePositions;
 static Compiler::PolyMode mode;
 static int                vertNum;
-static List<ushort>       polyIndices;
+static List<uint>         polyIndices;
 
 static void calculateBounds(const Node* node, const Mat4& parentTransf)
 {
@@ -241,6 +264,8 @@ void Compiler::beginModel()
   normals.trim();
   vertices.clear();
   vertices.trim();
+  vertexIndices.clear();
+  vertexIndices.trim();
   meshes.clear();
   meshes.trim();
   lights.clear();
@@ -533,15 +558,25 @@ void Compiler::vertex(float x, float y, float z)
   int index;
 
   if (caps & UNIQUE) {
-    index = int(&vertices.include(vert) - vertices.begin());
+    const int* existing = vertexIndices.find(vert);
+
+    if (existing != nullptr) {
+      index = *existing;
+    }
+    else {
+      index = vertices.length();
 
-    polyIndices.add(ushort(index));
+      vertices.add(vert);
+      vertexIndices.add(vert, index);
+    }
+
+    polyIndices.add(uint(index));
   }
   else {
     index = vertices.length();
 
     vertices.add(vert);
-    polyIndices.add(ushort(index));
+    polyIndices.add(uint(index));
   }
 
   ++vertNum;
@@ -686,8 +721,9 @@ void Compiler::writeModel(Stream* os, bool globalTextures)
 
   Log::print("Writing mesh ...");
 
-  List<String> textures;
-  List<ushort> indices;
+  List<String>  textures;
+  List<uint>    indices;
+  List<Meshlet> meshlets;
 
   int nIndices = 0;
 
@@ -710,24 +746,6 @@ void Compiler::writeModel(Stream* os, bool globalTextures)
     storeNode(&root, i);
   }
 
-  os->writeVec3(bounds.dim());
-
-  os->writeString(shaderName);
-  os->writeInt(globalTextures ? ~textures.length() : textures.length());
-  os->writeInt(vertices.length());
-  os->writeInt(nIndices);
-  os->writeInt(nFrames);
-  os->writeInt(nFramePositions);
-
-  os->writeInt(meshes.length());
-  os->writeInt(lights.length());
-  os->writeInt(Node::pool.length());
-  os->writeInt(animations.length());
-
-  for (const String& texture : textures) {
-    os->writeString(texture);
-  }
-
   // Generate tangents and binormals.
   for (int i = 0; i < indices.length(); i += 3) {
     Vertex* v[3] = {
@@ -788,14 +806,111 @@ void Compiler::writeModel(Stream* os, bool globalTextures)
     }
   }
 
+  // Reorder triangles of solid meshes for the vertex cache and less overdraw. Blended meshes are
+  // left in the original order, which might be relied upon as they are not depth-sorted.
+  List<Point> vertexPositions(vertices.length());
+
+  for (int i = 0; i < vertices.length(); ++i) {
+    vertexPositions[i] = nFrames == 0 ? vertices[i].pos : positions[int(vertices[i].pos.x)];
+  }
+
+  float acmr = MeshOptimiser::acmr(indices.begin(), indices.length());
+
+  for (const Mesh& mesh : meshes) {
+    if (mesh.flags & Model::SOLID_BIT) {
+      MeshOptimiser::reorderTriangles(indices.begin() + mesh.firstIndex, mesh.nIndices,
+                                      vertices.length(), vertexPositions.begin());
+    }
+  }
+
+  List<int>    remap(vertices.length());
+  List<Vertex> orderedVertices(vertices.length());
+
+  MeshOptimiser::reorderVertices(indices.begin(), indices.length(), vertices.length(),
+                                 remap.begin());
+
+  for (int i = 0; i < vertices.length(); ++i) {
+    orderedVertices[remap[i]] = static_cast<Vertex&&>(vertices[i]);
+  }
+  vertices = static_cast<List<Vertex>&&>(orderedVertices);
+
+  for (Mesh& mesh : meshes) {
+    mesh.indices = List<uint>(indices.begin() + mesh.firstIndex, mesh.nIndices);
+  }
+
+  float optimisedACMR = MeshOptimiser::acmr(indices.begin(), indices.length());
+
+  // Bounding spheres of consecutive triangle runs let the client cull parts of large static meshes.
+  for (Mesh& mesh : meshes) {
+    mesh.firstMeshlet = meshlets.length();
+    mesh.nMeshlets    = 0;
+
+    if (nFrames != 0 || mesh.nIndices < MESHLET_MIN_MESHLETS * MESHLET_TRIANGLES * 3) {
+      continue;
+    }
+
+    for (int i = 0; i < mesh.nIndices; i += MESHLET_TRIANGLES * 3) {
+      int    first = mesh.firstIndex + i;
+      int    count = min(MESHLET_TRIANGLES * 3, mesh.nIndices - i);
+      Bounds meshletBounds(Point(+Math::INF, +Math::INF, +Math::INF),
+                           Point(-Math::INF, -Math::INF, -Math::INF));
+
+      for (int j = first; j < first + count; ++j) {
+        meshletBounds.mins = min(meshletBounds.mins, vertices[indices[j]].pos);
+        meshletBounds.maxs = max(meshletBounds.maxs, vertices[indices[j]].pos);
+      }
+
+      Point centre = meshletBounds.mins + (meshletBounds.maxs - meshletBounds.mins) * 0.5f;
+      float radius = 0.0f;
+
+      for (int j = first; j < first + count; ++j) {
+        radius = max(radius, (vertices[indices[j]].pos - centre).sqN());
+      }
+
+      meshlets.add(Meshlet{ first, count, centre, Math::sqrt(radius) });
+      ++mesh.nMeshlets;
+    }
+  }
+
+  // 16-bit indices unless there are too many vertices.
+  int indexSize = vertices.length() > 65536 ? int(sizeof(uint)) : int(sizeof(ushort));
+
+  os->writeInt(Model::FORMAT_MAGIC);
+  os->writeInt(Model::FORMAT_VERSION);
+  os->writeVec3(bounds.dim());
+
+  os->writeString(shaderName);
+  os->writeInt(globalTextures ? ~textures.length() : textures.length());
+  os->writeInt(vertices.length());
+  os->writeInt(nIndices);
+  os->writeInt(nFrames);
+  os->writeInt(nFramePositions);
+
+  os->writeInt(meshes.length());
+  os->writeInt(lights.length());
+  os->writeInt(Node::pool.length());
+  os->writeInt(animations.length());
+
+  os->writeInt(indexSize);
+  os->writeInt(meshlets.length());
+
+  for (const String& texture : textures) {
+    os->writeString(texture);
+  }
+
   for (Vertex& vertex : vertices) {
     if (nFrames != 0) {
       vertex.pos = Point((vertex.pos.x + 0.5f) / float(nFramePositions), 0.0f, 0.0f);
     }
     vertex.write(os);
   }
-  for (ushort index : indices) {
-    os->writeUShort(index);
+  for (uint index : indices) {
+    if (indexSize == int(sizeof(ushort))) {
+      os->writeUShort(ushort(index));
+    }
+    else {
+      os->writeUInt(index);
+    }
   }
 
   if (nFrames != 0) {
@@ -817,6 +932,16 @@ void Compiler::writeModel(Stream* os, bool globalTextures)
 
     os->writeInt(mesh.nIndices);
     os->writeInt(mesh.firstIndex);
+
+    os->writeInt(mesh.nMeshlets);
+    os->writeInt(mesh.firstMeshlet);
+  }
+
+  for (const Meshlet& meshlet : meshlets) {
+    os->writeInt(meshlet.nIndices);
+    os->writeInt(meshlet.firstIndex);
+    os->writePoint(meshlet.centre);
+    os->writeFloat(meshlet.radius);
   }
 
   for (const Light& light : lights) {
@@ -871,7 +996,8 @@ void Compiler::writeModel(Stream* os, bool globalTextures)
     }
   }
 
-  Log::printEnd(" OK");
+  Log::printEnd(" OK, ACMR %.2f -> %.2f, %d-bit indices, %d meshlets", acmr, optimisedACMR,
+                indexSize * 8, meshlets.length());
 }
 
 void Compiler::buildModelTextures(const File& destDir)
@@ -904,6 +1030,9 @@ void Compiler::destroy()
   vertices.clear();
   vertices.trim();
 
+  vertexIndices.clear();
+  vertexIndices.trim();
+
   meshes.clear();
   meshes.trim();
 
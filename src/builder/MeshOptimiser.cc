@@ -0,0 +1,309 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file builder/MeshOptimiser.cc
+ */
+
+#include <builder/MeshOptimiser.hh>
+
+namespace oz
+{
+namespace builder
+{
+
+struct Cluster
+{
+  int   firstTriangle;
+  int   nTriangles;
+  float depth;
+
+  // Outermost clusters first.
+  bool operator < (const Cluster& c) const
+  {
+    return depth > c.depth;
+  }
+};
+
+/**
+ * FIFO post-transform cache simulation.
+ */
+class VertexCache
+{
+private:
+
+  List<int> entries;
+  int       head = 0;
+
+public:
+
+  explicit VertexCache(int size) :
+    entries(size)
+  {
+    Arrays::fill(entries.begin(), size, -1);
+  }
+
+  /**
+   * Fetch a vertex, return true on a miss.
+   */
+  bool fetch(int index)
+  {
+    if (entries.contains(index)) {
+      return false;
+    }
+
+    entries[head] = index;
+    head          = (head + 1) % entries.length();
+    return true;
+  }
+};
+
+float MeshOptimiser::acmr(const uint* indices, int nIndices, int cacheSize)
+{
+  if (nIndices < 3) {
+    return 0.0f;
+  }
+
+  VertexCache cache(cacheSize);
+  int         nMisses = 0;
+
+  for (int i = 0; i < nIndices; ++i) {
+    nMisses += cache.fetch(indices[i]);
+  }
+  return float(nMisses) / float(nIndices / 3);
+}
+
+void MeshOptimiser::reorderTriangles(uint* indices, int nIndices, int nVertices,
+                                     const Point* positions, int cacheSize)
+{
+  int nTriangles = nIndices / 3;
+
+  if (nTriangles < 2) {
+    return;
+  }
+
+  // Triangles adjacent to each vertex, packed into one array.
+  List<int> nLive(nVertices);
+  List<int> firstAdjacent(nVertices + 1);
+  List<int> adjacent(nIndices);
+
+  Arrays::fill(nLive.begin(), nVertices, 0);
+
+  for (int i = 0; i < nIndices; ++i) {
+    ++nLive[indices[i]];
+  }
+
+  firstAdjacent[0] = 0;
+  for (int i = 0; i < nVertices; ++i) {
+    firstAdjacent[i + 1] = firstAdjacent[i] + nLive[i];
+  }
+
+  List<int> adjacentEnd(firstAdjacent.begin(), nVertices);
+
+  for (int i = 0; i < nIndices; ++i) {
+    adjacent[adjacentEnd[indices[i]]++] = i / 3;
+  }
+
+  // Tipsify.
+  List<int>  cacheTime(nVertices);
+  List<bool> isEmitted(nTriangles);
+  List<int>  deadEnd;
+  List<int>  candidates;
+  List<int>  order;
+
+  Arrays::fill(cacheTime.begin(), nVertices, 0);
+  Arrays::fill(isEmitted.begin(), nTriangles, false);
+
+  int fanning = indices[0];
+  int time    = cacheSize + 1;
+  int cursor  = 0;
+
+  while (fanning >= 0) {
+    candidates.clear();
+
+    for (int i = firstAdjacent[fanning]; i < firstAdjacent[fanning + 1]; ++i) {
+      int triangle = adjacent[i];
+
+      if (isEmitted[triangle]) {
+        continue;
+      }
+
+      for (int j = 0; j < 3; ++j) {
+        int vertex = indices[triangle * 3 + j];
+
+        deadEnd.add(vertex);
+        candidates.add(vertex);
+        --nLive[vertex];
+
+        if (time - cacheTime[vertex] > cacheSize) {
+          cacheTime[vertex] = time;
+          ++time;
+        }
+      }
+
+      isEmitted[triangle] = true;
+      order.add(triangle);
+    }
+
+    // Prefer the candidate that is oldest in the cache, yet will stay there while its remaining
+    // triangles are emitted.
+    int next         = -1;
+    int bestPriority = -1;
+
+    for (int vertex : candidates) {
+      if (nLive[vertex] > 0) {
+        int priority = 0;
+
+        if (time - cacheTime[vertex] + 2 * nLive[vertex] <= cacheSize) {
+          priority = time - cacheTime[vertex];
+        }
+        if (priority > bestPriority) {
+          bestPriority = priority;
+          next         = vertex;
+        }
+      }
+    }
+
+    // Dead end, continue from the most recently used vertex with live triangles or with the next
+    // vertex in input order.
+    while (next < 0 && !deadEnd.isEmpty()) {
+      int vertex = deadEnd.popLast();
+
+      if (nLive[vertex] > 0) {
+        next = vertex;
+      }
+    }
+    while (next < 0 && cursor < nVertices) {
+      if (nLive[cursor] > 0) {
+        next = cursor;
+      }
+      ++cursor;
+    }
+
+    fanning = next;
+  }
+
+  hard_assert(order.length() == nTriangles);
+
+  // Split into clusters at triangles that miss the cache with all vertices. Moving such clusters
+  // around does not cost additional vertex transformations.
+  List<Cluster> clusters;
+  VertexCache   cache(cacheSize);
+
+  for (int i = 0; i < nTriangles; ++i) {
+    int triangle = order[i];
+    int nMisses  = cache.fetch(indices[triangle * 3 + 0]) +
+                   cache.fetch(indices[triangle * 3 + 1]) +
+                   cache.fetch(indices[triangle * 3 + 2]);
+
+    if (nMisses == 3 || i == 0) {
+      clusters.add(Cluster{ i, 0, 0.0f });
+    }
+    ++clusters.last().nTriangles;
+  }
+
+  if (positions != nullptr && clusters.length() > 1) {
+    Vec3  centreSum = Vec3::ZERO;
+    float areaSum   = 0.0f;
+
+    for (int i = 0; i < nIndices; i += 3) {
+      Point a    = positions[indices[i + 0]];
+      Point b    = positions[indices[i + 1]];
+      Point c    = positions[indices[i + 2]];
+      float area = !((b - a) ^ (c - a));
+
+      centreSum += area * ((a - Point::ORIGIN) + (b - Point::ORIGIN) + (c - Point::ORIGIN));
+      areaSum   += area;
+    }
+
+    if (areaSum != 0.0f) {
+      Point centre = Point::ORIGIN + centreSum / (3.0f * areaSum);
+
+      // Depth is how far in front of the model centre a cluster lies along its average normal.
+      for (Cluster& cluster : clusters) {
+        Vec3  clusterSum    = Vec3::ZERO;
+        Vec3  normalSum     = Vec3::ZERO;
+        float clusterArea   = 0.0f;
+
+        for (int i = cluster.firstTriangle; i < cluster.firstTriangle + cluster.nTriangles; ++i) {
+          int   triangle = order[i];
+          Point a        = positions[indices[triangle * 3 + 0]];
+          Point b        = positions[indices[triangle * 3 + 1]];
+          Point c        = positions[indices[triangle * 3 + 2]];
+          Vec3  normal   = (b - a) ^ (c - a);
+          float area     = !normal;
+
+          clusterSum  += area * ((a - centre) + (b - centre) + (c - centre));
+          normalSum   += normal;
+          clusterArea += area;
+        }
+
+        float normalLength = !normalSum;
+
+        if (clusterArea != 0.0f && normalLength != 0.0f) {
+          cluster.depth = (clusterSum * normalSum) / (3.0f * clusterArea * normalLength);
+        }
+      }
+
+      clusters.sort();
+    }
+  }
+
+  List<uint> sortedIndices(nIndices);
+  int          nSorted = 0;
+
+  for (const Cluster& cluster : clusters) {
+    for (int i = cluster.firstTriangle; i < cluster.firstTriangle + cluster.nTriangles; ++i) {
+      int triangle = order[i];
+
+      sortedIndices[nSorted + 0] = indices[triangle * 3 + 0];
+      sortedIndices[nSorted + 1] = indices[triangle * 3 + 1];
+      sortedIndices[nSorted + 2] = indices[triangle * 3 + 2];
+      nSorted += 3;
+    }
+  }
+
+  Arrays::copy<uint>(sortedIndices.begin(), nSorted, indices);
+}
+
+void MeshOptimiser::reorderVertices(uint* indices, int nIndices, int nVertices, int* remap)
+{
+  int nRemapped = 0;
+
+  Arrays::fill(remap, nVertices, -1);
+
+  for (int i = 0; i < nIndices; ++i) {
+    if (remap[indices[i]] < 0) {
+      remap[indices[i]] = nRemapped++;
+    }
+  }
+  for (int i = 0; i < nVertices; ++i) {
+    if (remap[i] < 0) {
+      remap[i] = nRemapped++;
+    }
+  }
+
+  for (int i = 0; i < nIndices; ++i) {
+    indices[i] = uint(remap[indices[i]]);
+  }
+}
+
+}
+}
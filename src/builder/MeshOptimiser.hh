@@ -0,0 +1,82 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file builder/MeshOptimiser.hh
+ */
+
+#pragma once
+
+#include <builder/common.hh>
+
+namespace oz
+{
+namespace builder
+{
+
+/**
+ * Index and vertex order optimisations for triangle lists.
+ *
+ * Triangles are reordered with Tipsify (Sander, Nehab, Barczak: Fast Triangle Reordering for
+ * Vertex Locality and Reduced Overdraw) so that consecutive triangles share vertices still present
+ * in the post-transform cache. The result is split into clusters at triangles that miss the cache
+ * with all three vertices and clusters are sorted so that the outer, outward-facing ones are drawn
+ * first, which lets early depth test reject more fragments of the inner ones.
+ */
+class MeshOptimiser
+{
+public:
+
+  /// Simulated post-transform cache size.
+  static const int CACHE_SIZE = 16;
+
+public:
+
+  /**
+   * Average cache miss ratio (transformed vertices per triangle) for a FIFO cache.
+   */
+  static float acmr(const uint* indices, int nIndices, int cacheSize = CACHE_SIZE);
+
+  /**
+   * Reorder triangles for the vertex cache and then order clusters to reduce overdraw.
+   *
+   * Overdraw ordering is skipped if `positions` is `nullptr`.
+   *
+   * @param indices triangle list that is reordered in place.
+   * @param nVertices number of vertices indices refer to.
+   * @param positions vertex positions, indexed by vertex index.
+   */
+  static void reorderTriangles(uint* indices, int nIndices, int nVertices,
+                               const Point* positions, int cacheSize = CACHE_SIZE);
+
+  /**
+   * Renumber vertices in order of first use, so vertex fetches are sequential.
+   *
+   * Unreferenced vertices are moved to the end.
+   *
+   * @param indices updated to new vertex numbers.
+   * @param remap receives new index for each old vertex index, must hold `nVertices` elements.
+   */
+  static void reorderVertices(uint* indices, int nIndices, int nVertices, int* remap);
+
+};
+
+}
+}
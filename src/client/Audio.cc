@@ -36,15 +36,50 @@ const float Audio::ROLLOFF_FACTOR       = 0.35f;
 const float Audio::COCKPIT_GAIN_FACTOR  = 0.35f;
 const float Audio::COCKPIT_PITCH_FACTOR = 0.95f;
 
+const float Audio::PLAYER_WEIGHT        = 8.00f;
+const float Audio::CONT_WEIGHT          = 1.00f;
+const float Audio::ENGINE_WEIGHT        = 1.50f;
+
 Collider Audio::collider;
 
-void Audio::playSound(int sound, float volume, const Object* parent) const
+float Audio::priority(const Point& p, float volume, float weight)
+{
+  return VoicePool::priority(volume, !(p - camera.p), REFERENCE_DISTANCE, ROLLOFF_FACTOR, weight);
+}
+
+float Audio::eventWeight(int event)
+{
+  switch (event) {
+    case Object::EVENT_DESTROY: {
+      return 4.00f;
+    }
+    case Object::EVENT_CREATE:
+    case Object::EVENT_USE:
+    case Object::EVENT_FAIL: {
+      return 2.00f;
+    }
+    case Object::EVENT_HIT:
+    case Object::EVENT_LAND: {
+      return 0.50f;
+    }
+    default: {
+      return 1.00f;
+    }
+  }
+}
+
+void Audio::playSound(int sound, float volume, const Object* parent, int event) const
 {
   hard_assert(uint(sound) < uint(liber.sounds.length()));
 
   const Dynamic* dynParent = static_cast<const Dynamic*>(parent);
 
-  uint srcId = context.addSource(sound);
+  bool  isPlayer = parent == camera.botObj || obj == camera.botObj ||
+                   (camera.botObj != nullptr && parent->index == camera.botObj->parent);
+  float priority = isPlayer ? Audio::priority(camera.p, volume, PLAYER_WEIGHT) :
+                              Audio::priority(parent->p, volume, eventWeight(event));
+
+  uint srcId = context.addSource(sound, priority);
   if (srcId == Context::INVALID_SOURCE) {
     return;
   }
@@ -59,9 +94,7 @@ void Audio::playSound(int sound, float volume, const Object* parent) const
   // However, when the sound is generated by the player (e.g. cries, talk) it is often annoying
   // if the sound source doesn't move with the player. That's why we position such sounds
   // at the origin of the coordinate system relative to player.
-  if (parent == camera.botObj || obj == camera.botObj ||
-      (camera.botObj != nullptr && parent->index == camera.botObj->parent))
-  {
+  if (isPlayer) {
     alSourcef(srcId, AL_GAIN, volume);
     alSourcei(srcId, AL_SOURCE_RELATIVE, AL_TRUE);
   }
@@ -85,14 +118,16 @@ void Audio::playContSound(int sound, float volume, const Object* parent) const
 {
   hard_assert(uint(sound) < uint(liber.sounds.length()));
 
-  int key = obj->index * ObjectClass::MAX_SOUNDS + sound;
+  long64 key = long64(obj->index) * ObjectClass::MAX_SOUNDS + sound;
 
   Context::ContSource* contSource = context.contSources.find(key);
   const Dynamic*       dynParent  = static_cast<const Dynamic*>(parent);
+  bool                 hasVoice   = contSource != nullptr && contSource->voice != VoicePool::NONE;
+  float                priority   = Audio::priority(parent->p, volume, CONT_WEIGHT);
   uint                 srcId;
 
-  if (contSource == nullptr) {
-    srcId = context.addContSource(sound, key);
+  if (!hasVoice) {
+    srcId = context.addContSource(sound, key, priority);
     if (srcId == Context::INVALID_SOURCE) {
       return;
     }
@@ -103,7 +138,7 @@ void Audio::playContSound(int sound, float volume, const Object* parent) const
   }
   else {
     srcId = contSource->id;
-    contSource->isUpdated = true;
+    context.updateContSource(contSource, priority);
   }
 
   collider.translate(camera.p, parent->p - camera.p, parent);
@@ -115,7 +150,7 @@ void Audio::playContSound(int sound, float volume, const Object* parent) const
     alSourcefv(srcId, AL_VELOCITY, dynParent->velocity);
   }
 
-  if (contSource == nullptr) {
+  if (!hasVoice) {
     alSourcePlay(srcId);
   }
 
@@ -173,13 +208,15 @@ void Audio::playEngineSound(int sound, float volume, float pitch, const Object*
     pitch  *= COCKPIT_PITCH_FACTOR;
   }
 
-  int key = veh->index * ObjectClass::MAX_SOUNDS + sound;
+  long64 key = long64(veh->index) * ObjectClass::MAX_SOUNDS + sound;
 
   Context::ContSource* contSource = context.contSources.find(key);
+  bool                 hasVoice   = contSource != nullptr && contSource->voice != VoicePool::NONE;
+  float                priority   = Audio::priority(veh->p, volume, ENGINE_WEIGHT);
   uint                 srcId;
 
-  if (contSource == nullptr) {
-    srcId = context.addContSource(sound, key);
+  if (!hasVoice) {
+    srcId = context.addContSource(sound, key, priority);
     if (srcId == Context::INVALID_SOURCE) {
       return;
     }
@@ -190,7 +227,7 @@ void Audio::playEngineSound(int sound, float volume, float pitch, const Object*
   }
   else {
     srcId = contSource->id;
-    contSource->isUpdated = true;
+    context.updateContSource(contSource, priority);
   }
 
   collider.translate(camera.p, parent->p - camera.p, parent);
@@ -201,7 +238,7 @@ void Audio::playEngineSound(int sound, float volume, float pitch, const Object*
   alSourcefv(srcId, AL_POSITION, veh->p);
   alSourcefv(srcId, AL_VELOCITY, veh->velocity);
 
-  if (contSource == nullptr) {
+  if (!hasVoice) {
     alSourcePlay(srcId);
   }
 
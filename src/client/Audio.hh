@@ -43,6 +43,11 @@ public:
   static const float COCKPIT_GAIN_FACTOR;
   static const float COCKPIT_PITCH_FACTOR;
 
+  // Priority weights of sounds played by the camera's bot, continuous sounds and engines.
+  static const float PLAYER_WEIGHT;
+  static const float CONT_WEIGHT;
+  static const float ENGINE_WEIGHT;
+
 public:
 
   typedef Audio* CreateFunc(const Object* object);
@@ -51,7 +56,7 @@ protected:
 
   // obj: source object of the effect, parent: object at which the effect is played
   // obj != parent: e.g. an object obj in the inventory of bot parent plays a sound
-  void playSound(int sound, float volume, const Object* parent) const;
+  void playSound(int sound, float volume, const Object* parent, int event) const;
   void playContSound(int sound, float volume, const Object* parent) const;
   bool playSpeak(const char* text, float volume, const Object* parent) const;
   void playEngineSound(int sound, float volume, float pitch, const Object* parent) const;
@@ -62,6 +67,12 @@ public:
 
   static Collider    collider;
 
+  // Voice priority of a sound played at a given position with a given importance weight.
+  static float priority(const Point& p, float volume, float weight);
+
+  // Importance weight of an object event sound, destruction is more important than hits.
+  static float eventWeight(int event);
+
   const Object*      obj;
   const ObjectClass* clazz;
   int                flags;
@@ -35,7 +35,9 @@ void BSPAudio::playDemolish(const Struct* str, int sound) const
 {
   hard_assert(uint(sound) < uint(liber.sounds.length()));
 
-  uint srcId = context.addSource(sound);
+  float priority = Audio::priority(str->p, 1.0f, Audio::eventWeight(Object::EVENT_DESTROY));
+
+  uint srcId = context.addSource(sound, priority);
   if (srcId == Context::INVALID_SOURCE) {
     return;
   }
@@ -64,7 +66,7 @@ void BSPAudio::playSound(const Entity* entity, int sound) const
   Point         p        = str->toAbsoluteCS(entity->clazz->p() + entity->offset);
   Vec3          velocity = str->toAbsoluteCS(entity->velocity);
 
-  uint srcId = context.addSource(sound);
+  uint srcId = context.addSource(sound, Audio::priority(p, 1.0f, 1.0f));
   if (srcId == Context::INVALID_SOURCE) {
     return;
   }
@@ -91,15 +93,17 @@ void BSPAudio::playContSound(const Entity* entity, int sound) const
   hard_assert(uint(sound) < uint(liber.sounds.length()));
 
   const Struct* str      = entity->str;
-  int           key      = entity->index();
+  long64        key      = ~long64(entity->index()); // Disjoint from object keys.
   Point         p        = str->toAbsoluteCS(entity->clazz->p() + entity->offset);
   Vec3          velocity = str->toAbsoluteCS(entity->velocity);
 
   Context::ContSource* contSource = context.contSources.find(key);
+  bool                 hasVoice   = contSource != nullptr && contSource->voice != VoicePool::NONE;
+  float                priority   = Audio::priority(p, 1.0f, Audio::CONT_WEIGHT);
   uint                 srcId;
 
-  if (contSource == nullptr) {
-    srcId = context.addContSource(sound, key);
+  if (!hasVoice) {
+    srcId = context.addContSource(sound, key, priority);
     if (srcId == Context::INVALID_SOURCE) {
       return;
     }
@@ -110,7 +114,7 @@ void BSPAudio::playContSound(const Entity* entity, int sound) const
   }
   else {
     srcId = contSource->id;
-    contSource->isUpdated = true;
+    context.updateContSource(contSource, priority);
   }
 
   Audio::collider.translate(camera.p, p - camera.p);
@@ -122,7 +126,7 @@ void BSPAudio::playContSound(const Entity* entity, int sound) const
   alSourcefv(srcId, AL_POSITION, p);
   alSourcefv(srcId, AL_VELOCITY, velocity);
 
-  if (contSource == nullptr) {
+  if (!hasVoice) {
     alSourcePlay(srcId);
   }
 
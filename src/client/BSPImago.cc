@@ -72,12 +72,28 @@ void BSPImago::schedule(const Struct* str, Model::QueueType queue)
   model.schedule(0, queue);
 }
 
+void BSPImago::drawOccluder(const Struct* str, OcclusionBuffer* buffer) const
+{
+  if (occluderIndices.isEmpty()) {
+    return;
+  }
+
+  Mat4 transf = Mat4::translation(str->p - Point::ORIGIN);
+  transf.rotateZ(float(str->heading) * Math::TAU / 4.0f);
+
+  buffer->drawOccluder(transf, occluderVertices.begin(), occluderVertices.length(),
+                       occluderIndices.begin(), occluderIndices.length());
+}
+
 void BSPImago::preload()
 {
   const File* file = model.preload();
   Stream      is   = file->read(Endian::LITTLE);
 
-  is.seek(is.available() - 2 * sizeof(float[4]));
+  int version = Model::readFormatVersion(&is);
+
+  OcclusionBuffer::readOccluder(&is, version, &occluderVertices, &occluderIndices);
+
   waterFogColour = is.readVec4();
   lavaFogColour  = is.readVec4();
 }
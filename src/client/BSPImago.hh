@@ -24,6 +24,7 @@
 #pragma once
 
 #include <client/Model.hh>
+#include <client/OcclusionBuffer.hh>
 
 namespace oz
 {
@@ -34,12 +35,14 @@ class BSPImago
 {
 private:
 
-  Model model;
+  Model        model;
+  List<Point>  occluderVertices;
+  List<ushort> occluderIndices;
 
 public:
 
-  Vec4 waterFogColour;
-  Vec4 lavaFogColour;
+  Vec4         waterFogColour;
+  Vec4         lavaFogColour;
 
 public:
 
@@ -63,6 +66,11 @@ public:
 
   void schedule(const Struct* str, Model::QueueType queue);
 
+  /**
+   * Rasterise occluder mesh of a given structure into an occlusion buffer.
+   */
+  void drawOccluder(const Struct* str, OcclusionBuffer* buffer) const;
+
   void preload();
   void load();
 
@@ -61,7 +61,7 @@ void BasicAudio::play(const Object* playAt)
       }
       else if (recent[event.id] == 0) {
         recent[event.id] = RECENT_TICKS;
-        playSound(sounds[event.id], event.intensity, playAt);
+        playSound(sounds[event.id], event.intensity, playAt, event.id);
       }
     }
   }
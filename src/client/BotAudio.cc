@@ -69,7 +69,7 @@ void BotAudio::play(const Object* playAt)
       }
       else if (recent[event.id] == 0) {
         recent[event.id] = RECENT_TICKS;
-        playSound(sounds[event.id], event.intensity, playAt);
+        playSound(sounds[event.id], event.intensity, playAt, event.id);
       }
     }
   }
@@ -98,7 +98,7 @@ void BotAudio::play(const Object* playAt)
         int sample = Bot::EVENT_SWIM_SURFACE + ((bot->state & Bot::SUBMERGED_BIT) != 0);
 
         if (sounds[sample] >= 0) {
-          playSound(sounds[sample], 1.0f, bot);
+          playSound(sounds[sample], 1.0f, bot, sample);
         }
       }
       else if (recent[Object::EVENT_FRICTING] != 0) {
@@ -106,7 +106,7 @@ void BotAudio::play(const Object* playAt)
 
         int sample = bot->depth != 0.0f ? Bot::EVENT_WATER_STEP : Bot::EVENT_STEP;
         if (sounds[sample] >= 0) {
-          playSound(sounds[sample], 1.0f, bot);
+          playSound(sounds[sample], 1.0f, bot, sample);
         }
       }
     }
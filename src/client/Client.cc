@@ -639,12 +639,19 @@ int Client::init(int argc, char** argv)
   Math::seed(seed);
   Lua::randomSeed = seed;
 
+  Lua::profileCalls  = config.include("lua.profileCalls",  false).get(false);
+  Lua::callBudget    = config.include("lua.callBudget",    0    ).get(0);
+  Lua::abortOverruns = config.include("lua.abortOverruns", false).get(false);
+
   Log::println("Random generator seed set to: %u", seed);
 
   sound.initLibs();
 
+  initFlags |= INIT_JOBS;
+  Jobs::init(config.include("jobs.workers", Thread::nCores() - 1).get(0));
+
   initFlags |= INIT_LIBRARY;
-  liber.init(config["dir.music"].get(""));
+  liber.init(config["dir.music"].get(""), config.include("liber.catalogues", true).get(true));
 
   initFlags |= INIT_CONTEXT;
   context.init();
@@ -719,6 +726,9 @@ void Client::shutdown()
   if (initFlags & INIT_LIBRARY) {
     liber.destroy();
   }
+  if (initFlags & INIT_JOBS) {
+    Jobs::destroy();
+  }
   if (initFlags & INIT_LINGUA) {
     lingua.destroy();
   }
@@ -53,6 +53,7 @@ private:
   static const int INIT_STAGE_INIT = 0x1000;
   static const int INIT_STAGE_LOAD = 0x2000;
   static const int INIT_MAIN_LOOP  = 0x4000;
+  static const int INIT_JOBS       = 0x8000;
 
   Stage* stage;
   int    initFlags;
@@ -72,6 +72,8 @@ struct Context::SoundResource::PreloadData
   AudioBuffer audioBuffer;
 };
 
+const float           Context::UI_PRIORITY = 1.0e6f;
+
 Pool<Context::Source> Context::Source::pool;
 int                   Context::speakSampleRate;
 Context::SpeakSource  Context::speakSource;
@@ -176,29 +178,72 @@ void Context::speakMain(void*)
   speakSource.isAlive = false;
 }
 
-uint Context::addSource(int sound)
+int Context::acquireVoice(float priority)
 {
-  hard_assert(sounds[sound].nUsers > 0);
+  bool isStolen;
+  int  voice = voices.acquire(priority, &isStolen);
 
-  uint srcId;
-  alGenSources(1, &srcId);
+  if (voice == VoicePool::NONE) {
+    return VoicePool::NONE;
+  }
 
-  // Can this ever happen?
-  if (srcId == INVALID_SOURCE) {
-    soft_assert(false);
+  uint srcId = voices.source(voice);
 
-    alDeleteSources(1, &srcId);
-    return INVALID_SOURCE;
+  // A stolen one-time source is forgotten while a stolen continuous source becomes
+  // virtual.
+  if (isStolen) {
+    VoiceUser& user = voiceUsers[voice];
+
+    alSourceStop(srcId);
+    alSourcei(srcId, AL_BUFFER, AL_NONE);
+
+    if (user.source != nullptr) {
+      Source* prev = nullptr;
+      for (Source* src = sources.first(); src != user.source; src = src->next[0]) {
+        prev = src;
+      }
+
+      --sounds[user.source->sound].nUsers;
+      sources.erase(user.source, prev);
+      delete user.source;
+    }
+    else {
+      ContSource* contSource = contSources.find(user.contKey);
+
+      --sounds[contSource->sound].nUsers;
+      contSource->id    = INVALID_SOURCE;
+      contSource->voice = VoicePool::NONE;
+    }
   }
-  if (alGetError() != AL_NO_ERROR) {
-    Log::printRaw("AL: Too many sources\n");
+
+  // Pooled sources keep their state, reset what sound effects set.
+  alSourcei(srcId, AL_LOOPING, AL_FALSE);
+  alSourcei(srcId, AL_SOURCE_RELATIVE, AL_FALSE);
+  alSourcef(srcId, AL_PITCH, 1.0f);
+  alSourcef(srcId, AL_GAIN, 1.0f);
+  alSource3f(srcId, AL_POSITION, 0.0f, 0.0f, 0.0f);
+  alSource3f(srcId, AL_VELOCITY, 0.0f, 0.0f, 0.0f);
+
+  return voice;
+}
+
+uint Context::addSource(int sound, float priority)
+{
+  hard_assert(sounds[sound].nUsers > 0);
+
+  int voice = acquireVoice(priority);
+  if (voice == VoicePool::NONE) {
     return INVALID_SOURCE;
   }
 
+  uint    srcId  = voices.source(voice);
+  Source* source = new Source(srcId, sound, voice);
+
   alSourcei(srcId, AL_BUFFER, sounds[sound].handle);
 
   ++sounds[sound].nUsers;
-  sources.add(new Source(srcId, sound));
+  sources.add(source);
+  voiceUsers[voice] = VoiceUser{ source, -1 };
   return srcId;
 }
 
@@ -208,49 +253,64 @@ void Context::removeSource(Source* source, Source* prev)
 
   hard_assert(sounds[sound].nUsers > 0);
 
-  alDeleteSources(1, &source->id);
+  alSourceStop(source->id);
+  alSourcei(source->id, AL_BUFFER, AL_NONE);
+  voices.release(source->voice);
 
   --sounds[sound].nUsers;
   sources.erase(source, prev);
   delete source;
 }
 
-uint Context::addContSource(int sound, int key)
+uint Context::addContSource(int sound, long64 key, float priority)
 {
   hard_assert(sounds[sound].nUsers > 0);
 
-  uint srcId;
-  alGenSources(1, &srcId);
-
-  // Can this ever happen?
-  if (srcId == INVALID_SOURCE) {
-    soft_assert(false);
+  int         voice      = acquireVoice(priority);
+  ContSource* contSource = contSources.find(key);
 
-    alDeleteSources(1, &srcId);
+  if (voice == VoicePool::NONE) {
+    if (contSource == nullptr) {
+      contSources.add(key, ContSource{ INVALID_SOURCE, sound, true, VoicePool::NONE });
+    }
+    else {
+      contSource->isUpdated = true;
+    }
     return INVALID_SOURCE;
   }
 
-  if (alGetError() != AL_NO_ERROR) {
-    // Too many sources.
-    return INVALID_SOURCE;
-  }
+  uint srcId = voices.source(voice);
 
   alSourcei(srcId, AL_BUFFER, sounds[sound].handle);
 
   ++sounds[sound].nUsers;
-  contSources.add(key, ContSource{ srcId, sound, true });
+  contSources.add(key, ContSource{ srcId, sound, true, voice });
+  voiceUsers[voice] = VoiceUser{ nullptr, key };
   return srcId;
 }
 
-void Context::removeContSource(ContSource* contSource, int key)
+void Context::updateContSource(ContSource* contSource, float priority)
 {
-  int sound = contSource->sound;
+  hard_assert(contSource->voice != VoicePool::NONE);
 
-  hard_assert(sounds[sound].nUsers > 0);
+  contSource->isUpdated = true;
+  voices.setPriority(contSource->voice, priority);
+}
 
-  alDeleteSources(1, &contSource->id);
+void Context::removeContSource(ContSource* contSource, long64 key)
+{
+  if (contSource->voice != VoicePool::NONE) {
+    int sound = contSource->sound;
+
+    hard_assert(sounds[sound].nUsers > 0);
+
+    alSourceStop(contSource->id);
+    alSourcei(contSource->id, AL_BUFFER, AL_NONE);
+    voices.release(contSource->voice);
+
+    --sounds[sound].nUsers;
+  }
 
-  --sounds[sound].nUsers;
   contSources.exclude(key);
 }
 
@@ -421,7 +481,7 @@ void Context::playSample(int id)
     return;
   }
 
-  uint srcId = addSource(id);
+  uint srcId = addSource(id, UI_PRIORITY);
 
   if (srcId != INVALID_SOURCE) {
     alSourcei(srcId, AL_SOURCE_RELATIVE, AL_TRUE);
@@ -516,8 +576,9 @@ PartClass* Context::requestPartClass(int id)
   Resource<PartClass>& resource = partClasses[id];
 
   if (resource.nUsers < 0) {
-//    resource.handle.preload();
-    resource.nUsers = 1;
+    resource.handle.preload(id);
+    resource.handle.load();
+    resource.nUsers = 0;
   }
 
   ++resource.nUsers;
@@ -533,6 +594,27 @@ void Context::releasePartClass(int id)
   --resource.nUsers;
 }
 
+PartGen* Context::addPartGen(int partClassId, const Mat4& transf)
+{
+  PartGen* partGen = new PartGen(requestPartClass(partClassId), transf);
+
+  partGens.add(partGen);
+  return partGen;
+}
+
+void Context::removePartGen(PartGen* partGen)
+{
+  PartGen* prev = nullptr;
+  for (PartGen* gen = partGens.first(); gen != partGen; gen = gen->next[0]) {
+    prev = gen;
+  }
+
+  releasePartClass(partGen->clazz->id);
+
+  partGens.erase(partGen, prev);
+  delete partGen;
+}
+
 void Context::drawImago(const Object* obj, const Imago* parent)
 {
   hard_assert(obj->flags & Object::IMAGO_BIT);
@@ -578,12 +660,41 @@ void Context::drawFrag(const Frag* frag)
   pool->draw(frag);
 }
 
+void Context::update()
+{
+  // Return voices of finished one-time sounds to the pool, so acquiring a voice never has to query
+  // source states.
+  Source* prev = nullptr;
+  Source* src  = sources.first();
+
+  while (src != nullptr) {
+    Source* next = src->next[0];
+
+    ALint value;
+    alGetSourcei(src->id, AL_SOURCE_STATE, &value);
+
+    if (value != AL_PLAYING) {
+      removeSource(src, prev);
+    }
+    else {
+      prev = src;
+    }
+    src = next;
+  }
+}
+
 void Context::updateLoad()
 {
   maxImagines           = max(maxImagines,           imagines.length());
   maxAudios             = max(maxAudios,             audios.length());
   maxSources            = max(maxSources,            Source::pool.length());
   maxContSources        = max(maxContSources,        contSources.length());
+
+  int nVirtualSources = 0;
+  for (const auto& contSource : contSources) {
+    nVirtualSources += contSource.value.voice == VoicePool::NONE;
+  }
+  maxVirtualSources     = max(maxVirtualSources,     nVirtualSources);
   maxPartGens           = max(maxPartGens,           partGens.length());
 
   maxSMMImagines        = max(maxSMMImagines,        SMMImago::pool.length());
@@ -657,6 +768,14 @@ void Context::unloadResources()
   }
   Model::deallocate();
 
+  partGens.free();
+
+  for (int i = 0; i < liber.parts.length(); ++i) {
+    partClasses[i].handle.unload();
+    partClasses[i].nUsers = -1;
+  }
+  PartGen::deallocate();
+
   if (!dynamicLoading) {
     for (int i = 0; i < liber.textures.length(); ++i) {
       releaseTexture(i);
@@ -685,10 +804,30 @@ void Context::load()
     OZ_ERROR("Failed to create speak source");
   }
 
+  // Sound effects use a pool of preallocated sources. If the device cannot provide that many, try
+  // with fewer.
+  List<uint> voiceIds(nVoices);
+
+  for (int i = nVoices; i > 0; i /= 2) {
+    alGenSources(i, voiceIds.begin());
+
+    if (alGetError() == AL_NO_ERROR) {
+      voiceIds.resize(i);
+      break;
+    }
+    if (i == 1) {
+      voiceIds.clear();
+    }
+  }
+
+  voices.init(voiceIds.begin(), voiceIds.length());
+  voiceUsers.resize(voiceIds.length(), true);
+
   maxImagines           = 0;
   maxAudios             = 0;
   maxSources            = 0;
   maxContSources        = 0;
+  maxVirtualSources     = 0;
 
   maxSMMImagines        = 0;
   maxSMMVehicleImagines = 0;
@@ -700,8 +839,8 @@ void Context::load()
   maxBotAudios          = 0;
   maxVehicleAudios      = 0;
 
-  imagines = HashMap<int, Imago*>(4096);
-  audios   = HashMap<int, Audio*>(1024);
+  imagines = FlatHashMap<int, Imago*>(4096);
+  audios   = FlatHashMap<int, Audio*>(1024);
 
   if (!dynamicLoading) {
     loadResources();
@@ -721,6 +860,8 @@ void Context::unload()
   Log::println("%6d  audio objects",       maxAudios);
   Log::println("%6d  one-time sources",    maxSources);
   Log::println("%6d  continuous sources",  maxContSources);
+  Log::println("%6d  virtual sources",     maxVirtualSources);
+  Log::println("%6d  voices",              voices.nPeakActive);
   Log::println("%6d  particle generators", maxPartGens);
   Log::println("%6d  SMM imagines",        maxSMMImagines);
   Log::println("%6d  SMMVehicle imagines", maxSMMVehicleImagines);
@@ -733,6 +874,15 @@ void Context::unload()
   Log::unindent();
   Log::println("}");
 
+  Log::println("Voices {");
+  Log::indent();
+  Log::println("%6d  pooled",   voices.length());
+  Log::println("%6lu  requests", ulong(voices.nRequests));
+  Log::println("%6lu  steals",   ulong(voices.nSteals));
+  Log::println("%6lu  drops",    ulong(voices.nDrops));
+  Log::unindent();
+  Log::println("}");
+
   // Speak source must be destroyed before anything else using OpenAL since it calls OpenAL
   // functions from its own thread.
   if (speakSource.thread.isValid()) {
@@ -777,6 +927,14 @@ void Context::unload()
   contSources.clear();
   contSources.trim();
 
+  for (int i = 0; i < voices.length(); ++i) {
+    uint srcId = voices.source(i);
+    alDeleteSources(1, &srcId);
+  }
+  voices.destroy();
+  voiceUsers.clear();
+  voiceUsers.trim();
+
   unloadResources();
 
   OZ_AL_CHECK_ERROR();
@@ -801,6 +959,7 @@ void Context::init()
 
   textureLod     = config.include("context.textureLod", 0).get(0);
   dynamicLoading = config.include("context.dynamicLoading", false).get(false);
+  nVoices        = config.include("sound.voices", int(DEFAULT_VOICES)).get(0);
 
   if (!liber.imagines.isEmpty()) {
     imagoClasses = new Imago::CreateFunc*[liber.imagines.length()] {};
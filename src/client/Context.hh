@@ -30,6 +30,7 @@
 #include <client/Audio.hh>
 #include <client/FragPool.hh>
 #include <client/PartGen.hh>
+#include <client/VoicePool.hh>
 
 namespace oz
 {
@@ -49,7 +50,13 @@ class Context
 private:
 
   // default audio format
-  static const uint INVALID_SOURCE = ~0u;
+  static const uint  INVALID_SOURCE = ~0u;
+
+  // Default number of pooled sources for sound effects.
+  static const int   DEFAULT_VOICES = 64;
+
+  // Priority of UI samples, above any priority of positional sounds.
+  static const float UI_PRIORITY;
 
   template <typename Type>
   struct Resource
@@ -76,10 +83,11 @@ private:
   {
     uint    id;
     int     sound;
+    int     voice;
     Source* next[1] = { nullptr };
 
-    explicit Source(uint sourceId, int sound_) :
-      id(sourceId), sound(sound_)
+    explicit Source(uint sourceId, int sound_, int voice_) :
+      id(sourceId), sound(sound_), voice(voice_)
     {}
 
     static Pool<Source> pool;
@@ -87,11 +95,25 @@ private:
     OZ_STATIC_POOL_ALLOC(pool)
   };
 
+  // Continuous source without a voice (`id == INVALID_SOURCE`) is virtual. It is kept alive while
+  // updated and gets a voice as soon as its priority allows.
   struct ContSource
   {
     uint id;
     int  sound;
     bool isUpdated;
+    int  voice;
+  };
+
+  // Continuous sources keyed by an object's full generational index and a sound or by a negated
+  // entity index, so an object in a reused slot never takes over its predecessor's loop.
+  typedef HashMap<long64, ContSource> ContSourceMap;
+
+  // Owner of a pooled voice, either a one-time source or a continuous source key.
+  struct VoiceUser
+  {
+    Source* source;
+    long64  contKey;
   };
 
   struct SpeakSource
@@ -125,7 +147,9 @@ private:
   SoundResource*           sounds;
 
   Chain<Source>            sources;               // Non-looping sources.
-  HashMap<int, ContSource> contSources;           // Looping sources.
+  ContSourceMap            contSources;           // Looping sources.
+  List<VoiceUser>          voiceUsers;            // Owners of pooled voices.
+  int                      nVoices;
 
   Chain<PartGen>           partGens;
 
@@ -135,13 +159,14 @@ private:
   Resource<BSPImago*>*     bspImagines;
   Resource<BSPAudio*>*     bspAudios;
 
-  HashMap<int, Imago*>     imagines;              // Currently loaded graphics models.
-  HashMap<int, Audio*>     audios;                // Currently loaded audio models.
+  FlatHashMap<int, Imago*> imagines;              // Currently loaded graphics models.
+  FlatHashMap<int, Audio*> audios;                // Currently loaded audio models.
 
   int                      maxImagines;
   int                      maxAudios;
   int                      maxSources;
   int                      maxContSources;
+  int                      maxVirtualSources;
   int                      maxPartGens;
 
   int                      maxSMMImagines;
@@ -156,6 +181,8 @@ private:
 
 public:
 
+  VoicePool                voices;                // Pooled sources for sound effects.
+
   int                      textureLod;
   bool                     dynamicLoading;
 
@@ -164,18 +191,18 @@ private:
   static int speakCallback(short int* samples, int nSamples, void*);
   static void speakMain(void*);
 
-  uint addSource(int sound);
+  int  acquireVoice(float priority);
+
+  uint addSource(int sound, float priority);
   void removeSource(Source* source, Source* prev);
 
-  uint addContSource(int sound, int key);
-  void removeContSource(ContSource* contSource, int key);
+  uint addContSource(int sound, long64 key, float priority);
+  void updateContSource(ContSource* contSource, float priority);
+  void removeContSource(ContSource* contSource, long64 key);
 
   uint requestSpeakSource(const char* text, int owner);
   void releaseSpeakSource();
 
-  PartGen* addPartGen();
-  void removePartGen(PartGen* partGen);
-
 public:
 
   Context();
@@ -203,6 +230,10 @@ public:
   PartClass* requestPartClass(int id);
   void releasePartClass(int id);
 
+  // Create a particle generator of a given class, it must be updated and scheduled by its owner.
+  PartGen* addPartGen(int partClassId, const Mat4& transf);
+  void removePartGen(PartGen* partGen);
+
   BSPImago* getBSP(const BSP* bsp);
   BSPImago* requestBSP(const BSP* bsp);
 
@@ -213,6 +244,7 @@ public:
   void playAudio(const Object* obj, const Object* parent);
   void drawFrag(const Frag* frag);
 
+  void update();
   void updateLoad();
 
   void loadResources();
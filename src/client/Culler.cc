@@ -0,0 +1,243 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file client/Culler.cc
+ */
+
+#include <client/Culler.hh>
+
+#include <client/FragPool.hh>
+
+namespace oz
+{
+namespace client
+{
+
+const float Culler::WIDE_CULL_FACTOR       = 6.0f;
+const float Culler::OBJECT_VISIBILITY_COEF = 0.004f;
+const float Culler::FRAG_VISIBILITY_RANGE2 = 150.0f*150.0f;
+const float Culler::CELL_RADIUS            = (Cell::SIZE / 2 + Object::MAX_DIM * WIDE_CULL_FACTOR) *
+                                             Math::sqrt(2.0f);
+
+void Culler::workerMain(void* data)
+{
+  Worker* worker = static_cast<Worker*>(data);
+  Culler* culler = worker->culler;
+
+  worker->semaphore.wait();
+
+  while (culler->isAlive) {
+    culler->cullTiles(worker);
+
+    culler->doneSemaphore.post();
+    worker->semaphore.wait();
+  }
+}
+
+void Culler::cullCell(Worker* worker, int cellX, int cellY) const
+{
+  const Cell& cell = orbis.cells[cellX][cellY];
+
+  for (int i = 0; i < cell.structs.length(); ++i) {
+    const Struct* str = orbis.str(cell.structs[i]);
+
+    if (frustum->isVisible(str->p, str->dim().fastN())) {
+      worker->structs.add(str);
+    }
+  }
+
+  // Objects are tested against frustum planes in batches of eight.
+  const Object* batch[8];
+  float         x[8]      = {};
+  float         y[8]      = {};
+  float         z[8]      = {};
+  float         radius[8] = {};
+  int           nBatched  = 0;
+
+  for (const Object* obj = cell.objects.first(); obj != nullptr || nBatched != 0;) {
+    if (obj != nullptr) {
+      batch[nBatched]  = obj;
+      x[nBatched]      = obj->p.x;
+      y[nBatched]      = obj->p.y;
+      z[nBatched]      = obj->p.z;
+      radius[nBatched] = obj->dim.fastN();
+
+      if (obj->flags & Object::WIDE_CULL_BIT) {
+        radius[nBatched] *= WIDE_CULL_FACTOR;
+      }
+
+      ++nBatched;
+      obj = obj->next[0];
+
+      if (nBatched != 8 && obj != nullptr) {
+        continue;
+      }
+    }
+
+    int visible = frustum->isVisible8(x, y, z, radius) & ((1 << nBatched) - 1);
+
+    for (int i = 0; i < nBatched; ++i) {
+      if (visible & 1 << i) {
+        float distance = (batch[i]->p - eye).fastN();
+
+        if (radius[i] / (distance * mag) >= OBJECT_VISIBILITY_COEF) {
+          worker->objects.add(batch[i]);
+        }
+      }
+    }
+    nBatched = 0;
+  }
+
+  for (const Frag& frag : cell.frags) {
+    float dist = (frag.p - eye) * at;
+
+    if (dist <= FRAG_VISIBILITY_RANGE2 && frustum->isVisible(frag.p, FragPool::FRAG_RADIUS)) {
+      worker->frags.add(&frag);
+    }
+  }
+}
+
+void Culler::cullTiles(Worker* worker)
+{
+  float minXCentre = float((span.minX - Orbis::CELLS / 2) * Cell::SIZE + Cell::SIZE / 2);
+  float minYCentre = float((span.minY - Orbis::CELLS / 2) * Cell::SIZE + Cell::SIZE / 2);
+
+  for (int tile = __atomic_fetch_add(&nextTile, 1, __ATOMIC_RELAXED); tile < nTiles;
+       tile = __atomic_fetch_add(&nextTile, 1, __ATOMIC_RELAXED))
+  {
+    int tileMinX = span.minX + tile % nTilesX * TILE_SIZE;
+    int tileMinY = span.minY + tile / nTilesX * TILE_SIZE;
+    int tileMaxX = min<int>(tileMinX + TILE_SIZE - 1, span.maxX);
+    int tileMaxY = min<int>(tileMinY + TILE_SIZE - 1, span.maxY);
+
+    for (int i = tileMinX; i <= tileMaxX; ++i) {
+      float x = minXCentre + float((i - span.minX) * Cell::SIZE);
+
+      for (int j = tileMinY; j <= tileMaxY; ++j) {
+        float y = minYCentre + float((j - span.minY) * Cell::SIZE);
+
+        if (frustum->isVisible(x, y, CELL_RADIUS)) {
+          cullCell(worker, i, j);
+        }
+      }
+    }
+  }
+}
+
+void Culler::cull(const Frustum& frustum_, const Span& span_, const Point& eye_, const Vec3& at_,
+                  float mag_)
+{
+  frustum  = &frustum_;
+  span     = span_;
+  eye      = eye_;
+  at       = at_;
+  mag      = mag_;
+
+  nTilesX  = (span.maxX - span.minX + TILE_SIZE) / TILE_SIZE;
+  nTiles   = nTilesX * ((span.maxY - span.minY + TILE_SIZE) / TILE_SIZE);
+  nextTile = 0;
+
+  clear();
+
+  for (int i = 1; i < nWorkers; ++i) {
+    workers[i].semaphore.post();
+  }
+
+  cullTiles(&workers[0]);
+
+  for (int i = 1; i < nWorkers; ++i) {
+    doneSemaphore.wait();
+  }
+
+  // A structure may span several cells in different tiles, so duplicates are filtered out here.
+  drawnStructs.clearAll();
+
+  for (int i = 0; i < nWorkers; ++i) {
+    Worker& worker = workers[i];
+
+    for (const Struct* str : worker.structs) {
+      int slot = Orbis::strSlot(str->index);
+
+      if (!drawnStructs.get(slot)) {
+        drawnStructs.set(slot);
+        structs.add(str);
+      }
+    }
+    objects.addAll(worker.objects.begin(), worker.objects.length());
+    frags.addAll(worker.frags.begin(), worker.frags.length());
+  }
+}
+
+void Culler::clear()
+{
+  for (int i = 0; i < nWorkers; ++i) {
+    workers[i].structs.clear();
+    workers[i].objects.clear();
+    workers[i].frags.clear();
+  }
+
+  structs.clear();
+  objects.clear();
+  frags.clear();
+}
+
+void Culler::init(int nThreads)
+{
+  nWorkers = nThreads < 1 ? 1 : nThreads > MAX_THREADS ? MAX_THREADS : nThreads;
+  isAlive  = true;
+
+  for (int i = 0; i < nWorkers; ++i) {
+    workers[i].culler = this;
+    workers[i].objects.reserve(1024);
+
+    if (i != 0) {
+      workers[i].thread = Thread("culler", workerMain, &workers[i]);
+    }
+  }
+
+  objects.reserve(8192);
+}
+
+void Culler::destroy()
+{
+  isAlive = false;
+
+  for (int i = 1; i < nWorkers; ++i) {
+    workers[i].semaphore.post();
+    workers[i].thread.join();
+  }
+
+  clear();
+
+  for (int i = 0; i < nWorkers; ++i) {
+    workers[i].structs.trim();
+    workers[i].objects.trim();
+    workers[i].frags.trim();
+  }
+
+  structs.trim();
+  objects.trim();
+  frags.trim();
+
+  nWorkers = 0;
+}
+
+}
+}
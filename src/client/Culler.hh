@@ -0,0 +1,141 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file client/Culler.hh
+ *
+ * Parallel frustum culling of structures, objects and fragments.
+ */
+
+#pragma once
+
+#include <client/Frustum.hh>
+
+namespace oz
+{
+namespace client
+{
+
+/**
+ * Frustum culler that splits cell span into tiles and culls them on a pool of worker threads.
+ *
+ * Each thread collects visible entities into its own draw lists, which are merged after all tiles
+ * have been processed. Culling does not depend on camera or OpenGL state, so it can be run headless
+ * on any loaded `Orbis`.
+ */
+class Culler
+{
+public:
+
+  /// Radius multiplier for objects with `Object::WIDE_CULL_BIT`.
+  static const float WIDE_CULL_FACTOR;
+
+  /// Minimum ratio between object radius and (magnified) distance for an object to be drawn.
+  static const float OBJECT_VISIBILITY_COEF;
+
+  /// Maximum distance along view direction at which fragments are drawn.
+  static const float FRAG_VISIBILITY_RANGE2;
+
+  /// Radius of a sphere enclosing a cell and all objects that may be positioned in it.
+  static const float CELL_RADIUS;
+
+  /// Width and height of a tile in cells.
+  static const int   TILE_SIZE   = 4;
+
+  /// Maximum number of culling threads, including the calling one.
+  static const int   MAX_THREADS = 8;
+
+private:
+
+  struct Worker
+  {
+    Culler*             culler;
+    Thread              thread;
+    Semaphore           semaphore;
+
+    List<const Struct*> structs;
+    List<const Object*> objects;
+    List<const Frag*>   frags;
+  };
+
+  const Frustum*              frustum = nullptr;
+  Span                        span;
+  Point                       eye;
+  Vec3                        at;
+  float                       mag;
+
+  int                         nTilesX;
+  int                         nTiles;
+  int                         nextTile;
+
+  Worker                      workers[MAX_THREADS];
+  int                         nWorkers = 0;
+  Semaphore                   doneSemaphore;
+  volatile bool               isAlive  = false;
+
+  SBitset<Orbis::MAX_STRUCTS> drawnStructs;
+
+public:
+
+  List<const Struct*>         structs; ///< Visible structures, each only once.
+  List<const Object*>         objects; ///< Visible objects.
+  List<const Frag*>           frags;   ///< Visible fragments.
+
+private:
+
+  static void workerMain(void* data);
+
+  void cullCell(Worker* worker, int cellX, int cellY) const;
+  void cullTiles(Worker* worker);
+
+public:
+
+  /**
+   * Cull all cells in a given span and fill `structs`, `objects` and `frags`.
+   *
+   * @param frustum view frustum.
+   * @param span cells to be culled, as obtained by `Frustum::getExtrems()`.
+   * @param eye viewer position.
+   * @param at unit view direction.
+   * @param mag zoom magnification.
+   */
+  void cull(const Frustum& frustum, const Span& span, const Point& eye, const Vec3& at, float mag);
+
+  /**
+   * Clear draw lists.
+   */
+  void clear();
+
+  /**
+   * Start worker threads.
+   *
+   * @param nThreads number of culling threads including the calling one, clamped to
+   *        [1, `MAX_THREADS`].
+   */
+  void init(int nThreads);
+
+  /**
+   * Stop worker threads and free draw lists.
+   */
+  void destroy();
+
+};
+
+}
+}
@@ -172,6 +172,7 @@ bool EditStage::update()
    * game.
    */
 
+  context.update();
   context.updateLoad();
   loader.update();
 
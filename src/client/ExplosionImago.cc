@@ -43,11 +43,19 @@ Imago* ExplosionImago::create(const Object* obj)
   imago->model = context.requestModel(modelId);
   imago->startMicros = uint(timer.micros);
 
+  if (obj->clazz->imagoParts >= 0) {
+    imago->partGen = context.addPartGen(obj->clazz->imagoParts,
+                                        Mat4::translation(obj->p - Point::ORIGIN));
+  }
+
   return imago;
 }
 
 ExplosionImago::~ExplosionImago()
 {
+  if (partGen != nullptr) {
+    context.removePartGen(partGen);
+  }
   context.releaseModel(modelId);
 }
 
@@ -69,6 +77,11 @@ void ExplosionImago::draw(const Imago*)
   model->schedule(0, Model::SCENE_QUEUE);
 
   tf.colour.w.w = 1.0f;
+
+  if (partGen != nullptr) {
+    partGen->update();
+    partGen->schedule();
+  }
 }
 
 }
@@ -25,6 +25,7 @@
 
 #include <client/Imago.hh>
 #include <client/Model.hh>
+#include <client/PartGen.hh>
 
 namespace oz
 {
@@ -37,8 +38,9 @@ private:
 
   static int modelId;
 
-  Model* model;
-  uint   startMicros;
+  Model*   model;
+  PartGen* partGen = nullptr;
+  uint     startMicros;
 
 private:
 
@@ -30,6 +30,38 @@ namespace oz
 namespace client
 {
 
+int Frustum::isVisible4(const float* x, const float* y, const float* z, const float* radius) const
+{
+#ifdef OZ_SIMD
+  float4 vx = { x[0], x[1], x[2], x[3] };
+  float4 vy = { y[0], y[1], y[2], y[3] };
+  float4 vz = { z[0], z[1], z[2], z[3] };
+  float4 vr = { radius[0], radius[1], radius[2], radius[3] };
+  float4 nr = -vr;
+
+  // Each comparison yields lanes of all ones (true) or zeros (false).
+  auto inside = (vx * vFill(left.n.x)  + vy * vFill(left.n.y)  + vz * vFill(left.n.z)  -
+                 vFill(left.d)  > nr) &
+                (vx * vFill(right.n.x) + vy * vFill(right.n.y) + vz * vFill(right.n.z) -
+                 vFill(right.d) > nr) &
+                (vx * vFill(up.n.x)    + vy * vFill(up.n.y)    + vz * vFill(up.n.z)    -
+                 vFill(up.d)    > nr) &
+                (vx * vFill(down.n.x)  + vy * vFill(down.n.y)  + vz * vFill(down.n.z)  -
+                 vFill(down.d)  > nr) &
+                (vx * vFill(front.n.x) + vy * vFill(front.n.y) + vz * vFill(front.n.z) -
+                 vFill(front.d) < vr);
+
+  return (inside[0] & 1) | (inside[1] & 2) | (inside[2] & 4) | (inside[3] & 8);
+#else
+  int mask = 0;
+
+  for (int i = 0; i < 4; ++i) {
+    mask |= int(isVisible(Point(x[i], y[i], z[i]), radius[i])) << i;
+  }
+  return mask;
+#endif
+}
+
 void Frustum::getExtrems(Span& span, const Point& p)
 {
   span.minX = max(int((p.x - radius + Orbis::DIM) / Cell::SIZE), 0);
@@ -38,26 +70,26 @@ void Frustum::getExtrems(Span& span, const Point& p)
   span.maxY = min(int((p.y + radius + Orbis::DIM) / Cell::SIZE), Orbis::CELLS - 1);
 }
 
-void Frustum::update()
+void Frustum::set(const Point& eye, const Mat4& rot, float tanX, float tanY, float maxDist)
 {
-  float fovX = Math::atan(camera.coeff * camera.mag * camera.aspect);
-  float fovY = Math::atan(camera.coeff * camera.mag);
+  float fovX = Math::atan(tanX);
+  float fovY = Math::atan(tanY);
 
   float sx, cx, sy, cy;
   Math::sincos(fovX, &sx, &cx);
   Math::sincos(fovY, &sy, &cy);
 
-  Vec3 nLeft  = camera.rotMat * Vec3(  cx, 0.0f, -sx);
-  Vec3 nRight = camera.rotMat * Vec3( -cx, 0.0f, -sx);
-  Vec3 nDown  = camera.rotMat * Vec3(0.0f,   cy, -sy);
-  Vec3 nUp    = camera.rotMat * Vec3(0.0f,  -cy, -sy);
-  Vec3 nFront = camera.at;
+  Vec3 nLeft  = rot * Vec3(  cx, 0.0f, -sx);
+  Vec3 nRight = rot * Vec3( -cx, 0.0f, -sx);
+  Vec3 nDown  = rot * Vec3(0.0f,   cy, -sy);
+  Vec3 nUp    = rot * Vec3(0.0f,  -cy, -sy);
+  Vec3 nFront = Vec3(-rot.z);
 
-  float dLeft  = camera.p * nLeft;
-  float dRight = camera.p * nRight;
-  float dDown  = camera.p * nDown;
-  float dUp    = camera.p * nUp;
-  float dFront = camera.p * nFront + camera.maxDist;
+  float dLeft  = eye * nLeft;
+  float dRight = eye * nRight;
+  float dDown  = eye * nDown;
+  float dUp    = eye * nUp;
+  float dFront = eye * nFront + maxDist;
 
   left  = Plane(nLeft,  dLeft );
   right = Plane(nRight, dRight);
@@ -65,7 +97,13 @@ void Frustum::update()
   up    = Plane(nUp,    dUp   );
   front = Plane(nFront, dFront);
 
-  radius = camera.maxDist / cx;
+  radius = maxDist / cx;
+}
+
+void Frustum::update()
+{
+  set(camera.p, camera.rotMat, camera.coeff * camera.mag * camera.aspect, camera.coeff * camera.mag,
+      camera.maxDist);
 }
 
 Frustum frustum;
@@ -67,9 +67,49 @@ public:
            (mins * front < +radius || maxs * front < +radius);
   }
 
+  /**
+   * Test four spheres at once.
+   *
+   * Coordinates and radii are given as separate arrays, so the test can be done on all four spheres
+   * with one SIMD operation per plane.
+   *
+   * @return Bitmask with i-th bit set iff the i-th sphere is visible.
+   */
+  int isVisible4(const float* x, const float* y, const float* z, const float* radius) const;
+
+  /**
+   * Test eight spheres at once, the same as two `isVisible4()` calls.
+   */
+  int isVisible8(const float* x, const float* y, const float* z, const float* radius) const
+  {
+    return isVisible4(x, y, z, radius) | isVisible4(x + 4, y + 4, z + 4, radius + 4) << 4;
+  }
+
+  /**
+   * Copy the five frustum planes, oriented so that a point is inside iff it lies on positive sides
+   * of all of them.
+   */
+  void getPlanes(Plane* planes) const
+  {
+    planes[0] = left;
+    planes[1] = right;
+    planes[2] = down;
+    planes[3] = up;
+    planes[4] = Plane(-front.n, -front.d);
+  }
+
   // get min and max index for cells per each axis, which should be included in PVS
   void getExtrems(Span& span, const Point& p);
 
+  /**
+   * Set planes for a viewer with given position, rotation, tangents of half field of view angles
+   * and view distance.
+   */
+  void set(const Point& eye, const Mat4& rot, float tanX, float tanY, float maxDist);
+
+  /**
+   * Set planes from the camera.
+   */
   void update();
 
 };
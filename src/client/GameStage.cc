@@ -46,6 +46,8 @@ namespace client
 {
 
 const uint GameStage::AUTOSAVE_INTERVAL = 150 * Timer::TICKS_PER_SEC;
+// Version 2: per-slot entity generations in Orbis, generation bits in entity handles.
+const uint GameStage::STATE_VERSION     = 0x6f7a0000 | 2;
 
 void GameStage::saveMain(void*)
 {
@@ -73,6 +75,12 @@ void GameStage::read()
     OZ_ERROR("Reading saved state '%s' failed", stateFile.c());
   }
 
+  uint version = is.readUInt();
+  if (version != STATE_VERSION) {
+    OZ_ERROR("Incompatible save '%s': state format %#x, expected %#x", stateFile.c(), version,
+             STATE_VERSION);
+  }
+
   Log::printEnd(" OK");
 
   matrix.read(&is);
@@ -96,6 +104,8 @@ void GameStage::write()
     saveThread.join();
   }
 
+  saveStream.writeUInt(STATE_VERSION);
+
   matrix.write(&saveStream);
   nirvana.write(&saveStream);
 
@@ -225,19 +235,34 @@ bool GameStage::update()
    * PHASE 2
    *
    * World is being updated in the auxiliary thread, any access of world structures might crash the
-   * game.
+   * game. In pipelined mode the frame prepared in the last present() is drawn here. It must be drawn
+   * before the loader runs as that may unload models and imagos it uses.
    */
 
+  if (isPipelined) {
+    beginMicros = Time::uclock();
+
+    render.drawPrepared();
+
+    overlapMicros += Time::uclock() - beginMicros;
+  }
+
   beginMicros = Time::uclock();
 
+  context.update();
   context.updateLoad();
   loader.update();
 
   loaderMicros += Time::uclock() - beginMicros;
 
   auxSemaphore.post();
+
+  beginMicros = Time::uclock();
+
   mainSemaphore.wait();
 
+  waitMicros += Time::uclock() - beginMicros;
+
   /*
    * PHASE 3
    *
@@ -254,8 +279,17 @@ void GameStage::present(bool isFull)
   uint beginMicros = Time::uclock();
   uint currentMicros;
 
+  int renderFlags = Render::EFFECTS_BIT | (isFull ? Render::ORBIS_BIT | Render::UI_BIT : 0);
+
   sound.play();
-  render.update(Render::EFFECTS_BIT | (isFull ? Render::ORBIS_BIT | Render::UI_BIT : 0));
+
+  if (isPipelined) {
+    render.finish();
+    render.prepare(renderFlags);
+  }
+  else {
+    render.update(renderFlags);
+  }
 
   sound.sync();
 
@@ -291,6 +325,8 @@ void GameStage::load()
   presentMicros = 0;
   matrixMicros  = 0;
   nirvanaMicros = 0;
+  overlapMicros = 0;
+  waitMicros    = 0;
 
   network.connect();
 
@@ -395,6 +431,7 @@ void GameStage::unload()
   float   soundTime             = float(soundMicros)                    * 1.0e-6f;
   float   soundEffectsTime      = float(sound.effectsMicros)            * 1.0e-6f;
   float   soundMusicTime        = float(sound.musicMicros)              * 1.0e-6f;
+  float   soundDecodeTime       = float(sound.decodeMicros)             * 1.0e-6f;
   float   renderTime            = float(renderMicros)                   * 1.0e-6f;
   float   renderPrepareTime     = float(render.prepareMicros)           * 1.0e-6f;
   float   renderCaelumTime      = float(render.caelumMicros)            * 1.0e-6f;
@@ -406,12 +443,17 @@ void GameStage::unload()
   float   renderSwapTime        = float(render.swapMicros)              * 1.0e-6f;
   float   matrixTime            = float(matrixMicros)                   * 1.0e-6f;
   float   nirvanaTime           = float(nirvanaMicros)                  * 1.0e-6f;
+  float   overlapTime           = float(overlapMicros)                  * 1.0e-6f;
+  float   waitTime              = float(waitMicros)                     * 1.0e-6f;
   float   loadingTime           = float(loadingMicros)                  * 1.0e-6f;
   float   runTime               = float(timer.runMicros)                * 1.0e-6f;
   float   gameTime              = float(timer.micros)                   * 1.0e-6f;
   float   droppedTime           = float(timer.runMicros - timer.micros) * 1.0e-6f;
   ulong64 nFrameDrops           = ticks - timer.nFrames;
   float   frameDropRate         = float(ticks - timer.nFrames) / float(ticks);
+  float   drawCallsPerFrame     = float(render.nDrawCalls) / float(timer.nFrames);
+  float   instancesPerFrame     = float(render.nDrawnInstances) / float(timer.nFrames);
+  float   occludedPerFrame      = float(render.nOccluded) / float(timer.nFrames);
 
   if (stateFile.isEmpty()) {
     stateFile = autosaveFile;
@@ -453,17 +495,23 @@ void GameStage::unload()
   Log::println("frame rate in run time  %6.2f Hz", float(timer.nFrames) / runTime             );
   Log::println("frame drop rate         %6.2f %%", frameDropRate * 100.0f                     );
   Log::println("frame drops           %8lu",       ulong(nFrameDrops)                         );
+  Log::println("draw calls per frame  %8.2f",      drawCallsPerFrame                          );
+  Log::println("instances per frame   %8.2f",      instancesPerFrame                          );
+  Log::println("occluded per frame    %8.2f",      occludedPerFrame                           );
   Log::println("Run time usage {");
   Log::indent();
   Log::println("Ph0  %6.2f %%  [M] sleep",            sleepTime             / runTime * 100.0f);
   Log::println("Ph1  %6.2f %%  [M] input & ui",       uiTime                / runTime * 100.0f);
   Log::println("Ph2  %6.2f %%  [A] matrix",           matrixTime            / runTime * 100.0f);
+  Log::println("     %6.2f %%  [M] draw prepared",    overlapTime           / runTime * 100.0f);
   Log::println("     %6.2f %%  [M] loader",           loaderTime            / runTime * 100.0f);
+  Log::println("     %6.2f %%  [M] wait for matrix",  waitTime              / runTime * 100.0f);
   Log::println("Ph3  %6.2f %%  [A] nirvana",          nirvanaTime           / runTime * 100.0f);
   Log::println("     %6.2f %%  [M] present",          presentTime           / runTime * 100.0f);
   Log::println("     %6.2f %%  [S] + sound",          soundTime             / runTime * 100.0f);
   Log::println("     %6.2f %%  [S]   + effects",      soundEffectsTime      / runTime * 100.0f);
   Log::println("     %6.2f %%  [S]   + music",        soundMusicTime        / runTime * 100.0f);
+  Log::println("     %6.2f %%  [D] music decoding",   soundDecodeTime       / runTime * 100.0f);
   Log::println("     %6.2f %%  [M] + render",         renderTime            / runTime * 100.0f);
   Log::println("     %6.2f %%  [M]   + prepare",      renderPrepareTime     / runTime * 100.0f);
   Log::println("     %6.2f %%  [M]   + caelum",       renderCaelumTime      / runTime * 100.0f);
@@ -491,6 +539,7 @@ void GameStage::init()
 
   autosaveFile  = profilePath / "saves/autosave.ozState";
   quicksaveFile = profilePath / "saves/quicksave.ozState";
+  isPipelined   = config.include("gameStage.pipelined", false).get(false);
 
   matrix.init();
   nirvana.init();
@@ -38,6 +38,10 @@ private:
   // 2.5 min.
   static const uint AUTOSAVE_INTERVAL;
 
+  // Leading word of a saved state, "oz" magic in high bits and format version in low bits. Bump
+  // the version whenever the layout written by write() changes.
+  static const uint STATE_VERSION;
+
   ulong64       startTicks;
   long64        sleepMicros;
   long64        loadingMicros;
@@ -46,6 +50,11 @@ private:
   long64        presentMicros;
   long64        matrixMicros;
   long64        nirvanaMicros;
+  long64        overlapMicros;
+  long64        waitMicros;
+
+  // Draw the previous frame in phase 2 while matrix is updating the world.
+  bool          isPipelined;
 
   uint          autosaveTicks;
 
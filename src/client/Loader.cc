@@ -47,8 +47,8 @@ void Loader::updateRender()
     auto imago = i;
     ++i;
 
-    // We can afford to do this as orbis.objects[key] will remain nullptr at least one whole tick
-    // after the object has been removed because matrix also needs to clear references.
+    // Keys are object indices, which never resolve again once the object has been removed, even
+    // if its slot has already been reused.
     if (orbis.obj(imago->key) == nullptr) {
       delete imago->value;
       context.imagines.exclude(imago->key);
@@ -83,8 +83,8 @@ void Loader::updateSound()
     auto audio = i;
     ++i;
 
-    // We can afford to do this as orbis.objects[key] will remain nullptr at least one whole tick
-    // after the object has been removed because matrix also needs to clear references.
+    // Keys are object indices, which never resolve again once the object has been removed, even
+    // if its slot has already been reused.
     if (orbis.obj(audio->key) == nullptr) {
       delete audio->value;
       context.audios.exclude(audio->key);
@@ -107,27 +107,6 @@ void Loader::updateSound()
     }
   }
 
-  // Remove stopped sources of non-continous sounds.
-  if (tick % SOURCE_CLEAR_INTERVAL == SOURCE_CLEAR_LAG) {
-    Context::Source* prev = nullptr;
-    Context::Source* src  = context.sources.first();
-
-    while (src != nullptr) {
-      Context::Source* next = src->next[0];
-
-      ALint value;
-      alGetSourcei(src->id, AL_SOURCE_STATE, &value);
-
-      if (value != AL_PLAYING) {
-        context.removeSource(src, prev);
-      }
-      else {
-        prev = src;
-      }
-      src = next;
-    }
-  }
-
   // Remove continuous sources that are not played any more.
   for (auto i = context.contSources.iterator(); i.isValid();) {
     auto src = i;
@@ -57,9 +57,6 @@ private:
   static const uint AUDIO_CLEAR_INTERVAL      = 5   * Timer::TICKS_PER_SEC;  //   5 s (+ 3 s)
   static const uint AUDIO_CLEAR_LAG           = 3   * Timer::TICKS_PER_SEC;
 
-  static const uint SOURCE_CLEAR_INTERVAL     = 1   * Timer::TICKS_PER_SEC;  //   1 s (+ ~0.5 s)
-  static const uint SOURCE_CLEAR_LAG          = 1   * Timer::TICKS_PER_SEC / 2;
-
   static const uint SOUND_CLEAR_INTERVAL      = 120 * Timer::TICKS_PER_SEC;  // 2 min (+ 100 s)
   static const uint SOUND_CLEAR_LAG           = 100 * Timer::TICKS_PER_SEC;
 
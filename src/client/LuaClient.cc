@@ -47,7 +47,7 @@ void LuaClient::staticCall(const char* functionName)
 
   l_getglobal(functionName);
 
-  if (l_pcall(0, 0) != LUA_OK) {
+  if (pcall(0, 0, functionName) != LUA_OK) {
     Log::println("Lua[C] in %s(): %s", functionName, l_tostring(-1));
     System::bell();
 
@@ -219,7 +219,7 @@ void LuaClient::init()
 {
   Log::print("Initialising Client Lua ...");
 
-  Lua::init();
+  Lua::init("client");
 
   ls.envName = "client";
   ms.structs.reserve(32);
@@ -414,6 +414,9 @@ void LuaClient::init()
   IGNORE_FUNC(ozObjIsVisibleFromSelf);
   IGNORE_FUNC(ozObjIsVisibleFromSelfEye);
 
+  IMPORT_FUNC(ozObjQuery);
+  IMPORT_FUNC(ozBoundObjsQuery);
+
   /*
    * Dynamic object
    */
@@ -26,6 +26,7 @@
 #include <client/Terra.hh>
 #include <client/Context.hh>
 #include <client/Camera.hh>
+#include <client/Frustum.hh>
 
 namespace oz
 {
@@ -75,12 +76,91 @@ struct Model::PreloadData
   List<TexFiles> textures;
 };
 
+struct Model::BatchEntry
+{
+  const Instance* instance;
+  int             node;     ///< Root node.
+  int             mask;
+
+  bool operator < (const BatchEntry& e) const
+  {
+    return node < e.node;
+  }
+};
+
+struct Model::MeshEntry
+{
+  int  mesh;
+  Mat4 transf;
+};
+
+struct Model::AnimKey
+{
+  const Model* model;
+  int          firstFrame;
+  int          secondFrame;
+  float        interpolation;
+
+  bool operator == (const AnimKey& k) const
+  {
+    return model == k.model && firstFrame == k.firstFrame && secondFrame == k.secondFrame &&
+           interpolation == k.interpolation;
+  }
+};
+
+struct Model::AnimKeyHash
+{
+  int operator () (const AnimKey& k) const
+  {
+    union
+    {
+      float f;
+      uint  u;
+    }
+    interpolation = { k.interpolation };
+
+    uint h = uint(size_t(k.model) >> 4);
+    h = h * 31 + uint(k.firstFrame);
+    h = h * 31 + uint(k.secondFrame);
+    h = h * 31 + interpolation.u;
+    return int(h);
+  }
+};
+
+struct Model::AnimEntry
+{
+  AnimKey key;
+  int     offset;   ///< Index of the first vertex in `animVertices`.
+};
+
+struct Model::AnimJob
+{
+  int entry;
+  int begin;
+  int end;
+};
+
 Set<Model::Ref>         Model::loadedModels;
 List<Model::Instance>   Model::instances[2];
 List<Model::LightEntry> Model::sceneLights;
-Vertex*                 Model::vertexAnimBuffer       = nullptr;
-int                     Model::vertexAnimBufferLength = 0;
+List<Model::BatchEntry> Model::batchInstances;
+List<Model::MeshEntry>  Model::batchMeshes;
+RenderQueue             Model::opaqueQueues[2];
+RenderQueue             Model::alphaQueues[2];
+int                     Model::nextId                 = 0;
+List<Model::AnimEntry>  Model::animEntries[2];
+List<Vertex>            Model::animVertices[2];
+List<Model::AnimJob>    Model::animJobs;
+Model::AnimCache        Model::animCache;
+bool                    Model::areAnimated[2]         = { false, false };
+int                     Model::animQueue              = 0;
 Model::Collation        Model::collation              = DEPTH_MAJOR;
+const Frustum*          Model::cullFrustum            = nullptr;
+int                     Model::nDrawCalls             = 0;
+int                     Model::nInstances             = 0;
+int                     Model::nAnimations            = 0;
+int                     Model::nAnimShared            = 0;
+int                     Model::nCulledMeshlets        = 0;
 
 void Model::addSceneLights()
 {
@@ -97,7 +177,133 @@ void Model::addSceneLights()
   }
 }
 
-void Model::animate(const Instance* instance)
+void Model::runAnimJobs(int begin, int end)
+{
+  const List<AnimEntry>& entries = animEntries[animQueue];
+  List<Vertex>&          output  = animVertices[animQueue];
+
+  for (int i = begin; i < end; ++i) {
+    const AnimJob&   job   = animJobs[i];
+    const AnimEntry& entry = entries[job.entry];
+
+    entry.key.model->interpolate(entry.key, &output[entry.offset], job.begin, job.end);
+  }
+}
+
+void Model::animateScheduled(QueueType queue)
+{
+  if (shader.hasVTF || areAnimated[queue]) {
+    return;
+  }
+  areAnimated[queue] = true;
+
+  List<AnimEntry>& entries       = animEntries[queue];
+  int              nAnimVertices = 0;
+
+  entries.clear();
+  animJobs.clear();
+  animCache.clear();
+
+  for (Instance& instance : instances[queue]) {
+    Model* model = instance.model;
+
+    if (model->nFrames == 0) {
+      continue;
+    }
+
+    model->uploadedAnimation = -1;
+
+    AnimKey key = {
+      model,
+      instance.firstFrame,
+      instance.interpolation == 0.0f ? instance.firstFrame : instance.secondFrame,
+      instance.interpolation
+    };
+
+    // Instances with the same model, frames and interpolation share interpolated vertices.
+    const int* index = animCache.find(key);
+
+    if (index != nullptr) {
+      instance.animation = *index;
+      ++nAnimShared;
+      continue;
+    }
+
+    instance.animation = entries.length();
+    animCache.add(key, entries.length());
+
+    for (int i = 0; i < model->nVertices; i += ANIM_JOB_VERTICES) {
+      int end = min<int>(i + ANIM_JOB_VERTICES, model->nVertices);
+      animJobs.add(AnimJob{ entries.length(), i, end });
+    }
+
+    entries.add(AnimEntry{ key, nAnimVertices });
+    nAnimVertices += model->nVertices;
+  }
+
+  if (entries.isEmpty()) {
+    return;
+  }
+
+  nAnimations += entries.length();
+  animVertices[queue].resize(nAnimVertices);
+
+  animQueue = queue;
+
+  // Each job already covers `ANIM_JOB_VERTICES` vertices, so threads take them one at a time.
+  Jobs::parallelFor(0, animJobs.length(), 1, [](int begin, int end)
+  {
+    runAnimJobs(begin, end);
+  });
+}
+
+void Model::interpolate(const AnimKey& key, Vertex* output, int begin, int end) const
+{
+  const Point* currPositions = &positions[key.firstFrame * nFramePositions];
+  const Point* nextPositions = &positions[key.secondFrame * nFramePositions];
+  const Vec3*  currNormals   = &normals[key.firstFrame * nFramePositions];
+  const Vec3*  nextNormals   = &normals[key.secondFrame * nFramePositions];
+
+#ifdef OZ_SIMD
+  float4 t     = vFill(key.interpolation);
+  // Zero w so that the padding byte after the normal is deterministic.
+  float4 scale = float4{ 127.0f, 127.0f, 127.0f, 0.0f };
+
+  for (int i = begin; i < end; ++i) {
+    int    j      = positionIndices[i];
+    float4 pos    = currPositions[j].f4 + (nextPositions[j].f4 - currPositions[j].f4) * t;
+    float4 normal = (currNormals[j].f4 + (nextNormals[j].f4 - currNormals[j].f4) * t) * scale;
+
+    output[i] = vertices[i];
+
+    output[i].pos[0]    = pos[0];
+    output[i].pos[1]    = pos[1];
+    output[i].pos[2]    = pos[2];
+
+    vStoreBytes(normal, output[i].normal);
+  }
+#else
+  float t = key.interpolation;
+
+  for (int i = begin; i < end; ++i) {
+    int   j      = positionIndices[i];
+    Point pos    = Math::mix(currPositions[j], nextPositions[j], t);
+    Vec3  normal = Math::mix(currNormals[j], nextNormals[j], t) * 127.0f;
+
+    output[i] = vertices[i];
+
+    output[i].pos[0]    = pos.x;
+    output[i].pos[1]    = pos.y;
+    output[i].pos[2]    = pos.z;
+
+    output[i].normal[0] = byte(normal.x);
+    output[i].normal[1] = byte(normal.y);
+    output[i].normal[2] = byte(normal.z);
+  }
+#endif
+}
+
+void Model::animate(QueueType queue, const Instance* instance)
 {
   if (shader.hasVTF) {
     glActiveTexture(Shader::VERTEX_ANIM);
@@ -109,52 +315,59 @@ void Model::animate(const Instance* instance)
                 instance->interpolation);
   }
   else {
-    const Point* currFramePositions = &positions[instance->firstFrame * nFramePositions];
-    const Vec3*  currFrameNormals   = &normals[instance->firstFrame * nFramePositions];
-
-    if (instance->interpolation == 0.0f) {
-      for (int i = 0; i < nVertices; ++i) {
-        int j = Math::lround(vertices[i].pos[0] * float(nFramePositions - 1));
-
-        Point pos    = currFramePositions[j];
-        Vec3  normal = currFrameNormals[j];
+    // Vertices were interpolated in `animateScheduled()`, only upload them if the buffer does not
+    // already hold the same animation.
+    int uploadId = instance->animation * 2 + queue;
 
-        vertexAnimBuffer[i].pos[0] = pos.x;
-        vertexAnimBuffer[i].pos[1] = pos.y;
-        vertexAnimBuffer[i].pos[2] = pos.z;
+    if (uploadedAnimation != uploadId) {
+      uploadedAnimation = uploadId;
 
-        vertexAnimBuffer[i].texCoord[0] = vertices[i].texCoord[0];
-        vertexAnimBuffer[i].texCoord[1] = vertices[i].texCoord[1];
-
-        vertexAnimBuffer[i].normal[0] = byte(normal.x * 127.0f);
-        vertexAnimBuffer[i].normal[1] = byte(normal.y * 127.0f);
-        vertexAnimBuffer[i].normal[2] = byte(normal.z * 127.0f);
-      }
+      const AnimEntry& entry = animEntries[queue][instance->animation];
+      upload(&animVertices[queue][entry.offset], nVertices, GL_STREAM_DRAW);
     }
-    else {
-      const Point* nextFramePositions = &positions[instance->secondFrame * nFramePositions];
-      const Vec3*  nextFrameNormals   = &normals[instance->secondFrame * nFramePositions];
-
-      for (int i = 0; i < nVertices; ++i) {
-        int j = Math::lround(vertices[i].pos[0] * float(nFramePositions - 1));
+  }
+}
 
-        Point pos    = Math::mix(currFramePositions[j], nextFramePositions[j], instance->interpolation);
-        Vec3  normal = Math::mix(currFrameNormals[j],   nextFrameNormals[j],   instance->interpolation);
+void Model::drawMesh(const Mesh* mesh) const
+{
+  if (cullFrustum == nullptr || mesh->nMeshlets == 0) {
+    glDrawElements(GL_TRIANGLES, mesh->nIndices, indexType,
+                   static_cast<char*>(nullptr) + mesh->firstIndex * indexSize);
+    ++nDrawCalls;
+    return;
+  }
 
-        vertexAnimBuffer[i].pos[0] = pos.x;
-        vertexAnimBuffer[i].pos[1] = pos.y;
-        vertexAnimBuffer[i].pos[2] = pos.z;
+  // Meshlet spheres are in mesh space, so they are scaled by the largest scale of the transform.
+  float scale = Math::sqrt(max(max(Vec3(tf.model.x).sqN(), Vec3(tf.model.y).sqN()),
+                               Vec3(tf.model.z).sqN()));
+  int   first = 0;
+  int   count = 0;
 
-        vertexAnimBuffer[i].texCoord[0] = vertices[i].texCoord[0];
-        vertexAnimBuffer[i].texCoord[1] = vertices[i].texCoord[1];
+  // Adjacent visible meshlets are drawn together.
+  for (int i = mesh->firstMeshlet; i < mesh->firstMeshlet + mesh->nMeshlets; ++i) {
+    const Meshlet& meshlet = meshlets[i];
 
-        vertexAnimBuffer[i].normal[0] = byte(normal.x * 127.0f);
-        vertexAnimBuffer[i].normal[1] = byte(normal.y * 127.0f);
-        vertexAnimBuffer[i].normal[2] = byte(normal.z * 127.0f);
+    if (!cullFrustum->isVisible(tf.model * meshlet.centre, scale * meshlet.radius)) {
+      ++nCulledMeshlets;
+    }
+    else if (count != 0 && first + count == meshlet.firstIndex) {
+      count += meshlet.nIndices;
+    }
+    else {
+      if (count != 0) {
+        glDrawElements(GL_TRIANGLES, count, indexType,
+                       static_cast<char*>(nullptr) + first * indexSize);
+        ++nDrawCalls;
       }
+
+      first = meshlet.firstIndex;
+      count = meshlet.nIndices;
     }
+  }
 
-    upload(vertexAnimBuffer, nVertices, GL_STREAM_DRAW);
+  if (count != 0) {
+    glDrawElements(GL_TRIANGLES, count, indexType, static_cast<char*>(nullptr) + first * indexSize);
+    ++nDrawCalls;
   }
 }
 
@@ -182,8 +395,7 @@ void Model::drawNode(const Node* node, int mask)
 
       glUniform1f(uniform.shininess, mesh.shininess);
 
-      glDrawElements(GL_TRIANGLES, mesh.nIndices, GL_UNSIGNED_SHORT,
-                     static_cast<ushort*>(nullptr) + mesh.firstIndex);
+      drawMesh(&mesh);
     }
   }
 
@@ -201,93 +413,190 @@ void Model::draw(const Instance* instance, int mask)
   tf.applyColour();
 
   drawNode(&nodes[instance->node], mask);
+  ++nInstances;
 }
 
-void Model::setCollation(Collation collation_)
+void Model::flattenNode(const Node* node, const Mat4& parentTransf)
 {
-  collation = collation_;
+  Mat4 transf = parentTransf ^ node->transf;
+
+  if (node->mesh >= 0) {
+    batchMeshes.add(MeshEntry{ node->mesh, transf });
+  }
+
+  for (int i = 0; i < node->nChildren; ++i) {
+    flattenNode(&nodes[node->firstChild + i], transf);
+  }
 }
 
-void Model::drawScheduled(QueueType queue, int mask)
+void Model::drawBatch()
 {
-  if (collation == MODEL_MAJOR) {
-    for (const Ref& ref : loadedModels) {
-      Model* model = ref.model;
+  // Draw instances from `batchInstances` mesh after mesh rather than instance after instance, so
+  // textures and material uniforms are bound once per mesh and colour is only uploaded when it
+  // changes. Instances are sorted by their root nodes, as each of those has its own mesh list, and
+  // then drawn group after group.
+  bool hasColour = false;
 
-      if (model->modelInstances[queue].isEmpty()) {
-        continue;
-      }
+  batchInstances.sort();
 
-      glBindBuffer(GL_ARRAY_BUFFER, model->vbo);
-      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model->ibo);
+  for (int i = 0; i < batchInstances.length();) {
+    int root = batchInstances[i].node;
+    int end  = i + 1;
 
-      Vertex::setFormat();
+    while (end < batchInstances.length() && batchInstances[end].node == root) {
+      ++end;
+    }
 
-      shader.program(model->shaderId);
+    batchMeshes.clear();
+    flattenNode(&nodes[root], Mat4::ID);
 
-      for (const Instance& instance : model->modelInstances[queue]) {
-        // HACK This is not a nice way to draw non-transparent parts with alpha < 1.
-        int instanceMask = mask;
+    for (const MeshEntry& entry : batchMeshes) {
+      const Mesh&    mesh    = meshes[entry.mesh];
+      const Texture& texture = textures[mesh.texture];
+      bool           isBound = false;
 
-        if (instance.colour.w.w != 1.0f) {
-          if (mask & ALPHA_BIT) {
-            instanceMask |= SOLID_BIT;
-          }
-          else {
-            continue;
-          }
-        }
+      for (int j = i; j < end; ++j) {
+        const BatchEntry& batchEntry = batchInstances[j];
 
-        if (!(model->flags & instanceMask)) {
+        if (!(mesh.flags & batchEntry.mask)) {
           continue;
         }
 
-        if (model->nFrames != 0) {
-          model->animate(&instance);
+        if (!isBound) {
+          isBound = true;
+
+          glActiveTexture(Shader::DIFFUSE);
+          glBindTexture(GL_TEXTURE_2D, texture.albedo);
+          glActiveTexture(Shader::MASKS);
+          glBindTexture(GL_TEXTURE_2D, texture.masks);
+          if (shader.doBumpMap) {
+            glActiveTexture(Shader::NORMALS);
+            glBindTexture(GL_TEXTURE_2D, texture.normals);
+          }
+
+          glUniform1f(uniform.shininess, mesh.shininess);
         }
 
-        model->draw(&instance, instanceMask);
+        if (!hasColour || batchEntry.instance->colour != tf.colour) {
+          hasColour = true;
+          tf.colour = batchEntry.instance->colour;
+          tf.applyColour();
+        }
+
+        tf.model = batchEntry.instance->transf ^ entry.transf;
+        tf.apply();
+
+        drawMesh(&mesh);
       }
     }
+
+    nInstances += end - i;
+    i = end;
   }
-  else {
-    Model* model = nullptr;
+}
 
-    for (const Instance& instance : instances[queue]) {
-      if (instance.model != model) {
-        model = instance.model;
+void Model::setCollation(Collation collation_)
+{
+  collation = collation_;
+}
 
-        glBindBuffer(GL_ARRAY_BUFFER, model->vbo);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model->ibo);
+void Model::resetCounters()
+{
+  nDrawCalls      = 0;
+  nInstances      = 0;
+  nAnimations     = 0;
+  nAnimShared     = 0;
+  nCulledMeshlets = 0;
+}
 
-        Vertex::setFormat();
+void Model::drawQueue(QueueType queue, RenderQueue* renderQueue, int mask)
+{
+  renderQueue->sort();
 
-        shader.program(model->shaderId);
-      }
+  Model* model = nullptr;
 
-      // HACK This is not a nice way to draw non-transparent parts for which alpha < 1 has been set.
-      int instanceMask = mask;
+  for (ulong64 key : *renderQueue) {
+    const Instance& instance = instances[queue][RenderQueue::index(key)];
 
-      if (instance.colour.w.w != 1.0f) {
-        if (mask & ALPHA_BIT) {
-          instanceMask |= SOLID_BIT;
-        }
-        else {
-          continue;
-        }
+    if (instance.model != model) {
+      if (!batchInstances.isEmpty()) {
+        model->drawBatch();
+        batchInstances.clear();
       }
 
-      if (!(model->flags & instanceMask)) {
-        continue;
-      }
+      model = instance.model;
 
-      if (model->nFrames != 0) {
-        model->animate(&instance);
-      }
+      glBindBuffer(GL_ARRAY_BUFFER, model->vbo);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model->ibo);
+
+      Vertex::setFormat();
+
+      shader.program(model->shaderId);
+    }
+
+    // HACK This is not a nice way to draw non-transparent parts for which alpha < 1 has been set.
+    // Such instances are only in alpha queues.
+    int instanceMask = instance.colour.w.w != 1.0f ? mask | SOLID_BIT : mask;
+
+    if (!(model->flags & instanceMask)) {
+      continue;
+    }
 
+    // Animated instances have their own vertex data or animation uniforms, so only static ones
+    // can be batched. Batching draws mesh after mesh across instances, which would break the
+    // back-to-front order of the alpha pass, so transparent instances are drawn one by one.
+    if (model->nFrames != 0) {
+      model->animate(queue, &instance);
       model->draw(&instance, instanceMask);
     }
+    else if (mask != SOLID_BIT) {
+      model->draw(&instance, instanceMask);
+    }
+    else {
+      batchInstances.add(BatchEntry{ &instance, instance.node, instanceMask });
+    }
+  }
+
+  if (!batchInstances.isEmpty()) {
+    model->drawBatch();
+    batchInstances.clear();
+  }
+}
+
+void Model::enqueue(QueueType queue, const Instance& instance)
+{
+  int   index = instances[queue].length();
+  Point pos   = Point(instance.transf.w.x, instance.transf.w.y, instance.transf.w.z);
+  float depth = (pos - camera.p) * camera.at / camera.maxDist;
+
+  instances[queue].add(instance);
+
+  if (instance.colour.w.w == 1.0f) {
+    RenderQueue::Layout layout = collation == MODEL_MAJOR ? RenderQueue::STATE_MAJOR :
+                                                            RenderQueue::DEPTH_MAJOR;
+
+    opaqueQueues[queue].add(RenderQueue::key(layout, shaderId, id, depth, index));
   }
+  if (instance.colour.w.w != 1.0f || (flags & ALPHA_BIT)) {
+    alphaQueues[queue].add(RenderQueue::key(RenderQueue::BACK_TO_FRONT, shaderId, id, depth,
+                                            index));
+  }
+}
+
+void Model::drawScheduled(QueueType queue, int mask, const Frustum* frustum)
+{
+  animateScheduled(queue);
+
+  cullFrustum = frustum;
+
+  if (mask & SOLID_BIT) {
+    drawQueue(queue, &opaqueQueues[queue], SOLID_BIT);
+  }
+  if (mask & ALPHA_BIT) {
+    drawQueue(queue, &alphaQueues[queue], ALPHA_BIT);
+  }
+
+  cullFrustum = nullptr;
 
   if (shader.hasVTF) {
     glActiveTexture(Shader::VERTEX_ANIM);
@@ -311,14 +620,11 @@ void Model::drawScheduled(QueueType queue, int mask)
 
 void Model::clearScheduled(QueueType queue)
 {
-  if (collation == MODEL_MAJOR) {
-    for (const Ref& ref : loadedModels) {
-      ref.model->modelInstances[queue].clear();
-    }
-  }
-  else {
-    instances[queue].clear();
-  }
+  areAnimated[queue] = false;
+
+  instances[queue].clear();
+  opaqueQueues[queue].clear();
+  alphaQueues[queue].clear();
 
   sceneLights.clear();
 }
@@ -329,21 +635,43 @@ void Model::deallocate()
 
   loadedModels.trim();
 
-  delete[] vertexAnimBuffer;
-  vertexAnimBuffer = nullptr;
-  vertexAnimBufferLength = 0;
+  animEntries[SCENE_QUEUE].trim();
+  animEntries[OVERLAY_QUEUE].trim();
+  animVertices[SCENE_QUEUE].trim();
+  animVertices[OVERLAY_QUEUE].trim();
+  animJobs.trim();
+  animCache.clear();
+  animCache.trim();
 
   instances[SCENE_QUEUE].trim();
   instances[OVERLAY_QUEUE].trim();
 
+  opaqueQueues[SCENE_QUEUE].trim();
+  opaqueQueues[OVERLAY_QUEUE].trim();
+  alphaQueues[SCENE_QUEUE].trim();
+  alphaQueues[OVERLAY_QUEUE].trim();
+
   sceneLights.trim();
+  batchInstances.trim();
+  batchMeshes.trim();
+}
+
+int Model::readFormatVersion(Stream* is)
+{
+  if (is->readInt() == FORMAT_MAGIC) {
+    return is->readInt();
+  }
+
+  is->seek(0);
+  return 0;
 }
 
 Model::Model(const File& path_) :
-  path(path_), vbo(0), ibo(0), animationTexId(0),
+  path(path_), id(nextId++), vbo(0), ibo(0), indexType(GL_UNSIGNED_SHORT),
+  indexSize(int(sizeof(ushort))), animationTexId(0),
   nTextures(0), nVertices(0), nIndices(0), nFrames(0), nFramePositions(0),
-  vertices(nullptr), positions(nullptr), normals(nullptr),
-  preloadData(nullptr), dim(Vec3::ONE), size(dim.fastN())
+  vertices(nullptr), positions(nullptr), normals(nullptr), positionIndices(nullptr),
+  uploadedAnimation(-1), preloadData(nullptr), dim(Vec3::ONE), size(dim.fastN())
 {}
 
 Model::~Model()
@@ -363,36 +691,31 @@ int Model::findNode(const char* name) const
 
 void Model::schedule(int mesh, QueueType queue)
 {
-  List<Instance>& list = collation == MODEL_MAJOR ? modelInstances[queue] : instances[queue];
-
   if (shader.nLights != 0 && lights.isEmpty() != 0) {
     addSceneLights();
   }
 
-  list.add(Instance{ this, tf.model, tf.colour, mesh, 0, 0, 0.0f });
+  enqueue(queue, Instance{ this, tf.model, tf.colour, mesh, 0, 0, 0.0f, -1 });
 }
 
 void Model::scheduleFrame(int mesh, int frame, QueueType queue)
 {
-  List<Instance>& list = collation == MODEL_MAJOR ? modelInstances[queue] : instances[queue];
-
   if (shader.nLights != 0 && lights.isEmpty() != 0) {
     addSceneLights();
   }
 
-  list.add(Instance{ this, tf.model, tf.colour, mesh, frame, 0, 0.0f });
+  enqueue(queue, Instance{ this, tf.model, tf.colour, mesh, frame, 0, 0.0f, -1 });
 }
 
 void Model::scheduleAnimated(int mesh, int firstFrame, int secondFrame, float interpolation,
                              QueueType queue)
 {
-  List<Instance>& list = collation == MODEL_MAJOR ? modelInstances[queue] : instances[queue];
-
   if (shader.nLights != 0 && lights.isEmpty() != 0) {
     addSceneLights();
   }
 
-  list.add(Instance{ this, tf.model, tf.colour, mesh, firstFrame, secondFrame, interpolation });
+  enqueue(queue, Instance{ this, tf.model, tf.colour, mesh, firstFrame, secondFrame,
+                           interpolation, -1 });
 }
 
 const File* Model::preload()
@@ -408,6 +731,12 @@ const File* Model::preload()
     OZ_ERROR("Failed to read '%s'", path.c());
   }
 
+  int version     = readFormatVersion(&is);
+
+  if (version > FORMAT_VERSION) {
+    OZ_ERROR("'%s' has unsupported model format version %d", path.c(), version);
+  }
+
   dim             = is.readVec3();
   size            = dim.fastN();
   flags           = 0;
@@ -422,6 +751,20 @@ const File* Model::preload()
   int nLights     = is.readInt();
   int nNodes      = is.readInt();
   int nAnimations = is.readInt();
+  int nMeshlets   = 0;
+
+  indexSize       = int(sizeof(ushort));
+
+  if (version >= 1) {
+    indexSize = is.readInt();
+    nMeshlets = is.readInt();
+  }
+
+  if (indexSize == int(sizeof(uint)) && !shader.hasUIntIndices) {
+    OZ_ERROR("'%s' needs 32-bit indices, which are not supported", path.c());
+  }
+
+  indexType       = indexSize == int(sizeof(uint)) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
 
   if (nTextures < 0) {
     textures.resize(~nTextures, true);
@@ -451,7 +794,7 @@ const File* Model::preload()
   }
 
   int vboSize = nVertices * sizeof(Vertex);
-  int iboSize = nIndices  * sizeof(ushort);
+  int iboSize = nIndices  * indexSize;
 
   const void* vertexBuffer = is.readSkip(vboSize);
   is.readSkip(iboSize);
@@ -476,22 +819,41 @@ const File* Model::preload()
       }
 
       memcpy(vertices, vertexBuffer, nVertices * sizeof(Vertex));
+
+      // Position X holds the index of the vertex in frame positions and normals.
+      positionIndices = new int[nVertices];
+
+      for (int i = 0; i < nVertices; ++i) {
+        positionIndices[i] = Math::lround(vertices[i].pos[0] * float(nFramePositions - 1));
+      }
     }
   }
 
   meshes.resize(nMeshes, true);
 
   for (int i = 0; i < nMeshes; ++i) {
-    meshes[i].flags      = is.readInt();
-    meshes[i].texture    = is.readInt();
-    meshes[i].shininess  = is.readFloat();
+    meshes[i].flags        = is.readInt();
+    meshes[i].texture      = is.readInt();
+    meshes[i].shininess    = is.readFloat();
 
-    meshes[i].nIndices   = is.readInt();
-    meshes[i].firstIndex = is.readInt();
+    meshes[i].nIndices     = is.readInt();
+    meshes[i].firstIndex   = is.readInt();
+
+    meshes[i].nMeshlets    = version >= 1 ? is.readInt() : 0;
+    meshes[i].firstMeshlet = version >= 1 ? is.readInt() : 0;
 
     flags |= meshes[i].flags & (SOLID_BIT | ALPHA_BIT);
   }
 
+  meshlets.resize(nMeshlets, true);
+
+  for (int i = 0; i < nMeshlets; ++i) {
+    meshlets[i].nIndices   = is.readInt();
+    meshlets[i].firstIndex = is.readInt();
+    meshlets[i].centre     = is.readPoint();
+    meshlets[i].radius     = is.readFloat();
+  }
+
   lights.resize(nLights, true);
 
   for (int i = 0; i < nLights; ++i) {
@@ -573,6 +935,8 @@ void Model::load()
   hard_assert(preloadData != nullptr);
   Stream is = preloadData->modelFile.read(Endian::LITTLE);
 
+  int version = readFormatVersion(&is);
+
   is.readVec3();
   is.readString();
   is.readInt();
@@ -586,6 +950,11 @@ void Model::load()
   is.readInt();
   is.readInt();
 
+  if (version >= 1) {
+    is.readInt();
+    is.readInt();
+  }
+
   if (nTextures < 0) {
     nTextures = ~nTextures;
 
@@ -608,7 +977,7 @@ void Model::load()
 
   uint usage   = nFrames != 0 && shader.hasVTF ? GL_STREAM_DRAW : GL_STATIC_DRAW;
   int  vboSize = nVertices * sizeof(Vertex);
-  int  iboSize = nIndices  * sizeof(ushort);
+  int  iboSize = nIndices  * indexSize;
 
   const void* vertexBuffer = is.readSkip(vboSize);
 
@@ -622,31 +991,23 @@ void Model::load()
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, iboSize, is.readSkip(iboSize), GL_STATIC_DRAW);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-  if (nFrames != 0) {
-    if (shader.hasVTF) {
+  if (nFrames != 0 && shader.hasVTF) {
 #ifndef OZ_GL_ES
-      int vertexBufferSize = nFramePositions * nFrames * sizeof(float[3]);
-      int normalBufferSize = nFramePositions * nFrames * sizeof(float[3]);
+    int vertexBufferSize = nFramePositions * nFrames * sizeof(float[3]);
+    int normalBufferSize = nFramePositions * nFrames * sizeof(float[3]);
 
-      glGenTextures(1, &animationTexId);
-      glBindTexture(GL_TEXTURE_2D, animationTexId);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glGenTextures(1, &animationTexId);
+    glBindTexture(GL_TEXTURE_2D, animationTexId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, nFramePositions, 2 * nFrames, 0, GL_RGB,
-                   GL_FLOAT, is.readSkip(vertexBufferSize + normalBufferSize));
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, nFramePositions, 2 * nFrames, 0, GL_RGB,
+                 GL_FLOAT, is.readSkip(vertexBufferSize + normalBufferSize));
 
-      glBindTexture(GL_TEXTURE_2D, shader.defaultTexture);
+    glBindTexture(GL_TEXTURE_2D, shader.defaultTexture);
 
-      OZ_GL_CHECK_ERROR();
+    OZ_GL_CHECK_ERROR();
 #endif
-    }
-    else if (nVertices > vertexAnimBufferLength) {
-      delete[] vertexAnimBuffer;
-
-      vertexAnimBuffer = new Vertex[nVertices];
-      vertexAnimBufferLength = nVertices;
-    }
   }
 
   loadedModels.include(Ref{ this });
@@ -683,6 +1044,8 @@ void Model::unload()
   nodes.trim();
   meshes.clear();
   meshes.trim();
+  meshlets.clear();
+  meshlets.trim();
   textures.clear();
   textures.trim();
 
@@ -691,9 +1054,15 @@ void Model::unload()
       glDeleteTextures(1, &animationTexId);
     }
     else {
+      delete[] positionIndices;
       delete[] normals;
       delete[] positions;
       delete[] vertices;
+
+      positionIndices = nullptr;
+      normals         = nullptr;
+      positions       = nullptr;
+      vertices        = nullptr;
     }
   }
 
@@ -25,12 +25,15 @@
 
 #include <client/Shader.hh>
 #include <client/MD2.hh>
+#include <client/RenderQueue.hh>
 
 namespace oz
 {
 namespace client
 {
 
+class Frustum;
+
 struct Vertex
 {
   float pos[3];
@@ -111,6 +114,13 @@ class Model
 {
 public:
 
+  /// First int of versioned model files. As a float it is a NaN, which can never be the first
+  /// dimension of bounds that unversioned files begin with.
+  static const int FORMAT_MAGIC    = int(0xffc0de01);
+
+  /// Version 1 adds index size and meshlets.
+  static const int FORMAT_VERSION  = 1;
+
   static const int EMBEDED_TEX_BIT = 0x01; ///< Textures are embedded into model file.
 
   static const int SOLID_BIT       = 0x04; ///< Mesh is opaque.
@@ -134,6 +144,9 @@ public:
 
 private:
 
+  /// Number of vertices interpolated by a single animation job.
+  static const int ANIM_JOB_VERTICES = 1024;
+
   struct Ref
   {
     Model* model;
@@ -157,6 +170,20 @@ private:
 
     int   nIndices;
     int   firstIndex;
+
+    int   nMeshlets;
+    int   firstMeshlet;
+  };
+
+  /**
+   * Consecutive triangles of a mesh with their bounding sphere in mesh space.
+   */
+  struct Meshlet
+  {
+    int   nIndices;
+    int   firstIndex;
+    Point centre;
+    float radius;
   };
 
   struct Node
@@ -179,30 +206,53 @@ private:
     int    firstFrame;
     int    secondFrame;
     float  interpolation;
+    int    animation;
   };
 
   struct LightEntry;
   struct PreloadData;
+  struct BatchEntry;
+  struct MeshEntry;
+  struct AnimKey;
+  struct AnimKeyHash;
+  struct AnimEntry;
+  struct AnimJob;
+
+  typedef FlatHashMap<AnimKey, int, AnimKeyHash> AnimCache;
 
 private:
 
   static Set<Ref>         loadedModels;
   static List<Instance>   instances[2];
   static List<LightEntry> sceneLights;
-
-  static Vertex*          vertexAnimBuffer;
-  static int              vertexAnimBufferLength;
+  static List<BatchEntry> batchInstances;
+  static List<MeshEntry>  batchMeshes;
+  static RenderQueue      opaqueQueues[2];
+  static RenderQueue      alphaQueues[2];
+  static int              nextId;
+
+  static List<AnimEntry>  animEntries[2];
+  static List<Vertex>     animVertices[2];
+  static List<AnimJob>    animJobs;
+  static AnimCache        animCache;
+  static bool             areAnimated[2];
+  static int              animQueue;
   static Collation        collation;
+  static const Frustum*   cullFrustum;
 
   File                    path;
+  int                     id;
   int                     flags;
   uint                    vbo;
   uint                    ibo;
+  uint                    indexType;
+  int                     indexSize;
   int                     shaderId;
   uint                    animationTexId;
 
   List<Texture>           textures;
   List<Mesh>              meshes;
+  List<Meshlet>           meshlets;
   List<Light>             lights;
   List<Node>              nodes;
   List<Animation>         animations;
@@ -216,12 +266,19 @@ private:
   Vertex*                 vertices;
   Point*                  positions;
   Vec3*                   normals;
+  int*                    positionIndices;
+  int                     uploadedAnimation;
 
-  List<Instance>          modelInstances[2];
   PreloadData*            preloadData;
 
 public:
 
+  static int              nDrawCalls;   ///< Mesh draw calls since the last `resetCounters()`.
+  static int              nInstances;   ///< Instances drawn since the last `resetCounters()`.
+  static int              nAnimations;  ///< Vertex animations interpolated on CPU.
+  static int              nAnimShared;  ///< Animated instances that reused another's vertices.
+  static int              nCulledMeshlets; ///< Meshlets outside the frustum.
+
   Vec3                    dim;
   float                   size;
 
@@ -229,19 +286,42 @@ private:
 
   void addSceneLights();
 
-  void animate(const Instance* instance);
+  static void runAnimJobs(int begin, int end);
+  static void animateScheduled(QueueType queue);
+
+  void interpolate(const AnimKey& key, Vertex* output, int begin, int end) const;
+  void animate(QueueType queue, const Instance* instance);
+  void drawMesh(const Mesh* mesh) const;
   void drawNode(const Node* node, int mask);
   void draw(const Instance* instance, int mask);
+  void flattenNode(const Node* node, const Mat4& parentTransf);
+  void drawBatch();
+  void enqueue(QueueType queue, const Instance& instance);
+
+  static void drawQueue(QueueType queue, RenderQueue* renderQueue, int mask);
 
 public:
 
   static void setCollation(Collation collation);
-
-  static void drawScheduled(QueueType queue, int mask);
+  static void resetCounters();
+
+  /**
+   * Draw scheduled instances.
+   *
+   * If `frustum` is given, meshlets of static meshes outside it are skipped.
+   */
+  static void drawScheduled(QueueType queue, int mask, const Frustum* frustum = nullptr);
   static void clearScheduled(QueueType queue);
 
   static void deallocate();
 
+  /**
+   * Read version of a model file and leave the stream at the beginning of the common header.
+   *
+   * Files without version are version 0.
+   */
+  static int readFormatVersion(Stream* is);
+
   explicit Model(const File& path);
   ~Model();
 
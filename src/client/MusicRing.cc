@@ -0,0 +1,123 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/MusicRing.cc
+ */
+
+#include <client/MusicRing.hh>
+
+namespace oz
+{
+namespace client
+{
+
+int MusicRing::depth() const
+{
+  uint written = __atomic_load_n(&writeHead, __ATOMIC_ACQUIRE);
+  uint read    = __atomic_load_n(&readHead, __ATOMIC_ACQUIRE);
+
+  return int(written - read);
+}
+
+MusicRing::Block* MusicRing::beginWrite()
+{
+  uint read = __atomic_load_n(&readHead, __ATOMIC_ACQUIRE);
+
+  if (int(writeHead - read) == nBlocks) {
+    return nullptr;
+  }
+  return &blocks[writeHead & uint(nBlocks - 1)];
+}
+
+void MusicRing::endWrite()
+{
+  hard_assert(int(writeHead - __atomic_load_n(&readHead, __ATOMIC_ACQUIRE)) < nBlocks);
+
+  nWrittenBytes += ulong64(blocks[writeHead & uint(nBlocks - 1)].size);
+  ++nWrites;
+
+  __atomic_store_n(&writeHead, writeHead + 1, __ATOMIC_RELEASE);
+
+  nPeakDepth = max(nPeakDepth, depth());
+}
+
+const MusicRing::Block* MusicRing::beginRead() const
+{
+  uint written = __atomic_load_n(&writeHead, __ATOMIC_ACQUIRE);
+
+  if (written == readHead) {
+    return nullptr;
+  }
+  return &blocks[readHead & uint(nBlocks - 1)];
+}
+
+void MusicRing::endRead()
+{
+  hard_assert(readHead != __atomic_load_n(&writeHead, __ATOMIC_ACQUIRE));
+
+  ++nReads;
+
+  __atomic_store_n(&readHead, readHead + 1, __ATOMIC_RELEASE);
+}
+
+void MusicRing::resetCounters()
+{
+  nPeakDepth    = depth();
+  nWrites       = 0;
+  nWrittenBytes = 0;
+  nReads        = 0;
+  nUnderruns    = 0;
+}
+
+void MusicRing::init(int nBlocks_)
+{
+  hard_assert(nBlocks_ > 0 && (nBlocks_ & (nBlocks_ - 1)) == 0);
+
+  destroy();
+
+  nBlocks = nBlocks_;
+  blocks  = new Block[nBlocks];
+  data    = new char[size_t(nBlocks) * BLOCK_SIZE];
+
+  for (int i = 0; i < nBlocks; ++i) {
+    blocks[i] = Block{ data + size_t(i) * BLOCK_SIZE, 0, 0, 0, 0 };
+  }
+
+  writeHead = 0;
+  readHead  = 0;
+
+  resetCounters();
+}
+
+void MusicRing::destroy()
+{
+  delete[] data;
+  delete[] blocks;
+
+  blocks    = nullptr;
+  data      = nullptr;
+  nBlocks   = 0;
+  writeHead = 0;
+  readHead  = 0;
+}
+
+}
+}
@@ -0,0 +1,134 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/MusicRing.hh
+ *
+ * Lock-free ring of decoded music blocks.
+ */
+
+#pragma once
+
+#include <ozCore/ozCore.hh>
+
+namespace oz
+{
+namespace client
+{
+
+/**
+ * Single-producer single-consumer ring of PCM blocks.
+ *
+ * The music thread decodes into free blocks and publishes them, the sound thread takes filled
+ * blocks and uploads them to sound buffers. Each side only advances its own index, so neither ever
+ * waits on the other. Producer and consumer counters are each written by one side only.
+ */
+class MusicRing
+{
+public:
+
+  /// Size of PCM data in a block.
+  static const int BLOCK_SIZE = 64 * 1024;
+
+  /**
+   * PCM block.
+   *
+   * A block with zero size marks the end of a track.
+   */
+  struct Block
+  {
+    char* data;       ///< 16-bit PCM samples.
+    int   size;       ///< Number of valid bytes in `data`.
+    int   rate;       ///< Sample rate.
+    int   channels;   ///< Number of channels, 1 or 2.
+    uint  generation; ///< Track selection the block was decoded for.
+  };
+
+private:
+
+  Block* blocks    = nullptr;
+  char*  data      = nullptr;
+  int    nBlocks   = 0;
+  uint   writeHead = 0;
+  uint   readHead  = 0;
+
+public:
+
+  int     nPeakDepth    = 0; ///< Peak number of filled blocks (producer).
+  ulong64 nWrites       = 0; ///< Number of published blocks (producer).
+  ulong64 nWrittenBytes = 0; ///< Amount of decoded PCM data (producer).
+  ulong64 nReads        = 0; ///< Number of consumed blocks (consumer).
+  ulong64 nUnderruns    = 0; ///< Number of times playback found the ring empty (consumer).
+
+  /**
+   * Number of blocks in the ring.
+   */
+  OZ_ALWAYS_INLINE
+  int length() const
+  {
+    return nBlocks;
+  }
+
+  /**
+   * Number of filled blocks waiting to be consumed.
+   */
+  int depth() const;
+
+  /**
+   * Free block to decode into or `nullptr` if the ring is full (producer).
+   */
+  Block* beginWrite();
+
+  /**
+   * Publish the block returned by the last `beginWrite()` (producer).
+   */
+  void endWrite();
+
+  /**
+   * Oldest filled block or `nullptr` if the ring is empty (consumer).
+   */
+  const Block* beginRead() const;
+
+  /**
+   * Release the block returned by the last `beginRead()` (consumer).
+   */
+  void endRead();
+
+  /**
+   * Reset counters.
+   *
+   * Counters are not synchronised, resetting them while music is streaming only skews statistics.
+   */
+  void resetCounters();
+
+  /**
+   * Allocate a ring with a given number of blocks, which must be a power of two.
+   */
+  void init(int nBlocks);
+
+  /**
+   * Free ring storage.
+   */
+  void destroy();
+
+};
+
+}
+}
@@ -0,0 +1,445 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/MusicStream.cc
+ */
+
+#include <client/MusicStream.hh>
+
+#include <cstring>
+
+namespace oz
+{
+namespace client
+{
+
+static OZ_DL_DEFINE(mad_stream_init);
+static OZ_DL_DEFINE(mad_stream_finish);
+static OZ_DL_DEFINE(mad_stream_buffer);
+static OZ_DL_DEFINE(mad_frame_init);
+static OZ_DL_DEFINE(mad_frame_finish);
+static OZ_DL_DEFINE(mad_frame_decode);
+static OZ_DL_DEFINE(mad_synth_init);
+static OZ_DL_DEFINE(mad_synth_frame);
+
+static OZ_DL_DEFINE(NeAACDecInit);
+static OZ_DL_DEFINE(NeAACDecOpen);
+static OZ_DL_DEFINE(NeAACDecClose);
+static OZ_DL_DEFINE(NeAACDecDecode);
+
+static SharedLib libMad;
+static SharedLib libFaad;
+
+static size_t vorbisRead(void* buffer, size_t size, size_t n, void* handle);
+static ov_callbacks VORBIS_CALLBACKS = { vorbisRead, nullptr, nullptr, nullptr };
+
+static size_t vorbisRead(void* buffer, size_t size, size_t n, void* handle)
+{
+  return size_t(PHYSFS_read(static_cast<PHYSFS_File*>(handle), buffer, 1, uint(size * n)));
+}
+
+OZ_ALWAYS_INLINE
+static inline short madFixedToShort(mad_fixed_t f)
+{
+  if (f < -MAD_F_ONE) {
+    return SHRT_MIN;
+  }
+  else if (f > +MAD_F_ONE) {
+    return SHRT_MAX;
+  }
+  else {
+    return short(f >> (MAD_F_FRACBITS - 15));
+  }
+}
+
+bool MusicStream::hasMP3()
+{
+  return libMad.isOpened();
+}
+
+bool MusicStream::hasAAC()
+{
+  return libFaad.isOpened();
+}
+
+void MusicStream::initLibs()
+{
+#ifndef __native_client__
+# ifdef _WIN32
+  const char* libMadName  = "libmad.dll";
+  const char* libFaadName = "libfaad2.dll";
+# else
+  const char* libMadName  = "libmad.so.0";
+  const char* libFaadName = "libfaad.so.2";
+# endif
+
+  Log::print("Linking MAD library '%s' ...", libMadName);
+
+  libMad = SharedLib(libMadName);
+  if (!libMad.isOpened()) {
+    Log::printEnd(" Not found, MP3 not supported");
+  }
+  else {
+    OZ_DL_LOAD(libMad, mad_stream_init  );
+    OZ_DL_LOAD(libMad, mad_stream_finish);
+    OZ_DL_LOAD(libMad, mad_stream_buffer);
+    OZ_DL_LOAD(libMad, mad_frame_init   );
+    OZ_DL_LOAD(libMad, mad_frame_finish );
+    OZ_DL_LOAD(libMad, mad_frame_decode );
+    OZ_DL_LOAD(libMad, mad_synth_init   );
+    OZ_DL_LOAD(libMad, mad_synth_frame  );
+
+    Log::printEnd(" OK, MP3 supported");
+  }
+
+  Log::print("Linking FAAD library '%s' ...", libFaadName);
+
+  libFaad = SharedLib(libFaadName);
+  if (!libFaad.isOpened()) {
+    Log::printEnd(" Not found, AAC not supported");
+  }
+  else {
+    OZ_DL_LOAD(libFaad, NeAACDecInit  );
+    OZ_DL_LOAD(libFaad, NeAACDecOpen  );
+    OZ_DL_LOAD(libFaad, NeAACDecClose );
+    OZ_DL_LOAD(libFaad, NeAACDecDecode);
+
+    Log::printEnd(" OK, AAC supported");
+  }
+#endif
+}
+
+void MusicStream::destroyLibs()
+{
+#ifndef __native_client__
+  libFaad.close();
+  libMad.close();
+#endif
+}
+
+MusicStream::~MusicStream()
+{
+  close();
+}
+
+void MusicStream::open(const File& file_)
+{
+  close();
+
+  path = file_;
+
+  if (path.hasExtension("oga") || path.hasExtension("ogg")) {
+    type = OGG;
+  }
+  else if (path.hasExtension("mp3")) {
+    type = libMad.isOpened() ? MP3 : NONE;
+  }
+  else if (path.hasExtension("aac")) {
+    type = libFaad.isOpened() ? AAC : NONE;
+  }
+  else {
+    OZ_ERROR("Unknown extension for file '%s'", path.c());
+  }
+
+  switch (type) {
+    case NONE: {
+      break;
+    }
+    case OGG: {
+      file = PHYSFS_openRead(path.toNative());
+      if (file == nullptr) {
+        OZ_ERROR("Failed to open file '%s'", path.c());
+      }
+
+      if (ov_open_callbacks(file, &oggStream, nullptr, 0, VORBIS_CALLBACKS) < 0) {
+        OZ_ERROR("Failed to open Ogg stream in '%s'", path.c());
+      }
+
+      vorbis_info* vorbisInfo = ov_info(&oggStream, -1);
+      if (vorbisInfo == nullptr) {
+        OZ_ERROR("Corrupted Vorbis header in '%s'", path.c());
+      }
+
+      rate     = int(vorbisInfo->rate);
+      channels = vorbisInfo->channels;
+      break;
+    }
+    case MP3: {
+      file = PHYSFS_openRead(path.toNative());
+      if (file == nullptr) {
+        OZ_ERROR("Failed to open file '%s'", path.c());
+      }
+
+      mad_stream_init(&madStream);
+      mad_frame_init(&madFrame);
+      mad_synth_init(&madSynth);
+
+      int readSize = int(PHYSFS_read(file, inputBuffer, 1, INPUT_BUFFER_SIZE));
+      if (readSize != INPUT_BUFFER_SIZE) {
+        OZ_ERROR("Failed to read MP3 stream in '%s'", path.c());
+      }
+
+      mad_stream_buffer(&madStream, inputBuffer, INPUT_BUFFER_SIZE);
+
+      while (mad_frame_decode(&madFrame, &madStream) != 0) {
+        if (!MAD_RECOVERABLE(madStream.error)) {
+          OZ_ERROR("Corrupted MP3 header in '%s'", path.c());
+        }
+      }
+
+      mad_synth_frame(&madSynth, &madFrame);
+
+      madFrameSamples   = madSynth.pcm.length;
+      madWrittenSamples = 0;
+
+      rate     = int(madFrame.header.samplerate);
+      channels = MAD_NCHANNELS(&madFrame.header);
+      break;
+    }
+    case AAC: {
+      file = PHYSFS_openRead(path.toNative());
+      if (file == nullptr) {
+        OZ_ERROR("Failed to open file '%s'", path.c());
+      }
+
+      aacDecoder = NeAACDecOpen();
+
+      int readSize = int(PHYSFS_read(file, inputBuffer, 1, INPUT_BUFFER_SIZE));
+      if (readSize != INPUT_BUFFER_SIZE) {
+        OZ_ERROR("Failed to read AAC stream in '%s'", path.c());
+      }
+
+      ulong aacRate;
+      ubyte aacChannels;
+
+      int skipBytes = int(NeAACDecInit(aacDecoder, inputBuffer, INPUT_BUFFER_SIZE,
+                                       &aacRate, &aacChannels));
+      if (skipBytes < 0) {
+        OZ_ERROR("Corrupted AAC header in '%s'", path.c());
+      }
+
+      memmove(inputBuffer, inputBuffer + skipBytes, size_t(INPUT_BUFFER_SIZE - skipBytes));
+
+      readSize = int(PHYSFS_read(file, inputBuffer + INPUT_BUFFER_SIZE - skipBytes, 1,
+                                 uint(skipBytes)));
+
+      if (readSize != skipBytes) {
+        OZ_ERROR("Failed to read AAC stream in '%s'", path.c());
+      }
+
+      aacBufferBytes  = 0;
+      aacWrittenBytes = 0;
+      aacInputBytes   = INPUT_BUFFER_SIZE;
+
+      rate     = int(aacRate);
+      channels = aacChannels;
+      break;
+    }
+  }
+
+  if (type != NONE && channels != 1 && channels != 2) {
+    OZ_ERROR("Invalid number of channels in '%s', should be 1 or 2", path.c());
+  }
+}
+
+void MusicStream::close()
+{
+  switch (type) {
+    case NONE: {
+      break;
+    }
+    case OGG: {
+      ov_clear(&oggStream);
+
+      PHYSFS_close(file);
+      break;
+    }
+    case MP3: {
+      mad_synth_finish(&madSynth);
+      mad_frame_finish(&madFrame);
+      mad_stream_finish(&madStream);
+
+      PHYSFS_close(file);
+      break;
+    }
+    case AAC: {
+      NeAACDecClose(aacDecoder);
+
+      PHYSFS_close(file);
+      break;
+    }
+  }
+
+  path       = "";
+  type       = NONE;
+  rate       = 0;
+  channels   = 0;
+  file       = nullptr;
+  aacDecoder = nullptr;
+}
+
+int MusicStream::decode(char* buffer, int size)
+{
+  switch (type) {
+    case NONE: {
+      return 0;
+    }
+    case OGG: {
+      int bytesRead = 0;
+      int result;
+      int section;
+
+      do {
+        result = int(ov_read(&oggStream, &buffer[bytesRead], size - bytesRead, false, 2, true,
+                             &section));
+        bytesRead += result;
+
+        if (result < 0) {
+          OZ_ERROR("Error during Ogg Vorbis decoding of '%s'", path.c());
+        }
+      }
+      while (result > 0 && bytesRead < size);
+
+      return bytesRead;
+    }
+    case MP3: {
+      char* output    = buffer;
+      char* outputEnd = buffer + size;
+
+      do {
+        for (; madWrittenSamples < madFrameSamples; ++madWrittenSamples) {
+          hard_assert(output <= outputEnd);
+
+          if (output == outputEnd) {
+            return size;
+          }
+
+          short value = madFixedToShort(madSynth.pcm.samples[0][madWrittenSamples]);
+
+#if OZ_BYTE_ORDER == 4321
+          output[0] = char(value >> 8);
+          output[1] = char(value);
+#else
+          output[0] = char(value);
+          output[1] = char(value >> 8);
+#endif
+          output += 2;
+
+          if (channels == 2) {
+            value = madFixedToShort(madSynth.pcm.samples[1][madWrittenSamples]);
+
+#if OZ_BYTE_ORDER == 4321
+            output[0] = char(value >> 8);
+            output[1] = char(value);
+#else
+            output[0] = char(value);
+            output[1] = char(value >> 8);
+#endif
+            output += 2;
+          }
+        }
+
+        while (mad_frame_decode(&madFrame, &madStream) != 0) {
+          if (madStream.error == MAD_ERROR_BUFLEN) {
+            int bytesLeft;
+
+            if (madStream.next_frame == nullptr) {
+              bytesLeft = 0;
+            }
+            else {
+              bytesLeft = int(madStream.bufend - madStream.next_frame);
+
+              memmove(inputBuffer, madStream.next_frame, size_t(bytesLeft));
+            }
+
+            int bytesRead = int(PHYSFS_read(file, inputBuffer + bytesLeft, 1,
+                                            uint(INPUT_BUFFER_SIZE - bytesLeft)));
+
+            if (bytesRead == 0) {
+              return int(output - buffer);
+            }
+            else if (bytesRead < INPUT_BUFFER_SIZE - bytesLeft) {
+              memset(inputBuffer + bytesLeft + bytesRead, 0, MAD_BUFFER_GUARD);
+            }
+
+            mad_stream_buffer(&madStream, inputBuffer, ulong(bytesLeft + bytesRead));
+          }
+          else if (!MAD_RECOVERABLE(madStream.error)) {
+            OZ_ERROR("Unrecoverable error during MP3 decoding of '%s'", path.c());
+          }
+        }
+
+        mad_synth_frame(&madSynth, &madFrame);
+
+        madFrameSamples   = madSynth.pcm.length;
+        madWrittenSamples = 0;
+      }
+      while (true);
+    }
+    case AAC: {
+      char* output    = buffer;
+      char* outputEnd = buffer + size;
+
+      do {
+        if (aacWrittenBytes < aacBufferBytes) {
+          int length = aacBufferBytes - aacWrittenBytes;
+          int space  = int(outputEnd - output);
+
+          if (length >= space) {
+            memcpy(output, aacOutputBuffer + aacWrittenBytes, size_t(space));
+            aacWrittenBytes += space;
+
+            return size;
+          }
+          else {
+            memcpy(output, aacOutputBuffer + aacWrittenBytes, size_t(length));
+            aacWrittenBytes += length;
+            output += length;
+          }
+        }
+
+        NeAACDecFrameInfo frameInfo;
+        aacOutputBuffer = static_cast<char*>(NeAACDecDecode(aacDecoder, &frameInfo, inputBuffer,
+                                                            ulong(aacInputBytes)));
+
+        if (aacOutputBuffer == nullptr) {
+          return int(output - buffer);
+        }
+
+        int bytesConsumed = int(frameInfo.bytesconsumed);
+        aacInputBytes  -= bytesConsumed;
+        aacBufferBytes  = int(frameInfo.samples * frameInfo.channels);
+        aacWrittenBytes = 0;
+
+        memmove(inputBuffer, inputBuffer + bytesConsumed, size_t(aacInputBytes));
+
+        int bytesRead = int(PHYSFS_read(file, inputBuffer + aacInputBytes, 1,
+                                        uint(INPUT_BUFFER_SIZE - aacInputBytes)));
+
+        aacInputBytes += bytesRead;
+      }
+      while (true);
+    }
+  }
+}
+
+}
+}
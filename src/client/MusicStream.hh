@@ -0,0 +1,169 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/MusicStream.hh
+ *
+ * Music track decoder.
+ */
+
+#pragma once
+
+#include <ozCore/ozCore.hh>
+
+// We don't use those callbacks anywhere and they don't compile on MinGW.
+#define OV_EXCLUDE_STATIC_CALLBACKS
+
+#include <physfs.h>
+#include <vorbis/vorbisfile.h>
+#include <mad.h>
+#include <neaacdec.h>
+
+namespace oz
+{
+namespace client
+{
+
+/**
+ * Decoder for Ogg Vorbis, MP3 and AAC tracks to 16-bit PCM.
+ *
+ * It does not depend on the sound backend, so a track can also be decoded offline. MP3 and AAC
+ * decoders are linked at run time by `initLibs()`, tracks in those formats decode to silence if the
+ * corresponding library is missing.
+ */
+class MusicStream
+{
+private:
+
+  static const int INPUT_BUFFER_SIZE = 64 * 1024;
+
+  enum Type
+  {
+    NONE,
+    OGG,
+    MP3,
+    AAC
+  };
+
+  File           path;
+  Type           type              = NONE;
+  int            rate              = 0;
+  int            channels          = 0;
+  PHYSFS_File*   file              = nullptr;
+
+  OggVorbis_File oggStream;
+
+  mad_stream     madStream;
+  mad_frame      madFrame;
+  mad_synth      madSynth;
+
+  int            madWrittenSamples = 0;
+  int            madFrameSamples   = 0;
+
+  NeAACDecHandle aacDecoder        = nullptr;
+
+  char*          aacOutputBuffer   = nullptr;
+  int            aacWrittenBytes   = 0;
+  int            aacBufferBytes    = 0;
+  int            aacInputBytes     = 0;
+
+  ubyte          inputBuffer[INPUT_BUFFER_SIZE + MAD_BUFFER_GUARD];
+
+public:
+
+  /**
+   * True iff MP3 decoder library is linked.
+   */
+  static bool hasMP3();
+
+  /**
+   * True iff AAC decoder library is linked.
+   */
+  static bool hasAAC();
+
+  /**
+   * Link optional MP3 and AAC decoder libraries.
+   */
+  static void initLibs();
+
+  /**
+   * Unlink decoder libraries.
+   */
+  static void destroyLibs();
+
+  /**
+   * Create an empty instance.
+   */
+  MusicStream() = default;
+
+  /**
+   * Destructor, closes the track.
+   */
+  ~MusicStream();
+
+  /**
+   * No copying.
+   */
+  MusicStream(const MusicStream&) = delete;
+
+  /**
+   * No copying.
+   */
+  MusicStream& operator = (const MusicStream&) = delete;
+
+  /**
+   * Sample rate of the open track.
+   */
+  OZ_ALWAYS_INLINE
+  int sampleRate() const
+  {
+    return rate;
+  }
+
+  /**
+   * Number of channels of the open track, 1 or 2.
+   */
+  OZ_ALWAYS_INLINE
+  int nChannels() const
+  {
+    return channels;
+  }
+
+  /**
+   * Open a track, closing the previous one.
+   */
+  void open(const File& file);
+
+  /**
+   * Close the track.
+   */
+  void close();
+
+  /**
+   * Decode the next chunk of the track.
+   *
+   * @return number of bytes written, less than `size` only at the end of the track.
+   */
+  int decode(char* buffer, int size);
+
+};
+
+}
+}
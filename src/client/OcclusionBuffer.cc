@@ -0,0 +1,383 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/OcclusionBuffer.cc
+ */
+
+#include <client/OcclusionBuffer.hh>
+
+#include <cstring>
+
+namespace oz
+{
+namespace client
+{
+
+const float OcclusionBuffer::MIN_W = 1.0e-3f;
+
+void OcclusionBuffer::drawTriangle(const Vec4& a, const Vec4& b, const Vec4& c)
+{
+  Level& level  = levels[0];
+  float  width  = float(level.width);
+  float  height = float(level.height);
+
+  float ax = (a.x / a.w * 0.5f + 0.5f) * width;
+  float ay = (a.y / a.w * 0.5f + 0.5f) * height;
+  float bx = (b.x / b.w * 0.5f + 0.5f) * width;
+  float by = (b.y / b.w * 0.5f + 0.5f) * height;
+  float cx = (c.x / c.w * 0.5f + 0.5f) * width;
+  float cy = (c.y / c.w * 0.5f + 0.5f) * height;
+  float ia = 1.0f / a.w;
+  float ib = 1.0f / b.w;
+  float ic = 1.0f / c.w;
+
+  float area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+
+  if (abs(area) < 1.0e-6f) {
+    return;
+  }
+  if (area < 0.0f) {
+    swap(bx, cx);
+    swap(by, cy);
+    swap(ib, ic);
+    area = -area;
+  }
+
+  // Pixel ranges, minX aligned to 4 so that each row is processed in whole groups of four pixels.
+  int minX = max(int(Math::floor(min(min(ax, bx), cx))), 0) & ~3;
+  int minY = max(int(Math::floor(min(min(ay, by), cy))), 0);
+  int maxX = min(int(Math::ceil(max(max(ax, bx), cx))), level.width - 1);
+  int maxY = min(int(Math::ceil(max(max(ay, by), cy))), level.height - 1);
+
+  if (minX > maxX || minY > maxY) {
+    return;
+  }
+
+  ++nTriangles;
+
+  // Edge functions opposite to each vertex (barycentric weights times area) and their gradients.
+  float e0dx = by - cy, e0dy = cx - bx;
+  float e1dx = cy - ay, e1dy = ax - cx;
+  float e2dx = ay - by, e2dy = bx - ax;
+
+  float px = float(minX) + 0.5f;
+  float py = float(minY) + 0.5f;
+
+  float e0 = e0dy * (py - by) + e0dx * (px - bx);
+  float e1 = e1dy * (py - cy) + e1dx * (px - cx);
+  float e2 = e2dy * (py - ay) + e2dx * (px - ax);
+
+  float invArea = 1.0f / area;
+  float ddx     = (e0dx * ia + e1dx * ib + e2dx * ic) * invArea;
+  float ddy     = (e0dy * ia + e1dy * ib + e2dy * ic) * invArea;
+  float d       = (e0 * ia + e1 * ib + e2 * ic) * invArea;
+
+#ifdef OZ_SIMD
+  float4 lanes = { 0.0f, 1.0f, 2.0f, 3.0f };
+  float4 zero  = vFill(0.0f);
+  float4 e0Inc = lanes * vFill(e0dx);
+  float4 e1Inc = lanes * vFill(e1dx);
+  float4 e2Inc = lanes * vFill(e2dx);
+  float4 dInc  = lanes * vFill(ddx);
+  float4 lastX = vFill(float(maxX) + 0.5f);
+#endif
+
+  for (int y = minY; y <= maxY; ++y) {
+    float* row = &level.depths[y * level.width];
+
+#ifdef OZ_SIMD
+    float4 ve0 = vFill(e0) + e0Inc;
+    float4 ve1 = vFill(e1) + e1Inc;
+    float4 ve2 = vFill(e2) + e2Inc;
+    float4 vd  = vFill(d) + dInc;
+    float4 vx  = vFill(px) + lanes;
+
+    for (int x = minX; x <= maxX; x += 4) {
+      auto inside = (ve0 >= zero) & (ve1 >= zero) & (ve2 >= zero) & (vx <= lastX);
+
+      float4 old;
+      memcpy(&old, row + x, sizeof(old));
+
+      uint4  mask   = uint4(inside);
+      float4 merged = float4((mask & uint4(vMax(old, vd))) | (~mask & uint4(old)));
+
+      memcpy(row + x, &merged, sizeof(merged));
+
+      ve0 += vFill(4.0f * e0dx);
+      ve1 += vFill(4.0f * e1dx);
+      ve2 += vFill(4.0f * e2dx);
+      vd  += vFill(4.0f * ddx);
+      vx  += vFill(4.0f);
+    }
+#else
+    float re0 = e0;
+    float re1 = e1;
+    float re2 = e2;
+    float rd  = d;
+
+    for (int x = minX; x <= maxX; ++x) {
+      if (re0 >= 0.0f && re1 >= 0.0f && re2 >= 0.0f && rd > row[x]) {
+        row[x] = rd;
+      }
+
+      re0 += e0dx;
+      re1 += e1dx;
+      re2 += e2dx;
+      rd  += ddx;
+    }
+#endif
+
+    e0 += e0dy;
+    e1 += e1dy;
+    e2 += e2dy;
+    d  += ddy;
+  }
+}
+
+void OcclusionBuffer::clipTriangle(const Vec4& a, const Vec4& b, const Vec4& c)
+{
+  // Trivially reject triangles completely outside one of the side clipping planes.
+  if ((a.x < -a.w && b.x < -b.w && c.x < -c.w) || (a.x > a.w && b.x > b.w && c.x > c.w) ||
+      (a.y < -a.w && b.y < -b.w && c.y < -c.w) || (a.y > a.w && b.y > b.w && c.y > c.w))
+  {
+    return;
+  }
+
+  bool aIn = a.w >= MIN_W;
+  bool bIn = b.w >= MIN_W;
+  bool cIn = c.w >= MIN_W;
+
+  if (aIn && bIn && cIn) {
+    drawTriangle(a, b, c);
+    return;
+  }
+  if (!aIn && !bIn && !cIn) {
+    return;
+  }
+
+  // Sutherland-Hodgman clipping against W = MIN_W yields a triangle or a quad.
+  const Vec4* input[3] = { &a, &b, &c };
+  Vec4        output[4];
+  int         nOutput = 0;
+
+  for (int i = 0; i < 3; ++i) {
+    const Vec4& p = *input[i];
+    const Vec4& q = *input[(i + 1) % 3];
+
+    if (p.w >= MIN_W) {
+      output[nOutput++] = p;
+    }
+    if ((p.w >= MIN_W) != (q.w >= MIN_W)) {
+      float t = (MIN_W - p.w) / (q.w - p.w);
+      output[nOutput++] = p + t * (q - p);
+    }
+  }
+
+  for (int i = 2; i < nOutput; ++i) {
+    drawTriangle(output[0], output[i - 1], output[i]);
+  }
+}
+
+void OcclusionBuffer::begin(const Mat4& projCamera_)
+{
+  projCamera = projCamera_;
+  nTriangles = 0;
+
+  Arrays::fill(levels[0].depths.begin(), levels[0].depths.length(), 0.0f);
+}
+
+void OcclusionBuffer::drawOccluder(const Mat4& transf, const Point* vertices, int nVertices,
+                                   const ushort* indices, int nIndices)
+{
+  Mat4 m = projCamera * transf;
+
+  clipVertices.resize(nVertices);
+
+  for (int i = 0; i < nVertices; ++i) {
+    clipVertices[i] = m * Vec4(vertices[i].x, vertices[i].y, vertices[i].z, 1.0f);
+  }
+
+  for (int i = 0; i + 2 < nIndices; i += 3) {
+    clipTriangle(clipVertices[indices[i]], clipVertices[indices[i + 1]],
+                 clipVertices[indices[i + 2]]);
+  }
+}
+
+void OcclusionBuffer::end()
+{
+  for (int i = 1; i < nLevels; ++i) {
+    const Level& src  = levels[i - 1];
+    Level&       dest = levels[i];
+
+    for (int y = 0; y < dest.height; ++y) {
+      int y0 = 2 * y;
+      int y1 = min(2 * y + 1, src.height - 1);
+
+      for (int x = 0; x < dest.width; ++x) {
+        int x0 = 2 * x;
+        int x1 = min(2 * x + 1, src.width - 1);
+
+        dest.depths[y * dest.width + x] = min(min(src.depths[y0 * src.width + x0],
+                                                  src.depths[y0 * src.width + x1]),
+                                              min(src.depths[y1 * src.width + x0],
+                                                  src.depths[y1 * src.width + x1]));
+      }
+    }
+  }
+}
+
+bool OcclusionBuffer::isVisible(const Point& mins, const Point& maxs) const
+{
+  const Level& base = levels[0];
+
+  float minX    = Math::INF;
+  float minY    = Math::INF;
+  float maxX    = -Math::INF;
+  float maxY    = -Math::INF;
+  float nearest = 0.0f;
+
+  for (int i = 0; i < 8; ++i) {
+    Vec4 c = projCamera * Vec4(i & 1 ? maxs.x : mins.x,
+                               i & 2 ? maxs.y : mins.y,
+                               i & 4 ? maxs.z : mins.z,
+                               1.0f);
+
+    if (c.w < MIN_W) {
+      return true;
+    }
+
+    float invW = 1.0f / c.w;
+    float x    = (c.x * invW * 0.5f + 0.5f) * float(base.width);
+    float y    = (c.y * invW * 0.5f + 0.5f) * float(base.height);
+
+    minX    = min(minX, x);
+    minY    = min(minY, y);
+    maxX    = max(maxX, x);
+    maxY    = max(maxY, y);
+    nearest = max(nearest, invW);
+  }
+
+  if (maxX < 0.0f || maxY < 0.0f || minX >= float(base.width) || minY >= float(base.height)) {
+    return true;
+  }
+
+  int x0 = max(int(minX), 0);
+  int y0 = max(int(minY), 0);
+  int x1 = min(int(maxX), base.width - 1);
+  int y1 = min(int(maxY), base.height - 1);
+  int l  = 0;
+
+  while (l < nLevels - 1 && (x1 - x0 > 1 || y1 - y0 > 1)) {
+    x0 >>= 1;
+    y0 >>= 1;
+    x1 >>= 1;
+    y1 >>= 1;
+    ++l;
+  }
+
+  const Level& level = levels[l];
+
+  for (int y = y0; y <= y1; ++y) {
+    for (int x = x0; x <= x1; ++x) {
+      if (level.depths[y * level.width + x] <= nearest) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool OcclusionBuffer::readOccluder(Stream* is, int version, List<Point>* vertices,
+                                   List<ushort>* indices)
+{
+  int fogSize     = 2 * int(sizeof(float[4]));
+  int trailerSize = fogSize + 2 * int(sizeof(int));
+  int end         = is->capacity();
+
+  vertices->clear();
+  indices->clear();
+
+  if (version >= 1 && end >= trailerSize) {
+    is->seek(end - int(sizeof(int)));
+
+    if (is->readInt() == OCCLUDER_MAGIC) {
+      int fogPos = end - trailerSize;
+
+      is->seek(fogPos + fogSize);
+      is->seek(is->readInt());
+
+      vertices->resize(is->readInt(), true);
+      for (Point& p : *vertices) {
+        p = is->readPoint();
+      }
+
+      indices->resize(is->readInt(), true);
+      for (ushort& i : *indices) {
+        i = is->readUShort();
+      }
+
+      is->seek(fogPos);
+      return true;
+    }
+  }
+
+  is->seek(end - fogSize);
+  return false;
+}
+
+void OcclusionBuffer::init(int width, int height)
+{
+  hard_assert(width > 0 && height > 0);
+
+  width   = (width + 3) & ~3;
+  nLevels = 0;
+
+  while (nLevels < MAX_LEVELS) {
+    levels[nLevels].width  = width;
+    levels[nLevels].height = height;
+    levels[nLevels].depths.resize(width * height);
+    ++nLevels;
+
+    if (width == 1 && height == 1) {
+      break;
+    }
+
+    width  = (width + 1) / 2;
+    height = (height + 1) / 2;
+  }
+
+  Arrays::fill(levels[0].depths.begin(), levels[0].depths.length(), 0.0f);
+}
+
+void OcclusionBuffer::destroy()
+{
+  for (int i = 0; i < MAX_LEVELS; ++i) {
+    levels[i].depths.clear();
+    levels[i].depths.trim();
+  }
+  clipVertices.clear();
+  clipVertices.trim();
+
+  nLevels = 0;
+}
+
+}
+}
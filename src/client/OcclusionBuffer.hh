@@ -0,0 +1,170 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/OcclusionBuffer.hh
+ *
+ * Software occlusion culling.
+ */
+
+#pragma once
+
+#include <ozCore/ozCore.hh>
+
+namespace oz
+{
+namespace client
+{
+
+/**
+ * Low-resolution software depth buffer with a hierarchical-Z pyramid for occlusion culling.
+ *
+ * Occluder triangles are rasterised on the CPU into a small depth buffer, storing inverse clip W
+ * (larger is nearer, cleared to 0). After all occluders have been drawn, `end()` builds a pyramid
+ * where each texel holds the farthest depth of the four texels below it, so a bounding box can be
+ * rejected by testing only a few texels of the level where its screen rectangle is at most two
+ * texels wide. This class does not depend on OpenGL, so it can be tested headless.
+ */
+class OcclusionBuffer
+{
+public:
+
+  /// Maximum number of pyramid levels.
+  static const int   MAX_LEVELS = 12;
+
+  /// Minimum clip W of rasterised vertices, triangles are clipped against W = `MIN_W`.
+  static const float MIN_W;
+
+  /// Last int of BSP model files that carry an occluder mesh.
+  static const int   OCCLUDER_MAGIC = int(0x0cc1de01);
+
+private:
+
+  struct Level
+  {
+    int         width;
+    int         height;
+    List<float> depths;
+  };
+
+  Level      levels[MAX_LEVELS];
+  int        nLevels = 0;
+  Mat4       projCamera;
+  List<Vec4> clipVertices;
+
+  void drawTriangle(const Vec4& a, const Vec4& b, const Vec4& c);
+  void clipTriangle(const Vec4& a, const Vec4& b, const Vec4& c);
+
+public:
+
+  int nTriangles = 0; ///< Number of occluder triangles rasterised since the last `begin()`.
+
+  /**
+   * Width of the full-resolution depth buffer.
+   */
+  OZ_ALWAYS_INLINE
+  int width() const
+  {
+    return levels[0].width;
+  }
+
+  /**
+   * Height of the full-resolution depth buffer.
+   */
+  OZ_ALWAYS_INLINE
+  int height() const
+  {
+    return levels[0].height;
+  }
+
+  /**
+   * Inverse clip W stored in the full-resolution depth buffer at a given pixel.
+   */
+  OZ_ALWAYS_INLINE
+  float depth(int x, int y) const
+  {
+    return levels[0].depths[y * levels[0].width + x];
+  }
+
+  /**
+   * Clear depth buffer and set projection-camera matrix for the following draws and tests.
+   */
+  void begin(const Mat4& projCamera);
+
+  /**
+   * Rasterise an indexed triangle list.
+   *
+   * Triangles are rasterised regardless of their winding.
+   *
+   * @param transf model transformation.
+   * @param vertices vertex positions in model space.
+   * @param nVertices number of vertices.
+   * @param indices indices, three per triangle.
+   * @param nIndices number of indices.
+   */
+  void drawOccluder(const Mat4& transf, const Point* vertices, int nVertices,
+                    const ushort* indices, int nIndices);
+
+  /**
+   * Build hierarchical-Z pyramid from the depth buffer.
+   */
+  void end();
+
+  /**
+   * False iff an axis-aligned box is completely hidden behind occluders.
+   *
+   * Boxes that cross the near clipping plane are always visible. Must be called after `end()`.
+   */
+  bool isVisible(const Point& mins, const Point& maxs) const;
+
+  /**
+   * Read occluder mesh from the end of a BSP model stream and seek to fog colours.
+   *
+   * BSP models with an occluder mesh end with the mesh, fog colours, offset of the mesh and
+   * `OCCLUDER_MAGIC`. Older files end with fog colours only, for those the lists are left empty, so
+   * occlusion culling is off for that BSP. The occluder mesh is only looked for in model format
+   * version 1 and later.
+   *
+   * @param is BSP model stream.
+   * @param version model format version, as returned by `Model::readFormatVersion()`.
+   * @param vertices occluder vertex positions.
+   * @param indices occluder indices.
+   * @return True iff an occluder mesh was read.
+   */
+  static bool readOccluder(Stream* is, int version, List<Point>* vertices,
+                           List<ushort>* indices);
+
+  /**
+   * Allocate buffers.
+   *
+   * @param width depth buffer width, rounded up to a multiple of 4.
+   * @param height depth buffer height.
+   */
+  void init(int width, int height);
+
+  /**
+   * Free buffers.
+   */
+  void destroy();
+
+};
+
+}
+}
@@ -0,0 +1,236 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/PartBuffer.cc
+ */
+
+#include <client/PartBuffer.hh>
+
+#include <cstring>
+
+namespace oz
+{
+namespace client
+{
+
+PartRandom::PartRandom(uint seed_)
+{
+  seed(seed_);
+}
+
+void PartRandom::seed(uint seed_)
+{
+  for (int i = 0; i < 4; ++i) {
+    uint x = seed_ * 2654435761u + uint(i + 1) * 0x9e3779b9u;
+    state[i] = x == 0 ? 1 : x;
+  }
+}
+
+void PartRandom::uniform(float* values)
+{
+  // Mantissa of a float in [1, 2) is filled with the highest 23 random bits.
+#ifdef OZ_SIMD
+  uint4 x;
+  memcpy(&x, state, sizeof(x));
+
+  x ^= x << vFill(13u);
+  x ^= x >> vFill(17u);
+  x ^= x << vFill(5u);
+
+  float4 f = float4((x >> vFill(9u)) | vFill(0x3f800000u)) - vFill(1.0f);
+
+  memcpy(state, &x, sizeof(x));
+  memcpy(values, &f, sizeof(f));
+#else
+  for (int i = 0; i < 4; ++i) {
+    uint x = state[i];
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    uint  bits = (x >> 9) | 0x3f800000u;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+
+    state[i]  = x;
+    values[i] = f - 1.0f;
+  }
+#endif
+}
+
+void PartRandom::central(float* values)
+{
+  float a[4], b[4];
+
+  uniform(a);
+  uniform(b);
+
+  for (int i = 0; i < 4; ++i) {
+    values[i] = a[i] + b[i] - 1.0f;
+  }
+}
+
+void PartBuffer::resize(int nParts)
+{
+  count    = nParts;
+  capacity = (nParts + 3) & ~3;
+
+  data.resize(MAX_FIELDS * capacity, true);
+
+  for (float& value : data) {
+    value = 0.0f;
+  }
+}
+
+void PartBuffer::update(const Emitter& emitter, float time)
+{
+  const Mat4& m      = emitter.transf;
+  float       spread = emitter.velocitySpread;
+  // Drag is given per second, so the effect does not depend on the frame rate.
+  float       drag   = Math::pow(emitter.drag, time);
+
+  float* posX  = field(POS_X);
+  float* posY  = field(POS_Y);
+  float* posZ  = field(POS_Z);
+  float* velX  = field(VEL_X);
+  float* velY  = field(VEL_Y);
+  float* velZ  = field(VEL_Z);
+  float* lives = field(LIFE);
+
+  for (int i = 0; i < capacity; i += 4) {
+    bool isAnyDead = lives[i] <= 0.0f || lives[i + 1] <= 0.0f || lives[i + 2] <= 0.0f ||
+                     lives[i + 3] <= 0.0f;
+
+    // Dead particles are respawned at the emitter origin with a random velocity and life time.
+    if (isAnyDead) {
+      float rx[4], ry[4], rz[4], rl[4];
+
+      random.central(rx);
+      random.central(ry);
+      random.central(rz);
+      random.uniform(rl);
+
+      for (int j = 0; j < 4; ++j) {
+        if (lives[i + j] <= 0.0f) {
+          float lx = emitter.velocity.x + spread * rx[j];
+          float ly = emitter.velocity.y + spread * ry[j];
+          float lz = emitter.velocity.z + spread * rz[j];
+
+          posX[i + j] = m.w.x;
+          posY[i + j] = m.w.y;
+          posZ[i + j] = m.w.z;
+          velX[i + j] = m.x.x * lx + m.y.x * ly + m.z.x * lz;
+          velY[i + j] = m.x.y * lx + m.y.y * ly + m.z.y * lz;
+          velZ[i + j] = m.x.z * lx + m.y.z * ly + m.z.z * lz;
+          lives[i + j] = emitter.lifeTime * (0.5f + 0.5f * rl[j]);
+        }
+      }
+    }
+
+#ifdef OZ_SIMD
+    float4 px, py, pz, vx, vy, vz, l;
+
+    memcpy(&px, &posX[i], sizeof(px));
+    memcpy(&py, &posY[i], sizeof(py));
+    memcpy(&pz, &posZ[i], sizeof(pz));
+    memcpy(&vx, &velX[i], sizeof(vx));
+    memcpy(&vy, &velY[i], sizeof(vy));
+    memcpy(&vz, &velZ[i], sizeof(vz));
+    memcpy(&l,  &lives[i], sizeof(l));
+
+    float4 t = vFill(time);
+    float4 d = vFill(drag);
+
+    px += vx * t;
+    py += vy * t;
+    pz += vz * t;
+    vz += vFill(emitter.gravity) * t;
+    vx *= d;
+    vy *= d;
+    vz *= d;
+    l  -= t;
+
+    memcpy(&posX[i], &px, sizeof(px));
+    memcpy(&posY[i], &py, sizeof(py));
+    memcpy(&posZ[i], &pz, sizeof(pz));
+    memcpy(&velX[i], &vx, sizeof(vx));
+    memcpy(&velY[i], &vy, sizeof(vy));
+    memcpy(&velZ[i], &vz, sizeof(vz));
+    memcpy(&lives[i], &l,  sizeof(l));
+#else
+    for (int j = i; j < i + 4; ++j) {
+      posX[j] += velX[j] * time;
+      posY[j] += velY[j] * time;
+      posZ[j] += velZ[j] * time;
+      velZ[j] += emitter.gravity * time;
+      velX[j] *= drag;
+      velY[j] *= drag;
+      velZ[j] *= drag;
+      lives[j] -= time;
+    }
+#endif
+  }
+}
+
+void PartBuffer::buildBillboards(const Vec3& right, const Vec3& up, float size,
+                                 Vertex* vertices) const
+{
+  static const short TEX_COORDS[BILLBOARD_VERTICES][2] = { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 0, 0 } };
+
+  Vec3 corners[BILLBOARD_VERTICES] = {
+    (-right - up) * size, (right - up) * size, (right + up) * size, (up - right) * size
+  };
+
+  const float* posX = field(POS_X);
+  const float* posY = field(POS_Y);
+  const float* posZ = field(POS_Z);
+
+  for (int i = 0; i < count; ++i) {
+    for (int j = 0; j < BILLBOARD_VERTICES; ++j) {
+      Vertex& vertex = vertices[i * BILLBOARD_VERTICES + j];
+
+      vertex.pos[0]      = posX[i] + corners[j].x;
+      vertex.pos[1]      = posY[i] + corners[j].y;
+      vertex.pos[2]      = posZ[i] + corners[j].z;
+      vertex.texCoord[0] = TEX_COORDS[j][0];
+      vertex.texCoord[1] = TEX_COORDS[j][1];
+    }
+  }
+}
+
+void PartBuffer::buildIndices(int nBillboards, ushort* indices)
+{
+  for (int i = 0; i < nBillboards; ++i) {
+    ushort  base     = ushort(i * BILLBOARD_VERTICES);
+    ushort* triangle = &indices[i * BILLBOARD_INDICES];
+
+    triangle[0] = ushort(base + 0);
+    triangle[1] = ushort(base + 1);
+    triangle[2] = ushort(base + 2);
+    triangle[3] = ushort(base + 0);
+    triangle[4] = ushort(base + 2);
+    triangle[5] = ushort(base + 3);
+  }
+}
+
+}
+}
@@ -0,0 +1,207 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/PartBuffer.hh
+ *
+ * Particle storage and integration.
+ */
+
+#pragma once
+
+#include <ozCore/ozCore.hh>
+
+namespace oz
+{
+namespace client
+{
+
+/**
+ * Four-lane xorshift random generator.
+ *
+ * Each call yields four numbers at once, one from each of four independent xorshift32 streams,
+ * computed with one SIMD operation per step.
+ */
+class PartRandom
+{
+private:
+
+  uint state[4];
+
+public:
+
+  /**
+   * Create generator with a given seed.
+   */
+  explicit PartRandom(uint seed = 1);
+
+  /**
+   * Reseed generator.
+   */
+  void seed(uint seed);
+
+  /**
+   * Four uniformly distributed numbers on [0, 1).
+   */
+  void uniform(float* values);
+
+  /**
+   * Four numbers on (-1, 1) with a triangular distribution centred at 0.
+   *
+   * This is a cheap replacement for `Math::normalRand()`, which also has most of its mass near 0.
+   */
+  void central(float* values);
+
+};
+
+/**
+ * Particle buffer with structure-of-arrays layout.
+ *
+ * Positions, velocities and remaining life times are stored in separate arrays padded to a
+ * multiple of four, so particles are integrated four at a time. This class does not depend on
+ * OpenGL, so it can be benchmarked headless.
+ */
+class PartBuffer
+{
+public:
+
+  /**
+   * Billboard vertex, the same layout as `Shape` vertices.
+   */
+  struct Vertex
+  {
+    float pos[3];
+    short texCoord[2];
+  };
+
+  /// Number of vertices per billboard.
+  static const int BILLBOARD_VERTICES = 4;
+
+  /// Number of indices per billboard.
+  static const int BILLBOARD_INDICES = 6;
+
+  /**
+   * Emitter and particle class parameters for `update()`.
+   */
+  struct Emitter
+  {
+    Mat4  transf;         ///< Emitter transformation, particles spawn at its origin.
+    Vec3  velocity;       ///< Mean initial velocity in emitter coordinates.
+    float velocitySpread; ///< Maximum deviation of initial velocity components.
+    float lifeTime;       ///< Maximum life time.
+    float gravity;        ///< Gravitational acceleration along z.
+    float drag;           ///< Fraction of velocity kept after one second.
+  };
+
+private:
+
+  enum Field
+  {
+    POS_X,
+    POS_Y,
+    POS_Z,
+    VEL_X,
+    VEL_Y,
+    VEL_Z,
+    LIFE,
+    MAX_FIELDS
+  };
+
+  List<float> data;
+  int         count    = 0;
+  int         capacity = 0;
+
+  float* field(Field f)
+  {
+    return &data[int(f) * capacity];
+  }
+
+  const float* field(Field f) const
+  {
+    return &data[int(f) * capacity];
+  }
+
+public:
+
+  PartRandom random; ///< Random generator for respawns.
+
+  /**
+   * Number of particles.
+   */
+  OZ_ALWAYS_INLINE
+  int length() const
+  {
+    return count;
+  }
+
+  /**
+   * Position of the i-th particle.
+   */
+  Point position(int i) const
+  {
+    return Point(field(POS_X)[i], field(POS_Y)[i], field(POS_Z)[i]);
+  }
+
+  /**
+   * Velocity of the i-th particle.
+   */
+  Vec3 velocity(int i) const
+  {
+    return Vec3(field(VEL_X)[i], field(VEL_Y)[i], field(VEL_Z)[i]);
+  }
+
+  /**
+   * Remaining life time of the i-th particle.
+   */
+  float life(int i) const
+  {
+    return field(LIFE)[i];
+  }
+
+  /**
+   * Set number of particles, all dead, so they are spawned on the next update.
+   */
+  void resize(int nParts);
+
+  /**
+   * Respawn dead particles and integrate all particles over a time step.
+   */
+  void update(const Emitter& emitter, float time);
+
+  /**
+   * Write four camera-facing billboard vertices for each particle.
+   *
+   * @param right camera right vector.
+   * @param up camera up vector.
+   * @param size half of billboard edge length.
+   * @param vertices output array for `length() * BILLBOARD_VERTICES` vertices.
+   */
+  void buildBillboards(const Vec3& right, const Vec3& up, float size, Vertex* vertices) const;
+
+  /**
+   * Write two triangles for each of `nBillboards` billboards, counter-clockwise when viewed from
+   * the camera.
+   */
+  static void buildIndices(int nBillboards, ushort* indices);
+
+};
+
+}
+}
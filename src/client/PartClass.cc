@@ -30,26 +30,49 @@ namespace oz
 namespace client
 {
 
+bool PartClass::isPreloaded() const
+{
+  return id >= 0;
+}
+
 bool PartClass::isLoaded() const
 {
-  return false;
+  return flags & LOADED_BIT;
 }
 
-// void PartClass::init(InputStream* is)
-// {
-//   flags          = 0;
-//
-//   nParts         = is->readInt();
-//   velocity       = is->readVec3();
-//   velocitySpread = is->readFloat();
-//   texId          = liber.textureIndex(is->readString());
-//   endTexId       = liber.textureIndex(is->readString());
-// }
+void PartClass::preload(int id_)
+{
+  const File& path = liber.parts[id_].path;
+  Json        config;
+
+  if (!config.load(path)) {
+    OZ_ERROR("Failed to load particle class '%s'", path.c());
+  }
+
+  id             = id_;
+  flags          = 0;
+  nParts         = config["nParts"].get(64);
+  velocity       = config["velocity"].get(Vec3::ZERO);
+  velocitySpread = config["velocitySpread"].get(0.0f);
+  lifeTime       = config["lifeTime"].get(1.0f);
+  size           = config["size"].get(0.1f);
+  drag           = config["drag"].get(1.0f);
+  texId          = liber.textureIndex(config["texture"].get(""));
+  endTexId       = liber.textureIndex(config["endTexture"].get(""));
+
+  if (nParts <= 0 || lifeTime <= 0.0f || size <= 0.0f || drag < 0.0f || drag > 1.0f) {
+    OZ_ERROR("Invalid parameters in particle class '%s'", path.c());
+  }
+}
 
 void PartClass::load()
 {
-  context.requestTexture(texId);
-  context.requestTexture(endTexId);
+  if (texId >= 0) {
+    texture = context.requestTexture(texId);
+  }
+  if (endTexId >= 0) {
+    context.requestTexture(endTexId);
+  }
 
   flags |= LOADED_BIT;
 }
@@ -57,8 +80,15 @@ void PartClass::load()
 void PartClass::unload()
 {
   if (flags & LOADED_BIT) {
-    context.releaseTexture(texId);
-    context.releaseTexture(endTexId);
+    if (texId >= 0) {
+      context.releaseTexture(texId);
+    }
+    if (endTexId >= 0) {
+      context.releaseTexture(endTexId);
+    }
+
+    texture = Texture();
+    flags  &= ~LOADED_BIT;
   }
 }
 
@@ -23,13 +23,15 @@
 
 #pragma once
 
-#include <client/common.hh>
+#include <client/Model.hh>
 
 namespace oz
 {
 namespace client
 {
 
+class PartGen;
+
 class PartClass
 {
 public:
@@ -39,24 +41,31 @@ public:
 
 public:
 
-  int   flags;
-  int   nParts;
+  int   flags          = 0;
+  int   id             = -1;   ///< Index in `liber.parts`, -1 if not preloaded.
+  int   nParts         = 0;
+
+  Vec3  velocity       = Vec3::ZERO;
+  float velocitySpread = 0.0f;
+  float lifeTime       = 1.0f;
+  float size           = 0.1f;
+  float drag           = 1.0f; ///< Fraction of velocity kept after one second.
 
-  Vec3  velocity;
-  float velocitySpread;
-  float drag;
+  int   texId          = -1;
+  int   endTexId       = -1;
 
-  int   texId;
-  int   endTexId;
+  Texture              texture;
+  List<const PartGen*> scheduled; ///< Generators scheduled for drawing in one batch.
 
 public:
 
   bool isPreloaded() const;
   bool isLoaded() const;
 
-  void schedule();
-
-  void preload();
+  /**
+   * Read class parameters from `liber.parts[id]`.
+   */
+  void preload(int id);
   void load();
   void unload();
 
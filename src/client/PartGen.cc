@@ -33,45 +33,147 @@ namespace oz
 namespace client
 {
 
-struct PartGen::Part
+List<PartClass*>         PartGen::scheduledClasses;
+List<PartBuffer::Vertex> PartGen::vertices;
+uint                     PartGen::vbo        = 0;
+uint                     PartGen::ibo        = 0;
+int                      PartGen::nParticles = 0;
+int                      PartGen::nDrawCalls = 0;
+
+void PartGen::drawScheduled()
+{
+  nParticles = 0;
+  nDrawCalls = 0;
+
+  if (scheduledClasses.isEmpty()) {
+    return;
+  }
+
+  if (vbo == 0) {
+    List<ushort> indices(MAX_BATCH_PARTS * PartBuffer::BILLBOARD_INDICES);
+    PartBuffer::buildIndices(MAX_BATCH_PARTS, indices.begin());
+
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ibo);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.length() * int(sizeof(ushort)), indices.begin(),
+                 GL_STATIC_DRAW);
+  }
+
+  shader.program(shader.plain);
+
+  tf.model = Mat4::ID;
+  tf.apply();
+  shape.colour(1.0f, 1.0f, 1.0f, 1.0f);
+
+  glDepthMask(GL_FALSE);
+
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+
+  glEnableVertexAttribArray(Shader::POSITION);
+  glEnableVertexAttribArray(Shader::TEXCOORD);
+
+  for (const PartClass* clazz : scheduledClasses) {
+    int nParts = 0;
+
+    for (const PartGen* partGen : clazz->scheduled) {
+      nParts += partGen->parts.length();
+    }
+
+    vertices.resize(nParts * PartBuffer::BILLBOARD_VERTICES);
+
+    int offset = 0;
+
+    for (const PartGen* partGen : clazz->scheduled) {
+      partGen->parts.buildBillboards(camera.right, camera.up, clazz->size, &vertices[offset]);
+      offset += partGen->parts.length() * PartBuffer::BILLBOARD_VERTICES;
+    }
+
+    // Orphan the previous buffer contents, so the driver need not wait for pending draws.
+    int size = vertices.length() * int(sizeof(PartBuffer::Vertex));
+
+    glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices.begin());
+
+    glBindTexture(GL_TEXTURE_2D, clazz->texture.albedo);
+
+    for (int first = 0; first < nParts; first += MAX_BATCH_PARTS) {
+      int   nBatchParts = min(nParts - first, MAX_BATCH_PARTS);
+      char* base        = static_cast<char*>(nullptr) +
+                          first * PartBuffer::BILLBOARD_VERTICES * sizeof(PartBuffer::Vertex);
+
+      glVertexAttribPointer(Shader::POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(PartBuffer::Vertex),
+                            base + offsetof(PartBuffer::Vertex, pos));
+      glVertexAttribPointer(Shader::TEXCOORD, 2, GL_SHORT, GL_FALSE, sizeof(PartBuffer::Vertex),
+                            base + offsetof(PartBuffer::Vertex, texCoord));
+
+      glDrawElements(GL_TRIANGLES, nBatchParts * PartBuffer::BILLBOARD_INDICES, GL_UNSIGNED_SHORT,
+                     nullptr);
+
+      ++nDrawCalls;
+    }
+
+    nParticles += nParts;
+  }
+
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  glBindTexture(GL_TEXTURE_2D, shader.defaultTexture);
+  glDepthMask(GL_TRUE);
+
+  OZ_GL_CHECK_ERROR();
+}
+
+void PartGen::clearScheduled()
 {
-  Vec3  p;
-  Vec3  velocity;
-  float life;
-};
+  for (PartClass* clazz : scheduledClasses) {
+    clazz->scheduled.clear();
+  }
+  scheduledClasses.clear();
+}
 
-void PartGen::draw() const
+void PartGen::deallocate()
 {
-  tf.model = camera.rotMat;
+  clearScheduled();
 
-  for (const Part& part : parts) {
-    tf.push();
-    tf.model.translate(part.p);
-    tf.model = tf.model ^ camera.rotTMat;
+  scheduledClasses.trim();
+  vertices.clear();
+  vertices.trim();
 
-    shape.quad(1.0f, 1.0f);
+  if (vbo != 0) {
+    glDeleteBuffers(1, &ibo);
+    glDeleteBuffers(1, &vbo);
 
-    tf.pop();
+    ibo = 0;
+    vbo = 0;
   }
 }
 
+PartGen::PartGen(PartClass* clazz_, const Mat4& transf_) :
+  transf(transf_), clazz(clazz_), flags(0)
+{
+  parts.resize(clazz->nParts);
+  parts.random.seed(uint(Math::rand(1 << 30)));
+}
+
 void PartGen::update()
 {
-  for (Part& part : parts) {
-    if (part.life <= 0.0f) {
-      Vec3 localVel = clazz->velocity + Vec3(clazz->velocitySpread * Math::normalRand(),
-                                             clazz->velocitySpread * Math::normalRand(),
-                                             clazz->velocitySpread * Math::normalRand());
-
-      part.p        = Vec3(transf.w);
-      part.velocity = transf * localVel;
-    }
+  PartBuffer::Emitter emitter = {
+    transf, clazz->velocity, clazz->velocitySpread, clazz->lifeTime, physics.gravity, clazz->drag
+  };
 
-    part.p          += part.velocity * timer.frameTime;
-    part.velocity.z += physics.gravity;
-    part.velocity   *= clazz->drag;
-    part.life       -= timer.frameTime;
+  parts.update(emitter, timer.frameTime);
+}
+
+void PartGen::schedule()
+{
+  if (clazz->scheduled.isEmpty()) {
+    scheduledClasses.add(clazz);
   }
+  clazz->scheduled.add(this);
 }
 
 }
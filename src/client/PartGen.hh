@@ -24,6 +24,7 @@
 #pragma once
 
 #include <client/PartClass.hh>
+#include <client/PartBuffer.hh>
 
 namespace oz
 {
@@ -33,37 +34,44 @@ namespace client
 class PartGen
 {
   friend class Chain<PartGen>;
+  friend class Context;
 
 public:
 
-  static const int UPDATED_BIT = 0x01;
+  static const int UPDATED_BIT     = 0x01;
 
-private:
-
-  struct Part;
+  /// Maximum number of particles per draw call, limited by 16-bit indices.
+  static const int MAX_BATCH_PARTS = 65536 / PartBuffer::BILLBOARD_VERTICES;
 
 private:
 
+  static List<PartClass*>         scheduledClasses;
+  static List<PartBuffer::Vertex> vertices;
+  static uint                     vbo;
+  static uint                     ibo;
+
   PartGen*   next[1];
 
   Mat4       transf;
   PartClass* clazz;
-  List<Part> parts;
+  PartBuffer parts;
   int        flags;
 
-private:
-
-  void draw() const;
-
 public:
 
+  static int nParticles; ///< Number of particles drawn by the last `drawScheduled()`.
+  static int nDrawCalls; ///< Number of draw calls issued by the last `drawScheduled()`.
+
+  /**
+   * Draw billboards of all scheduled generators, one streamed vertex buffer and one draw call per
+   * particle class (more only if a class has over `MAX_BATCH_PARTS` particles).
+   */
   static void drawScheduled();
   static void clearScheduled();
 
-  static void dellocate();
+  static void deallocate();
 
-  explicit PartGen(Stream* is);
-  ~PartGen();
+  explicit PartGen(PartClass* clazz_, const Mat4& transf_);
 
   void update();
   void schedule();
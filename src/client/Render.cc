@@ -24,7 +24,6 @@
 #include <client/Render.hh>
 
 #include <client/Shape.hh>
-#include <client/Frustum.hh>
 #include <client/Camera.hh>
 #include <client/Caelum.hh>
 #include <client/Terra.hh>
@@ -36,11 +35,6 @@ namespace oz
 namespace client
 {
 
-const float Render::WIDE_CULL_FACTOR       = 6.0f;
-const float Render::OBJECT_VISIBILITY_COEF = 0.004f;
-const float Render::FRAG_VISIBILITY_RANGE2 = 150.0f*150.0f;
-const float Render::CELL_RADIUS            = (Cell::SIZE / 2 + Object::MAX_DIM * WIDE_CULL_FACTOR) *
-                                             Math::sqrt(2.0f);
 const float Render::EFFECTS_DISTANCE       = 192.0f;
 
 const float Render::NIGHT_FOG_COEFF        = 2.0f;
@@ -53,40 +47,13 @@ const float Render::WIND_PHI_INC           = 0.04f;
 
 const int   Render::GLOW_MINIFICATION      = 4;
 
+const float Render::OCCLUDER_DISTANCE      = 100.0f;
+
 const Vec4  Render::STRUCT_AABB            = Vec4(0.20f, 0.50f, 1.00f, 1.00f);
 const Vec4  Render::ENTITY_AABB            = Vec4(1.00f, 0.20f, 0.50f, 1.00f);
 const Vec4  Render::SOLID_AABB             = Vec4(0.50f, 0.80f, 0.20f, 1.00f);
 const Vec4  Render::NONSOLID_AABB          = Vec4(0.70f, 0.80f, 0.90f, 1.00f);
 
-struct Render::DrawEntry
-{
-  float distance;
-  union
-  {
-    const Struct* str;
-    const Object* obj;
-  };
-
-  OZ_ALWAYS_INLINE
-  DrawEntry() = default;
-
-  OZ_ALWAYS_INLINE
-  explicit DrawEntry(float distance_, const Struct* str_) :
-    distance(distance_), str(str_)
-  {}
-
-  OZ_ALWAYS_INLINE
-  explicit DrawEntry(float distance_, const Object* obj_) :
-    distance(distance_), obj(obj_)
-  {}
-
-  OZ_ALWAYS_INLINE
-  bool operator < (const DrawEntry& de) const
-  {
-    return distance < de.distance;
-  }
-};
-
 void Render::effectsMain(void*)
 {
   render.effectsRun();
@@ -139,48 +106,52 @@ void Render::effectsRun()
   }
 }
 
-void Render::scheduleCell(int cellX, int cellY)
+void Render::cullOccluded()
 {
-  const Cell& cell = orbis.cells[cellX][cellY];
+  Mat4 projCamera = view.proj * view.rotTMat;
+  projCamera.translate(Point::ORIGIN - view.p);
 
-  for (int i = 0; i < cell.structs.length(); ++i) {
-    if (!drawnStructs.get(cell.structs[i])) {
-      drawnStructs.set(cell.structs[i]);
+  occlusion.begin(projCamera);
 
-      Struct* str    = orbis.str(cell.structs[i]);
-      float   radius = str->dim().fastN();
+  // Only nearby structures are rasterised; distant ones cover too few pixels to hide anything.
+  for (const Struct* str : culler.structs) {
+    float distance = (str->p - view.p).fastN() - str->dim().fastN();
 
-      if (frustum.isVisible(str->p, radius)) {
-        float distance = (str->p - camera.p).fastN();
+    if (distance > OCCLUDER_DISTANCE) {
+      continue;
+    }
 
-        structs.add(DrawEntry(distance, str));
-      }
+    const BSPImago* bsp = context.getBSP(str->bsp);
+
+    if (bsp != nullptr) {
+      bsp->drawOccluder(str, &occlusion);
     }
   }
 
-  for (const Object& obj : cell.objects) {
-    float radius = obj.dim.fastN();
+  if (occlusion.nTriangles == 0) {
+    return;
+  }
 
-    if (obj.flags & Object::WIDE_CULL_BIT) {
-      radius *= WIDE_CULL_FACTOR;
-    }
+  occlusion.end();
 
-    if (frustum.isVisible(obj.p, radius)) {
-      float distance = (obj.p - camera.p).fastN();
+  int nStructs = 0;
+  int nObjects = 0;
 
-      if (radius / (distance * camera.mag) >= OBJECT_VISIBILITY_COEF) {
-        objects.add(DrawEntry(distance, &obj));
-      }
+  for (const Struct* str : culler.structs) {
+    if (occlusion.isVisible(str->mins, str->maxs)) {
+      culler.structs[nStructs++] = str;
     }
   }
-
-  for (const Frag& frag : cell.frags) {
-    float dist = (frag.p - camera.p) * camera.at;
-
-    if (dist <= FRAG_VISIBILITY_RANGE2 && frustum.isVisible(frag.p, FragPool::FRAG_RADIUS)) {
-      context.drawFrag(&frag);
+  for (const Object* obj : culler.objects) {
+    if (occlusion.isVisible(obj->p - obj->dim, obj->p + obj->dim)) {
+      culler.objects[nObjects++] = obj;
     }
   }
+
+  nOccluded += ulong64(culler.structs.length() - nStructs + culler.objects.length() - nObjects);
+
+  culler.structs.resize(nStructs);
+  culler.objects.resize(nObjects);
 }
 
 void Render::prepareDraw()
@@ -238,34 +209,62 @@ void Render::prepareDraw()
   frustum.update();
   frustum.getExtrems(span, camera.p);
 
+  // Drawing uses this copy, so camera changes before drawPrepared() (e.g. a proxy switch or a
+  // window resize) do not mismatch the queues and the frustum prepared here.
+  tf.projection();
+
+  view.proj       = tf.proj;
+  view.rotTMat    = camera.rotTMat;
+  view.p          = camera.p;
+  view.pixelScale = float(camera.height) / (2.0f * camera.coeff * camera.mag);
+
   caelum.update();
 
-  // drawnStructs
-  drawnStructs.clearAll();
+  culler.cull(frustum, span, camera.p, camera.at, camera.mag);
 
-  float minXCentre = float((span.minX - Orbis::CELLS / 2) * Cell::SIZE + Cell::SIZE / 2);
-  float minYCentre = float((span.minY - Orbis::CELLS / 2) * Cell::SIZE + Cell::SIZE / 2);
+  if (doOcclusion) {
+    cullOccluded();
+  }
 
-  float x = minXCentre;
-  for (int i = span.minX; i <= span.maxX; ++i, x = x + Cell::SIZE) {
-    float y = minYCentre;
-    for (int j = span.minY; j <= span.maxY; ++j, y = y + Cell::SIZE) {
-      if (frustum.isVisible(x, y, CELL_RADIUS)) {
-        scheduleCell(i, j);
-      }
-    }
+  // Draw order is determined by sort keys in Model's render queues, so there is no need to sort
+  // structures and objects by distance here.
+  for (const Struct* str : culler.structs) {
+    context.drawBSP(str);
+  }
+  for (const Object* obj : culler.objects) {
+    context.drawImago(obj, nullptr);
+  }
+  for (const Frag* frag : culler.frags) {
+    context.drawFrag(frag);
   }
 
-  structs.sort();
-  for (int i = 0; i < structs.length(); ++i) {
-    context.drawBSP(structs[i].str);
+  if (showAim) {
+    Vec3 move = camera.at * 32.0f;
+    collider.translate(camera.p, move, camera.botObj);
+    move *= collider.hit.ratio;
+
+    aimPoint = camera.p + move;
   }
 
-  objects.sort();
-  for (int i = 0; i < objects.length(); ++i) {
-    context.drawImago(objects[i].obj, nullptr);
+  if (showBounds) {
+    boundBoxes.clear();
+
+    for (const Object* obj : culler.objects) {
+      boundBoxes.add(Box{ *obj, obj->flags & Object::SOLID_BIT ? SOLID_AABB : NONSOLID_AABB });
+    }
+
+    for (const Struct* str : culler.structs) {
+      for (const Entity& entity : str->entities) {
+        Bounds bb = str->toAbsoluteCS(*entity.clazz + entity.offset);
+        boundBoxes.add(Box{ bb.toAABB(), ENTITY_AABB });
+      }
+
+      boundBoxes.add(Box{ str->toAABB(), STRUCT_AABB });
+    }
   }
 
+  culler.clear();
+
   currentMicros = Time::uclock();
   prepareMicros += currentMicros - beginMicros;
 }
@@ -282,9 +281,10 @@ void Render::drawGeometry()
   beginMicros = currentMicros;
 
   // camera transformation
-  tf.projection();
-  tf.camera = camera.rotTMat;
-  tf.camera.translate(Point::ORIGIN - camera.p);
+  tf.proj   = view.proj;
+  tf.camera = view.rotTMat;
+  tf.camera.translate(Point::ORIGIN - view.p);
+  tf.eye    = view.p;
 
   shader.setAmbientLight(Caelum::GLOBAL_AMBIENT_COLOUR + caelum.ambientColour);
   shader.setCaelumLight(caelum.lightDir, caelum.diffuseColour);
@@ -305,14 +305,14 @@ void Render::drawGeometry()
   miscMicros += currentMicros - beginMicros;
   beginMicros = currentMicros;
 
-  if (!(shader.medium & Medium::LIQUID_MASK) && camera.p.z >= 0.0f) {
+  if (!(shader.medium & Medium::LIQUID_MASK) && view.p.z >= 0.0f) {
     glClear(GL_DEPTH_BUFFER_BIT);
 
-    tf.camera = camera.rotTMat;
+    tf.camera = view.rotTMat;
 
     caelum.draw();
 
-    tf.camera.translate(Point::ORIGIN - camera.p);
+    tf.camera.translate(Point::ORIGIN - view.p);
     tf.applyCamera();
   }
   else {
@@ -326,29 +326,34 @@ void Render::drawGeometry()
   caelumMicros += currentMicros - beginMicros;
   beginMicros = currentMicros;
 
+  Model::resetCounters();
+
   glDisable(GL_BLEND);
-  Model::drawScheduled(Model::SCENE_QUEUE, Model::SOLID_BIT);
+  Model::drawScheduled(Model::SCENE_QUEUE, Model::SOLID_BIT, doClusterCull ? &frustum : nullptr);
 
   currentMicros = Time::uclock();
   meshesMicros += currentMicros - beginMicros;
   beginMicros = currentMicros;
 
-  terra.draw();
+  terra.draw(view.p, view.pixelScale);
   glEnable(GL_BLEND);
 
   currentMicros = Time::uclock();
   terraMicros += currentMicros - beginMicros;
   beginMicros = currentMicros;
 
-  terra.drawLiquid();
+  terra.drawLiquid(view.p);
 
   currentMicros = Time::uclock();
   terraMicros += currentMicros - beginMicros;
   beginMicros = currentMicros;
 
-  Model::drawScheduled(Model::SCENE_QUEUE, Model::ALPHA_BIT);
+  Model::drawScheduled(Model::SCENE_QUEUE, Model::ALPHA_BIT, doClusterCull ? &frustum : nullptr);
   Model::clearScheduled(Model::SCENE_QUEUE);
 
+  PartGen::drawScheduled();
+  PartGen::clearScheduled();
+
   currentMicros = Time::uclock();
   meshesMicros += currentMicros - beginMicros;
   beginMicros = currentMicros;
@@ -356,6 +361,9 @@ void Render::drawGeometry()
   Model::drawScheduled(Model::OVERLAY_QUEUE, Model::SOLID_BIT | Model::ALPHA_BIT);
   Model::clearScheduled(Model::OVERLAY_QUEUE);
 
+  nDrawCalls      += ulong64(Model::nDrawCalls + PartGen::nDrawCalls);
+  nDrawnInstances += ulong64(Model::nInstances);
+
   shape.bind();
   shader.program(shader.plain);
 
@@ -363,36 +371,16 @@ void Render::drawGeometry()
   glBindTexture(GL_TEXTURE_2D, shader.defaultTexture);
 
   if (showAim) {
-    Vec3 move = camera.at * 32.0f;
-    collider.translate(camera.p, move, camera.botObj);
-    move *= collider.hit.ratio;
-
     shape.colour(0.0f, 1.0f, 0.0f, 1.0f);
-    shape.box(AABB(camera.p + move, Vec3(0.05f, 0.05f, 0.05f)));
+    shape.box(AABB(aimPoint, Vec3(0.05f, 0.05f, 0.05f)));
   }
 
   if (showBounds) {
     glLineWidth(1.0f);
 
-    for (int i = 0; i < objects.length(); ++i) {
-      const Object* obj = objects[i].obj;
-
-      shape.colour(obj->flags & Object::SOLID_BIT ? SOLID_AABB : NONSOLID_AABB);
-      shape.wireBox(*obj);
-    }
-
-    for (int i = 0; i < structs.length(); ++i) {
-      const Struct* str = structs[i].str;
-
-      shape.colour(ENTITY_AABB);
-
-      for (const Entity& entity : str->entities) {
-        Bounds bb = str->toAbsoluteCS(*entity.clazz + entity.offset);
-        shape.wireBox(bb.toAABB());
-      }
-
-      shape.colour(STRUCT_AABB);
-      shape.wireBox(str->toAABB());
+    for (const Box& box : boundBoxes) {
+      shape.colour(box.colour);
+      shape.wireBox(box.bb);
     }
   }
 
@@ -402,9 +390,6 @@ void Render::drawGeometry()
 
   OZ_GL_CHECK_ERROR();
 
-  structs.clear();
-  objects.clear();
-
   currentMicros = Time::uclock();
   miscMicros += currentMicros - beginMicros;
 }
@@ -426,7 +411,6 @@ void Render::drawOrbis()
 #endif
   }
 
-  prepareDraw();
   drawGeometry();
 
   uint beginMicros = Time::uclock();
@@ -519,6 +503,7 @@ void Render::update(int flags)
   MainCall() << [&]
   {
     if (flags & ORBIS_BIT) {
+      prepareDraw();
       drawOrbis();
     }
     if (flags & UI_BIT) {
@@ -528,6 +513,7 @@ void Render::update(int flags)
 
   Model::clearScheduled(Model::SCENE_QUEUE);
   Model::clearScheduled(Model::OVERLAY_QUEUE);
+  PartGen::clearScheduled();
 
   if (flags & (ORBIS_BIT | UI_BIT)) {
     swap();
@@ -536,6 +522,74 @@ void Render::update(int flags)
   if (flags & EFFECTS_BIT) {
     effectsMainSemaphore.wait();
   }
+
+  preparedFlags   = 0;
+  isPreparedDrawn = false;
+}
+
+void Render::prepare(int flags)
+{
+  OZ_NACL_IS_MAIN(false);
+
+  if (flags & EFFECTS_BIT) {
+    effectsAuxSemaphore.post();
+  }
+
+  if (flags & ORBIS_BIT) {
+    MainCall() << [&]
+    {
+      prepareDraw();
+    };
+  }
+
+  if (flags & EFFECTS_BIT) {
+    effectsMainSemaphore.wait();
+  }
+
+  preparedFlags   = flags & (ORBIS_BIT | UI_BIT);
+  isPreparedDrawn = false;
+}
+
+void Render::drawPrepared()
+{
+  OZ_NACL_IS_MAIN(false);
+
+  if (preparedFlags & ORBIS_BIT) {
+    MainCall() << [&]
+    {
+      drawOrbis();
+    };
+
+    preparedFlags  &= ~ORBIS_BIT;
+    isPreparedDrawn = true;
+  }
+}
+
+void Render::finish()
+{
+  OZ_NACL_IS_MAIN(false);
+
+  drawPrepared();
+
+  if (preparedFlags & UI_BIT) {
+    MainCall() << [&]
+    {
+      drawUI();
+    };
+
+    isPreparedDrawn = true;
+  }
+
+  Model::clearScheduled(Model::SCENE_QUEUE);
+  Model::clearScheduled(Model::OVERLAY_QUEUE);
+  PartGen::clearScheduled();
+
+  if (isPreparedDrawn) {
+    swap();
+  }
+
+  preparedFlags   = 0;
+  isPreparedDrawn = false;
 }
 
 void Render::resize()
@@ -653,8 +707,11 @@ void Render::load()
 
   effectsThread = Thread("effects", effectsMain);
 
-  structs.reserve(64);
-  objects.reserve(8192);
+  culler.init(nCullThreads);
+
+  if (doOcclusion) {
+    occlusion.init(OCCLUSION_WIDTH, OCCLUSION_HEIGHT);
+  }
 
   prepareMicros     = 0;
   caelumMicros      = 0;
@@ -665,6 +722,13 @@ void Render::load()
   uiMicros          = 0;
   swapMicros        = 0;
 
+  nDrawCalls        = 0;
+  nDrawnInstances   = 0;
+  nOccluded         = 0;
+
+  preparedFlags     = 0;
+  isPreparedDrawn   = false;
+
   Log::printEnd(" OK");
 }
 
@@ -676,11 +740,11 @@ void Render::unload()
 
   glFinish();
 
-  structs.clear();
-  structs.trim();
+  culler.destroy();
+  occlusion.destroy();
 
-  objects.clear();
-  objects.trim();
+  boundBoxes.clear();
+  boundBoxes.trim();
 
   areEffectsAlive = false;
 
@@ -746,6 +810,9 @@ void Render::init()
     {
       shader.hasS3TC = true;
     }
+    if (extension == "GL_OES_element_index_uint") {
+      shader.hasUIntIndices = true;
+    }
   }
 
 #ifdef __native_client__
@@ -753,6 +820,8 @@ void Render::init()
 #endif
 #ifdef OZ_GL_ES
   shader.hasFBO = true;
+#else
+  shader.hasUIntIndices = true;
 #endif
 
   Log::unindent();
@@ -762,10 +831,11 @@ void Render::init()
 
   Log::println("Feature availability {");
   Log::indent();
-  Log::println("Offscreen rendering:        %s", shader.hasFBO        ? "yes" : "no");
-  Log::println("Postprocessing:             %s", shader.doPostprocess ? "yes" : "no");
-  Log::println("Animation in vertex shader: %s", shader.hasVTF        ? "yes" : "no");
-  Log::println("Compressed texture loading: %s", shader.hasS3TC       ? "yes" : "no");
+  Log::println("Offscreen rendering:        %s", shader.hasFBO         ? "yes" : "no");
+  Log::println("Postprocessing:             %s", shader.doPostprocess  ? "yes" : "no");
+  Log::println("Animation in vertex shader: %s", shader.hasVTF         ? "yes" : "no");
+  Log::println("Compressed texture loading: %s", shader.hasS3TC        ? "yes" : "no");
+  Log::println("32-bit mesh indices:        %s", shader.hasUIntIndices ? "yes" : "no");
   Log::unindent();
   Log::println("}");
 
@@ -792,6 +862,9 @@ void Render::init()
   visibilityRange = config.include("render.distance",   350.0f).get(0.0f);
   showBounds      = config.include("render.showBounds", false).get(false);
   showAim         = config.include("render.showAim",    false).get(false);
+  nCullThreads    = config.include("render.cullThreads", Thread::nCores()).get(1);
+  doOcclusion     = config.include("render.occlusion",   true).get(false);
+  doClusterCull   = config.include("render.clusterCull", true).get(false);
 
   isOffscreen     = isOffscreen || shader.doPostprocess || scale != 1.0f;
   windPhi         = 0.0f;
@@ -23,7 +23,8 @@
 
 #pragma once
 
-#include <client/common.hh>
+#include <client/Culler.hh>
+#include <client/OcclusionBuffer.hh>
 
 namespace oz
 {
@@ -49,10 +50,6 @@ public:
 
 private:
 
-  static const float WIDE_CULL_FACTOR;
-  static const float OBJECT_VISIBILITY_COEF;
-  static const float FRAG_VISIBILITY_RANGE2;
-  static const float CELL_RADIUS;
   static const float EFFECTS_DISTANCE;
 
   static const float NIGHT_FOG_COEFF;
@@ -65,17 +62,36 @@ private:
 
   static const int   GLOW_MINIFICATION;
 
+  static const int   OCCLUSION_WIDTH  = 256;
+  static const int   OCCLUSION_HEIGHT = 128;
+  static const float OCCLUDER_DISTANCE;
+
   static const Vec4  STRUCT_AABB;
   static const Vec4  ENTITY_AABB;
   static const Vec4  SOLID_AABB;
   static const Vec4  NONSOLID_AABB;
 
-  struct DrawEntry;
+  struct Box
+  {
+    AABB bb;
+    Vec4 colour;
+  };
+
+  // Camera state captured by prepareDraw() together with the render queues and the frustum.
+  struct View
+  {
+    Mat4  proj;
+    Mat4  rotTMat;
+    Point p;
+    float pixelScale;   // Screen pixels per unit of size at unit distance, for terrain LOD.
+  };
 
-  SBitset<Orbis::MAX_STRUCTS> drawnStructs;
+  Culler                      culler;
+  int                         nCullThreads;
 
-  List<DrawEntry>             structs;
-  List<DrawEntry>             objects;
+  OcclusionBuffer             occlusion;
+  bool                        doOcclusion;
+  bool                        doClusterCull;
 
   float                       visibilityRange;
   float                       visibility;
@@ -83,6 +99,14 @@ private:
   bool                        showBounds;
   bool                        showAim;
 
+  // Debug shapes are collected by prepareDraw(), so drawing does not access the world.
+  List<Box>                   boundBoxes;
+  Point                       aimPoint;
+
+  View                        view;
+  int                         preparedFlags;
+  bool                        isPreparedDrawn;
+
   bool                        isOffscreen;
 
   float                       windPhi;
@@ -119,6 +143,10 @@ public:
   ulong64                     uiMicros;
   ulong64                     swapMicros;
 
+  ulong64                     nDrawCalls;
+  ulong64                     nDrawnInstances;
+  ulong64                     nOccluded;
+
 private:
 
   static void effectsMain(void*);
@@ -126,7 +154,7 @@ private:
   void cellEffects(int cellX, int cellY);
   void effectsRun();
 
-  void scheduleCell(int cellX, int cellY);
+  void cullOccluded();
   void prepareDraw();
   void drawGeometry();
 
@@ -137,6 +165,13 @@ private:
 public:
 
   void update(int flags);
+
+  // Pipelined frame: prepare() reads the world, drawPrepared() only draws what was prepared, so it
+  // may overlap with matrix update, and finish() draws UI and swaps buffers.
+  void prepare(int flags);
+  void drawPrepared();
+  void finish();
+
   void resize();
 
   void load();
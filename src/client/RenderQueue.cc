@@ -0,0 +1,117 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file client/RenderQueue.cc
+ */
+
+#include <client/RenderQueue.hh>
+
+namespace oz
+{
+namespace client
+{
+
+ulong64 RenderQueue::key(Layout layout, int shaderId, int modelId, float depth, int index)
+{
+  hard_assert(uint(index) < uint(MAX_KEYS));
+
+  float   clamped = !(depth > 0.0f) ? 0.0f : depth > 1.0f ? 1.0f : depth;
+  ulong64 depthQ  = ulong64(clamped * float((1 << DEPTH_BITS) - 1) + 0.5f);
+  ulong64 shaderQ = ulong64(uint(shaderId) & ((1u << SHADER_BITS) - 1));
+  ulong64 modelQ  = ulong64(uint(modelId) & ((1u << MODEL_BITS) - 1));
+  ulong64 state   = shaderQ << MODEL_BITS | modelQ;
+
+  if (layout == BACK_TO_FRONT) {
+    depthQ = ((1 << DEPTH_BITS) - 1) - depthQ;
+  }
+
+  ulong64 high = layout == STATE_MAJOR ? state << DEPTH_BITS | depthQ :
+                                         depthQ << (SHADER_BITS + MODEL_BITS) | state;
+
+  return high << INDEX_BITS | ulong64(index);
+}
+
+void RenderQueue::sort()
+{
+  if (isSorted) {
+    return;
+  }
+  isSorted = true;
+
+  int count = keys.length();
+  if (count < 2) {
+    return;
+  }
+
+  // Histograms for all bytes are built in a single pass.
+  int histograms[8][256] = {};
+
+  for (ulong64 key : keys) {
+    for (int i = 0; i < 8; ++i) {
+      ++histograms[i][(key >> (i * 8)) & 0xff];
+    }
+  }
+
+  buffer.resize(count);
+
+  ulong64* src  = keys.begin();
+  ulong64* dest = buffer.begin();
+
+  for (int i = 0; i < 8; ++i) {
+    int* histogram = histograms[i];
+    int  shift     = i * 8;
+
+    if (histogram[(src[0] >> shift) & 0xff] == count) {
+      continue;
+    }
+
+    int offset = 0;
+    for (int j = 0; j < 256; ++j) {
+      int n = histogram[j];
+      histogram[j] = offset;
+      offset += n;
+    }
+
+    for (int j = 0; j < count; ++j) {
+      dest[histogram[(src[j] >> shift) & 0xff]++] = src[j];
+    }
+
+    swap<ulong64*>(src, dest);
+  }
+
+  if (src != keys.begin()) {
+    Arrays::copy<ulong64>(src, count, keys.begin());
+  }
+}
+
+void RenderQueue::clear()
+{
+  keys.clear();
+  isSorted = true;
+}
+
+void RenderQueue::trim()
+{
+  keys.trim();
+  buffer.trim();
+}
+
+}
+}
@@ -0,0 +1,180 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file client/RenderQueue.hh
+ *
+ * Sort-key based draw queue.
+ */
+
+#pragma once
+
+#include <ozCore/ozCore.hh>
+
+namespace oz
+{
+namespace client
+{
+
+/**
+ * Queue of 64-bit draw keys, radix-sorted once per frame.
+ *
+ * Each key packs shader id, model id and quantised depth in the order given by the key layout and
+ * the index of the scheduled instance in the lowest 24 bits, so sorting keys alone orders the
+ * instances. This class does not depend on OpenGL, so its ordering can be tested headless.
+ */
+class RenderQueue
+{
+public:
+
+  /// Number of bits for the scheduled instance index.
+  static const int INDEX_BITS  = 24;
+
+  /// Number of bits for the quantised depth.
+  static const int DEPTH_BITS  = 16;
+
+  /// Number of bits for the model id.
+  static const int MODEL_BITS  = 16;
+
+  /// Number of bits for the shader id.
+  static const int SHADER_BITS = 8;
+
+  /// Maximum number of keys in a queue.
+  static const int MAX_KEYS    = 1 << INDEX_BITS;
+
+  /**
+   * Order of key fields, from the most to the least significant.
+   */
+  enum Layout
+  {
+    /// Shader, model, depth front-to-back. Minimises state changes for opaque geometry.
+    STATE_MAJOR,
+
+    /// Depth front-to-back, shader, model. Minimises overdraw.
+    DEPTH_MAJOR,
+
+    /// Depth back-to-front, shader, model. For blending of transparent geometry.
+    BACK_TO_FRONT
+  };
+
+private:
+
+  List<ulong64> keys;    ///< Scheduled keys.
+  List<ulong64> buffer;  ///< Temporary buffer for radix sort.
+  bool          isSorted = true;
+
+public:
+
+  /**
+   * Create a key.
+   *
+   * @param layout order of fields.
+   * @param shaderId shader program id, only the lowest `SHADER_BITS` are used.
+   * @param modelId model id, only the lowest `MODEL_BITS` are used.
+   * @param depth depth relative to visibility range, clamped to [0, 1] (NaN maps to 0).
+   * @param index index of the scheduled instance.
+   */
+  static ulong64 key(Layout layout, int shaderId, int modelId, float depth, int index);
+
+  /**
+   * Instance index stored in a key.
+   */
+  OZ_ALWAYS_INLINE
+  static int index(ulong64 key)
+  {
+    return int(key & (MAX_KEYS - 1));
+  }
+
+  /**
+   * Constant iterator over keys.
+   */
+  OZ_ALWAYS_INLINE
+  List<ulong64>::CIterator citerator() const
+  {
+    return keys.citerator();
+  }
+
+  /**
+   * STL-style constant begin iterator.
+   */
+  OZ_ALWAYS_INLINE
+  const ulong64* begin() const
+  {
+    return keys.begin();
+  }
+
+  /**
+   * STL-style constant end iterator.
+   */
+  OZ_ALWAYS_INLINE
+  const ulong64* end() const
+  {
+    return keys.end();
+  }
+
+  /**
+   * Number of scheduled keys.
+   */
+  OZ_ALWAYS_INLINE
+  int length() const
+  {
+    return keys.length();
+  }
+
+  /**
+   * True iff empty.
+   */
+  OZ_ALWAYS_INLINE
+  bool isEmpty() const
+  {
+    return keys.isEmpty();
+  }
+
+  /**
+   * Schedule a key.
+   */
+  OZ_ALWAYS_INLINE
+  void add(ulong64 key)
+  {
+    keys.add(key);
+    isSorted = false;
+  }
+
+  /**
+   * Sort keys with LSD radix sort if they have changed since the last sort.
+   *
+   * Byte positions where all keys have the same value are skipped, so queues that use only a few
+   * shaders and models take fewer passes.
+   */
+  void sort();
+
+  /**
+   * Remove all keys.
+   */
+  void clear();
+
+  /**
+   * Free allocated storage.
+   */
+  void trim();
+
+};
+
+}
+}
@@ -75,11 +75,12 @@ private:
 
 public:
 
-  Mat4 proj;
-  Mat4 camera;
-  Mat4 model;
+  Mat4  proj;
+  Mat4  camera;
+  Mat4  model;
+  Point eye;     ///< Camera position passed to shaders by `applyCamera()`.
 
-  Mat4 colour;
+  Mat4  colour;
 
   OZ_ALWAYS_INLINE
   void push()
@@ -193,6 +194,7 @@ public:
   bool hasFBO;
   bool hasVTF;
   bool hasS3TC;
+  bool hasUIntIndices;
   bool doVertexEffects;
   bool doEnvMap;
   bool doBumpMap;
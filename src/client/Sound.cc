@@ -42,42 +42,6 @@ namespace oz
 namespace client
 {
 
-static OZ_DL_DEFINE(mad_stream_init);
-static OZ_DL_DEFINE(mad_stream_finish);
-static OZ_DL_DEFINE(mad_stream_buffer);
-static OZ_DL_DEFINE(mad_frame_init);
-static OZ_DL_DEFINE(mad_frame_finish);
-static OZ_DL_DEFINE(mad_frame_decode);
-static OZ_DL_DEFINE(mad_synth_init);
-static OZ_DL_DEFINE(mad_synth_frame);
-
-static OZ_DL_DEFINE(NeAACDecInit);
-static OZ_DL_DEFINE(NeAACDecOpen);
-static OZ_DL_DEFINE(NeAACDecClose);
-static OZ_DL_DEFINE(NeAACDecDecode);
-
-static size_t vorbisRead(void* buffer, size_t size, size_t n, void* handle);
-static ov_callbacks VORBIS_CALLBACKS = { vorbisRead, nullptr, nullptr, nullptr };
-
-static size_t vorbisRead(void* buffer, size_t size, size_t n, void* handle)
-{
-  return size_t(PHYSFS_read(static_cast<PHYSFS_File*>(handle), buffer, 1, uint(size * n)));
-}
-
-OZ_ALWAYS_INLINE
-static inline short madFixedToShort(mad_fixed_t f)
-{
-  if (f < -MAD_F_ONE) {
-    return SHRT_MIN;
-  }
-  else if (f > +MAD_F_ONE) {
-    return SHRT_MAX;
-  }
-  else {
-    return short(f >> (MAD_F_FRACBITS - 15));
-  }
-}
-
 const float Sound::SOUND_DISTANCE = 192.0f;
 
 void Sound::musicMain(void*)
@@ -90,362 +54,51 @@ void Sound::soundMain(void*)
   sound.soundRun();
 }
 
-void Sound::musicOpen(const File& file)
+void Sound::musicRun()
 {
-  if (file.hasExtension("oga") || file.hasExtension("ogg")) {
-    musicStreamType = OGG;
-  }
-  else if (file.hasExtension("mp3")) {
-    if (libMad.isOpened()) {
-      musicStreamType = MP3;
-    }
-    else {
-      musicStreamType = NONE;
-    }
-  }
-  else if (file.hasExtension("aac")) {
-    if (libFaad.isOpened()) {
-      musicStreamType = AAC;
-    }
-    else {
-      musicStreamType = NONE;
-    }
-  }
-  else {
-    OZ_ERROR("Unknown extension for file '%s'", file.c());
-  }
-
-  switch (musicStreamType) {
-    case NONE: {
-      break;
-    }
-    case OGG: {
-      musicFile = PHYSFS_openRead(file.toNative());
-      if (musicFile == nullptr) {
-        OZ_ERROR("Failed to open file '%s'", file.c());
-      }
-
-      if (ov_open_callbacks(musicFile, &oggStream, nullptr, 0, VORBIS_CALLBACKS) < 0) {
-        OZ_ERROR("Failed to open Ogg stream in '%s'", file.c());
-      }
-
-      vorbis_info* vorbisInfo = ov_info(&oggStream, -1);
-      if (vorbisInfo == nullptr) {
-        OZ_ERROR("Corrupted Vorbis header in '%s'", file.c());
-      }
-
-      musicRate     = int(vorbisInfo->rate);
-      musicChannels = vorbisInfo->channels;
-
-      if (vorbisInfo->channels == 1) {
-        musicFormat = AL_FORMAT_MONO16;
-      }
-      else if (vorbisInfo->channels == 2) {
-        musicFormat = AL_FORMAT_STEREO16;
-      }
-      else {
-        OZ_ERROR("Invalid number of channels in '%s', should be 1 or 2", file.c());
-      }
-
-      break;
-    }
-    case MP3: {
-      musicFile = PHYSFS_openRead(file.toNative());
-      if (musicFile == nullptr) {
-        OZ_ERROR("Failed to open file '%s'", file.c());
-      }
-
-      mad_stream_init(&madStream);
-      mad_frame_init(&madFrame);
-      mad_synth_init(&madSynth);
-
-      int readSize = int(PHYSFS_read(musicFile, musicInputBuffer, 1, MUSIC_INPUT_BUFFER_SIZE));
-      if (readSize != MUSIC_INPUT_BUFFER_SIZE) {
-        OZ_ERROR("Failed to read MP3 stream in '%s'", file.c());
-      }
-
-      mad_stream_buffer(&madStream, musicInputBuffer, MUSIC_INPUT_BUFFER_SIZE);
+  uint generation = 0;
+  bool isDecoding = false;
 
-      while (mad_frame_decode(&madFrame, &madStream) != 0) {
-        if (!MAD_RECOVERABLE(madStream.error)) {
-          OZ_ERROR("Corrupted MP3 header in '%s'", file.c());
-        }
-      }
+  while (isMusicAlive) {
+    uint selection = __atomic_load_n(&musicGeneration, __ATOMIC_ACQUIRE);
 
-      mad_synth_frame(&madSynth, &madFrame);
+    if (selection != generation) {
+      generation = selection;
 
-      madFrameSamples   = madSynth.pcm.length;
-      madWrittenSamples = 0;
+      int track = decodedTrack;
 
-      musicRate     = madFrame.header.samplerate;
-      musicChannels = MAD_NCHANNELS(&madFrame.header);
+      musicStream.close();
+      isDecoding = track >= 0;
 
-      if (musicChannels == 1) {
-        musicFormat = AL_FORMAT_MONO16;
-      }
-      else if (musicChannels == 2) {
-        musicFormat = AL_FORMAT_STEREO16;
+      if (isDecoding) {
+        musicStream.open(liber.musicTracks[track].path);
       }
-      else {
-        OZ_ERROR("Invalid number of channels in '%s', should be 1 or 2", file.c());
-      }
-
-      break;
     }
-    case AAC: {
-      musicFile = PHYSFS_openRead(file.toNative());
-      if (musicFile == nullptr) {
-        OZ_ERROR("Failed to open file '%s'", file.c());
-      }
-
-      aacDecoder = NeAACDecOpen();
-
-      int readSize = int(PHYSFS_read(musicFile, musicInputBuffer, 1, MUSIC_INPUT_BUFFER_SIZE));
-      if (readSize != MUSIC_INPUT_BUFFER_SIZE) {
-        OZ_ERROR("Failed to read AAC stream in '%s'", file.c());
-      }
-
-      ulong aacRate;
-      ubyte aacChannels;
-
-      int skipBytes = int(NeAACDecInit(aacDecoder, musicInputBuffer, MUSIC_INPUT_BUFFER_SIZE,
-                                       &aacRate, &aacChannels));
-      if (skipBytes < 0) {
-        OZ_ERROR("Corrupted AAC header in '%s'", file.c());
-      }
-
-      memmove(musicInputBuffer, musicInputBuffer + skipBytes, skipBytes);
-
-      readSize = int(PHYSFS_read(musicFile, musicInputBuffer + MUSIC_INPUT_BUFFER_SIZE - skipBytes,
-                                 1, skipBytes));
-
-      if (readSize != skipBytes) {
-        OZ_ERROR("Failed to read AAC stream in '%s'", file.c());
-      }
-
-      aacBufferBytes  = 0;
-      aacWrittenBytes = 0;
-      aacInputBytes   = MUSIC_INPUT_BUFFER_SIZE;
-
-      musicRate     = int(aacRate);
-      musicChannels = aacChannels;
-
-      if (musicChannels == 1) {
-        musicFormat = AL_FORMAT_MONO16;
-      }
-      else if (musicChannels == 2) {
-        musicFormat = AL_FORMAT_STEREO16;
-      }
-      else {
-        OZ_ERROR("Invalid number of channels in '%s', should be 1 or 2", file.c());
-      }
-
-      break;
-    }
-  }
-}
-
-void Sound::musicClear()
-{
-  switch (musicStreamType) {
-    case NONE: {
-      break;
-    }
-    case OGG: {
-      ov_clear(&oggStream);
-
-      PHYSFS_close(musicFile);
-      break;
-    }
-    case MP3: {
-      mad_synth_finish(&madSynth);
-      mad_frame_finish(&madFrame);
-      mad_stream_finish(&madStream);
-
-      PHYSFS_close(musicFile);
-      break;
-    }
-    case AAC: {
-      NeAACDecClose(aacDecoder);
-
-      PHYSFS_close(musicFile);
-      break;
-    }
-  }
-}
 
-int Sound::musicDecode()
-{
-  switch (musicStreamType) {
-    case NONE: {
-      return 0;
-    }
-    case OGG: {
-      int bytesRead = 0;
-      int result;
-      int section;
-
-      do {
-        result = int(ov_read(&oggStream, &musicBuffer[bytesRead], MUSIC_BUFFER_SIZE - bytesRead,
-                             false, 2, true, &section));
-        bytesRead += result;
-
-        if (result < 0) {
-          OZ_ERROR("Error during Ogg Vorbis decoding of '%s'",
-                   liber.musicTracks[streamedTrack].path.c());
-        }
-      }
-      while (result > 0 && bytesRead < MUSIC_BUFFER_SIZE);
+    MusicRing::Block* block = isDecoding ? musicRing.beginWrite() : nullptr;
 
-      return bytesRead;
+    // Sleep until the sound thread consumes a block or selects another track.
+    if (block == nullptr) {
+      musicSemaphore.wait();
+      continue;
     }
-    case MP3: {
-      char* musicOutput    = musicBuffer;
-      char* musicOutputEnd = musicBuffer + MUSIC_BUFFER_SIZE;
 
-      do {
-        for (; madWrittenSamples < madFrameSamples; ++madWrittenSamples) {
-          hard_assert(musicOutput <= musicOutputEnd);
+    uint beginMicros = Time::uclock();
 
-          if (musicOutput == musicOutputEnd) {
-            return MUSIC_BUFFER_SIZE;
-          }
+    block->size       = musicStream.decode(block->data, MusicRing::BLOCK_SIZE);
+    block->rate       = musicStream.sampleRate();
+    block->channels   = musicStream.nChannels();
+    block->generation = generation;
 
-          short value = madFixedToShort(madSynth.pcm.samples[0][madWrittenSamples]);
-
-#if OZ_BYTE_ORDER == 4321
-          musicOutput[0] = char(value >> 8);
-          musicOutput[1] = char(value);
-#else
-          musicOutput[0] = char(value);
-          musicOutput[1] = char(value >> 8);
-#endif
-          musicOutput += 2;
+    decodeMicros += Time::uclock() - beginMicros;
 
-          if (musicChannels == 2) {
-            value = madFixedToShort(madSynth.pcm.samples[1][madWrittenSamples]);
+    // An empty block marks the end of the track.
+    isDecoding = block->size != 0;
 
-#if OZ_BYTE_ORDER == 4321
-            musicOutput[0] = char(value >> 8);
-            musicOutput[1] = char(value);
-#else
-            musicOutput[0] = char(value);
-            musicOutput[1] = char(value >> 8);
-#endif
-            musicOutput += 2;
-          }
-        }
-
-        while (mad_frame_decode(&madFrame, &madStream) != 0) {
-          if (madStream.error == MAD_ERROR_BUFLEN) {
-            int bytesLeft;
-
-            if (madStream.next_frame == nullptr) {
-              bytesLeft = 0;
-            }
-            else {
-              bytesLeft = int(madStream.bufend - madStream.next_frame);
-
-              memmove(musicInputBuffer, madStream.next_frame, bytesLeft);
-            }
-
-            int bytesRead = int(PHYSFS_read(musicFile, musicInputBuffer + bytesLeft,
-                                            1, MUSIC_INPUT_BUFFER_SIZE - bytesLeft));
-
-            if (bytesRead == 0) {
-              return int(reinterpret_cast<char*>(musicOutput) - musicBuffer);
-            }
-            else if (bytesRead < MUSIC_INPUT_BUFFER_SIZE - bytesLeft) {
-              memset(musicInputBuffer + bytesLeft + bytesRead, 0, MAD_BUFFER_GUARD);
-            }
-
-            mad_stream_buffer(&madStream, musicInputBuffer, bytesLeft + bytesRead);
-          }
-          else if (!MAD_RECOVERABLE(madStream.error)) {
-            OZ_ERROR("Unrecoverable error during MP3 decoding of '%s'",
-                     liber.musicTracks[streamedTrack].path.c());
-          }
-        }
-
-        mad_synth_frame(&madSynth, &madFrame);
-
-        madFrameSamples = madSynth.pcm.length;
-        madWrittenSamples = 0;
-      }
-      while (true);
-    }
-    case AAC: {
-      char* musicOutput    = musicBuffer;
-      char* musicOutputEnd = musicBuffer + MUSIC_BUFFER_SIZE;
-
-      do {
-        if (aacWrittenBytes < aacBufferBytes) {
-          int length = aacBufferBytes - aacWrittenBytes;
-          int space  = int(musicOutputEnd - musicOutput);
-
-          if (length >= space) {
-            memcpy(musicOutput, aacOutputBuffer + aacWrittenBytes, space);
-            aacWrittenBytes += space;
-
-            return MUSIC_BUFFER_SIZE;
-          }
-          else {
-            memcpy(musicOutput, aacOutputBuffer + aacWrittenBytes, length);
-            aacWrittenBytes += length;
-            musicOutput += length;
-          }
-        }
-
-        NeAACDecFrameInfo frameInfo;
-        aacOutputBuffer = static_cast<char*>(NeAACDecDecode(aacDecoder, &frameInfo,
-                                                            musicInputBuffer, aacInputBytes));
-
-        if (aacOutputBuffer == nullptr) {
-          return int(musicOutput - musicBuffer);
-        }
-
-        int bytesConsumed = int(frameInfo.bytesconsumed);
-        aacInputBytes  -= bytesConsumed;
-        aacBufferBytes  = int(frameInfo.samples * frameInfo.channels);
-        aacWrittenBytes = 0;
-
-        memmove(musicInputBuffer, musicInputBuffer + bytesConsumed, aacInputBytes);
-
-        int bytesRead = int(PHYSFS_read(musicFile, musicInputBuffer + aacInputBytes,
-                                        1, MUSIC_INPUT_BUFFER_SIZE - aacInputBytes));
-
-        aacInputBytes += bytesRead;
-      }
-      while (true);
-    }
+    musicRing.endWrite();
   }
-}
-
-void Sound::musicRun()
-{
-  streamedTrack = -1;
-
-  while (isMusicAlive) {
-    musicMainSemaphore.post();
-    musicAuxSemaphore.wait();
-
-    if (selectedTrack != -1) {
-      if (streamedTrack >= 0) {
-        musicClear();
-      }
-
-      streamedTrack = selectedTrack == -2 ? -1 : selectedTrack;
-      selectedTrack = -1;
 
-      if (streamedTrack >= 0) {
-        musicOpen(liber.musicTracks[streamedTrack].path);
-      }
-    }
-
-    if (streamedTrack >= 0) {
-      streamedBytes = musicDecode();
-    }
-  }
+  musicStream.close();
 }
 
 void Sound::playCell(int cellX, int cellY)
@@ -455,8 +108,8 @@ void Sound::playCell(int cellX, int cellY)
   for (int i = 0; i < cell.structs.length(); ++i) {
     int strIndex = cell.structs[i];
 
-    if (!playedStructs.get(strIndex)) {
-      playedStructs.set(strIndex);
+    if (!playedStructs.get(Orbis::strSlot(strIndex))) {
+      playedStructs.set(Orbis::strSlot(strIndex));
 
       const Struct* str = orbis.str(strIndex);
       float radius = SOUND_DISTANCE + str->dim().fastN();
@@ -484,79 +137,101 @@ void Sound::playCell(int cellX, int cellY)
 
 void Sound::updateMusic()
 {
-  if (!musicMainSemaphore.tryWait()) {
-    return;
-  }
-
   if (selectedTrack != -1) {
-    musicBuffersQueued = 0;
-
     alSourceStop(musicSource);
 
     int nQueued;
     alGetSourcei(musicSource, AL_BUFFERS_QUEUED, &nQueued);
 
     if (nQueued != 0) {
-      uint buffers[2];
+      uint buffers[MUSIC_BUFFERS];
       alSourceUnqueueBuffers(musicSource, nQueued, buffers);
     }
 
-    musicAuxSemaphore.post();
+    for (int i = 0; i < MUSIC_BUFFERS; ++i) {
+      musicFreeBuffers[i] = musicBufferIds[i];
+    }
+
+    nMusicFreeBuffers  = MUSIC_BUFFERS;
+    musicBuffersQueued = 0;
+    isMusicEnded       = false;
+    isMusicStarved     = true;
+
+    streamedTrack = selectedTrack == -2 ? -1 : selectedTrack;
+    selectedTrack = -1;
+    decodedTrack  = streamedTrack;
+
+    __atomic_store_n(&musicGeneration, musicGeneration + 1, __ATOMIC_RELEASE);
+    musicSemaphore.post();
   }
-  else if (streamedTrack < 0) {
-    musicMainSemaphore.post();
+
+  if (streamedTrack < 0) {
+    return;
   }
-  else {
-    bool hasLoaded = false;
 
-    int nProcessed;
-    alGetSourcei(musicSource, AL_BUFFERS_PROCESSED, &nProcessed);
+  int nProcessed;
+  alGetSourcei(musicSource, AL_BUFFERS_PROCESSED, &nProcessed);
 
-    if (nProcessed != 0) {
-      if (streamedBytes == 0) {
-        --musicBuffersQueued;
+  if (nProcessed != 0) {
+    alSourceUnqueueBuffers(musicSource, nProcessed, &musicFreeBuffers[nMusicFreeBuffers]);
 
-        if (musicBuffersQueued == 0) {
-          streamedTrack = -1;
-        }
-      }
-      else {
-        hasLoaded = true;
+    nMusicFreeBuffers  += nProcessed;
+    musicBuffersQueued -= nProcessed;
+  }
 
-        uint buffer;
-        alSourceUnqueueBuffers(musicSource, 1, &buffer);
-        alBufferData(buffer, musicFormat, musicBuffer, streamedBytes, musicRate);
-        alSourceQueueBuffers(musicSource, 1, &buffer);
-      }
-    }
-    // If beginning a track.
-    else if (musicBuffersQueued != 2 && streamedBytes != 0) {
-      hasLoaded = true;
+  bool hasConsumed = false;
 
-      int i = musicBuffersQueued;
-      ++musicBuffersQueued;
+  while (nMusicFreeBuffers != 0 && !isMusicEnded) {
+    const MusicRing::Block* block = musicRing.beginRead();
 
-      alBufferData(musicBufferIds[i], musicFormat, musicBuffer, streamedBytes, musicRate);
-      alSourceQueueBuffers(musicSource, 1, &musicBufferIds[i]);
-      alSourcePlay(musicSource);
+    // Count each stretch of time the ring runs dry during playback once. A track starts starved
+    // since its first block cannot be there yet.
+    if (block == nullptr) {
+      musicRing.nUnderruns += !isMusicStarved;
+      isMusicStarved = true;
+      break;
     }
 
-    if (musicBuffersQueued != 0) {
-      ALint value;
-      alGetSourcei(musicSource, AL_SOURCE_STATE, &value);
+    hasConsumed = true;
 
-      if (value == AL_STOPPED) {
-        alSourcePlay(musicSource);
-      }
+    // Skip blocks the music thread decoded for a previous selection.
+    if (block->generation != musicGeneration) {
+      musicRing.endRead();
+      continue;
     }
 
-    if (hasLoaded) {
-      musicAuxSemaphore.post();
+    if (block->size == 0) {
+      isMusicEnded = true;
     }
     else {
-      musicMainSemaphore.post();
+      int  format = block->channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+      uint buffer = musicFreeBuffers[--nMusicFreeBuffers];
+
+      alBufferData(buffer, format, block->data, block->size, block->rate);
+      alSourceQueueBuffers(musicSource, 1, &buffer);
+
+      ++musicBuffersQueued;
+      isMusicStarved = false;
+    }
+
+    musicRing.endRead();
+  }
+
+  if (hasConsumed) {
+    musicSemaphore.post();
+  }
+
+  if (musicBuffersQueued != 0) {
+    ALint value;
+    alGetSourcei(musicSource, AL_SOURCE_STATE, &value);
+
+    if (value != AL_PLAYING) {
+      alSourcePlay(musicSource);
     }
   }
+  else if (isMusicEnded) {
+    streamedTrack = -1;
+  }
 
   OZ_AL_CHECK_ERROR();
 }
@@ -666,10 +341,24 @@ void Sound::load()
 {
   effectsMicros = 0;
   musicMicros   = 0;
+  decodeMicros  = 0;
+
+  musicRing.resetCounters();
 }
 
 void Sound::unload()
-{}
+{
+  Log::println("Music ring {");
+  Log::indent();
+  Log::println("%6d  blocks",       musicRing.length());
+  Log::println("%6d  peak depth",   musicRing.nPeakDepth);
+  Log::println("%6lu  decoded",     ulong(musicRing.nWrites));
+  Log::println("%6lu  played",      ulong(musicRing.nReads));
+  Log::println("%6lu  underruns",   ulong(musicRing.nUnderruns));
+  Log::println("%6.2f  MB decoded", float(musicRing.nWrittenBytes) / float(1024 * 1024));
+  Log::unindent();
+  Log::println("}");
+}
 
 void Sound::init()
 {
@@ -792,13 +481,28 @@ void Sound::init()
   Log::println("}");
   Log::verboseMode = false;
 
-  selectedTrack = -1;
-  streamedTrack = -1;
+  selectedTrack   = -1;
+  streamedTrack   = -1;
+  decodedTrack    = -1;
+  musicGeneration = 0;
 
-  alGenBuffers(2, musicBufferIds);
+  alGenBuffers(MUSIC_BUFFERS, musicBufferIds);
   alGenSources(1, &musicSource);
 
+  nMusicFreeBuffers  = 0;
   musicBuffersQueued = 0;
+  isMusicEnded       = true;
+  isMusicStarved     = true;
+
+  int nMusicBlocks = config.include("sound.musicBlocks", int(DEFAULT_MUSIC_BLOCKS)).get(0);
+  nMusicBlocks = max(nMusicBlocks, 2);
+
+  // Ring indices are wrapped with a mask.
+  if ((nMusicBlocks & (nMusicBlocks - 1)) != 0) {
+    nMusicBlocks = Math::nextPow2(nMusicBlocks);
+  }
+
+  musicRing.init(nMusicBlocks);
 
   alSourcei(musicSource, AL_SOURCE_RELATIVE, AL_TRUE);
 
@@ -841,14 +545,16 @@ void Sound::destroy()
   isMusicAlive = false;
 
   soundAuxSemaphore.post();
-  musicAuxSemaphore.post();
+  musicSemaphore.post();
   soundThread.join();
   musicThread.join();
 
+  musicRing.destroy();
+
   if (soundContext != nullptr) {
     alSourceStop(musicSource);
     alDeleteSources(1, &musicSource);
-    alDeleteBuffers(2, musicBufferIds);
+    alDeleteBuffers(MUSIC_BUFFERS, musicBufferIds);
 
     OZ_AL_CHECK_ERROR();
 
@@ -859,9 +565,9 @@ void Sound::destroy()
     soundDevice = nullptr;
   }
 
+  MusicStream::destroyLibs();
+
 #ifndef __native_client__
-  libFaad.close();
-  libMad.close();
   libeSpeak.close();
 #endif
 
@@ -872,17 +578,11 @@ void Sound::initLibs()
 {
 #ifdef __native_client__
   static_cast<void>(libeSpeak);
-  static_cast<void>(libMad);
-  static_cast<void>(libFaad);
 #else
 # ifdef _WIN32
   const char* libeSpeakName = "libespeak.dll";
-  const char* libMadName    = "libmad.dll";
-  const char* libFaadName   = "libfaad2.dll";
 # else
   const char* libeSpeakName = "libespeak.so.1";
-  const char* libMadName    = "libmad.so.0";
-  const char* libFaadName   = "libfaad.so.2";
 # endif
 
   Log::print("Linking eSpeak library '%s' ...", libeSpeakName);
@@ -902,47 +602,10 @@ void Sound::initLibs()
     Log::printEnd(" OK, speech synthesis supported");
   }
 
-  Log::print("Linking MAD library '%s' ...", libMadName);
+  MusicStream::initLibs();
 
-  libMad = SharedLib(libMadName);
-  if (!libMad.isOpened()) {
-    liber.mapMP3s = false;
-
-    Log::printEnd(" Not found, MP3 not supported");
-  }
-  else {
-    OZ_DL_LOAD(libMad, mad_stream_init  );
-    OZ_DL_LOAD(libMad, mad_stream_finish);
-    OZ_DL_LOAD(libMad, mad_stream_buffer);
-    OZ_DL_LOAD(libMad, mad_frame_init   );
-    OZ_DL_LOAD(libMad, mad_frame_finish );
-    OZ_DL_LOAD(libMad, mad_frame_decode );
-    OZ_DL_LOAD(libMad, mad_synth_init   );
-    OZ_DL_LOAD(libMad, mad_synth_frame  );
-
-    liber.mapMP3s = true;
-
-    Log::printEnd(" OK, MP3 supported");
-  }
-
-  Log::print("Linking FAAD library '%s' ...", libFaadName);
-
-  libFaad = SharedLib(libFaadName);
-  if (!libFaad.isOpened()) {
-    liber.mapAACs = false;
-
-    Log::printEnd(" Not found, AAC not supported");
-  }
-  else {
-    OZ_DL_LOAD(libFaad, NeAACDecInit  );
-    OZ_DL_LOAD(libFaad, NeAACDecOpen  );
-    OZ_DL_LOAD(libFaad, NeAACDecClose );
-    OZ_DL_LOAD(libFaad, NeAACDecDecode);
-
-    liber.mapAACs = true;
-
-    Log::printEnd(" OK, AAC supported");
-  }
+  liber.mapMP3s = MusicStream::hasMP3();
+  liber.mapAACs = MusicStream::hasAAC();
 #endif
 }
 
@@ -24,15 +24,10 @@
 #pragma once
 
 #include <client/common.hh>
+#include <client/MusicRing.hh>
+#include <client/MusicStream.hh>
 
-// We don't use those callbacks anywhere and they don't compile on MinGW.
-#define OV_EXCLUDE_STATIC_CALLBACKS
-
-#include <physfs.h>
 #include <AL/alc.h>
-#include <vorbis/vorbisfile.h>
-#include <mad.h>
-#include <neaacdec.h>
 
 namespace oz
 {
@@ -43,67 +38,41 @@ class Sound
 {
 private:
 
-  static const int   MUSIC_BUFFER_SIZE       = 64 * 1024;
-  static const int   MUSIC_INPUT_BUFFER_SIZE = 64 * 1024;
+  static const int   MUSIC_BUFFERS        = 2;
+  static const int   DEFAULT_MUSIC_BLOCKS = 8;
   static const float SOUND_DISTANCE;
 
-  enum StreamType
-  {
-    NONE,
-    OGG,
-    MP3,
-    AAC
-  };
-
   ALCdevice*                  soundDevice;
   ALCcontext*                 soundContext;
 
   SharedLib                   libeSpeak;
-  SharedLib                   libMad;
-  SharedLib                   libFaad;
 
   SBitset<Orbis::MAX_STRUCTS> playedStructs;
   float                       volume;
 
-  StreamType                  musicStreamType;
-
-  int                         musicRate;
-  int                         musicChannels;
-  int                         musicFormat;
   uint                        musicSource;
-  uint                        musicBufferIds[2];
+  uint                        musicBufferIds[MUSIC_BUFFERS];
+  uint                        musicFreeBuffers[MUSIC_BUFFERS];
+  int                         nMusicFreeBuffers;
   int                         musicBuffersQueued;
-  char                        musicBuffer[MUSIC_BUFFER_SIZE];
-  ubyte                       musicInputBuffer[MUSIC_INPUT_BUFFER_SIZE + MAD_BUFFER_GUARD];
-
-  PHYSFS_File*                musicFile;
-
-  OggVorbis_File              oggStream;
-
-  mad_stream                  madStream;
-  mad_frame                   madFrame;
-  mad_synth                   madSynth;
-
-  int                         madWrittenSamples;
-  int                         madFrameSamples;
-
-  NeAACDecHandle              aacDecoder;
+  bool                        isMusicEnded;
+  bool                        isMusicStarved;
 
-  char*                       aacOutputBuffer;
-  int                         aacWrittenBytes;
-  int                         aacBufferBytes;
-  int                         aacInputBytes;
+  // Decoder and ring are owned by the music thread, except for the consumer side of the ring.
+  MusicStream                 musicStream;
+  MusicRing                   musicRing;
 
   // Music track id to switch to, -1 to do nothing, -2 stop playing.
   int                         selectedTrack;
   volatile int                streamedTrack;
-  volatile int                streamedBytes;
+  // Track the music thread should decode and the selection it belongs to.
+  volatile int                decodedTrack;
+  uint                        musicGeneration;
 
   Thread                      musicThread;
   Thread                      soundThread;
 
-  Semaphore                   musicMainSemaphore;
-  Semaphore                   musicAuxSemaphore;
+  Semaphore                   musicSemaphore;
   Semaphore                   soundMainSemaphore;
   Semaphore                   soundAuxSemaphore;
 
@@ -114,15 +83,13 @@ public:
 
   ulong64                     effectsMicros;
   ulong64                     musicMicros;
+  ulong64                     decodeMicros;
 
 private:
 
   static void musicMain(void*);
   static void soundMain(void*);
 
-  void musicOpen(const File& file);
-  void musicClear();
-  int  musicDecode();
   void musicRun();
 
   void playCell(int cellX, int cellY);
@@ -32,10 +32,13 @@ namespace oz
 namespace client
 {
 
-const float Terra::WAVE_BIAS_INC = 1.5f;
+static_assert(Terra::TILE_QUADS == TerraLOD::TILE_QUADS, "Terra and TerraLOD tile sizes differ");
+
+const float Terra::WAVE_BIAS_INC     = 1.5f;
+const float Terra::DEFAULT_LOD_ERROR = 2.0f;
 
 Terra::Terra() :
-  ibo(0), id(-1)
+  ibo(0), lodIbo(0), id(-1)
 {
   for (int i = 0; i < TILES; ++i) {
     for (int j = 0; j < TILES; ++j) {
@@ -44,7 +47,7 @@ Terra::Terra() :
   }
 }
 
-void Terra::draw()
+void Terra::draw(const Point& eye, float pixelScale)
 {
   if (id < 0) {
     return;
@@ -54,10 +57,19 @@ void Terra::draw()
   // we draw column-major (triangle strips along y axis) for better cache performance
   glFrontFace(GL_CW);
 
-  span.minX = max(int((camera.p.x - frustum.radius + oz::Terra::DIM) / TILE_SIZE), 0);
-  span.minY = max(int((camera.p.y - frustum.radius + oz::Terra::DIM) / TILE_SIZE), 0);
-  span.maxX = min(int((camera.p.x + frustum.radius + oz::Terra::DIM) / TILE_SIZE), TILES - 1);
-  span.maxY = min(int((camera.p.y + frustum.radius + oz::Terra::DIM) / TILE_SIZE), TILES - 1);
+  Span span;
+  span.minX = max(int((eye.x - frustum.radius + oz::Terra::DIM) / TILE_SIZE), 0);
+  span.minY = max(int((eye.y - frustum.radius + oz::Terra::DIM) / TILE_SIZE), 0);
+  span.maxX = min(int((eye.x + frustum.radius + oz::Terra::DIM) / TILE_SIZE), TILES - 1);
+  span.maxY = min(int((eye.y + frustum.radius + oz::Terra::DIM) / TILE_SIZE), TILES - 1);
+
+  // Tiles in span are tested against the frustum by their bounding boxes and their levels of
+  // detail are chosen so that the geometric error projects to at most `lodError` pixels.
+  Plane planes[5];
+  frustum.getPlanes(planes);
+
+  lod.select(eye, pixelScale, lodError, span.minX, span.minY, span.maxX, span.maxY,
+             planes, 5);
 
   shader.program(landShaderId);
 
@@ -75,16 +87,17 @@ void Terra::draw()
 
   OZ_GL_CHECK_ERROR();
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lodIbo);
 
-  for (int i = span.minX; i <= span.maxX; ++i) {
-    for (int j = span.minY; j <= span.maxY; ++j) {
-      glBindBuffer(GL_ARRAY_BUFFER, vbos[i][j]);
+  for (const TerraLOD::Draw& draw : lod.draws) {
+    const TerraLOD::Range& range = lod.range(draw);
 
-      Vertex::setFormat();
+    glBindBuffer(GL_ARRAY_BUFFER, vbos[draw.x][draw.y]);
 
-      glDrawElements(GL_TRIANGLE_STRIP, TILE_INDICES, GL_UNSIGNED_SHORT, nullptr);
-    }
+    Vertex::setFormat();
+
+    glDrawElements(GL_TRIANGLES, range.count, GL_UNSIGNED_SHORT,
+                   static_cast<ushort*>(nullptr) + range.offset);
   }
 
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -103,13 +116,13 @@ void Terra::draw()
   OZ_GL_CHECK_ERROR();
 }
 
-void Terra::drawLiquid()
+void Terra::drawLiquid(const Point& eye)
 {
   if (id < 0) {
     return;
   }
 
-  if (camera.p.z >= 0.0f) {
+  if (eye.z >= 0.0f) {
     glFrontFace(GL_CW);
   }
 
@@ -134,15 +147,14 @@ void Terra::drawLiquid()
 
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
 
-  for (int i = span.minX; i <= span.maxX; ++i) {
-    for (int j = span.minY; j <= span.maxY; ++j) {
-      if (liquidTiles.get(i * TILES + j)) {
-        glBindBuffer(GL_ARRAY_BUFFER, vbos[i][j]);
+  // Liquid surface is always drawn at full detail, tile bounding boxes include it.
+  for (const TerraLOD::Draw& draw : lod.draws) {
+    if (liquidTiles.get(draw.x * TILES + draw.y)) {
+      glBindBuffer(GL_ARRAY_BUFFER, vbos[draw.x][draw.y]);
 
-        Vertex::setFormat();
+      Vertex::setFormat();
 
-        glDrawElements(GL_TRIANGLE_STRIP, TILE_INDICES, GL_UNSIGNED_SHORT, nullptr);
-      }
+      glDrawElements(GL_TRIANGLE_STRIP, TILE_INDICES, GL_UNSIGNED_SHORT, nullptr);
     }
   }
 
@@ -157,7 +169,7 @@ void Terra::drawLiquid()
   glActiveTexture(Shader::DIFFUSE);
   glBindTexture(GL_TEXTURE_2D, shader.defaultTexture);
 
-  if (camera.p.z >= 0.0f) {
+  if (eye.z >= 0.0f) {
     glFrontFace(GL_CCW);
   }
 
@@ -186,6 +198,7 @@ void Terra::load()
 
   glGenBuffers(TILES * TILES, &vbos[0][0]);
   glGenBuffers(1, &ibo);
+  glGenBuffers(1, &lodIbo);
 
   int vboSize = TILE_VERTICES * sizeof(Vertex);
   int iboSize = TILE_INDICES  * sizeof(ushort);
@@ -247,6 +260,36 @@ void Terra::load()
     }
   }
 
+  lod.init(TILES);
+
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lodIbo);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, lod.indices.length() * int(sizeof(ushort)),
+               lod.indices.begin(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+  Point* positions = new Point[TILE_VERTICES];
+
+  for (int i = 0; i < TILES; ++i) {
+    for (int j = 0; j < TILES; ++j) {
+      for (int k = 0; k <= TILE_QUADS; ++k) {
+        for (int l = 0; l <= TILE_QUADS; ++l) {
+          int x = i * TILE_QUADS + k;
+          int y = j * TILE_QUADS + l;
+
+          positions[TerraLOD::vertexIndex(k, l)] = orbis.terra.quads[x][y].vertex;
+        }
+      }
+
+      bool isLiquid = liquidTiles.get(i * TILES + j);
+
+      lod.setTile(i, j, positions, isLiquid ? 0.0f : Math::INF, isLiquid ? 0.0f : -Math::INF);
+    }
+  }
+
+  delete[] positions;
+
+  lodError        = config.include("render.terraError", DEFAULT_LOD_ERROR).get(0.0f);
+
   detailTexId     = liber.textureIndex(is.readString());
   liquidTexId     = liber.textureIndex(is.readString());
   liquidFogColour = is.readVec4();
@@ -282,10 +325,14 @@ void Terra::unload()
 
     glDeleteTextures(1, &mapTex);
 
+    glDeleteBuffers(1, &lodIbo);
     glDeleteBuffers(1, &ibo);
     glDeleteBuffers(TILES * TILES, &vbos[0][0]);
 
-    ibo = 0;
+    lod.destroy();
+
+    lodIbo = 0;
+    ibo    = 0;
     for (int i = 0; i < TILES; ++i) {
       for (int j = 0; j < TILES; ++j) {
         vbos[i][j] = 0;
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <client/Model.hh>
+#include <client/TerraLOD.hh>
 
 namespace oz
 {
@@ -44,9 +45,11 @@ private:
   static const int       TILE_VERTICES = (TILE_QUADS + 1) * (TILE_QUADS + 1);
 
   static const float     WAVE_BIAS_INC;
+  static const float     DEFAULT_LOD_ERROR;
 
   uint                   vbos[TILES][TILES];
   uint                   ibo;
+  uint                   lodIbo;
 
   int                    detailTexId;
   int                    landShaderId;
@@ -57,9 +60,10 @@ private:
   GLuint                 mapTex;
 
   float                  waveBias;
+  float                  lodError;
 
-  Span                   span;
   SBitset<TILES * TILES> liquidTiles;
+  TerraLOD               lod;
 
 public:
 
@@ -70,8 +74,8 @@ public:
 
   Terra();
 
-  void draw();
-  void drawLiquid();
+  void draw(const Point& eye, float pixelScale);
+  void drawLiquid(const Point& eye);
 
   void load();
   void unload();
@@ -0,0 +1,272 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/TerraLOD.cc
+ */
+
+#include <client/TerraLOD.hh>
+
+namespace oz
+{
+namespace client
+{
+
+void TerraLOD::setTile(int x, int y, const Point* vertices, float minZ, float maxZ)
+{
+  Tile& tile = tiles[x * nTiles + y];
+
+  tile.mins = vertices[0];
+  tile.maxs = vertices[0];
+
+  for (int i = 1; i < TILE_VERTS * TILE_VERTS; ++i) {
+    tile.mins = Point(min(tile.mins.x, vertices[i].x), min(tile.mins.y, vertices[i].y),
+                      min(tile.mins.z, vertices[i].z));
+    tile.maxs = Point(max(tile.maxs.x, vertices[i].x), max(tile.maxs.y, vertices[i].y),
+                      max(tile.maxs.z, vertices[i].z));
+  }
+
+  tile.mins.z = min(tile.mins.z, minZ);
+  tile.maxs.z = max(tile.maxs.z, maxZ);
+
+  // Error of a level is the largest height difference between a full-resolution vertex and the
+  // surface of the level's triangle it lies on.
+  tile.errors[0] = 0.0f;
+
+  for (int lod = 1; lod < LODS; ++lod) {
+    int   step  = 1 << lod;
+    float error = tile.errors[lod - 1];
+
+    for (int i = 0; i < TILE_VERTS; ++i) {
+      for (int j = 0; j < TILE_VERTS; ++j) {
+        int x0 = min(i - i % step, TILE_QUADS - step);
+        int y0 = min(j - j % step, TILE_QUADS - step);
+        int x1 = x0 + step;
+        int y1 = y0 + step;
+
+        float u   = float(i - x0) / float(step);
+        float v   = float(j - y0) / float(step);
+        float h00 = vertices[vertexIndex(x0, y0)].z;
+        float h11 = vertices[vertexIndex(x1, y1)].z;
+        float h;
+
+        if (u >= v) {
+          float h10 = vertices[vertexIndex(x1, y0)].z;
+          h = h00 + u * (h10 - h00) + v * (h11 - h10);
+        }
+        else {
+          float h01 = vertices[vertexIndex(x0, y1)].z;
+          h = h00 + v * (h01 - h00) + u * (h11 - h01);
+        }
+
+        error = max(error, abs(vertices[vertexIndex(i, j)].z - h));
+      }
+    }
+
+    tile.errors[lod] = error;
+  }
+}
+
+void TerraLOD::select(const Point& eye, float pixelScale, float maxError,
+                      int minX, int minY, int maxX, int maxY, const Plane* planes, int nPlanes)
+{
+  draws.clear();
+  nCulled    = 0;
+  nTriangles = 0;
+
+  if (minX > maxX || minY > maxY) {
+    return;
+  }
+
+  int width  = maxX - minX + 1;
+  int height = maxY - minY + 1;
+
+  lods.resize(width * height);
+
+  // Coarsest level with projected error within limits, error / distance * pixelScale <= maxError.
+  for (int i = 0; i < width; ++i) {
+    for (int j = 0; j < height; ++j) {
+      const Tile& tile = tiles[(minX + i) * nTiles + minY + j];
+
+      Point nearest  = Point(clamp(eye.x, tile.mins.x, tile.maxs.x),
+                             clamp(eye.y, tile.mins.y, tile.maxs.y),
+                             clamp(eye.z, tile.mins.z, tile.maxs.z));
+      float distance = !(nearest - eye);
+      int   lod      = LODS - 1;
+
+      while (lod > 0 && tile.errors[lod] * pixelScale > maxError * distance) {
+        --lod;
+      }
+      lods[i * height + j] = lod;
+    }
+  }
+
+  // Neighbouring tiles may differ by at most one level, refine coarser ones until that holds.
+  bool hasChanged;
+  do {
+    hasChanged = false;
+
+    for (int i = 0; i < width; ++i) {
+      for (int j = 0; j < height; ++j) {
+        int& lod   = lods[i * height + j];
+        int  limit = lod;
+
+        if (i != 0) {
+          limit = min(limit, lods[(i - 1) * height + j] + 1);
+        }
+        if (i != width - 1) {
+          limit = min(limit, lods[(i + 1) * height + j] + 1);
+        }
+        if (j != 0) {
+          limit = min(limit, lods[i * height + j - 1] + 1);
+        }
+        if (j != height - 1) {
+          limit = min(limit, lods[i * height + j + 1] + 1);
+        }
+
+        if (limit != lod) {
+          lod        = limit;
+          hasChanged = true;
+        }
+      }
+    }
+  }
+  while (hasChanged);
+
+  for (int i = 0; i < width; ++i) {
+    for (int j = 0; j < height; ++j) {
+      const Tile& tile = tiles[(minX + i) * nTiles + minY + j];
+
+      // Box is outside if its corner farthest along a plane normal is behind that plane.
+      bool isVisible = true;
+
+      for (int k = 0; k < nPlanes; ++k) {
+        const Plane& plane = planes[k];
+
+        Point corner = Point(plane.n.x >= 0.0f ? tile.maxs.x : tile.mins.x,
+                             plane.n.y >= 0.0f ? tile.maxs.y : tile.mins.y,
+                             plane.n.z >= 0.0f ? tile.maxs.z : tile.mins.z);
+
+        if (corner * plane < 0.0f) {
+          isVisible = false;
+          break;
+        }
+      }
+
+      if (!isVisible) {
+        ++nCulled;
+        continue;
+      }
+
+      int lod      = lods[i * height + j];
+      int stitches = 0;
+
+      if (i != 0 && lods[(i - 1) * height + j] > lod) {
+        stitches |= NEG_X_BIT;
+      }
+      if (i != width - 1 && lods[(i + 1) * height + j] > lod) {
+        stitches |= POS_X_BIT;
+      }
+      if (j != 0 && lods[i * height + j - 1] > lod) {
+        stitches |= NEG_Y_BIT;
+      }
+      if (j != height - 1 && lods[i * height + j + 1] > lod) {
+        stitches |= POS_Y_BIT;
+      }
+
+      draws.add(Draw{ minX + i, minY + j, lod, stitches });
+      nTriangles += ranges[lod][stitches].count / 3;
+    }
+  }
+}
+
+void TerraLOD::init(int nTiles_)
+{
+  nTiles = nTiles_;
+  tiles.resize(nTiles * nTiles, true);
+
+  indices.clear();
+
+  for (int lod = 0; lod < LODS; ++lod) {
+    int step  = 1 << lod;
+    int quads = TILE_QUADS / step;
+
+    for (int stitches = 0; stitches < STITCHES; ++stitches) {
+      // The coarsest level never borders a coarser one.
+      int mask = lod == LODS - 1 ? 0 : stitches;
+
+      // Snap odd vertices on stitched edges to the preceding vertex of the coarser level.
+      auto snap = [mask, step](int x, int y)
+      {
+        if ((x == 0 && (mask & NEG_X_BIT)) || (x == TILE_QUADS && (mask & POS_X_BIT))) {
+          y -= y % (2 * step);
+        }
+        if ((y == 0 && (mask & NEG_Y_BIT)) || (y == TILE_QUADS && (mask & POS_Y_BIT))) {
+          x -= x % (2 * step);
+        }
+        return ushort(vertexIndex(x, y));
+      };
+
+      ranges[lod][stitches].offset = indices.length();
+
+      // Clockwise triangles, split along the same diagonal as `oz::Terra` quads.
+      for (int i = 0; i < quads; ++i) {
+        for (int j = 0; j < quads; ++j) {
+          int x0 = i * step;
+          int y0 = j * step;
+          int x1 = x0 + step;
+          int y1 = y0 + step;
+
+          ushort triangles[2][3] = {
+            { snap(x1, y0), snap(x0, y0), snap(x1, y1) },
+            { snap(x0, y0), snap(x0, y1), snap(x1, y1) }
+          };
+
+          for (const ushort* t : triangles) {
+            if (t[0] != t[1] && t[1] != t[2] && t[2] != t[0]) {
+              indices.addAll(t, 3);
+            }
+          }
+        }
+      }
+
+      ranges[lod][stitches].count = indices.length() - ranges[lod][stitches].offset;
+    }
+  }
+
+  indices.trim();
+}
+
+void TerraLOD::destroy()
+{
+  tiles.clear();
+  tiles.trim();
+  lods.clear();
+  lods.trim();
+  indices.clear();
+  indices.trim();
+  draws.clear();
+  draws.trim();
+
+  nTiles = 0;
+}
+
+}
+}
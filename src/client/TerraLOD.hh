@@ -0,0 +1,190 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/TerraLOD.hh
+ *
+ * Terrain tile level-of-detail selection.
+ */
+
+#pragma once
+
+#include <ozCore/ozCore.hh>
+
+namespace oz
+{
+namespace client
+{
+
+/**
+ * Geomipmapping index buffers and per-frame tile LOD selection.
+ *
+ * Each terrain tile has `LODS` levels of detail, level `l` using every `2^l`-th vertex of the
+ * tile's full-resolution vertex grid. Every level has `STITCHES` index ranges, one for each
+ * combination of edges bordering a tile that is one level coarser. On such an edge every other
+ * vertex is snapped onto its preceding neighbour, so the edge matches the coarser tile and no
+ * cracks appear. Triangles that become degenerate by snapping are dropped.
+ *
+ * Level selection picks the coarsest level whose geometric error, projected onto the screen from
+ * the nearest point of the tile's bounding box, stays within a given number of pixels. Levels are
+ * then relaxed so that neighbouring tiles differ by at most one level. This class does not depend
+ * on OpenGL, so it can be tested headless.
+ */
+class TerraLOD
+{
+public:
+
+  /// Number of quads along a tile edge.
+  static const int TILE_QUADS = 32;
+
+  /// Number of vertices along a tile edge.
+  static const int TILE_VERTS = TILE_QUADS + 1;
+
+  /// Number of levels of detail, the coarsest one having only two triangles per tile.
+  static const int LODS = 6;
+
+  /// Number of edge stitching combinations for a level.
+  static const int STITCHES = 16;
+
+  static const int NEG_X_BIT = 0x01; ///< Tile at -x is one level coarser.
+  static const int POS_X_BIT = 0x02; ///< Tile at +x is one level coarser.
+  static const int NEG_Y_BIT = 0x04; ///< Tile at -y is one level coarser.
+  static const int POS_Y_BIT = 0x08; ///< Tile at +y is one level coarser.
+
+  /**
+   * Range in `indices` for a level and stitching combination.
+   */
+  struct Range
+  {
+    int offset; ///< Offset of the first index.
+    int count;  ///< Number of indices.
+  };
+
+  /**
+   * Tile chosen for drawing.
+   */
+  struct Draw
+  {
+    int x;        ///< Tile x index.
+    int y;        ///< Tile y index.
+    int lod;      ///< Level of detail.
+    int stitches; ///< Bitwise OR of `NEG_X_BIT`, `POS_X_BIT`, `NEG_Y_BIT` and `POS_Y_BIT`.
+  };
+
+private:
+
+  struct Tile
+  {
+    Point mins;
+    Point maxs;
+    float errors[LODS];
+  };
+
+  int        nTiles = 0;
+  List<Tile> tiles;
+  List<int>  lods;
+
+public:
+
+  List<ushort> indices;                  ///< Triangle list indices for all ranges.
+  Range        ranges[LODS][STITCHES];   ///< Ranges in `indices` per level and stitching.
+  List<Draw>   draws;                    ///< Tiles chosen by the last `select()`.
+
+  int          nCulled    = 0;           ///< Tiles in span rejected by the last `select()`.
+  int          nTriangles = 0;           ///< Triangles of tiles chosen by the last `select()`.
+
+  /**
+   * Index of a vertex in a tile's vertex grid, stored column-major as in `client::Terra`.
+   */
+  OZ_ALWAYS_INLINE
+  static int vertexIndex(int x, int y)
+  {
+    return x * TILE_VERTS + y;
+  }
+
+  /**
+   * Range for a given tile in `draws`.
+   */
+  OZ_ALWAYS_INLINE
+  const Range& range(const Draw& draw) const
+  {
+    return ranges[draw.lod][draw.stitches];
+  }
+
+  /**
+   * Set tile bounds and per-level errors from its `TILE_VERTS` x `TILE_VERTS` vertex positions.
+   *
+   * If `minZ` or `maxZ` extend beyond vertex heights, the bounding box is enlarged accordingly,
+   * e.g. to include liquid surface.
+   */
+  void setTile(int x, int y, const Point* vertices,
+               float minZ = Math::INF, float maxZ = -Math::INF);
+
+  /**
+   * Bounding box minimum of a tile.
+   */
+  const Point& tileMins(int x, int y) const
+  {
+    return tiles[x * nTiles + y].mins;
+  }
+
+  /**
+   * Bounding box maximum of a tile.
+   */
+  const Point& tileMaxs(int x, int y) const
+  {
+    return tiles[x * nTiles + y].maxs;
+  }
+
+  /**
+   * Geometric error of a tile for a given level, maximum height difference to the full-resolution
+   * surface.
+   */
+  float tileError(int x, int y, int lod) const
+  {
+    return tiles[x * nTiles + y].errors[lod];
+  }
+
+  /**
+   * Choose visible tiles inside a span and their levels of detail.
+   *
+   * @param eye camera position.
+   * @param pixelScale number of pixels one unit spans at unit distance (screen height divided by
+   *        twice the tangent of half vertical field of view).
+   * @param maxError maximum projected error in pixels.
+   * @param planes frustum planes, a point is inside iff it is on positive sides of all planes.
+   */
+  void select(const Point& eye, float pixelScale, float maxError,
+              int minX, int minY, int maxX, int maxY, const Plane* planes, int nPlanes);
+
+  /**
+   * Build index ranges and allocate an `nTiles_` x `nTiles_` tile grid.
+   */
+  void init(int nTiles_);
+
+  /**
+   * Free all storage.
+   */
+  void destroy();
+
+};
+
+}
+}
@@ -69,7 +69,7 @@ void VehicleAudio::play(const Object* playAt)
       hard_assert(0.0f <= event.intensity);
 
       recent[event.id] = RECENT_TICKS;
-      playSound(sounds[event.id], event.intensity, playAt);
+      playSound(sounds[event.id], event.intensity, playAt, event.id);
     }
   }
 
@@ -0,0 +1,129 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/VoicePool.cc
+ */
+
+#include <client/VoicePool.hh>
+
+namespace oz
+{
+namespace client
+{
+
+float VoicePool::priority(float gain, float distance, float refDistance, float rolloff,
+                          float weight)
+{
+  float clampedDistance = max(distance, refDistance);
+  float attenuation     = refDistance / (refDistance + rolloff * (clampedDistance - refDistance));
+
+  return weight * gain * attenuation;
+}
+
+int VoicePool::acquire(float priority, bool* isStolen)
+{
+  ++nRequests;
+  *isStolen = false;
+
+  if (!freeVoices.isEmpty()) {
+    int voice = freeVoices.popLast();
+
+    voices[voice].priority = priority;
+    voices[voice].isActive = true;
+
+    ++nActive;
+    nPeakActive = max(nPeakActive, nActive);
+    return voice;
+  }
+
+  int victim = NONE;
+
+  for (int i = 0; i < voices.length(); ++i) {
+    if (victim == NONE || voices[i].priority < voices[victim].priority) {
+      victim = i;
+    }
+  }
+
+  if (victim == NONE || voices[victim].priority >= priority) {
+    ++nDrops;
+    return NONE;
+  }
+
+  voices[victim].priority = priority;
+
+  ++nSteals;
+  *isStolen = true;
+  return victim;
+}
+
+void VoicePool::release(int voice)
+{
+  hard_assert(voices[voice].isActive);
+
+  voices[voice].isActive = false;
+  freeVoices.add(voice);
+
+  --nActive;
+}
+
+void VoicePool::setPriority(int voice, float priority)
+{
+  hard_assert(voices[voice].isActive);
+
+  voices[voice].priority = priority;
+}
+
+void VoicePool::resetCounters()
+{
+  nPeakActive = nActive;
+  nRequests   = 0;
+  nSteals     = 0;
+  nDrops      = 0;
+}
+
+void VoicePool::init(const uint* sources, int nSources)
+{
+  voices.resize(nSources, true);
+  freeVoices.clear();
+  freeVoices.reserve(nSources, true);
+
+  // Voices are handed out from the end of the free list, so reverse it to start with voice 0.
+  for (int i = 0; i < nSources; ++i) {
+    voices[i] = Voice{ sources[i], 0.0f, false };
+    freeVoices.add(nSources - 1 - i);
+  }
+
+  nActive = 0;
+  resetCounters();
+}
+
+void VoicePool::destroy()
+{
+  voices.clear();
+  voices.trim();
+  freeVoices.clear();
+  freeVoices.trim();
+
+  nActive = 0;
+}
+
+}
+}
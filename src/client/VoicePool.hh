@@ -0,0 +1,155 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/VoicePool.hh
+ *
+ * Prioritised pool of sound sources.
+ */
+
+#pragma once
+
+#include <ozCore/ozCore.hh>
+
+namespace oz
+{
+namespace client
+{
+
+/**
+ * Fixed pool of preallocated sound sources (voices) assigned by priority.
+ *
+ * When all voices are in use, a new request steals the voice with the lowest priority if that
+ * priority is lower than the requested one, otherwise the request is dropped. Owners release voices
+ * of finished sounds once per frame, so a request never has to query the backend. The pool only
+ * manages source ids it is given, so it can be tested headless.
+ */
+class VoicePool
+{
+public:
+
+  /// Invalid voice index.
+  static const int NONE = -1;
+
+private:
+
+  struct Voice
+  {
+    uint  source;
+    float priority;
+    bool  isActive;
+  };
+
+  List<Voice> voices;
+  List<int>   freeVoices;
+
+public:
+
+  int     nActive     = 0; ///< Number of voices in use.
+  int     nPeakActive = 0; ///< Peak number of voices in use.
+  ulong64 nRequests   = 0; ///< Number of requests.
+  ulong64 nSteals     = 0; ///< Number of requests that took a voice from a less important sound.
+  ulong64 nDrops      = 0; ///< Number of requests that were dropped.
+
+  /**
+   * Priority of a sound with given gain at a given distance under the OpenAL inverse distance
+   * clamped attenuation model, weighted by an importance factor.
+   */
+  static float priority(float gain, float distance, float refDistance, float rolloff,
+                        float weight);
+
+  /**
+   * Number of voices in the pool.
+   */
+  OZ_ALWAYS_INLINE
+  int length() const
+  {
+    return voices.length();
+  }
+
+  /**
+   * Backend source id of a voice.
+   */
+  OZ_ALWAYS_INLINE
+  uint source(int voice) const
+  {
+    return voices[voice].source;
+  }
+
+  /**
+   * Priority of a voice.
+   */
+  OZ_ALWAYS_INLINE
+  float priority(int voice) const
+  {
+    return voices[voice].priority;
+  }
+
+  /**
+   * True iff voice is in use.
+   */
+  OZ_ALWAYS_INLINE
+  bool isActive(int voice) const
+  {
+    return voices[voice].isActive;
+  }
+
+  /**
+   * Acquire a voice for a sound with a given priority.
+   *
+   * @param priority sound priority.
+   * @param isStolen set to true iff the returned voice was taken from a less important sound, which
+   *        the caller must stop and forget.
+   * @return voice index or `NONE` if the request is dropped.
+   */
+  int acquire(float priority, bool* isStolen);
+
+  /**
+   * Return a voice to the pool.
+   */
+  void release(int voice);
+
+  /**
+   * Update priority of an active voice, e.g. as a looping sound moves.
+   */
+  void setPriority(int voice, float priority);
+
+  /**
+   * Reset counters.
+   */
+  void resetCounters();
+
+  /**
+   * Create pool with given backend source ids.
+   *
+   * @param sources backend source ids.
+   * @param nSources number of sources.
+   */
+  void init(const uint* sources, int nSources);
+
+  /**
+   * Free pool storage.
+   */
+  void destroy();
+
+};
+
+}
+}
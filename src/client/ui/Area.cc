@@ -24,6 +24,7 @@
 #include <client/ui/Area.hh>
 
 #include <client/ui/Mouse.hh>
+#include <client/ui/TextBatch.hh>
 
 namespace oz
 {
@@ -99,6 +100,11 @@ void Area::drawChildren()
   // Render in opposite order; last added child (the first one in the list) should be rendered last.
   for (Area* child = children.last(); child != nullptr; child = child->prev[0]) {
     if (child->isVisible()) {
+      // Queued text must not end up on top of an area drawn over it.
+      if (textBatch.overlaps(child->x, child->y, child->width, child->height)) {
+        textBatch.flush();
+      }
+
       child->onDraw();
     }
   }
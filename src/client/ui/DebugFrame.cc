@@ -24,7 +24,9 @@
 #include <client/ui/DebugFrame.hh>
 
 #include <client/Camera.hh>
+#include <client/Model.hh>
 #include <client/ui/Style.hh>
+#include <client/ui/TextBatch.hh>
 
 namespace oz
 {
@@ -42,6 +44,19 @@ void DebugFrame::onDraw()
                     camera.rot.x, camera.rot.y, camera.rot.z, camera.rot.w);
   camPosRot.draw(this);
 
+  drawStats.setText("draws %d instances %d anims %d shared %d culled meshlets %d",
+                    Model::nDrawCalls, Model::nInstances, Model::nAnimations, Model::nAnimShared,
+                    Model::nCulledMeshlets);
+  drawStats.draw(this);
+
+  const GlyphAtlas& atlas    = textBatch.atlas;
+  ulong64           nLookups = atlas.nHits + atlas.nMisses;
+
+  textStats.setText("glyphs %d hits %.1f%% uploads %d text draws %d quads %d", atlas.length(),
+                    nLookups == 0 ? 100.0f : 100.0f * float(atlas.nHits) / float(nLookups),
+                    textBatch.nFrameUploads, textBatch.nFrameDrawCalls, textBatch.nFrameQuads);
+  textStats.draw(this);
+
   if (camera.bot >= 0) {
     const Bot* bot = static_cast<const Bot*>(camera.botObj);
 
@@ -95,7 +110,7 @@ void DebugFrame::onDraw()
 }
 
 DebugFrame::DebugFrame() :
-  Frame(560, 10 + 7 * (style.fonts[Font::MONO].height + 2), OZ_GETTEXT("Debug"))
+  Frame(560, 10 + 9 * (style.fonts[Font::MONO].height + 2), OZ_GETTEXT("Debug"))
 {
   flags |= PINNED_BIT;
 
@@ -103,6 +118,8 @@ DebugFrame::DebugFrame() :
 
   int height = style.fonts[Font::MONO].height + 2;
 
+  textStats     = Text(5, 5 + height * 8, 0, ALIGN_NONE, Font::MONO, "");
+  drawStats     = Text(5, 5 + height * 7, 0, ALIGN_NONE, Font::MONO, "");
   camPosRot     = Text(5, 5 + height * 6, 0, ALIGN_NONE, Font::MONO, "");
   botPosRot     = Text(5, 5 + height * 5, 0, ALIGN_NONE, Font::MONO, "");
   botVelMom     = Text(5, 5 + height * 4, 0, ALIGN_NONE, Font::MONO, "");
@@ -43,6 +43,8 @@ private:
   Text tagPos;
   Text tagVelMom;
   Text tagFlags;
+  Text drawStats;
+  Text textStats;
 
 protected:
 
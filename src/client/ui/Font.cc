@@ -41,28 +41,60 @@ void Font::sizeOf(const char* s, int* width, int* height) const
   TTF_SizeUTF8(font, s, width, height);
 }
 
-void Font::upload(const char* s, int* width, int* height) const
+int Font::lineHeight() const
 {
-  TTF_Font*    font = static_cast<TTF_Font*>(handle);
-  SDL_Surface* surf = width != nullptr && *width > 0 ?
-                      TTF_RenderUTF8_Blended_Wrapped(font, s, SDL_COLOUR_WHITE, *width) :
-                      TTF_RenderUTF8_Blended(font, s, SDL_COLOUR_WHITE);
+  return TTF_FontHeight(static_cast<TTF_Font*>(handle));
+}
 
-  if (surf == nullptr) {
-    OZ_ERROR("Failed to generate texture from text: %s", s);
+bool Font::rasterise(uint codePoint, GlyphAtlas::Bitmap* bitmap)
+{
+  TTF_Font* font = static_cast<TTF_Font*>(handle);
+
+  if (glyphSurface != nullptr) {
+    SDL_FreeSurface(static_cast<SDL_Surface*>(glyphSurface));
+    glyphSurface = nullptr;
   }
 
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, surf->w, surf->h, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-               surf->pixels);
+  // SDL_ttf glyph queries only take UCS-2 characters.
+  if (codePoint > 0xffff || !TTF_GlyphIsProvided(font, Uint16(codePoint))) {
+    return false;
+  }
+
+  int advance;
+  TTF_GlyphMetrics(font, Uint16(codePoint), nullptr, nullptr, nullptr, nullptr, &advance);
 
-  if (width != nullptr) {
-    *width = surf->w;
+  if (codePoint == ' ') {
+    *bitmap = { nullptr, 0, 0, 0, advance };
+    return true;
   }
-  if (height != nullptr) {
-    *height = surf->h;
+
+  char utf8[4];
+
+  if (codePoint < 0x80) {
+    utf8[0] = char(codePoint);
+    utf8[1] = '\0';
   }
+  else if (codePoint < 0x800) {
+    utf8[0] = char(0xc0 | codePoint >> 6);
+    utf8[1] = char(0x80 | (codePoint & 0x3f));
+    utf8[2] = '\0';
+  }
+  else {
+    utf8[0] = char(0xe0 | codePoint >> 12);
+    utf8[1] = char(0x80 | (codePoint >> 6 & 0x3f));
+    utf8[2] = char(0x80 | (codePoint & 0x3f));
+    utf8[3] = '\0';
+  }
+
+  SDL_Surface* surf = TTF_RenderUTF8_Blended(font, utf8, SDL_COLOUR_WHITE);
+  if (surf == nullptr) {
+    return false;
+  }
+
+  glyphSurface = surf;
 
-  SDL_FreeSurface(surf);
+  *bitmap = { static_cast<const char*>(surf->pixels), surf->w, surf->h, surf->pitch, advance };
+  return true;
 }
 
 void Font::init(const char* name, int height_)
@@ -86,6 +118,11 @@ void Font::init(const char* name, int height_)
 
 void Font::destroy()
 {
+  if (glyphSurface != nullptr) {
+    SDL_FreeSurface(static_cast<SDL_Surface*>(glyphSurface));
+    glyphSurface = nullptr;
+  }
+
   if (handle != nullptr) {
     TTF_Font* font = static_cast<TTF_Font*>(handle);
 
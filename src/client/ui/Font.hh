@@ -24,6 +24,7 @@
 #pragma once
 
 #include <client/common.hh>
+#include <client/ui/GlyphAtlas.hh>
 
 namespace oz
 {
@@ -32,7 +33,7 @@ namespace client
 namespace ui
 {
 
-class Font
+class Font : public GlyphAtlas::Source
 {
 public:
 
@@ -48,7 +49,8 @@ public:
 
 private:
 
-  void*  handle;
+  void*  handle       = nullptr;
+  void*  glyphSurface = nullptr;
   Stream fileBuffer;
 
 public:
@@ -63,12 +65,14 @@ public:
   void sizeOf(const char* s, int* width = nullptr, int* height = nullptr) const;
 
   /**
-   * Generate texture data for the given text and upload it via `glTexImage2D`.
-   *
-   * `*width` and `*height` are set to the final texture size if not null. `*width` is also an
-   * input parameter; if it is > 0, the text is wrapped to `*width` pixels.
+   * Height of a line of text in pixels.
    */
-  void upload(const char* s, int* width = nullptr, int* height = nullptr) const;
+  int lineHeight() const override;
+
+  /**
+   * Render a single glyph for the glyph atlas.
+   */
+  bool rasterise(uint codePoint, GlyphAtlas::Bitmap* bitmap) override;
 
   void init(const char* name, int height);
   void destroy();
@@ -0,0 +1,304 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/ui/GlyphAtlas.cc
+ */
+
+#include <client/ui/GlyphAtlas.hh>
+
+#include <cstring>
+
+namespace oz
+{
+namespace client
+{
+namespace ui
+{
+
+static const uint REPLACEMENT_CHAR = 0xfffd;
+
+OZ_ALWAYS_INLINE
+static inline uint glyphKey(int font, uint codePoint)
+{
+  return uint(font) << 24 | codePoint;
+}
+
+GlyphAtlas::Source::~Source()
+{}
+
+uint GlyphAtlas::decodeUTF8(const char** s)
+{
+  const ubyte* bytes = reinterpret_cast<const ubyte*>(*s);
+  uint         c     = bytes[0];
+  int          nTail;
+  uint         minValue;
+
+  if (c < 0x80) {
+    *s += 1;
+    return c;
+  }
+  else if ((c & 0xe0) == 0xc0) {
+    c        &= 0x1f;
+    nTail     = 1;
+    minValue  = 0x80;
+  }
+  else if ((c & 0xf0) == 0xe0) {
+    c        &= 0x0f;
+    nTail     = 2;
+    minValue  = 0x800;
+  }
+  else if ((c & 0xf8) == 0xf0) {
+    c        &= 0x07;
+    nTail     = 3;
+    minValue  = 0x10000;
+  }
+  else {
+    *s += 1;
+    return REPLACEMENT_CHAR;
+  }
+
+  for (int i = 1; i <= nTail; ++i) {
+    if ((bytes[i] & 0xc0) != 0x80) {
+      *s += 1;
+      return REPLACEMENT_CHAR;
+    }
+    c = c << 6 | (bytes[i] & 0x3f);
+  }
+
+  *s += 1 + nTail;
+  return c < minValue || c > 0x10ffff ? REPLACEMENT_CHAR : c;
+}
+
+const GlyphAtlas::Glyph* GlyphAtlas::find(int font, uint codePoint) const
+{
+  return glyphs.find(glyphKey(font, codePoint));
+}
+
+const GlyphAtlas::Glyph* GlyphAtlas::get(Source* source, int font, uint codePoint)
+{
+  hard_assert(uint(font) < uint(MAX_FONTS));
+
+  uint         key   = glyphKey(font, codePoint);
+  const Glyph* glyph = glyphs.find(key);
+
+  if (glyph != nullptr) {
+    ++nHits;
+    return glyph;
+  }
+
+  ++nMisses;
+
+  Bitmap bitmap;
+  if (!source->rasterise(codePoint, &bitmap)) {
+    return &glyphs.add(key, Glyph{ 0, 0, 0, 0, 0 }).value;
+  }
+
+  if (bitmap.width == 0 || bitmap.height == 0) {
+    return &glyphs.add(key, Glyph{ 0, 0, 0, 0, short(bitmap.advance) }).value;
+  }
+
+  // Glyphs are separated by one pixel so linear filtering does not bleed between them.
+  if (shelfX + bitmap.width > size) {
+    shelfX      = 0;
+    shelfY     += shelfHeight + 1;
+    shelfHeight = 0;
+  }
+  if (bitmap.width > size || shelfY + bitmap.height > size) {
+    return nullptr;
+  }
+
+  for (int y = 0; y < bitmap.height; ++y) {
+    memcpy(&pixels[((shelfY + y) * size + shelfX) * 4], bitmap.pixels + y * bitmap.pitch,
+           size_t(bitmap.width) * 4);
+  }
+
+  if (dirtyMinY == dirtyMaxY) {
+    dirtyMinY = shelfY;
+    dirtyMaxY = shelfY + bitmap.height;
+  }
+  else {
+    dirtyMinY = min(dirtyMinY, shelfY);
+    dirtyMaxY = max(dirtyMaxY, shelfY + bitmap.height);
+  }
+
+  Glyph newGlyph = {
+    short(shelfX), short(shelfY), short(bitmap.width), short(bitmap.height), short(bitmap.advance)
+  };
+
+  shelfX     += bitmap.width + 1;
+  shelfHeight = max(shelfHeight, bitmap.height);
+
+  return &glyphs.add(key, newGlyph).value;
+}
+
+void GlyphAtlas::layout(Source* source, int font, const char* s, int wrapWidth,
+                        List<Quad>* quads, int* width, int* height)
+{
+  int  lineHeight = source->lineHeight();
+  bool hasReset   = false;
+
+restart:
+
+  quads->clear();
+
+  int nLines    = 1;
+  int penX      = 0;
+  int penY      = 0;
+  int breakQuad = -1;
+  int breakX    = 0;
+  int maxWidth  = 0;
+
+  for (const char* p = s; *p != '\0';) {
+    uint c = decodeUTF8(&p);
+
+    if (c == '\n') {
+      penX      = 0;
+      penY     += lineHeight;
+      breakQuad = -1;
+      ++nLines;
+      continue;
+    }
+
+    const Glyph* glyph = get(source, font, c);
+
+    if (glyph == nullptr) {
+      if (!hasReset) {
+        hasReset = true;
+
+        ++nResets;
+        if (onReset != nullptr) {
+          onReset(onResetData);
+        }
+        clear();
+        goto restart;
+      }
+      continue;
+    }
+
+    // Move the last word to a new line.
+    if (wrapWidth > 0 && c != ' ' && penX + glyph->advance > wrapWidth && breakQuad >= 0) {
+      for (int i = breakQuad; i < quads->length(); ++i) {
+        (*quads)[i].x = short((*quads)[i].x - breakX);
+        (*quads)[i].y = short((*quads)[i].y + lineHeight);
+      }
+
+      penX     -= breakX;
+      penY     += lineHeight;
+      breakQuad = -1;
+      ++nLines;
+    }
+
+    if (glyph->width != 0) {
+      quads->add(Quad{ short(penX), short(penY), glyph->width, glyph->height, glyph->x, glyph->y });
+    }
+
+    penX += glyph->advance;
+
+    if (c == ' ') {
+      breakQuad = quads->length();
+      breakX    = penX;
+    }
+  }
+
+  for (const Quad& quad : *quads) {
+    maxWidth = max(maxWidth, quad.x + quad.width);
+  }
+
+  *width  = maxWidth;
+  *height = nLines * lineHeight;
+}
+
+bool GlyphAtlas::takeDirtyRows(int* minY, int* maxY)
+{
+  if (dirtyMinY == dirtyMaxY) {
+    return false;
+  }
+
+  *minY = dirtyMinY;
+  *maxY = dirtyMaxY;
+
+  ++nUploads;
+  nUploadedBytes += ulong64(dirtyMaxY - dirtyMinY) * ulong64(size) * 4;
+
+  dirtyMinY = 0;
+  dirtyMaxY = 0;
+  return true;
+}
+
+void GlyphAtlas::clear()
+{
+  glyphs.clear();
+
+  shelfX      = 0;
+  shelfY      = 0;
+  shelfHeight = 0;
+
+  ++generation;
+}
+
+void GlyphAtlas::resetCounters()
+{
+  nHits          = 0;
+  nMisses        = 0;
+  nResets        = 0;
+  nUploads       = 0;
+  nUploadedBytes = 0;
+}
+
+void GlyphAtlas::init(int size_, ResetFunc* onReset_, void* onResetData_)
+{
+  hard_assert(size_ > 0 && size_ <= SHRT_MAX);
+
+  size        = size_;
+  onReset     = onReset_;
+  onResetData = onResetData_;
+  pixels.resize(size * size * 4, true);
+  memset(pixels.begin(), 0, size_t(pixels.length()));
+
+  glyphs.clear();
+
+  shelfX      = 0;
+  shelfY      = 0;
+  shelfHeight = 0;
+  dirtyMinY   = 0;
+  dirtyMaxY   = size;
+
+  ++generation;
+  resetCounters();
+}
+
+void GlyphAtlas::destroy()
+{
+  glyphs.clear();
+  glyphs.trim();
+  pixels.clear();
+  pixels.trim();
+
+  size        = 0;
+  dirtyMinY   = 0;
+  dirtyMaxY   = 0;
+  onReset     = nullptr;
+  onResetData = nullptr;
+}
+
+}
+}
+}
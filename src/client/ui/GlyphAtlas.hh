@@ -0,0 +1,249 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/ui/GlyphAtlas.hh
+ *
+ * Glyph cache and text layout.
+ */
+
+#pragma once
+
+#include <ozCore/ozCore.hh>
+
+namespace oz
+{
+namespace client
+{
+namespace ui
+{
+
+/**
+ * Cache of rasterised glyphs for all fonts packed into one RGBA texture image.
+ *
+ * Text is laid out into quads that reference glyph rectangles in the atlas, so any number of
+ * labels can be drawn with a single texture and a single vertex batch. Glyphs are rasterised on
+ * first use by a `Source` and packed into shelves. When the atlas is full, the reset callback is
+ * given a chance to draw pending text, then the atlas is cleared and `generation` increases, which
+ * tells users to lay their text out again. The atlas only keeps
+ * pixels in memory and records which rows changed; uploading them is left to the renderer, so
+ * layout can be tested headless.
+ */
+class GlyphAtlas
+{
+public:
+
+  /// Default atlas width and height.
+  static const int DEFAULT_SIZE = 1024;
+
+  /// Maximum number of fonts (font index is stored in the upper byte of a glyph key).
+  static const int MAX_FONTS = 256;
+
+  /**
+   * Function called before a full atlas is cleared, while queued quads still match its pixels.
+   */
+  typedef void ResetFunc(void* data);
+
+  /**
+   * Glyph image produced by a `Source`.
+   */
+  struct Bitmap
+  {
+    const char* pixels;  ///< RGBA pixels, top row first.
+    int         width;   ///< Width in pixels.
+    int         height;  ///< Height in pixels.
+    int         pitch;   ///< Bytes per row.
+    int         advance; ///< Horizontal pen advance.
+  };
+
+  /**
+   * Font rasteriser.
+   */
+  class Source
+  {
+  public:
+
+    /**
+     * Virtual destructor.
+     */
+    virtual ~Source();
+
+    /**
+     * Line height in pixels.
+     */
+    virtual int lineHeight() const = 0;
+
+    /**
+     * Rasterise a glyph.
+     *
+     * `bitmap` must stay valid until the next call. A glyph without pixels (e.g. a space) should
+     * return zero width and height.
+     *
+     * @return false if the font cannot render the code point.
+     */
+    virtual bool rasterise(uint codePoint, Bitmap* bitmap) = 0;
+  };
+
+  /**
+   * Cached glyph.
+   */
+  struct Glyph
+  {
+    short x;       ///< Left edge in the atlas.
+    short y;       ///< Top edge in the atlas.
+    short width;   ///< Width in pixels.
+    short height;  ///< Height in pixels.
+    short advance; ///< Horizontal pen advance.
+  };
+
+  /**
+   * Laid out glyph, positions are relative to the top-left corner of the text, y points down.
+   */
+  struct Quad
+  {
+    short x;
+    short y;
+    short width;
+    short height;
+    short u;       ///< Left edge in the atlas.
+    short v;       ///< Top edge in the atlas.
+  };
+
+private:
+
+  FlatHashMap<uint, Glyph> glyphs;
+  List<char>               pixels;
+  int                      size        = 0;
+  int                      shelfX      = 0;
+  int                      shelfY      = 0;
+  int                      shelfHeight = 0;
+  int                      dirtyMinY   = 0;
+  int                      dirtyMaxY   = 0;
+  ResetFunc*               onReset     = nullptr;
+  void*                    onResetData = nullptr;
+
+public:
+
+  int     generation     = 0; ///< Increased every time the atlas is cleared.
+  ulong64 nHits          = 0; ///< Number of glyph lookups found in the atlas.
+  ulong64 nMisses        = 0; ///< Number of glyphs rasterised.
+  ulong64 nResets        = 0; ///< Number of times a full atlas was cleared.
+  ulong64 nUploads       = 0; ///< Number of dirty regions taken for upload.
+  ulong64 nUploadedBytes = 0; ///< Amount of pixel data taken for upload.
+
+public:
+
+  /**
+   * Decode the next code point from an UTF-8 string and advance the pointer.
+   *
+   * Invalid sequences decode to U+FFFD, one byte at a time.
+   */
+  static uint decodeUTF8(const char** s);
+
+  /**
+   * Atlas width and height.
+   */
+  OZ_ALWAYS_INLINE
+  int dim() const
+  {
+    return size;
+  }
+
+  /**
+   * RGBA pixels of the whole atlas.
+   */
+  OZ_ALWAYS_INLINE
+  const char* image() const
+  {
+    return pixels.begin();
+  }
+
+  /**
+   * Number of cached glyphs.
+   */
+  OZ_ALWAYS_INLINE
+  int length() const
+  {
+    return glyphs.length();
+  }
+
+  /**
+   * Cached glyph or `nullptr`, without touching counters.
+   */
+  const Glyph* find(int font, uint codePoint) const;
+
+  /**
+   * Cached glyph, rasterised and packed on a miss.
+   *
+   * Code points the source cannot render are cached as empty glyphs with zero advance.
+   *
+   * @return `nullptr` if the atlas is full.
+   */
+  const Glyph* get(Source* source, int font, uint codePoint);
+
+  /**
+   * Lay out an UTF-8 string.
+   *
+   * Lines are broken at '\n' and, when `wrapWidth` > 0, at the last space before a line would
+   * exceed `wrapWidth`. If the atlas fills up, the reset callback is called, the atlas is cleared
+   * once and layout starts over.
+   *
+   * @param quads receives quads, previous content is discarded.
+   * @param width receives width of the widest line.
+   * @param height receives number of lines times line height.
+   */
+  void layout(Source* source, int font, const char* s, int wrapWidth, List<Quad>* quads,
+              int* width, int* height);
+
+  /**
+   * Take the range of rows changed since the last call.
+   *
+   * @return false if nothing changed.
+   */
+  bool takeDirtyRows(int* minY, int* maxY);
+
+  /**
+   * Drop all glyphs and increase generation.
+   */
+  void clear();
+
+  /**
+   * Reset counters.
+   */
+  void resetCounters();
+
+  /**
+   * Allocate an empty atlas.
+   *
+   * @param onReset function called before a full atlas is cleared during layout, may be `nullptr`.
+   * @param onResetData user data passed to `onReset`.
+   */
+  void init(int size = DEFAULT_SIZE, ResetFunc* onReset = nullptr, void* onResetData = nullptr);
+
+  /**
+   * Free atlas storage.
+   */
+  void destroy();
+
+};
+
+}
+}
+}
@@ -23,10 +23,9 @@
 
 #include <client/ui/Text.hh>
 
-#include <client/Shader.hh>
-#include <client/Shape.hh>
 #include <client/ui/Area.hh>
 #include <client/ui/Style.hh>
+#include <client/ui/TextBatch.hh>
 
 namespace oz
 {
@@ -54,14 +53,23 @@ void Text::realign()
   }
 }
 
+void Text::layout()
+{
+  textBatch.atlas.layout(&style.fonts[font], font, text, width, &quads, &texWidth, &texHeight);
+  atlasGeneration = textBatch.atlas.generation;
+
+  realign();
+}
+
 Text::Text() :
   x(0), y(0), width(0), align(Area::ALIGN_NONE), font(Font::MONO),
-  lastHash(Hash<const char*>::EMPTY), texX(0), texY(0), texWidth(0), texHeight(0), texId(0)
+  lastHash(Hash<const char*>::EMPTY), texX(0), texY(0), texWidth(0), texHeight(0),
+  atlasGeneration(0)
 {}
 
 Text::Text(int x_, int y_, int width_, int align_, Font::Type font_, const char* s, ...) :
   x(x_), y(y_), width(width_), align(align_), font(font_), lastHash(Hash<const char*>::EMPTY),
-  texX(0), texY(0), texWidth(0), texHeight(0), texId(0)
+  texX(0), texY(0), texWidth(0), texHeight(0), atlasGeneration(0)
 {
   va_list ap;
   va_start(ap, s);
@@ -76,7 +84,9 @@ Text::~Text()
 
 Text::Text(Text&& l) :
   x(l.x), y(l.y), width(l.width), align(l.align), font(l.font), lastHash(l.lastHash),
-  texX(l.texX), texY(l.texY), texWidth(l.texWidth), texHeight(l.texHeight), texId(l.texId)
+  texX(l.texX), texY(l.texY), texWidth(l.texWidth), texHeight(l.texHeight),
+  text(static_cast<String&&>(l.text)), quads(static_cast<List<GlyphAtlas::Quad>&&>(l.quads)),
+  atlasGeneration(l.atlasGeneration)
 {
   l.x         = 0;
   l.y         = 0;
@@ -88,7 +98,8 @@ Text::Text(Text&& l) :
   l.texY      = 0;
   l.texWidth  = 0;
   l.texHeight = 0;
-  l.texId     = 0;
+
+  l.atlasGeneration = 0;
 }
 
 Text& Text::operator = (Text&& l)
@@ -109,7 +120,10 @@ Text& Text::operator = (Text&& l)
   texY      = l.texY;
   texWidth  = l.texWidth;
   texHeight = l.texHeight;
-  texId     = l.texId;
+  text      = static_cast<String&&>(l.text);
+  quads     = static_cast<List<GlyphAtlas::Quad>&&>(l.quads);
+
+  atlasGeneration = l.atlasGeneration;
 
   l.x         = 0;
   l.y         = 0;
@@ -121,7 +135,8 @@ Text& Text::operator = (Text&& l)
   l.texY      = 0;
   l.texWidth  = 0;
   l.texHeight = 0;
-  l.texId     = 0;
+
+  l.atlasGeneration = 0;
 
   return *this;
 }
@@ -171,23 +186,11 @@ void Text::setTextv(const char* s, va_list ap)
 
     if (newHash != lastHash) {
       lastHash = newHash;
-      texWidth = width;
+      text     = buffer;
 
       MainCall() << [&]
       {
-        if (texId == 0) {
-          glGenTextures(1, &texId);
-        }
-
-        glBindTexture(GL_TEXTURE_2D, texId);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-        style.fonts[font].upload(buffer, &texWidth, &texHeight);
-
-        glBindTexture(GL_TEXTURE_2D, shader.defaultTexture);
-
-        realign();
+        layout();
       };
     }
   }
@@ -203,37 +206,31 @@ void Text::setText(const char* s, ...)
 
 void Text::draw(const Area* area)
 {
-  if (texId == 0) {
+  if (text.isEmpty()) {
     return;
   }
 
+  if (atlasGeneration != textBatch.atlas.generation) {
+    layout();
+  }
+
   int posX = area->x + (x < 0 ? area->width  + texX : texX);
   int posY = area->y + (y < 0 ? area->height + texY : texY);
 
-  glBindTexture(GL_TEXTURE_2D, texId);
-
-  shape.colour(style.colours.textBackground);
-  shape.fill(posX + 1, posY - 1, texWidth, texHeight);
-  shape.colour(style.colours.text);
-  shape.fill(posX, posY, texWidth, texHeight);
-
-  glBindTexture(GL_TEXTURE_2D, shader.defaultTexture);
+  textBatch.add(quads, posX, posY, texHeight);
 }
 
 void Text::clear()
 {
-  if (texId != 0) {
-    MainCall() << [&]
-    {
-      glDeleteTextures(1, &texId);
-    };
-
+  if (!text.isEmpty()) {
     lastHash  = Hash<const char*>::EMPTY;
     texX      = x;
     texY      = y;
     texWidth  = 0;
     texHeight = 0;
-    texId     = 0;
+    text      = "";
+
+    quads.clear();
   }
 }
 
@@ -38,22 +38,26 @@ class Text
 {
 private:
 
-  int        x;
-  int        y;
-  int        width;
-  int        align;
-  Font::Type font;
-  int        lastHash;
-
-  int        texX;
-  int        texY;
-  int        texWidth;
-  int        texHeight;
-  uint       texId;
+  int                    x;
+  int                    y;
+  int                    width;
+  int                    align;
+  Font::Type             font;
+  int                    lastHash;
+
+  int                    texX;
+  int                    texY;
+  int                    texWidth;
+  int                    texHeight;
+
+  String                 text;
+  List<GlyphAtlas::Quad> quads;
+  int                    atlasGeneration;
 
 private:
 
   void realign();
+  void layout();
 
 public:
 
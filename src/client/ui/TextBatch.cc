@@ -0,0 +1,229 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/ui/TextBatch.cc
+ */
+
+#include <client/ui/TextBatch.hh>
+
+#include <client/Shader.hh>
+#include <client/Shape.hh>
+#include <client/ui/Style.hh>
+
+namespace oz
+{
+namespace client
+{
+namespace ui
+{
+
+// Quads queued earlier in the frame reference glyphs that a full atlas is about to overwrite.
+static void flushBeforeReset(void* batch)
+{
+  static_cast<TextBatch*>(batch)->flush();
+}
+
+void TextBatch::add(const List<GlyphAtlas::Quad>& quads, int x, int y, int height)
+{
+  if (quads.isEmpty()) {
+    return;
+  }
+
+  float scale = 1.0f / float(atlas.dim());
+  int   top   = y + height;
+
+  if (vertices.isEmpty()) {
+    textMinX = x;
+    textMinY = y - 1;
+    textMaxX = x;
+    textMaxY = top;
+  }
+  else {
+    textMinX = min(textMinX, x);
+    textMinY = min(textMinY, y - 1);
+    textMaxY = max(textMaxY, top);
+  }
+
+  for (const GlyphAtlas::Quad& quad : quads) {
+    float minX = float(x + quad.x);
+    float maxX = float(x + quad.x + quad.width);
+    float maxY = float(top - quad.y);
+    float minY = float(top - quad.y - quad.height);
+    float minU = float(quad.u) * scale;
+    float maxU = float(quad.u + quad.width) * scale;
+    float minV = float(quad.v) * scale;
+    float maxV = float(quad.v + quad.height) * scale;
+
+    vertices.add(Vertex{ { minX, minY }, { minU, maxV } });
+    vertices.add(Vertex{ { maxX, minY }, { maxU, maxV } });
+    vertices.add(Vertex{ { maxX, maxY }, { maxU, minV } });
+    vertices.add(Vertex{ { minX, maxY }, { minU, minV } });
+
+    textMaxX = max(textMaxX, x + quad.x + quad.width + 1);
+  }
+}
+
+bool TextBatch::overlaps(int x, int y, int width, int height) const
+{
+  return !vertices.isEmpty() &&
+         textMinX < x + width && x < textMaxX && textMinY < y + height && y < textMaxY;
+}
+
+void TextBatch::flush()
+{
+  if (vertices.isEmpty()) {
+    return;
+  }
+
+  glBindTexture(GL_TEXTURE_2D, texId);
+
+  int minY, maxY;
+  if (atlas.takeDirtyRows(&minY, &maxY)) {
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, minY, atlas.dim(), maxY - minY, GL_RGBA,
+                    GL_UNSIGNED_BYTE, atlas.image() + minY * atlas.dim() * 4);
+    ++nUploads;
+  }
+
+  // Orphan the previous buffer contents, so the driver need not wait for pending draws.
+  int size = vertices.length() * int(sizeof(Vertex));
+
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices.begin());
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+
+  int nBatchQuads = vertices.length() / 4;
+
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass == 0) {
+      tf.model = Mat4::translation(Vec3(1.0f, -1.0f, 0.0f));
+      tf.apply();
+      shape.colour(style.colours.textBackground);
+    }
+    else {
+      tf.model = Mat4::ID;
+      tf.apply();
+      shape.colour(style.colours.text);
+    }
+
+    for (int first = 0; first < nBatchQuads; first += MAX_QUADS) {
+      int   nChunkQuads = min(nBatchQuads - first, MAX_QUADS);
+      char* base        = static_cast<char*>(nullptr) + first * 4 * sizeof(Vertex);
+
+      glVertexAttribPointer(Shader::POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                            base + offsetof(Vertex, pos));
+      glVertexAttribPointer(Shader::TEXCOORD, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                            base + offsetof(Vertex, texCoord));
+
+      glDrawElements(GL_TRIANGLES, nChunkQuads * 6, GL_UNSIGNED_SHORT, nullptr);
+      ++nDrawCalls;
+    }
+  }
+
+  nQuads += nBatchQuads;
+  vertices.clear();
+
+  glBindTexture(GL_TEXTURE_2D, shader.defaultTexture);
+
+  // Restore shape buffers and attribute layout for the rest of the UI.
+  shape.bind();
+}
+
+void TextBatch::beginFrame()
+{
+  nFrameQuads     = nQuads;
+  nFrameDrawCalls = nDrawCalls;
+  nFrameUploads   = nUploads;
+
+  nQuads     = 0;
+  nDrawCalls = 0;
+  nUploads   = 0;
+}
+
+void TextBatch::init()
+{
+  atlas.init(GlyphAtlas::DEFAULT_SIZE, flushBeforeReset, this);
+
+  List<ushort> indices(MAX_QUADS * 6);
+
+  for (int i = 0; i < MAX_QUADS; ++i) {
+    ushort base = ushort(i * 4);
+
+    indices[i * 6 + 0] = ushort(base + 0);
+    indices[i * 6 + 1] = ushort(base + 1);
+    indices[i * 6 + 2] = ushort(base + 2);
+    indices[i * 6 + 3] = ushort(base + 0);
+    indices[i * 6 + 4] = ushort(base + 2);
+    indices[i * 6 + 5] = ushort(base + 3);
+  }
+
+  MainCall() << [&]
+  {
+    glGenTextures(1, &texId);
+    glBindTexture(GL_TEXTURE_2D, texId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas.dim(), atlas.dim(), 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, atlas.image());
+    glBindTexture(GL_TEXTURE_2D, shader.defaultTexture);
+
+    glGenBuffers(1, &vbo);
+
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.length() * int(sizeof(ushort)), indices.begin(),
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  };
+
+  // The whole image has just been uploaded.
+  int minY, maxY;
+  atlas.takeDirtyRows(&minY, &maxY);
+  atlas.resetCounters();
+}
+
+void TextBatch::destroy()
+{
+  MainCall() << [&]
+  {
+    if (texId != 0) {
+      glDeleteBuffers(1, &ibo);
+      glDeleteBuffers(1, &vbo);
+      glDeleteTextures(1, &texId);
+
+      ibo   = 0;
+      vbo   = 0;
+      texId = 0;
+    }
+  };
+
+  vertices.clear();
+  vertices.trim();
+  atlas.destroy();
+}
+
+TextBatch textBatch;
+
+}
+}
+}
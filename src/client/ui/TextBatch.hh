@@ -0,0 +1,110 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file client/ui/TextBatch.hh
+ *
+ * Batched UI text rendering.
+ */
+
+#pragma once
+
+#include <client/ui/GlyphAtlas.hh>
+#include <client/common.hh>
+
+namespace oz
+{
+namespace client
+{
+namespace ui
+{
+
+/**
+ * Collects laid out text from all labels and draws it from the glyph atlas texture at once.
+ *
+ * Normally all UI text is drawn by one flush at the end of the frame. An area is only preceded by
+ * a flush if it overlaps text that is already queued, so windows stacked over each other still
+ * cover the text beneath them. A full glyph atlas also flushes queued text before it is cleared.
+ */
+class TextBatch
+{
+private:
+
+  /// Quads per draw call, limited by 16-bit indices.
+  static const int MAX_QUADS = 16384;
+
+  struct Vertex
+  {
+    float pos[2];
+    float texCoord[2];
+  };
+
+  List<Vertex> vertices;
+  uint         texId = 0;
+  uint         vbo   = 0;
+  uint         ibo   = 0;
+
+  int          textMinX   = 0;  ///< Bounds of queued text, including shadow.
+  int          textMinY   = 0;
+  int          textMaxX   = 0;
+  int          textMaxY   = 0;
+
+  int          nQuads     = 0;
+  int          nDrawCalls = 0;
+  int          nUploads   = 0;
+
+public:
+
+  GlyphAtlas   atlas;
+
+  int          nFrameQuads     = 0; ///< Number of glyph quads drawn in the last frame.
+  int          nFrameDrawCalls = 0; ///< Number of text draw calls in the last frame.
+  int          nFrameUploads   = 0; ///< Number of atlas texture uploads in the last frame.
+
+  /**
+   * Queue quads of a text whose bottom-left corner is at (x, y).
+   */
+  void add(const List<GlyphAtlas::Quad>& quads, int x, int y, int height);
+
+  /**
+   * True iff a rectangle overlaps bounds of queued text.
+   */
+  bool overlaps(int x, int y, int width, int height) const;
+
+  /**
+   * Upload new glyphs and draw queued text with its shadow.
+   */
+  void flush();
+
+  /**
+   * Move counters of the current frame to the last-frame ones.
+   */
+  void beginFrame();
+
+  void init();
+  void destroy();
+
+};
+
+extern TextBatch textBatch;
+
+}
+}
+}
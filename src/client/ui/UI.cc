@@ -28,6 +28,7 @@
 #include <client/Context.hh>
 #include <client/Shape.hh>
 #include <client/ui/Style.hh>
+#include <client/ui/TextBatch.hh>
 #include <client/ui/LoadingArea.hh>
 #include <client/ui/StrategicArea.hh>
 #include <client/ui/HudArea.hh>
@@ -116,8 +117,9 @@ void UI::draw()
 
   shader.program(shader.plain);
 
+  textBatch.beginFrame();
+
   root->drawChildren();
-  mouse.draw();
 
   if (showFPS) {
     if (timer.frameTicks != 0) {
@@ -128,6 +130,10 @@ void UI::draw()
     fpsLabel->draw(root);
   }
 
+  textBatch.flush();
+
+  mouse.draw();
+
   shape.unbind();
 
   OZ_GL_CHECK_ERROR();
@@ -170,10 +176,25 @@ void UI::load()
   buildFrame->enable(false);
 
   loadingScreen->raise();
+
+  textBatch.atlas.resetCounters();
 }
 
 void UI::unload()
 {
+  const GlyphAtlas& atlas = textBatch.atlas;
+
+  Log::println("Glyph atlas {");
+  Log::indent();
+  Log::println("%6d  glyphs",        atlas.length());
+  Log::println("%6lu  hits",         ulong(atlas.nHits));
+  Log::println("%6lu  misses",       ulong(atlas.nMisses));
+  Log::println("%6lu  resets",       ulong(atlas.nResets));
+  Log::println("%6lu  uploads",      ulong(atlas.nUploads));
+  Log::println("%6.2f  MB uploaded", float(atlas.nUploadedBytes) / float(1024 * 1024));
+  Log::unindent();
+  Log::println("}");
+
   if (debugFrame != nullptr) {
     root->remove(debugFrame);
     debugFrame = nullptr;
@@ -221,6 +242,7 @@ void UI::init()
   isVisible     = true;
 
   style.init();
+  textBatch.init();
   mouse.init();
 
   root = new Area(camera.width, camera.height);
@@ -242,6 +264,7 @@ void UI::destroy()
   fpsLabel = nullptr;
 
   mouse.destroy();
+  textBatch.destroy();
   style.destroy();
 
   context.clearSounds();
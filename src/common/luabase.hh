@@ -45,6 +45,7 @@
 
 #if LUA_VERSION_NUM < 502 && !defined(DOXYGEN_IGNORE)
 # define LUA_OK 0
+# define lua_rawlen lua_objlen
 #endif
 
 /**
@@ -120,12 +121,9 @@
  * indices.
  */
 #define STR_INDEX(index) \
-  if (uint(index) >= uint(Orbis::MAX_STRUCTS)) { \
-    ERROR("Invalid structure index (out of range)"); \
-  } \
   Struct* str = orbis.str(index); \
   if (str == nullptr) { \
-    ERROR("Invalid structures index (null)"); \
+    ERROR("Invalid structure index (null or removed)"); \
   }
 
 /**
@@ -183,12 +181,9 @@
  * indices.
  */
 #define OBJ_INDEX(index) \
-  if (uint(index) >= uint(Orbis::MAX_OBJECTS)) { \
-    ERROR("Invalid object index (out of range)"); \
-  } \
   Object* obj = orbis.obj(index); \
   if (obj == nullptr) { \
-    ERROR("Invalid object index (null)"); \
+    ERROR("Invalid object index (null or removed)"); \
   }
 
 /**
@@ -197,12 +192,9 @@
  * or objects that are not items.
  */
 #define ITEM_INDEX(index) \
-  if (uint(index) >= uint(Orbis::MAX_OBJECTS)) { \
-    ERROR("Invalid item index (out of range)"); \
-  } \
   Dynamic* item = orbis.obj<Dynamic>(index); \
   if (item == nullptr) { \
-    ERROR("Invalid item index (null)"); \
+    ERROR("Invalid item index (null or removed)"); \
   } \
   if (!(item->flags & Object::ITEM_BIT)) { \
     ERROR("Invalid item index (not an item)"); \
@@ -214,12 +206,9 @@
  * or objects that are not bots.
  */
 #define BOT_INDEX(index) \
-  if (uint(index) >= uint(Orbis::MAX_OBJECTS)) { \
-    ERROR("Invalid bot index (out of range)"); \
-  } \
   Bot* bot = orbis.obj<Bot>(index); \
   if (bot == nullptr) { \
-    ERROR("Invalid bot index (null)"); \
+    ERROR("Invalid bot index (null or removed)"); \
   } \
   if (!(bot->flags & Object::BOT_BIT)) { \
     ERROR("Invalid bot index (not a bot)"); \
@@ -437,6 +426,13 @@
 #define l_rawset(t) \
   lua_rawset(l, t)
 
+/**
+ * @def l_rawlen
+ * Shorthand for lua_rawlen (plus cast to int)
+ */
+#define l_rawlen(t) \
+  int(lua_rawlen(l, t))
+
 /**
  * @def l_rawgeti
  * Shorthand for lua_rawgeti
@@ -451,6 +447,13 @@
 #define l_rawseti(t, i) \
   lua_rawseti(l, t, i)
 
+/**
+ * @def l_getref
+ * Pushes a value referenced in the registry (e.g. by `Lua::functionRef()`)
+ */
+#define l_getref(ref) \
+  lua_rawgeti(l, LUA_REGISTRYINDEX, ref)
+
 /**
  * @def l_getglobal
  * Shorthand for lua_getglobal
@@ -86,6 +86,9 @@ public:
   String mind;
   int    mindAutomaton;
 
+  // Lua registry reference to the `mind` function, resolved by `LuaNirvana::init()`.
+  mutable int mindRef = -1;
+
   float  bobRotation;
   float  bobAmplitude;
   float  bobSwimAmplitude;
@@ -193,11 +193,11 @@ bool Collider::overlapsAABBOrbis()
 
         str = orbis.str(strIndex);
 
-        if (visitedStructs.get(strIndex) || !trace.overlaps(*str)) {
+        if (visitedStructs.get(Orbis::strSlot(strIndex)) || !trace.overlaps(*str)) {
           continue;
         }
 
-        visitedStructs.set(strIndex);
+        visitedStructs.set(Orbis::strSlot(strIndex));
         visitedBrushes.clearAll();
 
         startPos = str->toStructCS(aabb.p);
@@ -686,11 +686,11 @@ void Collider::trimAABBOrbis()
 
         str = orbis.str(strIndex);
 
-        if (visitedStructs.get(strIndex) || !trace.overlaps(*str)) {
+        if (visitedStructs.get(Orbis::strSlot(strIndex)) || !trace.overlaps(*str)) {
           continue;
         }
 
-        visitedStructs.set(strIndex);
+        visitedStructs.set(Orbis::strSlot(strIndex));
         visitedBrushes.clearAll();
 
         startPos = str->toStructCS(originalStartPos);
@@ -35,7 +35,7 @@ Pool<Dynamic> Dynamic::pool(4096);
 void Dynamic::onDestroy()
 {
   if (!clazz->onDestroy.isEmpty()) {
-    luaMatrix.objectCall(clazz->onDestroy, this);
+    luaMatrix.objectCall(clazz->onDestroyRef, clazz->onDestroy, this);
   }
 
   for (int i : items) {
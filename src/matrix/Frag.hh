@@ -48,7 +48,7 @@ public:
   Frag*           next[1];
 
   Cell*           cell;
-  int             index;         // position in world.objects vector
+  int             index;         // slot in orbis.frags and its generation
 
   int             poolId;
   const FragPool* pool;
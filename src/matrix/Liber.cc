@@ -35,14 +35,14 @@ namespace oz
 
 static HashMap<String, ObjectClass::CreateFunc*> baseClasses;
 
-static HashMap<String, int>                      shaderIndices;
-static HashMap<String, int>                      textureIndices;
-static HashMap<String, int>                      soundIndices;
-static HashMap<String, int>                      musicTrackIndices;
-static HashMap<String, int>                      caelumIndices;
-static HashMap<String, int>                      terraIndices;
-static HashMap<String, int>                      partIndices;
-static HashMap<String, int>                      modelIndices;
+static PerfectHash                              shaderIndices;
+static PerfectHash                              textureIndices;
+static PerfectHash                              soundIndices;
+static PerfectHash                              musicTrackIndices;
+static PerfectHash                              caelumIndices;
+static PerfectHash                              terraIndices;
+static PerfectHash                              partIndices;
+static PerfectHash                              modelIndices;
 
 static HashMap<String, BSP>                      bspMap;
 static HashMap<String, ObjectClass*>             objClassMap;
@@ -50,18 +50,66 @@ static HashMap<String, FragPool>                 fragPoolMap;
 
 static HashMap<String, int>                      mindIndices;
 
+// Index of the resource with a given name or -1 if none. The perfect hash gives a candidate index
+// for any name, so the name must be compared.
+static int resourceIndex(const List<Liber::Resource>& resources, const PerfectHash& index,
+                         const char* name)
+{
+  int i = index.index(name);
+  return i >= 0 && String::equals(resources[i].name, name) ? i : -1;
+}
+
+// Build perfect hash index of names of the first `count` resources. A repeated name maps to its
+// first occurrence. Returns index of the first resource with a repeated name or -1 if none.
+static int buildIndex(const List<Liber::Resource>& resources, int count, PerfectHash* index)
+{
+  List<const char*> names(count);
+
+  for (int i = 0; i < count; ++i) {
+    names[i] = resources[i].name;
+  }
+
+  if (!index->build(names.begin(), count)) {
+    OZ_ERROR("Hash collision in resource names");
+  }
+
+  for (int i = 0; i < count; ++i) {
+    if (index->index(names[i]) != i) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Read a resource list from a catalogue, followed by the index of resource names.
+static void readResources(Stream* is, List<Liber::Resource>* resources, PerfectHash* index)
+{
+  int nResources = is->readInt();
+
+  resources->reserve(resources->length() + nResources, true);
+
+  for (int i = 0; i < nResources; ++i) {
+    const char* name = is->readString();
+    const char* path = is->readString();
+
+    resources->add(Liber::Resource{ name, path });
+  }
+
+  index->read(is);
+}
+
 int Liber::shaderIndex(const char* name) const
 {
   if (String::isEmpty(name)) {
     return -1;
   }
 
-  const int* value = shaderIndices.find(name);
+  int index = resourceIndex(shaders, shaderIndices, name);
 
-  if (value == nullptr) {
+  if (index < 0) {
     OZ_ERROR("Invalid shader requested '%s'", name);
   }
-  return *value;
+  return index;
 }
 
 int Liber::textureIndex(const char* name) const
@@ -70,12 +118,12 @@ int Liber::textureIndex(const char* name) const
     return -1;
   }
 
-  const int* value = textureIndices.find(name);
+  int index = resourceIndex(textures, textureIndices, name);
 
-  if (value == nullptr) {
+  if (index < 0) {
     OZ_ERROR("Invalid texture requested '%s'", name);
   }
-  return *value;
+  return index;
 }
 
 int Liber::soundIndex(const char* name) const
@@ -84,12 +132,12 @@ int Liber::soundIndex(const char* name) const
     return -1;
   }
 
-  const int* value = soundIndices.find(name);
+  int index = resourceIndex(sounds, soundIndices, name);
 
-  if (value == nullptr) {
+  if (index < 0) {
     OZ_ERROR("Invalid sound requested '%s'", name);
   }
-  return *value;
+  return index;
 }
 
 int Liber::caelumIndex(const char* name) const
@@ -98,12 +146,12 @@ int Liber::caelumIndex(const char* name) const
     return -1;
   }
 
-  const int* value = caelumIndices.find(name);
+  int index = resourceIndex(caela, caelumIndices, name);
 
-  if (value == nullptr) {
+  if (index < 0) {
     OZ_ERROR("Invalid caelum requested '%s'", name);
   }
-  return *value;
+  return index;
 }
 
 int Liber::terraIndex(const char* name) const
@@ -112,12 +160,12 @@ int Liber::terraIndex(const char* name) const
     return -1;
   }
 
-  const int* value = terraIndices.find(name);
+  int index = resourceIndex(terrae, terraIndices, name);
 
-  if (value == nullptr) {
+  if (index < 0) {
     OZ_ERROR("Invalid terra requested '%s'", name);
   }
-  return *value;
+  return index;
 }
 
 int Liber::partIndex(const char* name) const
@@ -126,12 +174,12 @@ int Liber::partIndex(const char* name) const
     return -1;
   }
 
-  const int* value = partIndices.find(name);
+  int index = resourceIndex(parts, partIndices, name);
 
-  if (value == nullptr) {
+  if (index < 0) {
     OZ_ERROR("Invalid particle requested '%s'", name);
   }
-  return *value;
+  return index;
 }
 
 int Liber::modelIndex(const char* name) const
@@ -140,12 +188,12 @@ int Liber::modelIndex(const char* name) const
     return -1;
   }
 
-  const int* value = modelIndices.find(name);
+  int index = resourceIndex(models, modelIndices, name);
 
-  if (value == nullptr) {
+  if (index < 0) {
     OZ_ERROR("Invalid model requested '%s'", name);
   }
-  return *value;
+  return index;
 }
 
 int Liber::musicTrackIndex(const char* name) const
@@ -154,12 +202,12 @@ int Liber::musicTrackIndex(const char* name) const
     return -1;
   }
 
-  const int* value = musicTrackIndices.find(name);
+  int index = resourceIndex(musicTracks, musicTrackIndices, name);
 
-  if (value == nullptr) {
+  if (index < 0) {
     OZ_ERROR("Invalid music track requested '%s'", name);
   }
-  return *value;
+  return index;
 }
 
 int Liber::mindIndex(const char* name) const
@@ -261,13 +309,13 @@ void Liber::initShaders()
 
     Log::println("%s", name.c());
 
-    shaderIndices.add(name, shaders.length());
     shaders.add(Resource{ name, file });
   }
 
-  shaderIndices.trim();
   shaders.trim();
 
+  buildIndex(shaders, shaders.length(), &shaderIndices);
+
   Log::unindent();
   Log::println("}");
 }
@@ -293,14 +341,14 @@ void Liber::initTextures()
 
       Log::println("%s", name.c());
 
-      textureIndices.add(name, textures.length());
       textures.add(Resource{ name, "@tex/" + name });
     }
   }
 
-  textureIndices.trim();
   textures.trim();
 
+  buildIndex(textures, textures.length(), &textureIndices);
+
   Log::unindent();
   Log::println("}");
 }
@@ -326,18 +374,17 @@ void Liber::initSounds()
 
       Log::println("%s", name.c());
 
-      if (soundIndices.contains(name)) {
-        OZ_ERROR("Duplicated sound '%s'", name.c());
-      }
-
-      soundIndices.add(name, sounds.length());
       sounds.add(Resource{ name, file });
     }
   }
 
-  soundIndices.trim();
   sounds.trim();
 
+  int repeated = buildIndex(sounds, sounds.length(), &soundIndices);
+  if (repeated >= 0) {
+    OZ_ERROR("Duplicated sound '%s'", sounds[repeated].name.c());
+  }
+
   Log::unindent();
   Log::println("}");
 }
@@ -358,13 +405,13 @@ void Liber::initCaela()
 
     Log::println("%s", name.c());
 
-    caelumIndices.add(name, caela.length());
     caela.add(Resource{ name, subDir });
   }
 
-  caelumIndices.trim();
   caela.trim();
 
+  buildIndex(caela, caela.length(), &caelumIndices);
+
   Log::unindent();
   Log::println("}");
 }
@@ -385,13 +432,13 @@ void Liber::initTerrae()
 
     Log::println("%s", name.c());
 
-    terraIndices.add(name, terrae.length());
     terrae.add(Resource{ name, file });
   }
 
-  terraIndices.trim();
   terrae.trim();
 
+  buildIndex(terrae, terrae.length(), &terraIndices);
+
   Log::unindent();
   Log::println("}");
 }
@@ -412,13 +459,13 @@ void Liber::initParticles()
 
     Log::println("%s", name.c());
 
-    partIndices.add(name, parts.length());
     parts.add(Resource{ name, file });
   }
 
-  partIndices.trim();
   parts.trim();
 
+  buildIndex(parts, parts.length(), &partIndices);
+
   Log::unindent();
   Log::println("}");
 }
@@ -444,17 +491,16 @@ void Liber::initModels()
 
     Log::println("%s", name.c());
 
-    if (modelIndices.contains(name)) {
-      OZ_ERROR("Duplicated model '%s'", name.c());
-    }
-
-    modelIndices.add(name, models.length());
     models.add(Resource{ name, file });
   }
 
-  modelIndices.trim();
   models.trim();
 
+  int repeated = buildIndex(models, models.length(), &modelIndices);
+  if (repeated >= 0) {
+    OZ_ERROR("Duplicated model '%s'", models[repeated].name.c());
+  }
+
   Log::unindent();
   Log::println("}");
 }
@@ -495,99 +541,59 @@ void Liber::initFragPools()
   Log::println("}");
 }
 
-void Liber::initClasses()
+void Liber::addClass(const String& name, const Json& config)
 {
-  OZ_REGISTER_BASECLASS(Object);
-  OZ_REGISTER_BASECLASS(Dynamic);
-  OZ_REGISTER_BASECLASS(Weapon);
-  OZ_REGISTER_BASECLASS(Bot);
-  OZ_REGISTER_BASECLASS(Vehicle);
-
-  baseClasses.trim();
-
-  Log::println("Object classes (*.json in 'class') {");
-  Log::indent();
-
-  File dir = "@class";
-
-  // First we only add class instances, we don't initialise them as each class may have references
-  // to other classes that haven't been created yet.
-  for (const File& file : dir.list()) {
-    if (!file.hasExtension("json")) {
-      continue;
-    }
-
-    Json config;
-    if (!config.load(file)) {
-      OZ_ERROR("Failed to read '%s'", file.c());
-    }
-
-    String name = file.baseName();
-    const String& base = config["base"].get("");
-
-    if (objClassMap.contains(name)) {
-      OZ_ERROR("Duplicated class '%s'", name.c());
-    }
+  const String& base = config["base"].get("");
 
-    if (String::isEmpty(base)) {
-      OZ_ERROR("%s: 'base' missing in class description", name.c());
-    }
-
-    ObjectClass::CreateFunc* const* createFunc = baseClasses.find(base);
-    if (createFunc == nullptr) {
-      OZ_ERROR("%s: Invalid class base '%s'", name.c(), base.c());
-    }
+  if (objClassMap.contains(name)) {
+    OZ_ERROR("Duplicated class '%s'", name.c());
+  }
 
-    const String& deviceType = config["deviceType"].get("");
-    const String& imagoType  = config["imagoType"].get("");
-    const String& audioType  = config["audioType"].get("");
+  if (String::isEmpty(base)) {
+    OZ_ERROR("%s: 'base' missing in class description", name.c());
+  }
 
-    if (!deviceType.isEmpty()) {
-      devices.include(deviceType);
-    }
-    if (!imagoType.isEmpty()) {
-      imagines.include(imagoType);
-    }
-    if (!audioType.isEmpty()) {
-      audios.include(audioType);
-    }
+  ObjectClass::CreateFunc* const* createFunc = baseClasses.find(base);
+  if (createFunc == nullptr) {
+    OZ_ERROR("%s: Invalid class base '%s'", name.c(), base.c());
+  }
 
-    ObjectClass* clazz = (*createFunc)();
+  const String& deviceType = config["deviceType"].get("");
+  const String& imagoType  = config["imagoType"].get("");
+  const String& audioType  = config["audioType"].get("");
 
-    objClassMap.add(name, clazz);
-    objClasses.add(clazz);
+  if (!deviceType.isEmpty()) {
+    devices.include(deviceType);
+  }
+  if (!imagoType.isEmpty()) {
+    imagines.include(imagoType);
+  }
+  if (!audioType.isEmpty()) {
+    audios.include(audioType);
   }
 
-  objClassMap.trim();
-  objClasses.trim();
-  devices.trim();
-  imagines.trim();
-  audios.trim();
+  ObjectClass* clazz = (*createFunc)();
 
-  // Initialise all classes.
-  for (const auto& classIter : objClassMap) {
-    const String& name  = classIter.key;
-    ObjectClass*  clazz = classIter.value;
+  objClassMap.add(name, clazz);
+  objClasses.add(clazz);
+}
 
-    Log::print("%s ...", name.c());
+void Liber::initClass(ObjectClass* clazz, const String& name, Json* config)
+{
+  Log::print("%s ...", name.c());
 
-    File file = "@class/" + name + ".json";
-    Json config;
-    if (!config.load(file)) {
-      OZ_ERROR("Failed to read '%s'", file.c());
-    }
+  clazz->init(*config, name);
 
-    clazz->init(config, name);
+  Log::showVerbose = true;
+  (*config)["base"];
+  config->clear(true);
+  Log::showVerbose = false;
 
-    Log::showVerbose = true;
-    config["base"];
-    config.clear(true);
-    Log::showVerbose = false;
-
-    Log::printEnd(" OK");
-  }
+  Log::printEnd(" OK");
+}
 
-  // Sanity checks.
+void Liber::checkClasses()
+{
   for (const auto& classIter : objClassMap) {
     ObjectClass* objClazz = classIter.value;
 
@@ -628,6 +634,48 @@ void Liber::initClasses()
       }
     }
   }
+}
+
+void Liber::initClasses()
+{
+  Log::println("Object classes (*.json in 'class') {");
+  Log::indent();
+
+  File dir = "@class";
+
+  // First we only add class instances, we don't initialise them as each class may have references
+  // to other classes that haven't been created yet.
+  for (const File& file : dir.list()) {
+    if (!file.hasExtension("json")) {
+      continue;
+    }
+
+    Json config;
+    if (!config.load(file)) {
+      OZ_ERROR("Failed to read '%s'", file.c());
+    }
+
+    addClass(file.baseName(), config);
+  }
+
+  objClassMap.trim();
+  objClasses.trim();
+  devices.trim();
+  imagines.trim();
+  audios.trim();
+
+  // Initialise all classes.
+  for (const auto& classIter : objClassMap) {
+    File file = "@class/" + classIter.key + ".json";
+    Json config;
+    if (!config.load(file)) {
+      OZ_ERROR("Failed to read '%s'", file.c());
+    }
+
+    initClass(classIter.value, classIter.key, &config);
+  }
+
+  checkClasses();
 
   Log::unindent();
   Log::println("}");
@@ -678,7 +726,7 @@ void Liber::initMusicRecurse(const File& dir)
   }
 }
 
-void Liber::initMusic(const char* userMusicPath)
+void Liber::initMusic(const char* userMusicPath, bool isMapped)
 {
   if (userMusicPath == nullptr || String::isEmpty(userMusicPath)) {
     Log::println("Music (*.oga, *.ogg%s%s in 'music') {",
@@ -690,41 +738,179 @@ void Liber::initMusic(const char* userMusicPath)
   }
   Log::indent();
 
-  initMusicRecurse("@music");
+  // Package tracks are already listed in catalogues, only user's tracks must be scanned then.
+  if (!isMapped) {
+    initMusicRecurse("@music");
 
-  for (int i = 0; i < musicTracks.length(); ++i) {
-    musicTrackIndices.add(musicTracks[i].name, i);
+    buildIndex(musicTracks, musicTracks.length(), &musicTrackIndices);
   }
 
   initMusicRecurse("@userMusic");
 
-  musicTrackIndices.trim();
   musicTracks.trim();
 
   Log::unindent();
   Log::println("}");
 }
 
-void Liber::init(const char* userMusicPath)
+bool Liber::initCatalogues()
+{
+  List<File> catalogues;
+
+  for (const File& file : File("@").list()) {
+    if (file.hasExtension("ozLiber")) {
+      catalogues.add(file);
+    }
+  }
+
+  if (catalogues.isEmpty()) {
+    return false;
+  }
+
+  Log::println("Precompiled catalogues (*.ozLiber) {");
+  Log::indent();
+
+  List<Resource>* resourceLists[]   = {
+    &shaders, &textures, &sounds, &caela, &terrae, &models, &musicTracks, &parts
+  };
+  PerfectHash*    resourceIndices[] = {
+    &shaderIndices, &textureIndices, &soundIndices, &caelumIndices, &terraIndices, &modelIndices,
+    &musicTrackIndices, &partIndices
+  };
+  List<String>    classNames;
+  List<Json>      classConfigs;
+
+  for (const File& file : catalogues) {
+    Log::println("%s", file.c());
+
+    Stream is = file.read(Endian::LITTLE);
+
+    if (is.available() < 2 * int(sizeof(int)) || is.readInt() != CATALOGUE_MAGIC) {
+      OZ_ERROR("Invalid catalogue '%s'", file.c());
+    }
+
+    int version = is.readInt();
+    if (version != CATALOGUE_VERSION) {
+      OZ_ERROR("Catalogue '%s' has format version %d, version %d is required, rebuild the package",
+               file.c(), version, CATALOGUE_VERSION);
+    }
+
+    for (int i = 0; i < Arrays::length(resourceLists); ++i) {
+      readResources(&is, resourceLists[i], resourceIndices[i]);
+    }
+
+    // Entries shadowed by an earlier package are skipped, as they are by a directory listing.
+    int nFragPools = is.readInt();
+
+    for (int i = 0; i < nFragPools; ++i) {
+      String name = is.readString();
+      Json   config;
+
+      config.read(&is);
+
+      if (!fragPoolMap.contains(name)) {
+        FragPool& pool = fragPoolMap.add(name, FragPool(config, name, fragPools.length())).value;
+        fragPools.add(&pool);
+
+        Log::showVerbose = true;
+        config.clear(true);
+        Log::showVerbose = false;
+      }
+    }
+
+    int nClasses = is.readInt();
+
+    for (int i = 0; i < nClasses; ++i) {
+      String name = is.readString();
+      Json   config;
+
+      config.read(&is);
+
+      if (!objClassMap.contains(name)) {
+        addClass(name, config);
+        classNames.add(name);
+        classConfigs.add(static_cast<Json&&>(config));
+      }
+    }
+
+    int nBSPs = is.readInt();
+
+    for (int i = 0; i < nBSPs; ++i) {
+      String name = is.readString();
+
+      if (!bspMap.contains(name)) {
+        BSP& bsp = bspMap.add(name, BSP(name, bsps.length())).value;
+        bsps.add(&bsp);
+
+        bsp.load();
+      }
+    }
+  }
+
+  fragPoolMap.trim();
+  fragPools.trim();
+  objClassMap.trim();
+  objClasses.trim();
+  devices.trim();
+  imagines.trim();
+  audios.trim();
+  bspMap.trim();
+  bsps.trim();
+
+  // Indices from a single catalogue are used as they are, merged lists need new ones.
+  if (catalogues.length() > 1) {
+    for (int i = 0; i < Arrays::length(resourceLists); ++i) {
+      buildIndex(*resourceLists[i], resourceLists[i]->length(), resourceIndices[i]);
+    }
+  }
+
+  for (int i = 0; i < objClasses.length(); ++i) {
+    initClass(const_cast<ObjectClass*>(objClasses[i]), classNames[i], &classConfigs[i]);
+  }
+
+  checkClasses();
+
+  Log::unindent();
+  Log::println("}");
+  return true;
+}
+
+void Liber::init(const char* userMusicPath, bool useCatalogues)
 {
   Log::println("Initialising Library {");
   Log::indent();
 
   Log::verboseMode = true;
 
+  OZ_REGISTER_BASECLASS(Object);
+  OZ_REGISTER_BASECLASS(Dynamic);
+  OZ_REGISTER_BASECLASS(Weapon);
+  OZ_REGISTER_BASECLASS(Bot);
+  OZ_REGISTER_BASECLASS(Vehicle);
+
+  baseClasses.trim();
+
   Log::println("Mapping resources {");
   Log::indent();
 
-  initShaders();
-  initTextures();
-  initSounds();
-  initCaela();
-  initTerrae();
-  initModels();
-  initFragPools();
-  initClasses();
-  initBSPs();
-  initMusic(userMusicPath);
+  uint startTime = Time::clock();
+  bool isMapped  = useCatalogues && initCatalogues();
+
+  if (!isMapped) {
+    initShaders();
+    initTextures();
+    initSounds();
+    initCaela();
+    initTerrae();
+    initModels();
+    initParticles();
+    initFragPools();
+    initClasses();
+    initBSPs();
+  }
+  initMusic(userMusicPath, isMapped);
+
+  uint endTime = Time::clock();
 
   Log::unindent();
   Log::println("}");
@@ -741,9 +927,12 @@ void Liber::init(const char* userMusicPath)
   Log::println("%5d  caela", caela.length());
   Log::println("%5d  terrae", terrae.length());
   Log::println("%5d  models", models.length());
+  Log::println("%5d  particle classes", parts.length());
   Log::println("%5d  fragment pools", fragPools.length());
   Log::println("%5d  object classes", objClasses.length());
   Log::println("%5d  BSPs", bsps.length());
+  Log::println("%5d  ms mapping from %s", int(endTime - startTime),
+               isMapped ? "catalogues" : "directories");
 
   Log::unindent();
   Log::println("}");
@@ -757,37 +946,34 @@ void Liber::destroy()
   shaders.clear();
   shaders.trim();
   shaderIndices.clear();
-  shaderIndices.trim();
 
   textures.clear();
   textures.trim();
   textureIndices.clear();
-  textureIndices.trim();
 
   sounds.clear();
   sounds.trim();
   soundIndices.clear();
-  soundIndices.trim();
 
   caela.clear();
   caela.trim();
   caelumIndices.clear();
-  caelumIndices.trim();
 
   terrae.clear();
   terrae.trim();
   terraIndices.clear();
-  terraIndices.trim();
 
   models.clear();
   models.trim();
   modelIndices.clear();
-  modelIndices.trim();
 
   musicTracks.clear();
   musicTracks.trim();
   musicTrackIndices.clear();
-  musicTrackIndices.trim();
+
+  parts.clear();
+  parts.trim();
+  partIndices.clear();
 
   mindIndices.clear();
   mindIndices.trim();
@@ -31,11 +31,20 @@ namespace oz
 
 /**
  * Mapping of all resources, object types, scripts etc.
+ *
+ * Resources are mapped from precompiled catalogues that ozBuild writes into the root of each
+ * package, or by scanning data directories and parsing class descriptions when there are none.
  */
 class Liber
 {
 public:
 
+  /// Magic number at the beginning of a catalogue file.
+  static const int CATALOGUE_MAGIC   = 0x6c5a6f21;
+
+  /// Catalogue format version, 2 adds particle classes.
+  static const int CATALOGUE_VERSION = 2;
+
   struct Resource
   {
     String name;
@@ -91,14 +100,28 @@ private:
   void initParticles();
   void initModels();
   void initFragPools();
+  void addClass(const String& name, const Json& config);
+  void initClass(ObjectClass* clazz, const String& name, Json* config);
+  void checkClasses();
   void initClasses();
   void initBSPs();
   void initMusicRecurse(const File& dir);
-  void initMusic(const char* userMusicPath);
+  void initMusic(const char* userMusicPath, bool isMapped);
+  bool initCatalogues();
 
 public:
 
-  void init(const char* userMusicPath);
+  /**
+   * Map resources, from catalogues if `useCatalogues` is set and any exist.
+   *
+   * A catalogue (`<package>.ozLiber`) contains, in little endian:
+   * - magic number and format version,
+   * - shaders, textures, sounds, caela, terrae, models, music tracks and particle classes, each as
+   *   a list of names and paths followed by a `PerfectHash` of names,
+   * - fragment pools and object classes as names and their descriptions in `Json` binary encoding,
+   * - BSP names.
+   */
+  void init(const char* userMusicPath, bool useCatalogues);
   void destroy();
 
 };
@@ -50,7 +50,7 @@ String LuaMatrix::nameGenCall(const char* functionName)
   if (!String::isEmpty(functionName)) {
     l_getglobal(functionName);
 
-    if (l_pcall(0, 1) != LUA_OK) {
+    if (pcall(0, 1, functionName) != LUA_OK) {
       Log::println("Lua[M] in %s(): %s", functionName, l_tostring(-1));
       System::bell();
     }
@@ -64,7 +64,7 @@ String LuaMatrix::nameGenCall(const char* functionName)
   return name;
 }
 
-bool LuaMatrix::objectCall(const char* functionName, Object* self, Bot* user)
+bool LuaMatrix::call(const char* functionName, Object* self, Bot* user)
 {
   ms.self     = self;
   ms.user     = user;
@@ -74,14 +74,13 @@ bool LuaMatrix::objectCall(const char* functionName, Object* self, Bot* user)
   ms.objIndex = 0;
   ms.strIndex = 0;
 
-  hard_assert(l_gettop() == 1 && self != nullptr);
+  hard_assert(l_gettop() == 2 && self != nullptr);
 
   bool success = true;
 
-  l_getglobal(functionName);
   l_rawgeti(1, self->index);
 
-  if (l_pcall(1, 1) != LUA_OK) {
+  if (pcall(1, 1, functionName, self->clazz->name) != LUA_OK) {
     Log::println("Lua[M] in %s(self = %d, user = %d): %s",
                  functionName, self->index, user == nullptr ? -1 : user->index, l_tostring(-1));
     System::bell();
@@ -96,6 +95,59 @@ bool LuaMatrix::objectCall(const char* functionName, Object* self, Bot* user)
   return success;
 }
 
+void LuaMatrix::resolveHandlers()
+{
+  for (const ObjectClass* clazz : liber.objClasses) {
+    clazz->onDestroyRef = functionRef(clazz->onDestroy);
+    clazz->onUseRef     = functionRef(clazz->onUse);
+    clazz->onUpdateRef  = functionRef(clazz->onUpdate);
+    clazz->getStatusRef = functionRef(clazz->getStatus);
+
+    if (clazz->flags & Object::WEAPON_BIT) {
+      const WeaponClass* weaponClazz = static_cast<const WeaponClass*>(clazz);
+
+      weaponClazz->onShotRef = functionRef(weaponClazz->onShot);
+    }
+  }
+}
+
+void LuaMatrix::releaseHandlers()
+{
+  // References are released together with the Lua state, only invalidate them here.
+  for (const ObjectClass* clazz : liber.objClasses) {
+    clazz->onDestroyRef = -1;
+    clazz->onUseRef     = -1;
+    clazz->onUpdateRef  = -1;
+    clazz->getStatusRef = -1;
+
+    if (clazz->flags & Object::WEAPON_BIT) {
+      static_cast<const WeaponClass*>(clazz)->onShotRef = -1;
+    }
+  }
+}
+
+bool LuaMatrix::objectCall(const char* functionName, Object* self, Bot* user)
+{
+  hard_assert(l_gettop() == 1);
+
+  l_getglobal(functionName);
+  return call(functionName, self, user);
+}
+
+bool LuaMatrix::objectCall(int functionRef, const char* functionName, Object* self, Bot* user)
+{
+  hard_assert(l_gettop() == 1);
+
+  // Fall back to a global look-up for unresolved handlers to get a proper error message.
+  if (functionRef < 0) {
+    l_getglobal(functionName);
+  }
+  else {
+    l_getref(functionRef);
+  }
+  return call(functionName, self, user);
+}
+
 void LuaMatrix::registerObject(int index)
 {
   // We cannot assume that `ozLocalData` exists at index 1 as this function may be called from a
@@ -155,7 +207,7 @@ void LuaMatrix::init()
 {
   Log::print("Initialising Matrix Lua ...");
 
-  Lua::init();
+  Lua::init("matrix");
 
   ls.envName = "matrix";
   ms.structs.reserve(32);
@@ -343,6 +395,9 @@ void LuaMatrix::init()
   IMPORT_FUNC(ozObjIsVisibleFromSelf);
   IMPORT_FUNC(ozObjIsVisibleFromSelfEye);
 
+  IMPORT_FUNC(ozObjQuery);
+  IMPORT_FUNC(ozBoundObjsQuery);
+
   /*
    * Dynamic object
    */
@@ -466,6 +521,8 @@ void LuaMatrix::init()
   loadDir("@lua/common");
   loadDir("@lua/matrix");
 
+  resolveHandlers();
+
   hard_assert(l_gettop() == 1);
 
   Log::printEnd(" OK");
@@ -485,6 +542,8 @@ void LuaMatrix::destroy()
   ms.objects.clear();
   ms.objects.trim();
 
+  releaseHandlers();
+
   hard_assert(l_gettop() == 1);
   hard_assert((l_pushnil(), true));
   hard_assert(!l_next(1));
@@ -38,10 +38,18 @@ public:
 
   float objectStatus;
 
+private:
+
+  bool call(const char* functionName, Object* self, Bot* user);
+
+  void resolveHandlers();
+  void releaseHandlers();
+
 public:
 
   String nameGenCall(const char* functionName);
   bool objectCall(const char* functionName, Object* self, Bot* user = nullptr);
+  bool objectCall(int functionRef, const char* functionName, Object* self, Bot* user = nullptr);
 
   void registerObject(int index);
   void unregisterObject(int index);
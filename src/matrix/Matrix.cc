@@ -37,7 +37,7 @@ const float Matrix::MAX_VELOCITY2 = 1000000.0f;
 void Matrix::update()
 {
   maxStructs  = max(maxStructs,  Struct::pool.length());
-  maxEvents   = max(maxEvents,   Object::Event::pool.length());
+  maxEvents   = max(maxEvents,   Object::Event::arena.length());
   maxObjects  = max(maxObjects,  Object::pool.length());
   maxDynamics = max(maxDynamics, Dynamic::pool.length());
   maxWeapons  = max(maxWeapons,  Weapon::pool.length());
@@ -46,12 +46,12 @@ void Matrix::update()
   maxFrags    = max(maxFrags,    Frag::mpool.length());
 
   for (int i = 0; i < Orbis::MAX_OBJECTS; ++i) {
-    Object* obj = orbis.obj(i);
+    Object* obj = orbis.objAt(i);
 
     if (obj != nullptr) {
       // If this is cleared on the object's update, we may also remove effects added by other
       // objects updated before it.
-      obj->events.free();
+      obj->events.clear();
 
       // We don't remove objects as they get destroyed but on the next update, so the destruction
       // sound and other effects can be played on an object's destruction.
@@ -61,8 +61,10 @@ void Matrix::update()
     }
   }
 
+  Object::Event::arena.reset();
+
   for (int i = 0; i < Orbis::MAX_STRUCTS; ++i) {
-    Struct* str = orbis.str(i);
+    Struct* str = orbis.strAt(i);
 
     if (str == nullptr) {
       continue;
@@ -82,7 +84,7 @@ void Matrix::update()
   }
 
   for (int i = 0; i < Orbis::MAX_OBJECTS; ++i) {
-    Object* obj = orbis.obj(i);
+    Object* obj = orbis.objAt(i);
 
     if (obj == nullptr) {
       continue;
@@ -94,22 +96,10 @@ void Matrix::update()
       obj->destroy();
     }
     else {
-      // clear inventory of invalid references
-      if (!obj->items.isEmpty()) {
-        for (int j = 0; j < obj->items.length();) {
-          if (orbis.obj(obj->items[j]) == nullptr) {
-            obj->items.erase(j);
-          }
-          else {
-            ++j;
-          }
-        }
-      }
-
       obj->update();
 
       // objects should not remove themselves within onUpdate()
-      hard_assert(orbis.obj(i) != nullptr);
+      hard_assert(orbis.objAt(i) != nullptr);
 
       if (obj->flags & Object::DYNAMIC_BIT) {
         Dynamic* dyn = static_cast<Dynamic*>(obj);
@@ -134,7 +124,7 @@ void Matrix::update()
   }
 
   for (int i = 0; i < Orbis::MAX_FRAGS; ++i) {
-    Frag* frag = orbis.frag(i);
+    Frag* frag = orbis.fragAt(i);
 
     if (frag == nullptr) {
       continue;
@@ -149,7 +139,6 @@ void Matrix::update()
     }
   }
 
-  // rotate freeing/waiting/available indices
   orbis.update();
 }
 
@@ -44,7 +44,7 @@ const float Object::DAMAGE_BASE_INTENSITY  = 0.30f;
 const float Object::DAMAGE_INTENSITY_COEF  = 0.01f;
 const Vec3  Object::DESTRUCT_FRAG_VELOCITY = Vec3(0.0f, 0.0f, 2.0f);
 
-Pool<Object::Event> Object::Event::pool(256);
+Arena               Object::Event::arena(4096);
 Pool<Object>        Object::pool(16384);
 
 void Object::onDestroy()
@@ -52,7 +52,7 @@ void Object::onDestroy()
   hard_assert(cell != nullptr);
 
   if (!clazz->onDestroy.isEmpty()) {
-    luaMatrix.objectCall(clazz->onDestroy, this);
+    luaMatrix.objectCall(clazz->onDestroyRef, clazz->onDestroy, this);
   }
 
   for (int i : items) {
@@ -76,14 +76,14 @@ bool Object::onUse(Bot* user)
 {
   hard_assert(!clazz->onUse.isEmpty());
 
-  return luaMatrix.objectCall(clazz->onUse, this, user);
+  return luaMatrix.objectCall(clazz->onUseRef, clazz->onUse, this, user);
 }
 
 void Object::onUpdate()
 {
   hard_assert(!clazz->onUpdate.isEmpty());
 
-  luaMatrix.objectCall(clazz->onUpdate, this);
+  luaMatrix.objectCall(clazz->onUpdateRef, clazz->onUpdate, this);
 }
 
 String Object::getTitle() const
@@ -95,7 +95,7 @@ float Object::getStatus() const
 {
   hard_assert(!clazz->getStatus.isEmpty());
 
-  luaMatrix.objectCall(clazz->getStatus, const_cast<Object*>(this));
+  luaMatrix.objectCall(clazz->getStatusRef, clazz->getStatus, const_cast<Object*>(this));
   return luaMatrix.objectStatus;
 }
 
@@ -104,7 +104,7 @@ Object::~Object()
   hard_assert(dim.x <= REAL_MAX_DIM);
   hard_assert(dim.y <= REAL_MAX_DIM);
 
-  events.free();
+  events.clear();
 }
 
 Object::Object(const ObjectClass* clazz_, int index_, const Point& p_, Heading heading)
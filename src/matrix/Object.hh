@@ -198,7 +198,7 @@ public:
   {
   public:
 
-    static Pool<Event> pool;
+    static Arena arena;
 
     Event* next[1]   = { nullptr };
     int    id;
@@ -211,7 +211,7 @@ public:
       id(id_), intensity(intensity_)
     {}
 
-    OZ_STATIC_POOL_ALLOC(pool)
+    OZ_STATIC_ARENA_ALLOC(arena)
   };
 
 public:
@@ -226,7 +226,7 @@ public:
   Object*            next[1]    = { nullptr }; // the next object in cell.objects chains
 
   Cell*              cell       = nullptr;     // parent cell, nullptr if not positioned in world
-  int                index      = -1;          // index in orbis.objects
+  int                index      = -1;          // slot in orbis.objects and its generation
 
   int                flags;
 
@@ -236,7 +236,7 @@ public:
   const ObjectClass* clazz;
 
   // events are used for reporting hits, friction & stuff and are cleared at the beginning of a
-  // matrix update
+  // matrix update, when their arena is reset
   Chain<Event>       events;
   // inventory
   List<int>          items;
@@ -187,6 +187,7 @@ void ObjectClass::init(const Json& config, const char* name_)
 
   imagoType  = liber.imagoIndex(config["imagoType"].get(""));
   imagoModel = liber.modelIndex(config["imagoModel"].get(""));
+  imagoParts = liber.partIndex(config["imagoParts"].get(""));
 
   if (imagoType >= 0) {
     flags |= Object::IMAGO_BIT;
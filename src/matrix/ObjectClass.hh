@@ -83,6 +83,7 @@ public:
 
   int                      imagoType;
   int                      imagoModel;
+  int                      imagoParts;
 
   int                      audioType;
   int                      audioSounds[MAX_SOUNDS];
@@ -92,6 +93,12 @@ public:
   String                   onUpdate;
   String                   getStatus;
 
+  // Lua registry references to the handlers above, resolved by `LuaMatrix::init()`.
+  mutable int              onDestroyRef = -1;
+  mutable int              onUseRef     = -1;
+  mutable int              onUpdateRef  = -1;
+  mutable int              getStatusRef = -1;
+
 public:
 
   virtual ~ObjectClass();
@@ -32,89 +32,72 @@ namespace oz
 
 static_assert(Orbis::CELLS * Cell::SIZE == Terra::QUADS * Terra::Quad::SIZE,
               "oz::Orbis and terrain size mismatch");
+static_assert((Orbis::MAX_STRUCTS | Orbis::STR_GEN_MASK << Orbis::STR_GEN_SHIFT) <= 0x7fff,
+              "oz::Orbis structure indices do not fit into Cell::structs");
 
 /*
  * Index reusing: when an entity (structure, object or fragment) is removed, there may still be
- * references to it from other entities or from render or sound subsystems; that's why every cycle
- * all references must be checked if the target still exists. To make sure all references can be
- * checked, one full world update must pass before a slot is reused. Otherwise an entity may be
- * removed and immediately after that another added into it's slot which might end in an inexpected
- * behaviour or even a crash if the new entity doesn't have the same type.
- *
- * To ensure that one full update passes between the updates we tag slots as 'freeing' when they are
- * freed and 'waiting' in the next world update. In the update after 'waiting' state they can be
- * reused again.
+ * references to it from other entities or from render or sound subsystems. Each slot has a
+ * generation that is increased when the slot is freed and becomes a part of indices of entities
+ * later added into that slot. `Orbis::str()`, `Orbis::obj()` and `Orbis::frag()` compare the whole
+ * index against the one of the entity in the slot, so stale references simply resolve to nullptr
+ * and a freed slot can be reused right away.
  */
 
-static int freeing = 0;
-static int waiting = 1;
-
 static int lastStructIndex = -1;
 static int lastObjectIndex = -1;
 static int lastFragIndex   = -1;
 
-static SBitset<Orbis::MAX_STRUCTS> pendingStructs[2];
-static SBitset<Orbis::MAX_OBJECTS> pendingObjects[2];
-static SBitset<Orbis::MAX_FRAGS>   pendingFrags[2];
+static ushort structGenerations[Orbis::MAX_STRUCTS];
+static ushort objectGenerations[Orbis::MAX_OBJECTS];
+static ushort fragGenerations[Orbis::MAX_FRAGS];
 
 int Orbis::allocStrIndex() const
 {
-  int index = lastStructIndex + 1;
-
-  while (structs[1 + index] != nullptr || pendingStructs[0].get(index) ||
-         pendingStructs[1].get(index))
-  {
-    if (index == lastStructIndex) {
-      // We have wrapped around => no slots available.
-      soft_assert(false);
-      return -1;
-    }
+  for (int i = 1; i <= MAX_STRUCTS; ++i) {
+    int slot = (lastStructIndex + i) % MAX_STRUCTS;
 
-    index = (index + 1) % MAX_STRUCTS;
+    if (structs[1 + slot] == nullptr) {
+      lastStructIndex = slot;
+      return slot | structGenerations[slot] << STR_GEN_SHIFT;
+    }
   }
 
-  lastStructIndex = index;
-  return index;
+  // We have wrapped around => no slots available.
+  soft_assert(false);
+  return -1;
 }
 
 int Orbis::allocObjIndex() const
 {
-  int index = lastObjectIndex + 1;
-
-  while (objects[1 + index] != nullptr || pendingObjects[0].get(index) ||
-         pendingObjects[1].get(index))
-  {
-    if (index == lastObjectIndex) {
-      // We have wrapped around => no slots available.
-      soft_assert(false);
-      return -1;
-    }
+  for (int i = 1; i <= MAX_OBJECTS; ++i) {
+    int slot = (lastObjectIndex + i) % MAX_OBJECTS;
 
-    index = (index + 1) % MAX_OBJECTS;
+    if (objects[1 + slot] == nullptr) {
+      lastObjectIndex = slot;
+      return slot | objectGenerations[slot] << OBJ_GEN_SHIFT;
+    }
   }
 
-  lastObjectIndex = index;
-  return index;
+  // We have wrapped around => no slots available.
+  soft_assert(false);
+  return -1;
 }
 
 int Orbis::allocFragIndex() const
 {
-  int index = lastFragIndex + 1;
-
-  while (frags[1 + index] != nullptr || pendingFrags[0].get(index) ||
-         pendingFrags[1].get(index))
-  {
-    if (index == lastFragIndex) {
-      // We have wrapped around => no slots available.
-      soft_assert(false);
-      return -1;
-    }
+  for (int i = 1; i <= MAX_FRAGS; ++i) {
+    int slot = (lastFragIndex + i) % MAX_FRAGS;
 
-    index = (index + 1) % MAX_FRAGS;
+    if (frags[1 + slot] == nullptr) {
+      lastFragIndex = slot;
+      return slot | fragGenerations[slot] << FRAG_GEN_SHIFT;
+    }
   }
 
-  lastFragIndex = index;
-  return index;
+  // We have wrapped around => no slots available.
+  soft_assert(false);
+  return -1;
 }
 
 bool Orbis::position(Struct* str)
@@ -224,7 +207,7 @@ Struct* Orbis::add(const BSP* bsp, const Point& p, Heading heading)
   }
 
   Struct* str = new Struct(bsp, index, p, heading);
-  structs[1 + index] = str;
+  structs[1 + strSlot(index)] = str;
 
   return str;
 }
@@ -237,7 +220,7 @@ Object* Orbis::add(const ObjectClass* clazz, const Point& p, Heading heading)
   }
 
   Object* obj = clazz->create(index, p, heading);
-  objects[1 + index] = obj;
+  objects[1 + objSlot(index)] = obj;
 
   if (obj->flags & Object::LUA_BIT) {
     luaMatrix.registerObject(index);
@@ -254,7 +237,7 @@ Frag* Orbis::add(const FragPool* pool, const Point& p, const Vec3& velocity)
   }
 
   Frag* frag = new Frag(pool, index, p, velocity);
-  frags[1 + index] = frag;
+  frags[1 + fragSlot(index)] = frag;
 
   return frag;
 }
@@ -263,8 +246,10 @@ void Orbis::remove(Struct* str)
 {
   hard_assert(str->index >= 0);
 
-  pendingStructs[freeing].set(str->index);
-  structs[1 + str->index] = nullptr;
+  int slot = strSlot(str->index);
+
+  structGenerations[slot] = ushort((structGenerations[slot] + 1) & STR_GEN_MASK);
+  structs[1 + slot] = nullptr;
   delete str;
 }
 
@@ -276,8 +261,10 @@ void Orbis::remove(Object* obj)
     luaMatrix.unregisterObject(obj->index);
   }
 
-  pendingObjects[freeing].set(obj->index);
-  objects[1 + obj->index] = nullptr;
+  int slot = objSlot(obj->index);
+
+  objectGenerations[slot] = ushort((objectGenerations[slot] + 1) & OBJ_GEN_MASK);
+  objects[1 + slot] = nullptr;
   delete obj;
 }
 
@@ -285,8 +272,10 @@ void Orbis::remove(Frag* frag)
 {
   hard_assert(frag->index >= 0 && frag->cell == nullptr);
 
-  pendingFrags[freeing].set(frag->index);
-  frags[1 + frag->index] = nullptr;
+  int slot = fragSlot(frag->index);
+
+  fragGenerations[slot] = ushort((fragGenerations[slot] + 1) & FRAG_GEN_MASK);
+  frags[1 + slot] = nullptr;
   delete frag;
 }
 
@@ -349,12 +338,6 @@ void Orbis::resetLastIndices()
 
 void Orbis::update()
 {
-  pendingStructs[waiting].clearAll();
-  pendingObjects[waiting].clearAll();
-  pendingFrags[waiting].clearAll();
-
-  swap(freeing, waiting);
-
   caelum.update();
 }
 
@@ -376,7 +359,7 @@ void Orbis::read(Stream* is)
     Struct* str = new Struct(bsp, is);
 
     position(str);
-    structs[1 + str->index] = str;
+    structs[1 + strSlot(str->index)] = str;
   }
 
   for (int i = 0; i < nObjects; ++i) {
@@ -390,7 +373,7 @@ void Orbis::read(Stream* is)
     if (!(obj->flags & Object::DYNAMIC_BIT) || dyn->parent < 0) {
       position(obj);
     }
-    objects[1 + obj->index] = obj;
+    objects[1 + objSlot(obj->index)] = obj;
   }
 
   for (int i = 0; i < nFrags; ++i) {
@@ -399,19 +382,22 @@ void Orbis::read(Stream* is)
     Frag*           frag = new Frag(pool, is);
 
     position(frag);
-    frags[1 + frag->index] = frag;
+    frags[1 + fragSlot(frag->index)] = frag;
   }
 
   lastStructIndex = is->readInt();
   lastObjectIndex = is->readInt();
   lastFragIndex   = is->readInt();
 
-  is->readBitset(pendingStructs[freeing], pendingStructs[freeing].length());
-  is->readBitset(pendingStructs[waiting], pendingStructs[waiting].length());
-  is->readBitset(pendingObjects[freeing], pendingObjects[freeing].length());
-  is->readBitset(pendingObjects[waiting], pendingObjects[waiting].length());
-  is->readBitset(pendingFrags[freeing], pendingFrags[freeing].length());
-  is->readBitset(pendingFrags[waiting], pendingFrags[waiting].length());
+  for (int i = 0; i < MAX_STRUCTS; ++i) {
+    structGenerations[i] = is->readUShort();
+  }
+  for (int i = 0; i < MAX_OBJECTS; ++i) {
+    objectGenerations[i] = is->readUShort();
+  }
+  for (int i = 0; i < MAX_FRAGS; ++i) {
+    fragGenerations[i] = is->readUShort();
+  }
 }
 
 void Orbis::read(const Json& json)
@@ -427,7 +413,7 @@ void Orbis::read(const Json& json)
     if (index >= 0) {
       Struct* str = new Struct(bsp, index, strJson);
       position(str);
-      structs[1 + index] = str;
+      structs[1 + strSlot(index)] = str;
     }
   }
 
@@ -447,7 +433,7 @@ void Orbis::read(const Json& json)
       if (!(obj->flags & Object::DYNAMIC_BIT) || dyn->parent < 0) {
         position(obj);
       }
-      objects[1 + obj->index] = obj;
+      objects[1 + objSlot(obj->index)] = obj;
 
       for (const Json& itemJson : objJson["items"].arrayCIter()) {
         String              itemName  = itemJson["class"].get("");
@@ -471,7 +457,7 @@ void Orbis::read(const Json& json)
             luaMatrix.registerObject(item->index);
           }
 
-          objects[1 + item->index] = item;
+          objects[1 + objSlot(item->index)] = item;
         }
       }
     }
@@ -497,7 +483,7 @@ int Orbis::readObject(const Json& json)
   if (!(obj->flags & Object::DYNAMIC_BIT) || dyn->parent < 0) {
     position(obj);
   }
-  objects[1 + obj->index] = obj;
+  objects[1 + objSlot(obj->index)] = obj;
 
   return index;
 }
@@ -547,12 +533,15 @@ void Orbis::write(Stream* os) const
   os->writeInt(lastObjectIndex);
   os->writeInt(lastFragIndex);
 
-  os->writeBitset(pendingStructs[freeing], pendingStructs[freeing].length());
-  os->writeBitset(pendingStructs[waiting], pendingStructs[waiting].length());
-  os->writeBitset(pendingObjects[freeing], pendingObjects[freeing].length());
-  os->writeBitset(pendingObjects[waiting], pendingObjects[waiting].length());
-  os->writeBitset(pendingFrags[freeing], pendingFrags[freeing].length());
-  os->writeBitset(pendingFrags[waiting], pendingFrags[waiting].length());
+  for (int i = 0; i < MAX_STRUCTS; ++i) {
+    os->writeUShort(structGenerations[i]);
+  }
+  for (int i = 0; i < MAX_OBJECTS; ++i) {
+    os->writeUShort(objectGenerations[i]);
+  }
+  for (int i = 0; i < MAX_FRAGS; ++i) {
+    os->writeUShort(fragGenerations[i]);
+  }
 }
 
 Json Orbis::write() const
@@ -574,7 +563,7 @@ Json Orbis::write() const
       structsJson.add(str->write());
 
       for (int j : str->boundObjects) {
-        if (objects[1 + j] != nullptr) {
+        if (obj(j) != nullptr) {
           boundObjects.add(j);
         }
       }
@@ -602,7 +591,7 @@ void Orbis::unload()
 {
   for (int i = 0; i < MAX_OBJECTS; ++i) {
     if (objects[1 + i] != nullptr && (objects[1 + i]->flags & Object::LUA_BIT)) {
-      luaMatrix.unregisterObject(i);
+      luaMatrix.unregisterObject(objects[1 + i]->index);
     }
   }
 
@@ -625,7 +614,7 @@ void Orbis::unload()
 
   Frag::mpool.free();
 
-  Object::Event::pool.free();
+  Object::Event::arena.free();
   Object::pool.free();
   Dynamic::pool.free();
   Weapon::pool.free();
@@ -641,12 +630,9 @@ void Orbis::unload()
   lastObjectIndex = -1;
   lastFragIndex   = -1;
 
-  pendingStructs[0].clearAll();
-  pendingStructs[1].clearAll();
-  pendingObjects[0].clearAll();
-  pendingObjects[1].clearAll();
-  pendingFrags[0].clearAll();
-  pendingFrags[1].clearAll();
+  Arrays::fill(structGenerations, MAX_STRUCTS, ushort(0));
+  Arrays::fill(objectGenerations, MAX_OBJECTS, ushort(0));
+  Arrays::fill(fragGenerations, MAX_FRAGS, ushort(0));
 }
 
 void Orbis::init()
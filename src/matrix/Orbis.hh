@@ -58,6 +58,21 @@ public:
   static const int MAX_OBJECTS = (1 << 15) - 1;
   static const int MAX_FRAGS   = (1 << 12) - 1;
 
+  // Structure, object and fragment indices are handles. The low bits hold a slot (masked by
+  // `MAX_STRUCTS`, `MAX_OBJECTS` or `MAX_FRAGS`) and the high bits a generation of that slot that
+  // is bumped whenever the slot is freed, so a stale index never resolves to a newer entity.
+  // Structure generations are short (5 bits) since a structure index must fit into a `short` in
+  // `Cell::structs` and entity indices put it above `Struct::MAX_ENT_SHIFT` bits. Shrinking the
+  // entity field would not help as `Cell::structs` is the tighter limit. This is acceptable since
+  // slots are allocated round-robin, so a handle only aliases a newer structure after its slot has
+  // been reused 32 times, i.e. after tens of thousands of structures have been created meanwhile.
+  static const int STR_GEN_SHIFT  = 10;
+  static const int OBJ_GEN_SHIFT  = 15;
+  static const int FRAG_GEN_SHIFT = 12;
+  static const int STR_GEN_MASK   = (1 << (31 - Struct::MAX_ENT_SHIFT - STR_GEN_SHIFT)) - 1;
+  static const int OBJ_GEN_MASK   = (1 << 16) - 1;
+  static const int FRAG_GEN_MASK  = (1 << 16) - 1;
+
   Caelum  caelum;
   Terra   terra;
   Cell    cells[CELLS][CELLS];
@@ -97,14 +112,42 @@ public:
   void reposition(Frag* frag);
 
   /**
-   * Return structure at a given index, nullptr if index is -1.
+   * Slot of a structure with a given index.
+   */
+  OZ_ALWAYS_INLINE
+  static int strSlot(int index)
+  {
+    return index & MAX_STRUCTS;
+  }
+
+  /**
+   * Slot of an object with a given index.
+   */
+  OZ_ALWAYS_INLINE
+  static int objSlot(int index)
+  {
+    return index & MAX_OBJECTS;
+  }
+
+  /**
+   * Slot of a fragment with a given index.
+   */
+  OZ_ALWAYS_INLINE
+  static int fragSlot(int index)
+  {
+    return index & MAX_FRAGS;
+  }
+
+  /**
+   * Return structure at a given index, nullptr if index is -1, invalid or stale.
    */
   OZ_ALWAYS_INLINE
   Struct* str(int index) const
   {
-    hard_assert(uint(1 + index) <= uint(MAX_STRUCTS));
+    // Index -1 and the never allocated last slot both wrap to the null slot 0.
+    Struct* str = structs[(uint(index) + 1) & MAX_STRUCTS];
 
-    return structs[1 + index];
+    return str != nullptr && str->index == index ? str : nullptr;
   }
 
   /**
@@ -112,10 +155,7 @@ public:
    */
   Entity* ent(int index) const
   {
-    hard_assert(uint(1 + index) <= uint(MAX_STRUCTS * Struct::MAX_ENTITIES));
-
-    int     strIndex = index >> Struct::MAX_ENT_SHIFT;
-    Struct* str      = structs[1 + strIndex];
+    Struct* str = this->str(index >> Struct::MAX_ENT_SHIFT);
 
     if (str == nullptr) {
       return nullptr;
@@ -129,26 +169,60 @@ public:
   }
 
   /**
-   * Return object at a given index, nullptr if index is -1.
+   * Return object at a given index, nullptr if index is -1, invalid or stale.
    */
   template <class ObjectType = Object>
   OZ_ALWAYS_INLINE
   ObjectType* obj(int index) const
   {
-    hard_assert(uint(1 + index) <= uint(MAX_OBJECTS));
+    Object* obj = objects[(uint(index) + 1) & MAX_OBJECTS];
 
-    return static_cast<ObjectType*>(objects[1 + index]);
+    return static_cast<ObjectType*>(obj != nullptr && obj->index == index ? obj : nullptr);
   }
 
   /**
-   * Return fragment at a given index, nullptr if index is -1.
+   * Return fragment at a given index, nullptr if index is -1, invalid or stale.
    */
   OZ_ALWAYS_INLINE
   Frag* frag(int index) const
   {
-    hard_assert(uint(1 + index) <= uint(MAX_FRAGS));
+    Frag* frag = frags[(uint(index) + 1) & MAX_FRAGS];
 
-    return frags[1 + index];
+    return frag != nullptr && frag->index == index ? frag : nullptr;
+  }
+
+  /**
+   * Return structure in a given slot, nullptr if the slot is empty.
+   */
+  OZ_ALWAYS_INLINE
+  Struct* strAt(int slot) const
+  {
+    hard_assert(uint(slot) < uint(MAX_STRUCTS));
+
+    return structs[1 + slot];
+  }
+
+  /**
+   * Return object in a given slot, nullptr if the slot is empty.
+   */
+  template <class ObjectType = Object>
+  OZ_ALWAYS_INLINE
+  ObjectType* objAt(int slot) const
+  {
+    hard_assert(uint(slot) < uint(MAX_OBJECTS));
+
+    return static_cast<ObjectType*>(objects[1 + slot]);
+  }
+
+  /**
+   * Return fragment in a given slot, nullptr if the slot is empty.
+   */
+  OZ_ALWAYS_INLINE
+  Frag* fragAt(int slot) const
+  {
+    hard_assert(uint(slot) < uint(MAX_FRAGS));
+
+    return frags[1 + slot];
   }
 
   /**
@@ -157,9 +231,7 @@ public:
   OZ_ALWAYS_INLINE
   int strIndex(int index) const
   {
-    hard_assert(uint(1 + index) <= uint(MAX_STRUCTS));
-
-    return structs[1 + index] == nullptr ? -1 : index;
+    return str(index) == nullptr ? -1 : index;
   }
 
   /**
@@ -168,12 +240,7 @@ public:
   OZ_ALWAYS_INLINE
   int entIndex(int index) const
   {
-    hard_assert(uint(1 + index) <= uint(MAX_STRUCTS * Struct::MAX_ENTITIES));
-
-    int     strIndex = index >> Struct::MAX_ENT_SHIFT;
-    Struct* str      = structs[1 + strIndex];
-
-    return str == nullptr ? -1 : index;
+    return str(index >> Struct::MAX_ENT_SHIFT) == nullptr ? -1 : index;
   }
 
   /**
@@ -182,9 +249,7 @@ public:
   OZ_ALWAYS_INLINE
   int objIndex(int index) const
   {
-    hard_assert(uint(1 + index) <= uint(MAX_OBJECTS));
-
-    return objects[1 + index] == nullptr ? -1 : index;
+    return obj(index) == nullptr ? -1 : index;
   }
 
   /**
@@ -193,9 +258,7 @@ public:
   OZ_ALWAYS_INLINE
   int fragIndex(int index) const
   {
-    hard_assert(uint(1 + index) <= uint(MAX_FRAGS));
-
-    return frags[1 + index] == nullptr ? -1 : index;
+    return frag(index) == nullptr ? -1 : index;
   }
 
   // get pointer to the cell the point is in
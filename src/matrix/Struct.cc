@@ -190,7 +190,7 @@ void Entity::autoDoorHandler()
 {
   switch (state) {
     case CLOSED: {
-      if ((timer.ticks + uint(str->index * 1025)) % (Timer::TICKS_PER_SEC / 6) == 0 &&
+      if ((timer.ticks + uint(str->index) * 1025u) % (Timer::TICKS_PER_SEC / 6) == 0 &&
           collider.overlaps(this, clazz->margin))
       {
         state    = OPENING;
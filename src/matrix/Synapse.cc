@@ -289,7 +289,8 @@ void Synapse::remove(Object* obj)
 {
   hard_assert(obj->index >= 0);
 
-  for (int i = 0; i < obj->items.length(); ++i) {
+  // Removed items unlink themselves from this object, hence the reverse order.
+  for (int i = obj->items.length() - 1; i >= 0; --i) {
     Object* item = orbis.obj(obj->items[i]);
 
     if (item != nullptr) {
@@ -297,6 +298,21 @@ void Synapse::remove(Object* obj)
     }
   }
 
+  if (obj->flags & Object::DYNAMIC_BIT) {
+    Object* container = orbis.obj(static_cast<Dynamic*>(obj)->parent);
+
+    // Slots are reused immediately, so inventories must never hold indices of removed objects.
+    if (container != nullptr) {
+      container->items.exclude(obj->index);
+
+      if (container->flags & Object::BOT_BIT) {
+        Bot* bot = static_cast<Bot*>(container);
+
+        bot->weapon = bot->weapon == obj->index ? -1 : bot->weapon;
+      }
+    }
+  }
+
   removedObjects.add(obj->index);
 
   if (obj->cell != nullptr) {
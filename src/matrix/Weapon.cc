@@ -70,7 +70,7 @@ void Weapon::onUpdate()
   }
 
   if ((flags & LUA_BIT) && !clazz->onUpdate.isEmpty()) {
-    luaMatrix.objectCall(clazz->onUpdate, this);
+    luaMatrix.objectCall(clazz->onUpdateRef, clazz->onUpdate, this);
   }
 
   if (!(flags & Object::UPDATE_FUNC_BIT)) {
@@ -97,7 +97,7 @@ void Weapon::trigger(Bot* user)
 
     shotTime = clazz->shotInterval;
 
-    if (nRounds != 0 && luaMatrix.objectCall(clazz->onShot, this, user)) {
+    if (nRounds != 0 && luaMatrix.objectCall(clazz->onShotRef, clazz->onShot, this, user)) {
       nRounds = max(-1, nRounds - 1);
       success = true;
     }
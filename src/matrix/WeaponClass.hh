@@ -38,6 +38,8 @@ public:
   float  shotInterval;
 
   String onShot;
+  // Lua registry reference to `onShot`, resolved by `LuaMatrix::init()`.
+  mutable int onShotRef = -1;
 
 public:
 
@@ -233,13 +233,7 @@ static int ozOrbisOverlaps(lua_State* l)
 
   const Object* exclObj = nullptr;
   if (l_gettop() == 8) {
-    int index = l_toint(8);
-
-    if (uint(index) >= uint(Orbis::MAX_OBJECTS)) {
-      ERROR("Invalid excluded object index (out of range)");
-    }
-
-    exclObj = orbis.obj(index);
+    exclObj = orbis.obj(l_toint(8));
   }
 
   hard_assert(collider.mask == Object::SOLID_BIT);
@@ -422,13 +416,7 @@ static int ozBindStr(lua_State* l)
 {
   ARG(1);
 
-  int index = l_toint(1);
-  if (uint(index) >= uint(Orbis::MAX_STRUCTS)) {
-    ms.str = nullptr;
-  }
-  else {
-    ms.str = orbis.str(index);
-  }
+  ms.str = orbis.str(l_toint(1));
 
   l_pushbool(ms.str != nullptr);
   return 1;
@@ -1173,13 +1161,7 @@ static int ozBindObj(lua_State* l)
 {
   ARG(1);
 
-  int index = l_toint(1);
-  if (uint(index) >= uint(Orbis::MAX_OBJECTS)) {
-    ms.obj = nullptr;
-  }
-  else {
-    ms.obj = orbis.obj(index);
-  }
+  ms.obj = orbis.obj(l_toint(1));
 
   l_pushbool(ms.obj != nullptr);
   return 1;
@@ -1798,6 +1780,112 @@ static int ozObjIsVisibleFromSelfEye(lua_State* l)
   return 1;
 }
 
+/*
+ * Batched object queries
+ *
+ * These write position, life and flags of many objects into a flat table in a single call, so
+ * scripts need not bind and query each object separately. If a result table is passed it is
+ * reused, which avoids creating garbage in per-tick scripts.
+ */
+
+static void queryObj(lua_State* l, int table, int first, const Object* obj)
+{
+  if (obj == nullptr) {
+    l_pushfloat(0.0f);
+    l_rawseti(table, first + 0);
+    l_pushfloat(0.0f);
+    l_rawseti(table, first + 1);
+    l_pushfloat(0.0f);
+    l_rawseti(table, first + 2);
+    l_pushfloat(-1.0f);
+    l_rawseti(table, first + 3);
+    l_pushint(0);
+    l_rawseti(table, first + 4);
+    return;
+  }
+
+  // Items in inventories are cut from the world, use their containers' positions.
+  const Object* posObj = obj;
+
+  if (obj->cell == nullptr) {
+    hard_assert(obj->flags & Object::DYNAMIC_BIT);
+
+    const Object* parent = orbis.obj(static_cast<const Dynamic*>(obj)->parent);
+    if (parent != nullptr) {
+      posObj = parent;
+    }
+  }
+
+  l_pushfloat(posObj->p.x);
+  l_rawseti(table, first + 0);
+  l_pushfloat(posObj->p.y);
+  l_rawseti(table, first + 1);
+  l_pushfloat(posObj->p.z);
+  l_rawseti(table, first + 2);
+  l_pushfloat(obj->life);
+  l_rawseti(table, first + 3);
+  l_pushint(obj->flags);
+  l_rawseti(table, first + 4);
+}
+
+static int ozObjQuery(lua_State* l)
+{
+  VARG(1, 2);
+
+  if (l_type(1) != LUA_TTABLE) {
+    ERROR("Table of object indices expected");
+  }
+
+  if (l_gettop() == 1) {
+    l_newtable();
+  }
+  else if (l_type(2) != LUA_TTABLE) {
+    ERROR("Result table expected");
+  }
+
+  int nObjects = l_rawlen(1);
+
+  for (int i = 0; i < nObjects; ++i) {
+    l_rawgeti(1, i + 1);
+    int index = l_toint(-1);
+    l_pop(1);
+
+    queryObj(l, 2, 5*i + 1, orbis.obj(index));
+  }
+
+  l_settop(2);
+  return 1;
+}
+
+static int ozBoundObjsQuery(lua_State* l)
+{
+  VARG(0, 1);
+
+  if (l_gettop() == 0) {
+    l_newtable();
+  }
+  else if (l_type(1) != LUA_TTABLE) {
+    ERROR("Result table expected");
+  }
+
+  int nObjects = 0;
+
+  for (int i = ms.objIndex; i < ms.objects.length(); ++i) {
+    const Object* obj = ms.objects[i];
+
+    if (obj != nullptr) {
+      l_pushint(obj->index);
+      l_rawseti(1, 6*nObjects + 1);
+      queryObj(l, 1, 6*nObjects + 2, obj);
+      ++nObjects;
+    }
+  }
+
+  l_settop(1);
+  l_pushint(nObjects);
+  return 2;
+}
+
 /*
  * Dynamic object
  */
@@ -2447,13 +2535,7 @@ static int ozFragBindIndex(lua_State* l)
 {
   ARG(1);
 
-  int index = l_toint(1);
-  if (uint(index) >= uint(Orbis::MAX_FRAGS)) {
-    ms.frag = nullptr;
-  }
-  else {
-    ms.frag = orbis.frag(index);
-  }
+  ms.frag = orbis.frag(l_toint(1));
 
   l_pushbool(ms.frag != nullptr);
   return 1;
@@ -33,7 +33,30 @@ namespace oz
 // For IMPORT_FUNC()/IGNORE_FUNC() macros.
 static LuaNirvana& lua = luaNirvana;
 
-void LuaNirvana::mindCall(const char* functionName, Mind* mind, Bot* self)
+void LuaNirvana::resolveMinds()
+{
+  for (const ObjectClass* clazz : liber.objClasses) {
+    if (clazz->flags & Object::BOT_BIT) {
+      const BotClass* botClazz = static_cast<const BotClass*>(clazz);
+
+      botClazz->mindRef = functionRef(botClazz->mind);
+    }
+  }
+}
+
+void LuaNirvana::releaseMinds()
+{
+  for (const ObjectClass* clazz : liber.objClasses) {
+    if (clazz->flags & Object::BOT_BIT) {
+      const BotClass* botClazz = static_cast<const BotClass*>(clazz);
+
+      releaseRef(botClazz->mindRef);
+      botClazz->mindRef = -1;
+    }
+  }
+}
+
+void LuaNirvana::mindCall(Mind* mind, Bot* self)
 {
   hard_assert(l_gettop() == 1 && mind != nullptr && self != nullptr);
 
@@ -46,10 +69,22 @@ void LuaNirvana::mindCall(const char* functionName, Mind* mind, Bot* self)
   ns.mind     = mind;
   ns.device   = nullptr;
 
-  l_getglobal(functionName);
+  const BotClass* clazz        = static_cast<const BotClass*>(self->clazz);
+  const char*     functionName = self->mind;
+
+  // Bots whose mind has been changed from their class default (e.g. via `ozBotSetMind()`) fall
+  // back to a global look-up.
+  if (clazz->mindRef >= 0 && self->mind.length() == clazz->mind.length() &&
+      self->mind == clazz->mind)
+  {
+    l_getref(clazz->mindRef);
+  }
+  else {
+    l_getglobal(functionName);
+  }
   l_rawgeti(1, self->index);
 
-  if (l_pcall(1, 0) != LUA_OK) {
+  if (pcall(1, 0, functionName, self->clazz->name) != LUA_OK) {
     Log::println("Lua[N] in %s(self = %d): %s", functionName, self->index, l_tostring(-1));
     System::bell();
 
@@ -114,7 +149,7 @@ void LuaNirvana::init()
 {
   Log::print("Initialising Nirvana Lua ...");
 
-  Lua::init();
+  Lua::init("nirvana");
 
   ls.envName = "nirvana";
   ms.structs.reserve(32);
@@ -305,6 +340,9 @@ void LuaNirvana::init()
   IMPORT_FUNC(ozObjIsVisibleFromSelf);
   IMPORT_FUNC(ozObjIsVisibleFromSelfEye);
 
+  IMPORT_FUNC(ozObjQuery);
+  IMPORT_FUNC(ozBoundObjsQuery);
+
   /*
    * Dynamic object
    */
@@ -513,6 +551,8 @@ void LuaNirvana::init()
   loadDir("@lua/common");
   loadDir("@lua/nirvana");
 
+  resolveMinds();
+
   hard_assert(l_gettop() == 1);
 
   Log::printEnd(" OK");
@@ -532,6 +572,8 @@ void LuaNirvana::destroy()
   ms.objects.clear();
   ms.objects.trim();
 
+  releaseMinds();
+
   hard_assert(l_gettop() == 1);
   hard_assert((l_pushnil(), true));
   hard_assert(!l_next(1));
@@ -32,9 +32,14 @@ namespace oz
 
 class LuaNirvana : public Lua
 {
+private:
+
+  void resolveMinds();
+  void releaseMinds();
+
 public:
 
-  void mindCall(const char* functionName, Mind* mind, Bot* self);
+  void mindCall(Mind* mind, Bot* self);
 
   void registerMind(int botIndex);
   void unregisterMind(int botIndex);
@@ -104,7 +104,7 @@ void Mind::update(bool doRegularUpdate)
     flags &= ~FORCE_UPDATE_BIT;
     botObj->actions = 0;
 
-    luaNirvana.mindCall(botObj->mind, this, botObj);
+    luaNirvana.mindCall(this, botObj);
   }
 }
 
@@ -34,6 +34,10 @@
 #include <cstring>
 #include <malloc.h>
 
+#ifndef _WIN32
+# include <pthread.h>
+#endif
+
 namespace oz
 {
 
@@ -43,118 +47,482 @@ enum AllocMode
   ARRAY
 };
 
-static const char* const       ALLOC_MODE_NAMES[2] = { "object", "array" };
-static Chain<Alloc::ChunkInfo> chunkInfos[2];
-static SpinLock                allocInfoLock;
+static const char* const ALLOC_MODE_NAMES[2] = { "object", "array" };
 
-static void* allocate(AllocMode mode, size_t size)
+static void* systemAlloc(size_t size)
 {
-  static_cast<void>(mode);
-
-  size_t chunkSize = size;
-#ifdef OZ_ALLOCATOR
-  chunkSize += Alloc::alignUp(sizeof(Alloc::ChunkInfo));
-#endif
-
 #if defined(OZ_SIMD) && defined(_ISOC11_SOURCE)
-  void* ptr = aligned_alloc(OZ_ALIGNMENT, chunkSize);
+  return aligned_alloc(OZ_ALIGNMENT, Alloc::alignUp(size));
 #elif defined(OZ_SIMD) && defined(_WIN32)
-  void* ptr = _aligned_malloc(chunkSize, OZ_ALIGNMENT);
+  return _aligned_malloc(size, OZ_ALIGNMENT);
 #elif defined(OZ_SIMD)
-  void* ptr = memalign(OZ_ALIGNMENT, chunkSize);
+  return memalign(OZ_ALIGNMENT, size);
 #else
-  void* ptr = malloc(chunkSize);
+  return malloc(size);
 #endif
+}
 
-  if (ptr == nullptr) {
-    OZ_ERROR("oz::Alloc: Out of memory while trying to allocate an %s of %llu B",
-             ALLOC_MODE_NAMES[mode], ulong64(size));
-  }
+static void systemFree(void* ptr)
+{
+#if defined(OZ_SIMD) && defined(_WIN32)
+  _aligned_free(ptr);
+#else
+  free(ptr);
+#endif
+}
 
 #ifdef OZ_ALLOCATOR
 
-  Alloc::ChunkInfo* ci = new(ptr) Alloc::ChunkInfo{ {}, size, StackTrace::current(2) };
+static const uint   CHUNK_MAGIC  = 0x0a110c8d;
+static const ubyte  LARGE_CLASS  = 0xff;
+static const size_t SLAB_SIZE    = 64 * 1024;
+static const int    MIN_SAMPLES  = 256;
 
-  allocInfoLock.lock();
+/**
+ * Meta data preceding each block.
+ */
+struct ChunkHeader
+{
+  size_t size;      ///< Size excluding meta data.
+  uint   magic;     ///< `CHUNK_MAGIC` while allocated.
+  ubyte  mode;      ///< `AllocMode`.
+  ubyte  sizeClass; ///< Size class index or `LARGE_CLASS`.
+  bool   isSampled; ///< Registered in samples hash table.
+};
 
-  chunkInfos[mode].add(ci);
+static const size_t HEADER_SIZE = Alloc::alignUp(sizeof(ChunkHeader));
 
-  ++Alloc::count;
-  Alloc::amount += size;
+/**
+ * Cached block, link overlays the header.
+ */
+struct FreeBlock
+{
+  FreeBlock* next;
+};
 
-  ++Alloc::sumCount;
-  Alloc::sumAmount += size;
+/**
+ * Shared pool for a size class.
+ */
+struct CentralList
+{
+  SpinLock   lock;
+  FreeBlock* freeBlocks;
+  char*      slabPos;
+  char*      slabEnd;
+};
 
-  Alloc::maxCount  = max<int>(Alloc::count, Alloc::maxCount);
-  Alloc::maxAmount = max<size_t>(Alloc::amount, Alloc::maxAmount);
+/**
+ * Per-thread free lists and sampling state.
+ */
+struct ThreadCache
+{
+  FreeBlock* freeBlocks[Alloc::N_SIZE_CLASSES];
+  int        nFree[Alloc::N_SIZE_CLASSES];
+  int        sampleCountdown;
+  bool       isRegistered;
+};
 
-  allocInfoLock.unlock();
+static CentralList              centralLists[Alloc::N_SIZE_CLASSES];
+static thread_local ThreadCache threadCache;
 
-  ptr = static_cast<char*>(ptr) + Alloc::alignUp(sizeof(Alloc::ChunkInfo));
+static SpinLock                 sampleLock;
+static Alloc::ChunkInfo*        samples        = nullptr;
+static int                      sampleCapacity = 0;
+static int                      nSamples       = 0;
 
+#ifndef _WIN32
+static pthread_once_t           cacheKeyOnce   = PTHREAD_ONCE_INIT;
+static pthread_key_t            cacheKey;
 #endif
 
-  return ptr;
+// Size classes grow by 16 B up to 128 B and then in four steps per doubling.
+static int sizeClassIndex(size_t size)
+{
+  if (size <= 128) {
+    return int((size + 15) / 16) - 1;
+  }
+
+  int log2 = 31 - __builtin_clz(uint(size - 1));
+  return 4 * log2 - 24 + int((size - 1) >> (log2 - 2));
 }
 
-static void deallocate(AllocMode mode, void* ptr)
+// Number of blocks moved between a thread cache and a central list at once.
+static int batchSize(int sizeClass)
 {
-  static_cast<void>(mode);
+  return clamp(int(8192 / Alloc::sizeClasses[sizeClass].size), 4, 64);
+}
 
-#ifdef OZ_ALLOCATOR
+template <typename Value>
+static void updateMax(Value* maxValue, Value value)
+{
+  Value current = __atomic_load_n(maxValue, __ATOMIC_RELAXED);
+
+  while (value > current && !__atomic_compare_exchange_n(maxValue, &current, value, true,
+                                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+  {}
+}
+
+static void releaseBlocks(int sizeClass, FreeBlock* first, FreeBlock* last)
+{
+  CentralList& central = centralLists[sizeClass];
+
+  central.lock.lock();
+
+  last->next         = central.freeBlocks;
+  central.freeBlocks = first;
+
+  central.lock.unlock();
+}
+
+static void releaseCache(void*)
+{
+  ThreadCache& cache = threadCache;
 
-  ptr = static_cast<char*>(ptr) - Alloc::alignUp(sizeof(Alloc::ChunkInfo));
+  for (int i = 0; i < Alloc::N_SIZE_CLASSES; ++i) {
+    FreeBlock* first = cache.freeBlocks[i];
 
-  allocInfoLock.lock();
+    if (first != nullptr) {
+      FreeBlock* last = first;
 
-  Alloc::ChunkInfo* ci   = static_cast<Alloc::ChunkInfo*>(ptr);
-  Alloc::ChunkInfo* prev = chunkInfos[mode].before(ci);
+      while (last->next != nullptr) {
+        last = last->next;
+      }
+      releaseBlocks(i, first, last);
 
-  if (prev != nullptr || chunkInfos[mode].first() == ci) {
-    chunkInfos[mode].erase(ci, prev);
+      cache.freeBlocks[i] = nullptr;
+      cache.nFree[i]      = 0;
+    }
   }
-  // Check if allocated as a different kind (object/array)
-  else if (chunkInfos[!mode].has(ci)) {
-    OZ_ERROR("oz::Alloc: new[] -> delete mismatch for %s block at %p of size %lu",
-             ALLOC_MODE_NAMES[mode], ptr, ulong(ci->size));
+
+  cache.isRegistered = false;
+}
+
+#ifndef _WIN32
+
+static void createCacheKey()
+{
+  pthread_key_create(&cacheKey, releaseCache);
+}
+
+#endif
+
+// Move a batch of blocks from the central list, carving a new slab if necessary.
+static void refillCache(ThreadCache* cache, int sizeClass)
+{
+  if (!cache->isRegistered) {
+    cache->isRegistered = true;
+
+#ifndef _WIN32
+    pthread_once(&cacheKeyOnce, createCacheKey);
+    pthread_setspecific(cacheKey, cache);
+#endif
+  }
+
+  CentralList& central   = centralLists[sizeClass];
+  size_t       blockSize = Alloc::sizeClasses[sizeClass].size;
+  int          nBlocks   = batchSize(sizeClass);
+  FreeBlock*   first     = nullptr;
+  int          nCarved   = 0;
+
+  central.lock.lock();
+
+  for (int i = 0; i < nBlocks; ++i) {
+    FreeBlock* block = central.freeBlocks;
+
+    if (block != nullptr) {
+      central.freeBlocks = block->next;
+    }
+    else {
+      if (central.slabPos == central.slabEnd) {
+        central.slabPos = static_cast<char*>(systemAlloc(SLAB_SIZE));
+
+        if (central.slabPos == nullptr) {
+          central.slabEnd = nullptr;
+          central.lock.unlock();
+
+          OZ_ERROR("oz::Alloc: Out of memory while trying to allocate a %llu B slab",
+                   ulong64(SLAB_SIZE));
+        }
+        central.slabEnd = central.slabPos + SLAB_SIZE / blockSize * blockSize;
+      }
+
+      block            = reinterpret_cast<FreeBlock*>(central.slabPos);
+      central.slabPos += blockSize;
+      ++nCarved;
+    }
+
+    block->next = first;
+    first       = block;
+  }
+
+  central.lock.unlock();
+
+  __atomic_add_fetch(&Alloc::sizeClasses[sizeClass].nBlocks, nCarved, __ATOMIC_RELAXED);
+
+  cache->freeBlocks[sizeClass] = first;
+  cache->nFree[sizeClass]      = nBlocks;
+}
+
+static int sampleSlot(const void* address)
+{
+  return int((uint(size_t(address) >> 4) * 2654435761u) & uint(sampleCapacity - 1));
+}
+
+static void addSample(const void* address, size_t size, AllocMode mode,
+                      const StackTrace& stackTrace)
+{
+  sampleLock.lock();
+
+  if (2 * (nSamples + 1) > sampleCapacity) {
+    Alloc::ChunkInfo* oldSamples  = samples;
+    int               oldCapacity = sampleCapacity;
+
+    sampleCapacity = max<int>(MIN_SAMPLES, 2 * sampleCapacity);
+    samples        = static_cast<Alloc::ChunkInfo*>(calloc(size_t(sampleCapacity),
+                                                           sizeof(Alloc::ChunkInfo)));
+    if (samples == nullptr) {
+      sampleLock.unlock();
+
+      OZ_ERROR("oz::Alloc: Out of memory while growing allocation samples table");
+    }
+
+    for (int i = 0; i < oldCapacity; ++i) {
+      if (oldSamples[i].address != nullptr) {
+        int j = sampleSlot(oldSamples[i].address);
+
+        while (samples[j].address != nullptr) {
+          j = (j + 1) & (sampleCapacity - 1);
+        }
+        samples[j] = oldSamples[i];
+      }
+    }
+    free(oldSamples);
+  }
+
+  int i = sampleSlot(address);
+
+  while (samples[i].address != nullptr) {
+    i = (i + 1) & (sampleCapacity - 1);
+  }
+  samples[i] = Alloc::ChunkInfo{ address, size, mode == ARRAY, stackTrace };
+  ++nSamples;
+
+  sampleLock.unlock();
+}
+
+// Linear probing with backward-shift deletion, so no tombstones are needed.
+static void removeSample(const void* address)
+{
+  sampleLock.lock();
+
+  int mask = sampleCapacity - 1;
+  int i    = sampleSlot(address);
+
+  while (samples[i].address != address) {
+    hard_assert(samples[i].address != nullptr);
+
+    i = (i + 1) & mask;
+  }
+
+  for (int j = (i + 1) & mask; samples[j].address != nullptr; j = (j + 1) & mask) {
+    int  home    = sampleSlot(samples[j].address);
+    bool isFixed = i <= j ? i < home && home <= j : i < home || home <= j;
+
+    if (!isFixed) {
+      samples[i] = samples[j];
+      i          = j;
+    }
+  }
+
+  samples[i].address = nullptr;
+  --nSamples;
+
+  sampleLock.unlock();
+}
+
+#endif
+
+static void* allocate(AllocMode mode, size_t size)
+{
+#ifdef OZ_ALLOCATOR
+
+  size_t       chunkSize = size + HEADER_SIZE;
+  ubyte        sizeClass = LARGE_CLASS;
+  ThreadCache& cache     = threadCache;
+  ChunkHeader* header;
+
+  if (chunkSize <= Alloc::MAX_SMALL_SIZE) {
+    sizeClass = ubyte(sizeClassIndex(chunkSize));
+
+    if (cache.freeBlocks[sizeClass] == nullptr) {
+      refillCache(&cache, sizeClass);
+    }
+
+    FreeBlock* block = cache.freeBlocks[sizeClass];
+
+    cache.freeBlocks[sizeClass] = block->next;
+    --cache.nFree[sizeClass];
+
+    Alloc::SizeClass& stats = Alloc::sizeClasses[sizeClass];
+
+    updateMax(&stats.maxCount, __atomic_add_fetch(&stats.count, 1, __ATOMIC_RELAXED));
+    __atomic_add_fetch(&stats.sumCount, 1, __ATOMIC_RELAXED);
+
+    header = reinterpret_cast<ChunkHeader*>(block);
   }
   else {
-    OZ_ERROR("oz::Alloc: Freeing unregistered %s block at %p of size %lu",
-             ALLOC_MODE_NAMES[mode], ptr, ulong(ci->size));
+    header = static_cast<ChunkHeader*>(systemAlloc(chunkSize));
+
+    if (header == nullptr) {
+      OZ_ERROR("oz::Alloc: Out of memory while trying to allocate an %s of %llu B",
+               ALLOC_MODE_NAMES[mode], ulong64(size));
+    }
   }
 
-  --Alloc::count;
-  Alloc::amount -= ci->size;
+  header->size      = size;
+  header->magic     = CHUNK_MAGIC;
+  header->mode      = ubyte(mode);
+  header->sizeClass = sizeClass;
+  header->isSampled = false;
 
-  allocInfoLock.unlock();
+  updateMax(&Alloc::maxCount, __atomic_add_fetch(&Alloc::count, 1, __ATOMIC_RELAXED));
+  updateMax(&Alloc::maxAmount, __atomic_add_fetch(&Alloc::amount, chunkSize, __ATOMIC_RELAXED));
+  __atomic_add_fetch(&Alloc::sumCount, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&Alloc::sumAmount, chunkSize, __ATOMIC_RELAXED);
 
-  size_t chunkSize = ci->size + Alloc::alignUp(sizeof(Alloc::ChunkInfo));
-  memset(ptr, 0xee, chunkSize);
+  void* ptr = reinterpret_cast<char*>(header) + HEADER_SIZE;
+
+  // The second condition applies a lowered interval immediately.
+  if (--cache.sampleCountdown <= 0 || cache.sampleCountdown >= Alloc::sampleInterval) {
+    cache.sampleCountdown = max<int>(Alloc::sampleInterval, 1);
+    header->isSampled     = true;
+
+    addSample(ptr, size, mode, StackTrace::current(2));
+  }
+
+  return ptr;
+
+#else
+
+  void* ptr = systemAlloc(size);
+
+  if (ptr == nullptr) {
+    OZ_ERROR("oz::Alloc: Out of memory while trying to allocate an %s of %llu B",
+             ALLOC_MODE_NAMES[mode], ulong64(size));
+  }
+  return ptr;
 
 #endif
+}
+
+static void deallocate(AllocMode mode, void* ptr)
+{
+#ifdef OZ_ALLOCATOR
+
+  ChunkHeader* header = reinterpret_cast<ChunkHeader*>(static_cast<char*>(ptr) - HEADER_SIZE);
+
+  if (header->magic != CHUNK_MAGIC) {
+    OZ_ERROR("oz::Alloc: Freeing unregistered %s block at %p", ALLOC_MODE_NAMES[mode], ptr);
+  }
+  // Check if allocated as a different kind (object/array)
+  if (header->mode != mode) {
+    OZ_ERROR("oz::Alloc: %s mismatch for %s block at %p of size %lu",
+             mode == OBJECT ? "new[] -> delete" : "new -> delete[]", ALLOC_MODE_NAMES[mode], ptr,
+             ulong(header->size));
+  }
+
+  if (header->isSampled) {
+    removeSample(ptr);
+  }
+
+  size_t size      = header->size;
+  ubyte  sizeClass = header->sizeClass;
+
+  __atomic_sub_fetch(&Alloc::count, 1, __ATOMIC_RELAXED);
+  __atomic_sub_fetch(&Alloc::amount, size + HEADER_SIZE, __ATOMIC_RELAXED);
+
+  memset(header, 0xee, size + HEADER_SIZE);
+
+  if (sizeClass == LARGE_CLASS) {
+    systemFree(header);
+    return;
+  }
+
+  __atomic_sub_fetch(&Alloc::sizeClasses[sizeClass].count, 1, __ATOMIC_RELAXED);
+
+  ThreadCache& cache = threadCache;
+  FreeBlock*   block = reinterpret_cast<FreeBlock*>(header);
+  int          batch = batchSize(sizeClass);
+
+  block->next                 = cache.freeBlocks[sizeClass];
+  cache.freeBlocks[sizeClass] = block;
+  ++cache.nFree[sizeClass];
+
+  // Keep at most two batches per class, blocks freed by a different thread than the one that
+  // allocated them thus flow back to the shared pool.
+  if (cache.nFree[sizeClass] > 2 * batch) {
+    FreeBlock* first = cache.freeBlocks[sizeClass];
+    FreeBlock* last  = first;
+
+    for (int i = 1; i < batch; ++i) {
+      last = last->next;
+    }
+
+    cache.freeBlocks[sizeClass] = last->next;
+    cache.nFree[sizeClass]     -= batch;
+
+    releaseBlocks(sizeClass, first, last);
+  }
 
-#if defined(OZ_SIMD) && defined(_WIN32)
-  _aligned_free(ptr));
 #else
-  free(ptr);
+
+  static_cast<void>(mode);
+
+  systemFree(ptr);
+
 #endif
 }
 
-int    Alloc::count     = 0;
-size_t Alloc::amount    = 0;
-int    Alloc::sumCount  = 0;
-size_t Alloc::sumAmount = 0;
-int    Alloc::maxCount  = 0;
-size_t Alloc::maxAmount = 0;
+int              Alloc::count          = 0;
+size_t           Alloc::amount         = 0;
+int              Alloc::sumCount       = 0;
+size_t           Alloc::sumAmount      = 0;
+int              Alloc::maxCount       = 0;
+size_t           Alloc::maxAmount      = 0;
+int              Alloc::sampleInterval = 64;
+
+Alloc::SizeClass Alloc::sizeClasses[N_SIZE_CLASSES] = {
+  {   16, 0, 0, 0, 0 }, {   32, 0, 0, 0, 0 }, {   48, 0, 0, 0, 0 }, {   64, 0, 0, 0, 0 },
+  {   80, 0, 0, 0, 0 }, {   96, 0, 0, 0, 0 }, {  112, 0, 0, 0, 0 }, {  128, 0, 0, 0, 0 },
+  {  160, 0, 0, 0, 0 }, {  192, 0, 0, 0, 0 }, {  224, 0, 0, 0, 0 }, {  256, 0, 0, 0, 0 },
+  {  320, 0, 0, 0, 0 }, {  384, 0, 0, 0, 0 }, {  448, 0, 0, 0, 0 }, {  512, 0, 0, 0, 0 },
+  {  640, 0, 0, 0, 0 }, {  768, 0, 0, 0, 0 }, {  896, 0, 0, 0, 0 }, { 1024, 0, 0, 0, 0 },
+  { 1280, 0, 0, 0, 0 }, { 1536, 0, 0, 0, 0 }, { 1792, 0, 0, 0, 0 }, { 2048, 0, 0, 0, 0 }
+};
 
 Alloc::CIterator Alloc::objectCIter()
 {
-  return chunkInfos[OBJECT].citerator();
+#ifdef OZ_ALLOCATOR
+  return CIterator(samples, samples + sampleCapacity, false);
+#else
+  return CIterator();
+#endif
 }
 
 Alloc::CIterator Alloc::arrayCIter()
 {
-  return chunkInfos[ARRAY].citerator();
+#ifdef OZ_ALLOCATOR
+  return CIterator(samples, samples + sampleCapacity, true);
+#else
+  return CIterator();
+#endif
+}
+
+void Alloc::releaseThreadCache()
+{
+#ifdef OZ_ALLOCATOR
+  releaseCache(nullptr);
+#endif
 }
 
 }
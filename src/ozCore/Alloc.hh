@@ -27,10 +27,13 @@
  *
  * Besides `Alloc` class, enhanced `new`/`delete` operators are defined in this module, overriding
  * the standard ones.
- * - When compiled with `OZ_ALLOCATOR` the `new`/`delete` overloads also rewrite the freed memory
- *   with 0xee bytes and track memory statistics and allocated chunks to catch any memory leaks and
- *   `new`/`delete` mismatches. `Alloc::objectCIter()` and `Alloc::arrayCIter()` can be used to
- *   iterate over the chunks currently allocated by `new` and `new[]` operator respectively.
+ * - When compiled with `OZ_ALLOCATOR` the `new`/`delete` overloads serve blocks of up to
+ *   `Alloc::MAX_SMALL_SIZE` bytes from size classes through per-thread caches. They rewrite the
+ *   freed memory with 0xee bytes, keep exact global and per-size-class statistics, catch
+ *   `new`/`delete` mismatches and frees of unallocated blocks, and record stack traces for one in
+ *   `Alloc::sampleInterval` allocations to find memory leaks. `Alloc::objectCIter()` and
+ *   `Alloc::arrayCIter()` can be used to iterate over the sampled chunks that are still allocated
+ *   by `new` and `new[]` operator respectively.
  * - If compiled with `OZ_SIMD` the allocated chunks are aligned to 16 bytes.
  *
  * @note
@@ -40,7 +43,6 @@
 
 #pragma once
 
-#include "Chain.hh"
 #include "StackTrace.hh"
 
 namespace oz
@@ -55,34 +57,123 @@ class Alloc
 {
 public:
 
+  /// Number of size classes for small blocks.
+  static const int N_SIZE_CLASSES = 24;
+
+  /// Largest block (including meta data) served from size classes.
+  static const size_t MAX_SMALL_SIZE = 2048;
+
   /**
-   * Information about an allocated memory chunk.
+   * Information about a sampled memory chunk.
    *
-   * Internal list of all memory allocations is held to detect memory leaks and `new`/`delete`
-   * mismatches.
+   * Sampled chunks are held in a hash table to report memory leaks.
    */
   struct ChunkInfo
   {
-    ChunkInfo* next[1];    ///< Pointer to the next chunk.
-    size_t     size;       ///< Size (including meta data).
-    StackTrace stackTrace; ///< Stack trace for the `new` call that allocated it.
+    const void* address;    ///< Address returned by `new`, `nullptr` for an empty hash table slot.
+    size_t      size;       ///< Size (excluding meta data).
+    bool        isArray;    ///< Allocated by `new[]`.
+    StackTrace  stackTrace; ///< Stack trace for the `new` call that allocated it.
+  };
+
+  /**
+   * Statistics for a size class.
+   */
+  struct SizeClass
+  {
+    size_t size;     ///< Block size (including meta data).
+    int    count;    ///< Current number of allocated blocks.
+    int    maxCount; ///< Top number of allocated blocks.
+    int    sumCount; ///< Number of all allocations.
+    int    nBlocks;  ///< Number of blocks ever carved for this class (allocated or cached).
   };
 
   /**
-   * %Iterator over memory chunks allocated via overloaded `new` operators.
+   * %Iterator over sampled memory chunks allocated via overloaded `new` operators.
    */
-  typedef typename Chain<ChunkInfo>::CIterator CIterator;
+  class CIterator : public detail::IteratorBase<const ChunkInfo>
+  {
+  private:
+
+    const ChunkInfo* past    = nullptr; ///< Successor of the last hash table slot.
+    bool             isArray = false;   ///< Iterate over arrays instead of objects.
+
+    /**
+     * Skip empty slots and chunks of the other kind.
+     */
+    void skip()
+    {
+      while (elem != past && (elem->address == nullptr || elem->isArray != isArray)) {
+        ++elem;
+      }
+      if (elem == past) {
+        elem = nullptr;
+      }
+    }
+
+  public:
+
+    /**
+     * Create an invalid iterator.
+     */
+    CIterator() = default;
+
+    /**
+     * Create iterator over hash table slots.
+     */
+    explicit CIterator(const ChunkInfo* first, const ChunkInfo* past_, bool isArray_) :
+      detail::IteratorBase<const ChunkInfo>(first), past(past_), isArray(isArray_)
+    {
+      if (elem != nullptr) {
+        skip();
+      }
+    }
+
+    /**
+     * Advance to the next chunk.
+     */
+    CIterator& operator ++ ()
+    {
+      hard_assert(elem != nullptr);
+
+      ++elem;
+      skip();
+      return *this;
+    }
+
+    /**
+     * STL-style begin iterator.
+     */
+    CIterator begin() const
+    {
+      return *this;
+    }
+
+    /**
+     * STL-style end iterator.
+     */
+    CIterator end() const
+    {
+      return CIterator();
+    }
+
+  };
 
 public:
 
-  static int    count;     ///< Current number of allocated memory chunks.
-  static size_t amount;    ///< Amount of currently allocated memory.
+  static int       count;          ///< Current number of allocated memory chunks.
+  static size_t    amount;         ///< Amount of currently allocated memory (with meta data).
+
+  static int       sumCount;       ///< Number of all memory allocations.
+  static size_t    sumAmount;      ///< Cumulative amount of all memory allocations.
+
+  static int       maxCount;       ///< Top number to memory allocations.
+  static size_t    maxAmount;      ///< Top amount of allocated memory.
 
-  static int    sumCount;  ///< Number of all memory allocations.
-  static size_t sumAmount; ///< Cumulative amount of all memory allocations.
+  static int       sampleInterval; ///< Record stack trace for every n-th allocation on a thread.
 
-  static int    maxCount;  ///< Top number to memory allocations.
-  static size_t maxAmount; ///< Top amount of allocated memory.
+  /// Statistics for size classes, ordered by block size.
+  static SizeClass sizeClasses[N_SIZE_CLASSES];
 
 public:
 
@@ -92,15 +183,22 @@ public:
   Alloc() = delete;
 
   /**
-   * Create iterator for iterating over allocated objects.
+   * Create iterator for iterating over sampled allocated objects.
    */
   static CIterator objectCIter();
 
   /**
-   * Create iterator for iterating over allocated arrays.
+   * Create iterator for iterating over sampled allocated arrays.
    */
   static CIterator arrayCIter();
 
+  /**
+   * Return blocks cached by the calling thread to the shared size class pools.
+   *
+   * This is done automatically when a thread exits, on platforms with POSIX threads.
+   */
+  static void releaseThreadCache();
+
   /**
    * Align to the previous boundary.
    */
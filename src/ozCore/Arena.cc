@@ -0,0 +1,207 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/Arena.cc
+ */
+
+#include "Arena.hh"
+
+#include "Alloc.hh"
+#include "System.hh"
+
+namespace oz
+{
+
+struct Arena::Block
+{
+  Block* next;
+  size_t size;
+
+  OZ_INTERNAL
+  char* begin()
+  {
+    return reinterpret_cast<char*>(this) + Alloc::alignUp(sizeof(Block));
+  }
+
+  OZ_INTERNAL
+  char* end()
+  {
+    return begin() + size;
+  }
+
+  OZ_INTERNAL
+  static Block* create(size_t size, Block* next)
+  {
+    char*  chunk = new char[Alloc::alignUp(sizeof(Block)) + size];
+    Block* block = new(chunk) Block;
+
+    block->next = next;
+    block->size = size;
+    return block;
+  }
+
+  OZ_INTERNAL
+  void destroy()
+  {
+    delete[] reinterpret_cast<char*>(this);
+  }
+};
+
+// Address of this variable identifies a thread.
+static thread_local char threadToken;
+
+Arena::Lane* Arena::lane()
+{
+  const void* token = &threadToken;
+  int         n     = __atomic_load_n(&nLanes, __ATOMIC_ACQUIRE);
+
+  for (int i = 0; i < n; ++i) {
+    if (lanes[i].owner == token) {
+      return &lanes[i];
+    }
+  }
+
+  laneLock.lock();
+
+  n = nLanes;
+  if (n == MAX_THREADS) {
+    laneLock.unlock();
+
+    OZ_ERROR("oz::Arena: More than %d threads allocating", MAX_THREADS);
+  }
+
+  Lane* lane = &lanes[n];
+
+  lane->owner   = token;
+  lane->first   = nullptr;
+  lane->current = nullptr;
+  lane->pos     = nullptr;
+  lane->end     = nullptr;
+  lane->count   = 0;
+
+  __atomic_store_n(&nLanes, n + 1, __ATOMIC_RELEASE);
+
+  laneLock.unlock();
+
+  return lane;
+}
+
+void* Arena::allocateSlow(Lane* lane, size_t size)
+{
+  Block* next = lane->current == nullptr ? lane->first : lane->current->next;
+
+  if (next == nullptr || next->size < size) {
+    next = Block::create(max<size_t>(size, blockSize), next);
+
+    if (lane->current == nullptr) {
+      lane->first = next;
+    }
+    else {
+      lane->current->next = next;
+    }
+  }
+
+  lane->current = next;
+  lane->pos     = next->begin() + size;
+  lane->end     = next->end();
+
+  return next->begin();
+}
+
+Arena::Arena(size_t blockSize_) :
+  blockSize(Alloc::alignUp(blockSize_))
+{}
+
+Arena::~Arena()
+{
+  free();
+}
+
+int Arena::length() const
+{
+  int n = 0;
+
+  for (int i = 0; i < nLanes; ++i) {
+    n += lanes[i].count;
+  }
+  return n;
+}
+
+size_t Arena::capacity() const
+{
+  size_t size = 0;
+
+  for (int i = 0; i < nLanes; ++i) {
+    for (const Block* block = lanes[i].first; block != nullptr; block = block->next) {
+      size += block->size;
+    }
+  }
+  return size;
+}
+
+void* Arena::allocate(size_t size)
+{
+  Lane* lane = this->lane();
+
+  size = Alloc::alignUp(size);
+  ++lane->count;
+
+  if (size_t(lane->end - lane->pos) < size) {
+    return allocateSlow(lane, size);
+  }
+
+  void* ptr = lane->pos;
+
+  lane->pos += size;
+  return ptr;
+}
+
+void Arena::reset()
+{
+  for (int i = 0; i < nLanes; ++i) {
+    Lane& lane = lanes[i];
+
+    lane.current = lane.first;
+    lane.pos     = lane.first == nullptr ? nullptr : lane.first->begin();
+    lane.end     = lane.first == nullptr ? nullptr : lane.first->end();
+    lane.count   = 0;
+  }
+}
+
+void Arena::free()
+{
+  for (int i = 0; i < nLanes; ++i) {
+    Block* block = lanes[i].first;
+
+    while (block != nullptr) {
+      Block* next = block->next;
+
+      block->destroy();
+      block = next;
+    }
+  }
+
+  nLanes = 0;
+}
+
+}
@@ -0,0 +1,155 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/Arena.hh
+ *
+ * `Arena` class and `OZ_STATIC_ARENA_ALLOC` macro.
+ */
+
+#pragma once
+
+#include "SpinLock.hh"
+
+/**
+ * @def OZ_STATIC_ARENA_ALLOC
+ * Add this macro to your class definition to allocate its instances from a static arena.
+ *
+ * `delete` only runs the destructor, memory is reclaimed when the arena is reset. Array versions of
+ * `new`/`delete` operator are disabled for the enclosing class.
+ */
+#define OZ_STATIC_ARENA_ALLOC(arena)                                                               \
+  void* operator new      (size_t n)                               { return arena.allocate(n); }   \
+  void* operator new[]    (size_t)                                 = delete;                       \
+  void  operator delete   (void*)                         noexcept {}                              \
+  void  operator delete[] (void*)                         noexcept = delete;                       \
+  void* operator new      (size_t n, const std::nothrow_t&)        noexcept                        \
+  { return arena.allocate(n); }                                                                    \
+  void* operator new[]    (size_t, const std::nothrow_t&) noexcept = delete;                       \
+  void  operator delete   (void*, std::nothrow_t&)        noexcept {}                              \
+  void  operator delete[] (void*, std::nothrow_t&)        noexcept = delete;
+
+namespace oz
+{
+
+/**
+ * Linear allocator for data that lives for one tick or frame.
+ *
+ * Allocation only bumps a pointer in the calling thread's current block, so threads never contend
+ * except when a thread allocates from the arena for the first time. All memory is reclaimed at once
+ * by `reset()`, which keeps the blocks, so an arena stops allocating from the heap after it has
+ * grown to its peak per-tick usage. Destructors are not called for objects in an arena.
+ *
+ * `reset()` and `free()` must not be called while any thread may allocate from the arena.
+ *
+ * @sa `oz::ArenaList`, `oz::Pool`
+ */
+class Arena
+{
+public:
+
+  /// Maximum number of threads that may allocate from an arena.
+  static const int MAX_THREADS = 16;
+
+private:
+
+  struct Block;
+
+  /**
+   * Per-thread allocation state.
+   */
+  struct Lane
+  {
+    const void* owner;   ///< Token of the owning thread, `nullptr` if free.
+    Block*      first;   ///< Chain of blocks.
+    Block*      current; ///< Block being allocated from.
+    char*       pos;     ///< Next free byte in the current block.
+    char*       end;     ///< End of the current block.
+    int         count;   ///< Number of allocations since the last reset.
+    char        pad[64 - 5 * sizeof(void*) - sizeof(int)];
+  };
+
+  Lane         lanes[MAX_THREADS]; ///< Lanes of threads that have allocated from the arena.
+  volatile int nLanes    = 0;      ///< Number of claimed lanes.
+  SpinLock     laneLock;           ///< Lock for claiming a lane.
+  size_t       blockSize;          ///< Default size of a new block.
+
+  /**
+   * Find the calling thread's lane, claim a new one if none.
+   */
+  Lane* lane();
+
+  /**
+   * Allocate from the next block, adding one if none or too small.
+   */
+  void* allocateSlow(Lane* lane, size_t size);
+
+public:
+
+  /**
+   * Create an empty arena, blocks are allocated on demand.
+   */
+  explicit Arena(size_t blockSize = 64 * 1024);
+
+  /**
+   * Destructor, frees all blocks.
+   */
+  ~Arena();
+
+  /**
+   * Copying or moving is not possible.
+   */
+  Arena(const Arena&) = delete;
+
+  /**
+   * Copying or moving is not possible.
+   */
+  Arena& operator = (const Arena&) = delete;
+
+  /**
+   * Number of allocations since the last reset.
+   */
+  int length() const;
+
+  /**
+   * Total size of all blocks.
+   */
+  size_t capacity() const;
+
+  /**
+   * Allocate `size` bytes aligned to `OZ_ALIGNMENT`.
+   */
+  void* allocate(size_t size);
+
+  /**
+   * Reclaim all allocations, keep blocks for reuse.
+   */
+  void reset();
+
+  /**
+   * Reclaim all allocations and free blocks.
+   */
+  void free();
+
+};
+
+}
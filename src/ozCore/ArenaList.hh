@@ -0,0 +1,427 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/ArenaList.hh
+ *
+ * `ArenaList` class template.
+ */
+
+#pragma once
+
+#include "Arena.hh"
+#include "Arrays.hh"
+
+namespace oz
+{
+
+/**
+ * Array list with storage in an `Arena`.
+ *
+ * Counterpart of `List` for transient lists that are built and dropped within one tick or frame.
+ * When the list grows, elements are moved to a larger array allocated from the arena and the old
+ * array is left to the arena, so growing, clearing and destroying the list never touch the heap.
+ * As with `List` all allocated elements are constructed. Destructors are called when the list is
+ * destroyed, the list must not be used after the arena is reset.
+ *
+ * @sa `oz::Arena`, `oz::List`
+ */
+template <typename Elem>
+class ArenaList
+{
+  static_assert(alignof(Elem) <= OZ_ALIGNMENT, "Element alignment exceeds OZ_ALIGNMENT");
+
+private:
+
+  /// Granularity for automatic storage allocations.
+  static const int GRANULARITY = 8;
+
+public:
+
+  /**
+   * %Iterator with constant access to elements.
+   */
+  typedef Arrays::CIterator<Elem> CIterator;
+
+  /**
+   * %Iterator with non-constant access to elements.
+   */
+  typedef Arrays::Iterator<Elem> Iterator;
+
+private:
+
+  Arena* arena;           ///< Arena storage is allocated from.
+  Elem*  data  = nullptr; ///< Array of elements.
+  int    count = 0;       ///< Number of elements.
+  int    size  = 0;       ///< Capacity, number of elements in storage.
+
+private:
+
+  /**
+   * Destruct `size` elements of an array, the memory is left to the arena.
+   */
+  static void destroy(Elem* array, int size)
+  {
+    for (int i = 0; i < size; ++i) {
+      array[i].~Elem();
+    }
+  }
+
+  /**
+   * Ensure a given capacity.
+   *
+   * Capacity is doubled if neccessary. If that doesn't suffice it is set to the least multiple of
+   * `GRANULARITY` able to hold the requested number of elements.
+   */
+  void ensureCapacity(int capacity)
+  {
+    if (capacity < 0) {
+      OZ_ERROR("oz::ArenaList: Capacity overflow");
+    }
+    else if (size < capacity) {
+      int newSize = size * 2;
+
+      if (newSize < capacity) {
+        newSize = (capacity + GRANULARITY - 1) & ~(GRANULARITY - 1);
+      }
+
+      if (newSize <= 0) {
+        OZ_ERROR("oz::ArenaList: Capacity overflow");
+      }
+
+      Elem* newData = static_cast<Elem*>(arena->allocate(size_t(newSize) * sizeof(Elem)));
+
+      for (int i = 0; i < newSize; ++i) {
+        ::new(&newData[i]) Elem();
+      }
+
+      Arrays::move<Elem>(data, count, newData);
+      destroy(data, size);
+
+      data = newData;
+      size = newSize;
+    }
+  }
+
+public:
+
+  /**
+   * Create an empty list, storage is allocated from `arena` when the first element is added.
+   */
+  explicit ArenaList(Arena* arena_) :
+    arena(arena_)
+  {}
+
+  /**
+   * Create an empty list with a given initial capacity.
+   */
+  explicit ArenaList(Arena* arena_, int capacity) :
+    arena(arena_)
+  {
+    ensureCapacity(capacity);
+  }
+
+  /**
+   * Destructor, destructs elements.
+   */
+  ~ArenaList()
+  {
+    destroy(data, size);
+  }
+
+  /**
+   * Copying is not possible.
+   */
+  ArenaList(const ArenaList&) = delete;
+
+  /**
+   * Move constructor, moves storage.
+   */
+  ArenaList(ArenaList&& l) :
+    arena(l.arena), data(l.data), count(l.count), size(l.size)
+  {
+    l.data  = nullptr;
+    l.count = 0;
+    l.size  = 0;
+  }
+
+  /**
+   * Copying is not possible.
+   */
+  ArenaList& operator = (const ArenaList&) = delete;
+
+  /**
+   * Move operator, moves storage.
+   */
+  ArenaList& operator = (ArenaList&& l)
+  {
+    if (&l != this) {
+      destroy(data, size);
+
+      arena = l.arena;
+      data  = l.data;
+      count = l.count;
+      size  = l.size;
+
+      l.data  = nullptr;
+      l.count = 0;
+      l.size  = 0;
+    }
+    return *this;
+  }
+
+  /**
+   * %Iterator with constant access, initially points to the first element.
+   */
+  OZ_ALWAYS_INLINE
+  CIterator citerator() const
+  {
+    return CIterator(data, data + count);
+  }
+
+  /**
+   * %Iterator with non-constant access, initially points to the first element.
+   */
+  OZ_ALWAYS_INLINE
+  Iterator iterator()
+  {
+    return Iterator(data, data + count);
+  }
+
+  /**
+   * STL-style constant begin iterator.
+   */
+  OZ_ALWAYS_INLINE
+  const Elem* begin() const
+  {
+    return data;
+  }
+
+  /**
+   * STL-style begin iterator.
+   */
+  OZ_ALWAYS_INLINE
+  Elem* begin()
+  {
+    return data;
+  }
+
+  /**
+   * STL-style constant end iterator.
+   */
+  OZ_ALWAYS_INLINE
+  const Elem* end() const
+  {
+    return data + count;
+  }
+
+  /**
+   * STL-style end iterator.
+   */
+  OZ_ALWAYS_INLINE
+  Elem* end()
+  {
+    return data + count;
+  }
+
+  /**
+   * Number of elements.
+   */
+  OZ_ALWAYS_INLINE
+  int length() const
+  {
+    return count;
+  }
+
+  /**
+   * True iff empty.
+   */
+  OZ_ALWAYS_INLINE
+  bool isEmpty() const
+  {
+    return count == 0;
+  }
+
+  /**
+   * Number of allocated elements.
+   */
+  OZ_ALWAYS_INLINE
+  int capacity() const
+  {
+    return size;
+  }
+
+  /**
+   * Constant reference to the `i`-th element.
+   */
+  OZ_ALWAYS_INLINE
+  const Elem& operator [] (int i) const
+  {
+    hard_assert(uint(i) < uint(count));
+
+    return data[i];
+  }
+
+  /**
+   * Reference to the `i`-th element.
+   */
+  OZ_ALWAYS_INLINE
+  Elem& operator [] (int i)
+  {
+    hard_assert(uint(i) < uint(count));
+
+    return data[i];
+  }
+
+  /**
+   * Constant reference to the last element.
+   */
+  OZ_ALWAYS_INLINE
+  const Elem& last() const
+  {
+    hard_assert(count != 0);
+
+    return data[count - 1];
+  }
+
+  /**
+   * Reference to the last element.
+   */
+  OZ_ALWAYS_INLINE
+  Elem& last()
+  {
+    hard_assert(count != 0);
+
+    return data[count - 1];
+  }
+
+  /**
+   * True iff a given value is found in the list.
+   */
+  template <typename Key>
+  bool contains(const Key& key) const
+  {
+    return Arrays::contains<Elem, Key>(data, count, key);
+  }
+
+  /**
+   * Index of the first occurrence of the value or -1 if not found.
+   */
+  template <typename Key>
+  int index(const Key& key) const
+  {
+    return Arrays::index<Elem, Key>(data, count, key);
+  }
+
+  /**
+   * Add an element to the end.
+   */
+  template <typename Elem_>
+  Elem& add(Elem_&& elem)
+  {
+    ensureCapacity(count + 1);
+
+    data[count] = static_cast<Elem_&&>(elem);
+    return data[count++];
+  }
+
+  /**
+   * Add (copy) elements from a given array to the end.
+   */
+  void addAll(const Elem* array, int arrayCount)
+  {
+    int newCount = count + arrayCount;
+
+    ensureCapacity(newCount);
+
+    Arrays::copy<Elem>(array, arrayCount, data + count);
+    count = newCount;
+  }
+
+  /**
+   * Add an element to the end if there is no equal element in the list.
+   *
+   * @return Position of the inserted or the existing equal element.
+   */
+  template <typename Elem_>
+  Elem& include(Elem_&& elem)
+  {
+    int i = Arrays::index<Elem, Elem>(data, count, elem);
+
+    if (i >= 0) {
+      return data[i];
+    }
+    else {
+      return add<Elem_>(static_cast<Elem_&&>(elem));
+    }
+  }
+
+  /**
+   * Remove the element at a given position from an unordered list.
+   *
+   * The last element is moved to its place.
+   */
+  void eraseUnordered(int i)
+  {
+    hard_assert(uint(i) < uint(count));
+
+    --count;
+
+    if (i == count) {
+      // When removing the last element, no shift is performed, so it is not implicitly destroyed by
+      // the move operation.
+      data[count] = Elem();
+    }
+    else {
+      data[i] = static_cast<Elem&&>(data[count]);
+    }
+  }
+
+  /**
+   * Sort elements with `Arrays::sort()`.
+   */
+  template <class LessFunc = Less<void>>
+  void sort()
+  {
+    Arrays::sort<Elem, LessFunc>(data, count);
+  }
+
+  /**
+   * Increase capacity to the given value if smaller.
+   */
+  void reserve(int capacity)
+  {
+    ensureCapacity(capacity);
+  }
+
+  /**
+   * Clear the list, storage is kept.
+   */
+  void clear()
+  {
+    Arrays::clear<Elem>(data, count);
+    count = 0;
+  }
+
+};
+
+}
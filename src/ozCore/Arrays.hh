@@ -129,65 +129,391 @@ public:
 
 private:
 
+  /// Partitions of at most this many elements are sorted with insertion sort.
+  static const int INSERTION_SORT_THRESHOLD = 16;
+
+  /// Maximum number of element moves partial insertion sort may do on a partition.
+  static const int PARTIAL_INSERTION_LIMIT = 8;
+
+  /// Minimum number of elements per run for `parallelSort()`.
+  static const int PARALLEL_SORT_THRESHOLD = 1 << 14;
+
+  /// Maximum number of runs `parallelSort()` splits an array into.
+  static const int MAX_SORT_THREADS = 32;
+
+  /// Range function type for `parallelFor()`, called for sub-ranges [`begin`, `end`).
+  typedef void RangeFunction(void* data, int begin, int end);
+
   /**
-   * Helper function for `sort()`.
+   * Range descriptor passed to `parallelSort()` jobs.
+   */
+  template <typename Elem>
+  struct SortRange
+  {
+    Elem* src;   ///< First element of the first sorted run (or the range to be sorted).
+    Elem* dest;  ///< Uninitialised destination buffer for the merged runs.
+    int   first; ///< Index of the first element.
+    int   mid;   ///< Index of the first element of the second run.
+    int   past;  ///< Index past the last element.
+  };
+
+  /**
+   * Swap two elements if they are in wrong order.
+   */
+  template <typename Elem, class LessFunc>
+  OZ_ALWAYS_INLINE
+  static void sort2(Elem* a, Elem* b)
+  {
+    if (LessFunc()(*b, *a)) {
+      swap<Elem>(*a, *b);
+    }
+  }
+
+  /**
+   * Sort three elements.
+   */
+  template <typename Elem, class LessFunc>
+  OZ_ALWAYS_INLINE
+  static void sort3(Elem* a, Elem* b, Elem* c)
+  {
+    sort2<Elem, LessFunc>(a, b);
+    sort2<Elem, LessFunc>(b, c);
+    sort2<Elem, LessFunc>(a, b);
+  }
+
+  /**
+   * Insertion sort for small or nearly sorted ranges.
    *
-   * @note
-   * `Elem` type must have `operator < (const Elem&)` defined.
+   * If `unguarded` is true, the caller guarantees that the element before `first` is not greater
+   * than any element in the range, so the inner loop needs no bounds check.
+   */
+  template <typename Elem, class LessFunc, bool unguarded = false>
+  static void insertionSort(Elem* first, Elem* past)
+  {
+    for (Elem* i = first + 1; i < past; ++i) {
+      if (LessFunc()(*i, i[-1])) {
+        Elem  tmp = static_cast<Elem&&>(*i);
+        Elem* j   = i;
+
+        do {
+          *j = static_cast<Elem&&>(j[-1]);
+          --j;
+        }
+        while ((unguarded || j != first) && LessFunc()(tmp, j[-1]));
+
+        *j = static_cast<Elem&&>(tmp);
+      }
+    }
+  }
+
+  /**
+   * Insertion sort that gives up after a given number of element moves.
    *
-   * Quicksort algorithm is used which takes last element in a partition as a pivot so sorting a
-   * sorted or nearly sorted array will take O(n^2) time instead of O(n log n) as in average case.
-   * When a partition has at most 11 elements, selection sort is used.
+   * The range is left in a permuted but not necessarily sorted state when it gives up.
    *
-   * @param first pointer to first element in the array to be sorted.
-   * @param last pointer to last element in the array.
+   * @return True iff the range has been sorted.
    */
-  template <typename Elem, class LessFunc = Less<void>>
-  static void quicksort(Elem* first, Elem* last)
+  template <typename Elem, class LessFunc>
+  static bool partialInsertionSort(Elem* first, Elem* past, ptrdiff_t limit)
   {
-    // 8-14 seem as optimal thresholds for switching to selection sort.
-    if (last - first > 11) {
-      // Quicksort (last element is pivot).
-      Elem* top    = first;
-      Elem* bottom = last - 1;
+    ptrdiff_t nMoves = 0;
 
-      do {
-        for (; !LessFunc()(*last, *top) && top <= bottom; ++top);
-        for (; LessFunc()(*last, *bottom) && top < bottom; --bottom);
+    for (Elem* i = first + 1; i < past; ++i) {
+      if (LessFunc()(*i, i[-1])) {
+        Elem  tmp = static_cast<Elem&&>(*i);
+        Elem* j   = i;
 
-        if (top >= bottom) {
-          break;
+        do {
+          *j = static_cast<Elem&&>(j[-1]);
+          --j;
         }
+        while (j != first && LessFunc()(tmp, j[-1]));
+
+        *j = static_cast<Elem&&>(tmp);
 
-        swap<Elem>(*top, *bottom);
+        nMoves += i - j;
+        if (nMoves > limit) {
+          return i + 1 == past;
+        }
       }
-      while (true);
+    }
+    return true;
+  }
 
-      if (top != last) {
-        swap<Elem>(*top, *last);
-        quicksort<Elem, LessFunc>(top + 1, last);
+  /**
+   * Heapsort, used when quicksort recursion gets too deep.
+   */
+  template <typename Elem, class LessFunc>
+  static void heapSort(Elem* first, Elem* past)
+  {
+    ptrdiff_t count = past - first;
+
+    for (ptrdiff_t i = count / 2 - 1; i >= 0; --i) {
+      siftDown<Elem, LessFunc>(first, i, count);
+    }
+    for (ptrdiff_t i = count - 1; i > 0; --i) {
+      swap<Elem>(first[0], first[i]);
+      siftDown<Elem, LessFunc>(first, 0, i);
+    }
+  }
+
+  /**
+   * Helper function for `heapSort()`.
+   */
+  template <typename Elem, class LessFunc>
+  static void siftDown(Elem* heap, ptrdiff_t root, ptrdiff_t count)
+  {
+    Elem tmp = static_cast<Elem&&>(heap[root]);
+
+    for (ptrdiff_t child = 2 * root + 1; child < count; child = 2 * root + 1) {
+      if (child + 1 < count && LessFunc()(heap[child], heap[child + 1])) {
+        ++child;
       }
-      quicksort<Elem, LessFunc>(first, top - 1);
+      if (!LessFunc()(tmp, heap[child])) {
+        break;
+      }
+
+      heap[root] = static_cast<Elem&&>(heap[child]);
+      root = child;
+    }
+    heap[root] = static_cast<Elem&&>(tmp);
+  }
+
+  /**
+   * Partition a range around the pivot in `*first`, elements equal to the pivot go right.
+   *
+   * Requires an element not less than the pivot at the end of the range.
+   *
+   * @param alreadyPartitioned set to true iff no elements had to be swapped.
+   * @return New position of the pivot.
+   */
+  template <typename Elem, class LessFunc>
+  static Elem* partitionRight(Elem* first, Elem* past, bool* alreadyPartitioned)
+  {
+    Elem  pivot  = static_cast<Elem&&>(*first);
+    Elem* top    = first;
+    Elem* bottom = past;
+
+    while (LessFunc()(*++top, pivot));
+
+    if (top - 1 == first) {
+      while (top < bottom && !LessFunc()(*--bottom, pivot));
     }
     else {
-      // Selection sort.
-      for (Elem* i = first; i < last;) {
-        Elem* pivot = i;
-        Elem* min   = i;
-        ++i;
-
-        for (Elem* j = i; j <= last; ++j) {
-          if (LessFunc()(*j, *min)) {
-            min = j;
-          }
+      while (!LessFunc()(*--bottom, pivot));
+    }
+
+    *alreadyPartitioned = top >= bottom;
+
+    while (top < bottom) {
+      swap<Elem>(*top, *bottom);
+
+      while (LessFunc()(*++top, pivot));
+      while (!LessFunc()(*--bottom, pivot));
+    }
+
+    Elem* pivotPos = top - 1;
+
+    *first    = static_cast<Elem&&>(*pivotPos);
+    *pivotPos = static_cast<Elem&&>(pivot);
+    return pivotPos;
+  }
+
+  /**
+   * Partition a range around the pivot in `*first`, elements equal to the pivot go left.
+   *
+   * Used when the pivot equals the element just before the range, i.e. the range contains many
+   * duplicates. Everything left of the returned position is then equal to the pivot.
+   *
+   * @return New position of the pivot.
+   */
+  template <typename Elem, class LessFunc>
+  static Elem* partitionLeft(Elem* first, Elem* past)
+  {
+    Elem  pivot  = static_cast<Elem&&>(*first);
+    Elem* top    = first;
+    Elem* bottom = past;
+
+    while (LessFunc()(pivot, *--bottom));
+
+    if (bottom + 1 == past) {
+      while (top < bottom && !LessFunc()(pivot, *++top));
+    }
+    else {
+      while (!LessFunc()(pivot, *++top));
+    }
+
+    while (top < bottom) {
+      swap<Elem>(*top, *bottom);
+
+      while (LessFunc()(pivot, *--bottom));
+      while (!LessFunc()(pivot, *++top));
+    }
+
+    *first  = static_cast<Elem&&>(*bottom);
+    *bottom = static_cast<Elem&&>(pivot);
+    return bottom;
+  }
+
+  /**
+   * Helper function for `sort()`.
+   *
+   * @note
+   * `Elem` type must have `operator < (const Elem&)` defined.
+   *
+   * Pattern-defeating introsort. Median of three is used as a pivot, partitions with at most
+   * `INSERTION_SORT_THRESHOLD` elements are sorted by insertion sort and heapsort takes over after
+   * `log2(n)` highly unbalanced partitions, so the worst case is O(n log n). Partitions that turn out
+   * to be already partitioned are given a chance to finish by partial insertion sort, which makes
+   * sorted and nearly sorted input O(n). Highly unbalanced partitions have a few elements swapped
+   * to break patterns that would otherwise keep choosing bad pivots. The smaller partition is
+   * sorted recursively, so stack depth is O(log n).
+   *
+   * @param first pointer to first element in the range to be sorted.
+   * @param past pointer past the last element in the range.
+   * @param depth number of unbalanced partitions left before switching to heapsort.
+   * @param leftmost true iff there are no elements before `first` that belong to the same array.
+   */
+  template <typename Elem, class LessFunc = Less<void>>
+  static void introsort(Elem* first, Elem* past, int depth, bool leftmost)
+  {
+    while (true) {
+      ptrdiff_t size = past - first;
+
+      if (size <= INSERTION_SORT_THRESHOLD) {
+        if (leftmost) {
+          insertionSort<Elem, LessFunc, false>(first, past);
+        }
+        else {
+          insertionSort<Elem, LessFunc, true>(first, past);
+        }
+        return;
+      }
+
+      // Places median of three into `*first`.
+      sort3<Elem, LessFunc>(first + size / 2, first, past - 1);
+
+      // Pivot equals the greatest element of the left neighbour partition, so all elements equal to
+      // it can be put left and skipped.
+      if (!leftmost && !LessFunc()(first[-1], *first)) {
+        first = partitionLeft<Elem, LessFunc>(first, past) + 1;
+        continue;
+      }
+
+      bool  alreadyPartitioned;
+      Elem* pivotPos  = partitionRight<Elem, LessFunc>(first, past, &alreadyPartitioned);
+      ptrdiff_t lSize = pivotPos - first;
+      ptrdiff_t rSize = past - (pivotPos + 1);
+
+      if (lSize < size / 8 || rSize < size / 8) {
+        if (--depth == 0) {
+          heapSort<Elem, LessFunc>(first, past);
+          return;
         }
-        if (min != pivot) {
-          swap<Elem>(*min, *pivot);
+
+        if (lSize >= INSERTION_SORT_THRESHOLD) {
+          swap<Elem>(first[0], first[lSize / 4]);
+          swap<Elem>(pivotPos[-1], pivotPos[-lSize / 4]);
+        }
+        if (rSize >= INSERTION_SORT_THRESHOLD) {
+          swap<Elem>(pivotPos[1], pivotPos[1 + rSize / 4]);
+          swap<Elem>(past[-1], past[-rSize / 4]);
         }
       }
+      else if (alreadyPartitioned &&
+               partialInsertionSort<Elem, LessFunc>(first, pivotPos, PARTIAL_INSERTION_LIMIT) &&
+               partialInsertionSort<Elem, LessFunc>(pivotPos + 1, past, PARTIAL_INSERTION_LIMIT))
+      {
+        return;
+      }
+
+      if (lSize < rSize) {
+        introsort<Elem, LessFunc>(first, pivotPos, depth, leftmost);
+        first    = pivotPos + 1;
+        leftmost = false;
+      }
+      else {
+        introsort<Elem, LessFunc>(pivotPos + 1, past, depth, false);
+        past = pivotPos;
+      }
+    }
+  }
+
+  /**
+   * Move an element into uninitialised storage and destroy the source.
+   */
+  template <typename Elem>
+  OZ_ALWAYS_INLINE
+  static void relocate(Elem* src, Elem* dest)
+  {
+    new(dest) Elem(static_cast<Elem&&>(*src));
+    src->~Elem();
+  }
+
+  /**
+   * Merge two adjacent sorted runs from `range->src` into uninitialised `range->dest`.
+   *
+   * Merged elements are destroyed in the source, so the source range is left uninitialised.
+   */
+  template <typename Elem, class LessFunc>
+  static void mergeRuns(SortRange<Elem>* range)
+  {
+    Elem* a     = range->src + range->first;
+    Elem* aPast = range->src + range->mid;
+    Elem* b     = aPast;
+    Elem* bPast = range->src + range->past;
+    Elem* dest  = range->dest + range->first;
+
+    while (a != aPast && b != bPast) {
+      // Take from the first run on ties to keep the merge stable.
+      relocate<Elem>(LessFunc()(*b, *a) ? b++ : a++, dest++);
+    }
+    while (a != aPast) {
+      relocate<Elem>(a++, dest++);
+    }
+    while (b != bPast) {
+      relocate<Elem>(b++, dest++);
+    }
+  }
+
+  /**
+   * `parallelSort()` job that sorts runs [`begin`, `end`).
+   */
+  template <typename Elem, class LessFunc>
+  static void sortRunsMain(void* data, int begin, int end)
+  {
+    SortRange<Elem>* ranges = static_cast<SortRange<Elem>*>(data);
+
+    for (int i = begin; i < end; ++i) {
+      sort<Elem, LessFunc>(ranges[i].src + ranges[i].first, ranges[i].past - ranges[i].first);
+    }
+  }
+
+  /**
+   * `parallelSort()` job that merges pairs of runs [`begin`, `end`).
+   */
+  template <typename Elem, class LessFunc>
+  static void mergeRunsMain(void* data, int begin, int end)
+  {
+    SortRange<Elem>* ranges = static_cast<SortRange<Elem>*>(data);
+
+    for (int i = begin; i < end; ++i) {
+      mergeRuns<Elem, LessFunc>(&ranges[i]);
     }
   }
 
+  /**
+   * Number of threads in the `Jobs` pool.
+   */
+  static int parallelThreads();
+
+  /**
+   * Call `function(data, begin, end)` for sub-ranges of [0, `count`) on the `Jobs` pool and wait.
+   *
+   * Implemented out of line, so this header does not depend on threading headers.
+   */
+  static void parallelFor(int count, RangeFunction* function, void* data);
+
 public:
 
   /**
@@ -348,16 +674,105 @@ public:
   }
 
   /**
-   * Sort array using `detail::quicksort()`.
+   * Sort array using `introsort()`.
+   *
+   * Nearly sorted arrays, e.g. objects sorted by distance in the previous frame, are first tried
+   * with insertion sort limited to O(n) element moves, which finishes them in linear time.
    */
   template <typename Elem, class LessFunc = Less<void>>
   static void sort(Elem* array, int count)
   {
-    int last = count - 1;
+    if (count < 2) {
+      return;
+    }
+    if (count > INSERTION_SORT_THRESHOLD &&
+        partialInsertionSort<Elem, LessFunc>(array, array + count, count))
+    {
+      return;
+    }
+
+    int depth = 0;
+    for (int i = count; i > 1; i >>= 1) {
+      ++depth;
+    }
+    introsort<Elem, LessFunc>(array, array + count, depth, true);
+  }
 
-    if (last > 0) {
-      quicksort<Elem, LessFunc>(array, &array[last]);
+  /**
+   * Sort array in parallel.
+   *
+   * The array is split into `nThreads` runs that are sorted as `Jobs` by `sort()` and then merged
+   * pairwise, also in parallel, through an uninitialised buffer of `count` elements. Elements are
+   * only move-constructed into the buffer and destroyed, so `Elem` need not be default-
+   * constructible or copyable. Arrays with less than `PARALLEL_SORT_THRESHOLD` elements per run are
+   * sorted on the calling thread, as is everything if `Jobs` is not initialised.
+   *
+   * @param array array of elements.
+   * @param count number of elements.
+   * @param nThreads maximum number of runs, 0 for `Jobs::nThreads()`.
+   */
+  template <typename Elem, class LessFunc = Less<void>>
+  static void parallelSort(Elem* array, int count, int nThreads = 0)
+  {
+    int maxThreads = count / PARALLEL_SORT_THRESHOLD;
+
+    nThreads = nThreads > 0 ? nThreads : parallelThreads();
+    nThreads = nThreads < maxThreads ? nThreads : maxThreads;
+    nThreads = nThreads < MAX_SORT_THREADS ? nThreads : MAX_SORT_THREADS;
+
+    if (nThreads < 2) {
+      sort<Elem, LessFunc>(array, count);
+      return;
+    }
+
+    SortRange<Elem> ranges[MAX_SORT_THREADS];
+    int             bounds[MAX_SORT_THREADS + 1];
+    int             nRuns = nThreads;
+
+    for (int i = 0; i <= nRuns; ++i) {
+      bounds[i] = int(long64(count) * i / nRuns);
+    }
+    for (int i = 0; i < nRuns; ++i) {
+      ranges[i] = { array, nullptr, bounds[i], bounds[i + 1], bounds[i + 1] };
+    }
+    parallelFor(nRuns, sortRunsMain<Elem, LessFunc>, ranges);
+
+    // Live elements are always in `src`, `dest` is uninitialised.
+    char* buffer = new char[size_t(count) * sizeof(Elem)];
+    Elem* src    = array;
+    Elem* dest   = reinterpret_cast<Elem*>(buffer);
+
+    while (nRuns > 1) {
+      int nMerges = nRuns / 2;
+
+      for (int i = 0; i < nMerges; ++i) {
+        ranges[i] = { src, dest, bounds[2 * i], bounds[2 * i + 1], bounds[2 * i + 2] };
+      }
+      if (nRuns % 2 != 0) {
+        for (int i = bounds[nRuns - 1]; i < count; ++i) {
+          relocate<Elem>(&src[i], &dest[i]);
+        }
+      }
+      parallelFor(nMerges, mergeRunsMain<Elem, LessFunc>, ranges);
+
+      for (int i = 0; i < nMerges; ++i) {
+        bounds[i] = bounds[2 * i];
+      }
+      bounds[nMerges] = bounds[2 * nMerges];
+      if (nRuns % 2 != 0) {
+        bounds[nMerges + 1] = count;
+      }
+      nRuns = (nRuns + 1) / 2;
+
+      swap<Elem*>(src, dest);
+    }
+
+    if (src != array) {
+      for (int i = 0; i < count; ++i) {
+        relocate<Elem>(&src[i], &array[i]);
+      }
     }
+    delete[] buffer;
   }
 
   /**
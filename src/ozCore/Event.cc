@@ -0,0 +1,63 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/Event.cc
+ */
+
+#include "Event.hh"
+
+#include "Futex.hh"
+
+namespace oz
+{
+
+void Event::set()
+{
+  __atomic_store_n(&isSet, 1, __ATOMIC_SEQ_CST);
+
+  if (__atomic_load_n(&nWaiters, __ATOMIC_SEQ_CST) != 0) {
+    Futex::wakeOne(&isSet);
+  }
+}
+
+void Event::wait()
+{
+  for (int i = 0; i < Futex::SPIN_COUNT; ++i) {
+    if (__atomic_load_n(&isSet, __ATOMIC_RELAXED) != 0 && tryWait()) {
+      return;
+    }
+    Futex::pause();
+  }
+
+  // Registering as a waiter before the last check ensures that either that check or `set()` sees
+  // the other side's write.
+  __atomic_add_fetch(&nWaiters, 1, __ATOMIC_SEQ_CST);
+
+  while (!tryWait()) {
+    Futex::wait(&isSet, 0);
+  }
+
+  __atomic_sub_fetch(&nWaiters, 1, __ATOMIC_RELAXED);
+}
+
+}
@@ -0,0 +1,96 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/Event.hh
+ *
+ * `Event` class.
+ */
+
+#pragma once
+
+#include "common.hh"
+
+namespace oz
+{
+
+/**
+ * Auto-reset event.
+ *
+ * A binary flag that one thread sets and another waits for. `wait()` spins for a short while and
+ * only then blocks on a futex, so a hand-off between two busy threads usually avoids a kernel
+ * transition, and `set()` only enters the kernel when a waiter is actually asleep. Unlike
+ * `Semaphore` setting an already set event has no effect.
+ *
+ * Platforms without futexes block by sleeping in short intervals instead.
+ *
+ * @sa `oz::Semaphore`, `oz::Latch`, `oz::Barrier`
+ */
+class Event
+{
+private:
+
+  volatile int isSet    = 0; ///< 1 iff set.
+  volatile int nWaiters = 0; ///< Number of threads blocked or about to block in `wait()`.
+
+public:
+
+  /**
+   * Create unset event.
+   */
+  Event() = default;
+
+  /**
+   * Copying or moving is not possible.
+   */
+  Event(const Event&) = delete;
+
+  /**
+   * Copying or moving is not possible.
+   */
+  Event& operator = (const Event&) = delete;
+
+  /**
+   * Set event and wake one waiting thread.
+   */
+  void set();
+
+  /**
+   * Wait until event is set, then reset it.
+   */
+  void wait();
+
+  /**
+   * Reset event if it is set.
+   *
+   * @return True iff event was set.
+   */
+  bool tryWait()
+  {
+    int expected = 1;
+    return __atomic_compare_exchange_n(&isSet, &expected, 0, false, __ATOMIC_SEQ_CST,
+                                       __ATOMIC_SEQ_CST);
+  }
+
+};
+
+}
@@ -0,0 +1,247 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/FlatHashMap.hh
+ *
+ * `FlatHashMap` class template.
+ */
+
+#pragma once
+
+#include "Map.hh"
+#include "FlatHashSet.hh"
+
+namespace oz
+{
+
+/**
+ * Open-addressing hashtable implementation.
+ *
+ * It has the same interface as `HashMap`, but values are moved when the table grows, so pointers
+ * returned by `find()` and `add()` are only valid until the next insertion.
+ *
+ * @sa `oz::FlatHashSet`, `oz::HashMap`
+ */
+template <typename Key, typename Value, class HashFunc = Hash<Key>>
+class FlatHashMap : private FlatHashSet<detail::MapPair<Key, Value, Less<void>>, HashFunc>
+{
+public:
+
+  /**
+   * Shortcut for key-value pair type.
+   */
+  typedef detail::MapPair<Key, Value, Less<void>> Pair;
+
+  using typename FlatHashSet<Pair, HashFunc>::CIterator;
+  using typename FlatHashSet<Pair, HashFunc>::Iterator;
+
+private:
+
+  using FlatHashSet<Pair, HashFunc>::slots;
+  using FlatHashSet<Pair, HashFunc>::ctrl;
+  using FlatHashSet<Pair, HashFunc>::size;
+  using FlatHashSet<Pair, HashFunc>::count;
+  using FlatHashSet<Pair, HashFunc>::hash;
+  using FlatHashSet<Pair, HashFunc>::lookup;
+  using FlatHashSet<Pair, HashFunc>::claim;
+  using FlatHashSet<Pair, HashFunc>::ensureCapacity;
+
+  /**
+   * Insert an element, optionally overwriting an existing one.
+   *
+   * This is a helper function to reduce code duplication between `add()` and `include()`.
+   *
+   * @return Value of the inserted element.
+   */
+  template <typename Key_, typename Value_>
+  Pair& insert(Key_&& key, Value_&& value, bool overwrite)
+  {
+    uint h     = hash(key);
+    int  index = lookup(key, h);
+
+    if (index >= 0) {
+      if (overwrite) {
+        slots[index].value = static_cast<Value_&&>(value);
+      }
+      return slots[index];
+    }
+
+    index = claim(h);
+    return *new(&slots[index]) Pair{ static_cast<Key_&&>(key), static_cast<Value_&&>(value) };
+  }
+
+public:
+
+  using FlatHashSet<Pair, HashFunc>::citerator;
+  using FlatHashSet<Pair, HashFunc>::iterator;
+  using FlatHashSet<Pair, HashFunc>::begin;
+  using FlatHashSet<Pair, HashFunc>::end;
+  using FlatHashSet<Pair, HashFunc>::length;
+  using FlatHashSet<Pair, HashFunc>::isEmpty;
+  using FlatHashSet<Pair, HashFunc>::capacity;
+  using FlatHashSet<Pair, HashFunc>::contains;
+  using FlatHashSet<Pair, HashFunc>::exclude;
+  using FlatHashSet<Pair, HashFunc>::trim;
+  using FlatHashSet<Pair, HashFunc>::clear;
+
+  /**
+   * Create an empty hashtable.
+   */
+  FlatHashMap() = default;
+
+  /**
+   * Create an empty hashtable with enough slots for a given number of elements.
+   */
+  explicit FlatHashMap(int capacity) :
+    FlatHashSet<Pair, HashFunc>(capacity)
+  {}
+
+  /**
+   * Initialise from an initialiser list.
+   */
+  FlatHashMap(InitialiserList<Pair> l) :
+    FlatHashMap(int(l.size()))
+  {
+    for (const Pair& p : l) {
+      add(p.key, p.value);
+    }
+  }
+
+  /**
+   * Copy constructor, copies elements and storage.
+   */
+  FlatHashMap(const FlatHashMap& ht) = default;
+
+  /**
+   * Move constructor, moves storage.
+   */
+  FlatHashMap(FlatHashMap&& ht) = default;
+
+  /**
+   * Copy operator, copies elements and storage.
+   */
+  FlatHashMap& operator = (const FlatHashMap& ht) = default;
+
+  /**
+   * Move operator, moves storage.
+   */
+  FlatHashMap& operator = (FlatHashMap&& ht) = default;
+
+  /**
+   * Assign from an initialiser list.
+   */
+  FlatHashMap& operator = (InitialiserList<Pair> l)
+  {
+    clear();
+    ensureCapacity(int(l.size()));
+
+    for (const Pair& p : l) {
+      add(p.key, p.value);
+    }
+    return *this;
+  }
+
+  /**
+   * True iff contained elements are equal.
+   */
+  bool operator == (const FlatHashMap& ht) const
+  {
+    if (count != ht.count) {
+      return false;
+    }
+
+    for (const Pair& p : *this) {
+      const Value* value = ht.find(p.key);
+
+      if (value == nullptr || !(*value == p.value)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * False iff contained elements are equal.
+   */
+  bool operator != (const FlatHashMap& ht) const
+  {
+    return !operator == (ht);
+  }
+
+  /**
+   * Constant pointer to the value for a given key or `nullptr` if not found.
+   */
+  template <typename Key_>
+  const Value* find(const Key_& key) const
+  {
+    int index = lookup(key, hash(key));
+    return index < 0 ? nullptr : &slots[index].value;
+  }
+
+  /**
+   * Pointer to the value for a given key or `nullptr` if not found.
+   */
+  template <typename Key_>
+  Value* find(const Key_& key)
+  {
+    return const_cast<Value*>(static_cast<const FlatHashMap*>(this)->find<Key_>(key));
+  }
+
+  /**
+   * Add a new element, if the key already exists in the hashtable overwrite existing element.
+   *
+   * @return Reference to the value of the inserted element.
+   */
+  template <typename Key_, typename Value_>
+  Pair& add(Key_&& key, Value_&& value)
+  {
+    return insert(static_cast<Key_&&>(key), static_cast<Value_&&>(value), true);
+  }
+
+  /**
+   * Add a new element if the key does not exist in the hashtable.
+   *
+   * @return Reference to the value of the inserted or the existing element with the same key.
+   */
+  template <typename Key_, typename Value_>
+  Pair& include(Key_&& key, Value_&& value)
+  {
+    return insert(static_cast<Key_&&>(key), static_cast<Value_&&>(value), false);
+  }
+
+  /**
+   * Delete all objects referenced by element values and clear the hashtable.
+   */
+  void free()
+  {
+    for (int i = 0; i < size; ++i) {
+      if (ctrl[i] >= 0) {
+        delete slots[i].value;
+      }
+    }
+    clear();
+  }
+
+};
+
+}
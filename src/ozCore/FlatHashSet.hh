@@ -0,0 +1,738 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/FlatHashSet.hh
+ *
+ * `FlatHashSet` class template.
+ */
+
+#pragma once
+
+#include "System.hh"
+#include "Arrays.hh"
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+namespace oz
+{
+
+namespace detail
+{
+
+template <typename Key, typename Value, class LessFunc>
+struct MapPair;
+
+}
+
+/**
+ * Open-addressing hashtable implementation, containing only keys without values.
+ *
+ * Elements are stored in a flat array of slots, accompanied by an array of control bytes, one per
+ * slot. A control byte is either `EMPTY`, `DELETED` or holds 7 bits of the element's hash. Slots
+ * are probed in aligned groups of 16 control bytes, which are matched all at once with SSE2 (or a
+ * plain loop where SSE2 is not available), so most lookups touch a single cache line of control
+ * bytes and compare keys only for elements whose 7 hash bits match.
+ *
+ * Unlike `HashSet`, elements are moved when the table is resized, so pointers to elements are only
+ * valid until the next insertion. Removal never moves elements, so it is safe to remove the
+ * previous element while iterating.
+ *
+ * Memory is allocated when the first element is added. The number of slots is always a power of
+ * two and is doubled when the table becomes 7/8 full.
+ *
+ * @sa `oz::FlatHashMap`, `oz::HashSet`
+ */
+template <typename Elem, class HashFunc = Hash<Elem>>
+class FlatHashSet
+{
+protected:
+
+  /// Number of control bytes probed at once.
+  static const int GROUP = 16;
+
+  /// Control byte of a slot that has never been used since the last rehash.
+  static const byte EMPTY = byte(0x80);
+
+  /// Control byte of a slot whose element has been removed.
+  static const byte DELETED = byte(0xfe);
+
+  /**
+   * Hashtable iterator.
+   */
+  template <typename ElemType>
+  class HashIterator : public detail::IteratorBase<ElemType>
+  {
+  private:
+
+    using detail::IteratorBase<ElemType>::elem;
+
+    const FlatHashSet* table = nullptr; ///< Hashtable that is being iterated.
+    int                index = 0;       ///< Index of the next slot.
+
+    /**
+     * Point to the first full slot at or after `index` or become invalid.
+     */
+    void advance()
+    {
+      while (index < table->size) {
+        if (table->ctrl[index] >= 0) {
+          elem = &table->slots[index];
+          ++index;
+          return;
+        }
+        ++index;
+      }
+      elem = nullptr;
+    }
+
+  public:
+
+    /**
+     * Create an invalid iterator.
+     */
+    HashIterator() = default;
+
+    /**
+     * Create hashtable iterator, initially pointing to the first hashtable element.
+     */
+    explicit HashIterator(const FlatHashSet& ht) :
+      table(&ht)
+    {
+      advance();
+    }
+
+    /**
+     * Advance to the next element.
+     */
+    HashIterator& operator ++ ()
+    {
+      hard_assert(elem != nullptr);
+
+      advance();
+      return *this;
+    }
+
+    /**
+     * STL-style begin iterator.
+     */
+    OZ_ALWAYS_INLINE
+    HashIterator begin() const
+    {
+      return *this;
+    }
+
+    /**
+     * STL-style end iterator.
+     */
+    OZ_ALWAYS_INLINE
+    HashIterator end() const
+    {
+      return HashIterator();
+    }
+
+  };
+
+public:
+
+  /**
+   * %Iterator with constant access to elements.
+   */
+  typedef HashIterator<const Elem> CIterator;
+
+  /**
+   * %Iterator with non-constant access to elements.
+   */
+  typedef HashIterator<Elem> Iterator;
+
+protected:
+
+  Elem* slots      = nullptr; ///< Element slots, followed by control bytes in the same block.
+  byte* ctrl       = nullptr; ///< Control bytes.
+  int   size       = 0;       ///< Number of slots, 0 or a power of two not less than `GROUP`.
+  int   count      = 0;       ///< Number of elements.
+  int   growthLeft = 0;       ///< Number of `EMPTY` slots that can be filled before rehashing.
+
+protected:
+
+  /**
+   * Scramble a hash value, so that identity hashes of integers spread over all groups.
+   */
+  OZ_ALWAYS_INLINE
+  static uint mix(int hash)
+  {
+    uint h = uint(hash) * 0x9e3779b9u;
+    return h ^ (h >> 16);
+  }
+
+  /**
+   * Hash of an element.
+   */
+  template <typename Elem_>
+  OZ_ALWAYS_INLINE
+  static uint hash(const Elem_& elem)
+  {
+    return mix(HashFunc()(elem));
+  }
+
+  /**
+   * Hash of a key-value pair is the hash of its key, so `FlatHashMap` can share rehashing code.
+   */
+  template <typename Key, typename Value, class LessFunc>
+  OZ_ALWAYS_INLINE
+  static uint hash(const detail::MapPair<Key, Value, LessFunc>& pair)
+  {
+    return mix(HashFunc()(pair.key));
+  }
+
+  /**
+   * Bit mask of group slots whose control byte equals a given value.
+   */
+  OZ_ALWAYS_INLINE
+  static uint match(const byte* group, byte value)
+  {
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return uint(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value))));
+#else
+    uint mask = 0;
+    for (int i = 0; i < GROUP; ++i) {
+      mask |= uint(group[i] == value) << i;
+    }
+    return mask;
+#endif
+  }
+
+  /**
+   * Bit mask of group slots that are either `EMPTY` or `DELETED`.
+   */
+  OZ_ALWAYS_INLINE
+  static uint matchFree(const byte* group)
+  {
+#ifdef __SSE2__
+    return uint(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+    uint mask = 0;
+    for (int i = 0; i < GROUP; ++i) {
+      mask |= uint(group[i] < 0) << i;
+    }
+    return mask;
+#endif
+  }
+
+  /**
+   * Number of elements that fit into a given number of slots before rehashing.
+   */
+  OZ_ALWAYS_INLINE
+  static int maxLoad(int nSlots)
+  {
+    return nSlots - nSlots / 8;
+  }
+
+  /**
+   * Index of the slot holding an element that matches a given key, -1 if not found.
+   */
+  template <typename Key>
+  int lookup(const Key& key, uint h) const
+  {
+    if (size == 0) {
+      return -1;
+    }
+
+    byte tag   = byte(h >> 25);
+    int  mask  = size / GROUP - 1;
+    int  group = int(h) & mask;
+
+    for (int step = 1; ; ++step) {
+      const byte* groupCtrl = &ctrl[group * GROUP];
+
+      for (uint bits = match(groupCtrl, tag); bits != 0; bits &= bits - 1) {
+        int index = group * GROUP + __builtin_ctz(bits);
+
+        if (key == slots[index]) {
+          return index;
+        }
+      }
+      if (match(groupCtrl, EMPTY) != 0) {
+        return -1;
+      }
+
+      // Triangular probing visits every group when their number is a power of two.
+      group = (group + step) & mask;
+    }
+  }
+
+  /**
+   * Index of the first free slot in the probe sequence for a given hash.
+   */
+  int findFree(uint h) const
+  {
+    int mask  = size / GROUP - 1;
+    int group = int(h) & mask;
+
+    for (int step = 1; ; ++step) {
+      uint bits = matchFree(&ctrl[group * GROUP]);
+
+      if (bits != 0) {
+        return group * GROUP + __builtin_ctz(bits);
+      }
+      group = (group + step) & mask;
+    }
+  }
+
+  /**
+   * Claim a free slot for a new element with a given hash, rehashing if necessary.
+   *
+   * The control byte is set, but the element has to be constructed by the caller.
+   */
+  int claim(uint h)
+  {
+    int index = size == 0 ? -1 : findFree(h);
+
+    if (index < 0 || (ctrl[index] == EMPTY && growthLeft == 0)) {
+      // Rehash in place if the table is mostly clogged with deleted slots, grow otherwise.
+      int newSize = size == 0 ? GROUP : count < maxLoad(size) / 2 ? size : size * 2;
+
+      resize(newSize);
+      index = findFree(h);
+    }
+
+    growthLeft -= ctrl[index] == EMPTY;
+    ctrl[index] = byte(h >> 25);
+    ++count;
+
+    return index;
+  }
+
+  /**
+   * Destroy an element and free its slot.
+   */
+  void erase(int index)
+  {
+    slots[index].~Elem();
+
+    // An aligned group with an empty slot never made any probe sequence go past it.
+    const byte* groupCtrl = &ctrl[index & ~(GROUP - 1)];
+
+    if (match(groupCtrl, EMPTY) != 0) {
+      ctrl[index] = EMPTY;
+      ++growthLeft;
+    }
+    else {
+      ctrl[index] = DELETED;
+    }
+    --count;
+  }
+
+  /**
+   * Resize slot array to a given number of slots (0 or a power of two) and rehash elements.
+   */
+  void resize(int newSize)
+  {
+    hard_assert(newSize == 0 || (newSize >= GROUP && (newSize & (newSize - 1)) == 0));
+    hard_assert(maxLoad(newSize) >= count);
+
+    Elem* oldSlots = slots;
+    byte* oldCtrl  = ctrl;
+    int   oldSize  = size;
+
+    slots      = nullptr;
+    ctrl       = nullptr;
+    size       = newSize;
+    growthLeft = maxLoad(newSize) - count;
+
+    if (newSize != 0) {
+      char* block = new char[size_t(newSize) * (sizeof(Elem) + 1)];
+
+      slots = reinterpret_cast<Elem*>(block);
+      ctrl  = reinterpret_cast<byte*>(block + size_t(newSize) * sizeof(Elem));
+
+      Arrays::fill(ctrl, newSize, byte(EMPTY));
+
+      for (int i = 0; i < oldSize; ++i) {
+        if (oldCtrl[i] >= 0) {
+          uint h     = hash(oldSlots[i]);
+          int  index = findFree(h);
+
+          ctrl[index] = byte(h >> 25);
+          new(&slots[index]) Elem(static_cast<Elem&&>(oldSlots[i]));
+          oldSlots[i].~Elem();
+        }
+      }
+    }
+    else {
+      hard_assert(count == 0);
+    }
+
+    delete[] reinterpret_cast<char*>(oldSlots);
+  }
+
+  /**
+   * Ensure there are enough slots for a given number of elements.
+   */
+  void ensureCapacity(int capacity)
+  {
+    if (capacity < 0) {
+      OZ_ERROR("oz::FlatHashSet: Capacity overflow");
+    }
+    else if (maxLoad(size) < capacity) {
+      int newSize = size == 0 ? GROUP : size;
+      while (maxLoad(newSize) < capacity) {
+        newSize *= 2;
+
+        if (newSize <= 0) {
+          OZ_ERROR("oz::FlatHashSet: Capacity overflow");
+        }
+      }
+
+      resize(newSize);
+    }
+  }
+
+  /**
+   * Insert an element, optionally overwriting an existing one.
+   *
+   * This is a helper function to reduce code duplication between `add()` and `include()`.
+   */
+  template <typename Elem_>
+  Elem& insert(Elem_&& elem, bool overwrite)
+  {
+    uint h     = hash(elem);
+    int  index = lookup(elem, h);
+
+    if (index >= 0) {
+      if (overwrite) {
+        slots[index] = static_cast<Elem_&&>(elem);
+      }
+      return slots[index];
+    }
+
+    index = claim(h);
+    return *new(&slots[index]) Elem(static_cast<Elem_&&>(elem));
+  }
+
+public:
+
+  /**
+   * Create an empty hashtable.
+   */
+  FlatHashSet() = default;
+
+  /**
+   * Create an empty hashtable with enough slots for a given number of elements.
+   */
+  explicit FlatHashSet(int capacity)
+  {
+    ensureCapacity(capacity);
+  }
+
+  /**
+   * Initialise from an initialiser list.
+   */
+  FlatHashSet(InitialiserList<Elem> l) :
+    FlatHashSet(int(l.size()))
+  {
+    for (const Elem& e : l) {
+      add(e);
+    }
+  }
+
+  /**
+   * Destructor.
+   */
+  ~FlatHashSet()
+  {
+    clear();
+    delete[] reinterpret_cast<char*>(slots);
+  }
+
+  /**
+   * Copy constructor, copies elements and storage.
+   */
+  FlatHashSet(const FlatHashSet& ht) :
+    FlatHashSet(ht.count)
+  {
+    for (const Elem& e : ht) {
+      add(e);
+    }
+  }
+
+  /**
+   * Move constructor, moves storage.
+   */
+  FlatHashSet(FlatHashSet&& ht) :
+    slots(ht.slots), ctrl(ht.ctrl), size(ht.size), count(ht.count), growthLeft(ht.growthLeft)
+  {
+    ht.slots      = nullptr;
+    ht.ctrl       = nullptr;
+    ht.size       = 0;
+    ht.count      = 0;
+    ht.growthLeft = 0;
+  }
+
+  /**
+   * Copy operator, copies elements and storage.
+   */
+  FlatHashSet& operator = (const FlatHashSet& ht)
+  {
+    if (&ht != this) {
+      clear();
+      ensureCapacity(ht.count);
+
+      for (const Elem& e : ht) {
+        add(e);
+      }
+    }
+    return *this;
+  }
+
+  /**
+   * Move operator, moves storage.
+   */
+  FlatHashSet& operator = (FlatHashSet&& ht)
+  {
+    if (&ht != this) {
+      clear();
+      delete[] reinterpret_cast<char*>(slots);
+
+      slots      = ht.slots;
+      ctrl       = ht.ctrl;
+      size       = ht.size;
+      count      = ht.count;
+      growthLeft = ht.growthLeft;
+
+      ht.slots      = nullptr;
+      ht.ctrl       = nullptr;
+      ht.size       = 0;
+      ht.count      = 0;
+      ht.growthLeft = 0;
+    }
+    return *this;
+  }
+
+  /**
+   * Assign from an initialiser list.
+   */
+  FlatHashSet& operator = (InitialiserList<Elem> l)
+  {
+    clear();
+    ensureCapacity(int(l.size()));
+
+    for (const Elem& e : l) {
+      add(e);
+    }
+    return *this;
+  }
+
+  /**
+   * True iff contained elements are equal.
+   */
+  bool operator == (const FlatHashSet& ht) const
+  {
+    if (count != ht.count) {
+      return false;
+    }
+
+    for (const Elem& e : *this) {
+      if (!ht.contains(e)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * False iff contained elements are equal.
+   */
+  bool operator != (const FlatHashSet& ht) const
+  {
+    return !operator == (ht);
+  }
+
+  /**
+   * %Iterator with constant access, initially points to the first element.
+   */
+  OZ_ALWAYS_INLINE
+  CIterator citerator() const
+  {
+    return CIterator(*this);
+  }
+
+  /**
+   * %Iterator with non-constant access, initially points to the first element.
+   */
+  OZ_ALWAYS_INLINE
+  Iterator iterator()
+  {
+    return Iterator(*this);
+  }
+
+  /**
+   * STL-style constant begin iterator.
+   */
+  OZ_ALWAYS_INLINE
+  CIterator begin() const
+  {
+    return CIterator(*this);
+  }
+
+  /**
+   * STL-style begin iterator.
+   */
+  OZ_ALWAYS_INLINE
+  Iterator begin()
+  {
+    return Iterator(*this);
+  }
+
+  /**
+   * STL-style constant end iterator.
+   */
+  OZ_ALWAYS_INLINE
+  CIterator end() const
+  {
+    return CIterator();
+  }
+
+  /**
+   * STL-style end iterator.
+   */
+  OZ_ALWAYS_INLINE
+  Iterator end()
+  {
+    return Iterator();
+  }
+
+  /**
+   * Number of elements.
+   */
+  OZ_ALWAYS_INLINE
+  int length() const
+  {
+    return count;
+  }
+
+  /**
+   * True iff empty.
+   */
+  OZ_ALWAYS_INLINE
+  bool isEmpty() const
+  {
+    return count == 0;
+  }
+
+  /**
+   * Number of slots.
+   */
+  OZ_ALWAYS_INLINE
+  int capacity() const
+  {
+    return size;
+  }
+
+  /**
+   * True iff an element matching a given key is found in the hashtable.
+   */
+  template <typename Key>
+  bool contains(const Key& key) const
+  {
+    return lookup(key, hash(key)) >= 0;
+  }
+
+  /**
+   * Add a new element, if the element already exists in the hashtable overwrite the existing one.
+   */
+  template <typename Elem_>
+  Elem& add(Elem_&& elem)
+  {
+    return insert(static_cast<Elem_&&>(elem), true);
+  }
+
+  /**
+   * Add a new element if it does not exist in the hashtable.
+   */
+  template <typename Elem_>
+  Elem& include(Elem_&& elem)
+  {
+    return insert(static_cast<Elem_&&>(elem), false);
+  }
+
+  /**
+   * Remove the element that matches a given key.
+   *
+   * @return True iff the element was found (and removed).
+   */
+  template <typename Key>
+  bool exclude(const Key& key)
+  {
+    int index = lookup(key, hash(key));
+
+    if (index < 0) {
+      return false;
+    }
+
+    erase(index);
+    return true;
+  }
+
+  /**
+   * Shrink the slot array to the least power of two that holds the current elements.
+   *
+   * In case the hastable contains no elements all its storage gets deallocated.
+   */
+  void trim()
+  {
+    int newSize = 0;
+
+    if (count != 0) {
+      newSize = GROUP;
+      while (maxLoad(newSize) < count) {
+        newSize *= 2;
+      }
+    }
+
+    if (newSize < size) {
+      resize(newSize);
+    }
+  }
+
+  /**
+   * Clear the hashtable.
+   */
+  void clear()
+  {
+    for (int i = 0; i < size; ++i) {
+      if (ctrl[i] >= 0) {
+        slots[i].~Elem();
+      }
+      ctrl[i] = EMPTY;
+    }
+
+    count      = 0;
+    growthLeft = maxLoad(size);
+  }
+
+};
+
+}
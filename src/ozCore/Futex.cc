@@ -0,0 +1,85 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/Futex.cc
+ */
+
+#include "Futex.hh"
+
+#include "Time.hh"
+
+#if defined(__linux__)
+# include <climits>
+# include <linux/futex.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+namespace oz
+{
+
+void Futex::wait(volatile int* address, int value)
+{
+#if defined(__linux__)
+  syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+#else
+  static_cast<void>(address);
+  static_cast<void>(value);
+
+  Time::usleep(50);
+#endif
+}
+
+void Futex::wakeOne(volatile int* address)
+{
+#if defined(__linux__)
+  syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+  static_cast<void>(address);
+#endif
+}
+
+void Futex::wakeAll(volatile int* address)
+{
+#if defined(__linux__)
+  syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+  static_cast<void>(address);
+#endif
+}
+
+void Futex::waitWhile(volatile int* address, int value)
+{
+  for (int i = 0; i < SPIN_COUNT; ++i) {
+    if (__atomic_load_n(address, __ATOMIC_ACQUIRE) != value) {
+      return;
+    }
+    pause();
+  }
+
+  while (__atomic_load_n(address, __ATOMIC_ACQUIRE) == value) {
+    wait(address, value);
+  }
+}
+
+}
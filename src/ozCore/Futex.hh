@@ -0,0 +1,90 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/Futex.hh
+ *
+ * `Futex` class.
+ */
+
+#pragma once
+
+#include "common.hh"
+
+namespace oz
+{
+
+/**
+ * Spin and futex wait helpers shared by ozCore synchronisation primitives.
+ *
+ * This is an internal header for `Event`, `Latch`, `Barrier` and `Jobs`; it is not included
+ * by `ozCore.hh`. On platforms without futexes, waiting sleeps briefly and waking does nothing,
+ * so callers must re-check their condition after every `wait()`.
+ */
+class Futex
+{
+public:
+
+  /// Number of `pause()` iterations `waitWhile()` spins before it blocks.
+  static const int SPIN_COUNT = 256;
+
+public:
+
+  /**
+   * Forbid instances.
+   */
+  Futex() = delete;
+
+  /**
+   * Hint to the CPU that the calling thread is spinning.
+   */
+  OZ_ALWAYS_INLINE
+  static void pause()
+  {
+#if defined(__i386__) || defined(__x86_64__)
+    __asm__ volatile ("pause");
+#endif
+  }
+
+  /**
+   * Block while `*address == value` or until woken, may also return spuriously.
+   */
+  static void wait(volatile int* address, int value);
+
+  /**
+   * Wake one thread blocked on `address`.
+   */
+  static void wakeOne(volatile int* address);
+
+  /**
+   * Wake all threads blocked on `address`.
+   */
+  static void wakeAll(volatile int* address);
+
+  /**
+   * Wait while `*address == value`, spinning for `SPIN_COUNT` rounds before blocking.
+   */
+  static void waitWhile(volatile int* address, int value);
+
+};
+
+}
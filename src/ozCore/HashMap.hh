@@ -40,7 +40,7 @@ namespace oz
  * Memory is allocated when the first element is added. The number of buckets is doubled when the
  * number of elements surpasses it.
  *
- * @sa `oz::HashSet`, `oz::Map`
+ * @sa `oz::HashSet`, `oz::FlatHashMap`, `oz::Map`
  */
 template <typename Key, typename Value, class HashFunc = Hash<Key>>
 class HashMap : private HashSet<detail::MapPair<Key, Value, Less<void>>, HashFunc>
@@ -40,7 +40,7 @@ namespace oz
  * Memory is allocated when the first element is added. The number of buckets is doubled when the
  * number of elements surpasses it.
  *
- * @sa `oz::HashMap`, `oz::Set`, `oz::Heap`
+ * @sa `oz::HashMap`, `oz::FlatHashSet`, `oz::Set`, `oz::Heap`
  */
 template <typename Elem, class HashFunc = Hash<Elem>>
 class HashSet
@@ -284,13 +284,13 @@ protected:
         if (overwrite) {
           entry->elem = static_cast<Elem_&&>(elem);
         }
-        return;
+        return entry->elem;
       }
       entry = entry->next;
     }
 
     data[index] = new(pool) Entry{ data[index], h, static_cast<Elem_&&>(elem) };
-    return *data[index];
+    return data[index]->elem;
   }
 
 public:
@@ -0,0 +1,501 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/Jobs.cc
+ */
+
+#include "Jobs.hh"
+
+#include "Futex.hh"
+#include "SpinLock.hh"
+#include "List.hh"
+
+#include <cstdio>
+
+#if defined(_WIN32)
+# include <windows.h>
+#elif defined(__GLIBC__)
+# include <pthread.h>
+# include <sched.h>
+#endif
+
+namespace oz
+{
+
+static_assert((Jobs::DEQUE_SIZE & (Jobs::DEQUE_SIZE - 1)) == 0,
+              "Jobs::DEQUE_SIZE must be a power of two");
+
+// Number of failed attempts to find a job before a worker goes to sleep.
+static const int SPIN_ROUNDS = 256;
+
+struct Job
+{
+  Jobs::Function* function;
+  void*           data;
+  Jobs::Group*    group;
+};
+
+/*
+ * Chase-Lev deque over a fixed ring buffer, using the memory orderings from Lê et al., "Correct and
+ * Efficient Work-Stealing for Weak Memory Models". A thief may read a slot while the owner refills
+ * it, so slot fields are accessed atomically. The thief's CAS on `top` fails in that case and the
+ * torn job is discarded.
+ */
+struct Deque
+{
+  volatile long64 top;
+  char            topPadding[64 - sizeof(long64)];
+  volatile long64 bottom;
+  char            bottomPadding[64 - sizeof(long64)];
+  Job             jobs[Jobs::DEQUE_SIZE];
+
+  OZ_ALWAYS_INLINE
+  void store(long64 i, const Job& job)
+  {
+    Job& slot = jobs[i & (Jobs::DEQUE_SIZE - 1)];
+
+    __atomic_store_n(&slot.function, job.function, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot.data, job.data, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot.group, job.group, __ATOMIC_RELAXED);
+  }
+
+  OZ_ALWAYS_INLINE
+  void load(long64 i, Job* job)
+  {
+    Job& slot = jobs[i & (Jobs::DEQUE_SIZE - 1)];
+
+    job->function = __atomic_load_n(&slot.function, __ATOMIC_RELAXED);
+    job->data     = __atomic_load_n(&slot.data, __ATOMIC_RELAXED);
+    job->group    = __atomic_load_n(&slot.group, __ATOMIC_RELAXED);
+  }
+
+  OZ_ALWAYS_INLINE
+  bool isEmpty() const
+  {
+    return __atomic_load_n(&bottom, __ATOMIC_SEQ_CST) <= __atomic_load_n(&top, __ATOMIC_SEQ_CST);
+  }
+
+  // Owner only.
+  bool push(const Job& job)
+  {
+    long64 b = __atomic_load_n(&bottom, __ATOMIC_RELAXED);
+    long64 t = __atomic_load_n(&top, __ATOMIC_ACQUIRE);
+
+    if (b - t >= Jobs::DEQUE_SIZE) {
+      return false;
+    }
+
+    store(b, job);
+    __atomic_store_n(&bottom, b + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  // Owner only.
+  bool pop(Job* job)
+  {
+    long64 b = __atomic_load_n(&bottom, __ATOMIC_RELAXED) - 1;
+
+    __atomic_store_n(&bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    long64 t = __atomic_load_n(&top, __ATOMIC_RELAXED);
+
+    if (t > b) {
+      __atomic_store_n(&bottom, b + 1, __ATOMIC_RELAXED);
+      return false;
+    }
+
+    load(b, job);
+
+    if (t == b) {
+      // Last job, race against thieves.
+      bool hasWon = __atomic_compare_exchange_n(&top, &t, t + 1, false, __ATOMIC_SEQ_CST,
+                                                __ATOMIC_RELAXED);
+
+      __atomic_store_n(&bottom, b + 1, __ATOMIC_RELAXED);
+      return hasWon;
+    }
+    return true;
+  }
+
+  bool steal(Job* job)
+  {
+    long64 t = __atomic_load_n(&top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long64 b = __atomic_load_n(&bottom, __ATOMIC_ACQUIRE);
+
+    if (t >= b) {
+      return false;
+    }
+
+    load(t, job);
+    return __atomic_compare_exchange_n(&top, &t, t + 1, false, __ATOMIC_SEQ_CST,
+                                       __ATOMIC_RELAXED);
+  }
+};
+
+struct Worker
+{
+  Deque  deque;
+  Thread thread;
+  int    index;
+};
+
+struct ForRange
+{
+  Jobs::RangeFunction* function;
+  void*                data;
+  int                  end;
+  int                  grainSize;
+  volatile int         next;
+};
+
+static Worker*              workers       = nullptr;
+static int                  poolSize      = 1;
+static bool                 doPin         = false;
+static volatile bool        isAlive       = false;
+static volatile int         nSleeping     = 0;
+static volatile int         wakeSequence  = 0; // Futex word, bumped on every wake-up.
+static volatile int         nShared       = 0;
+static SpinLock             sharedLock;
+static List<Job>            sharedJobs;
+static thread_local Worker* currentWorker = nullptr;
+static thread_local uint    randomState   = 0;
+
+static void pinThread(int index)
+{
+  int core = index % Thread::nCores();
+
+#if defined(_WIN32)
+
+  SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core);
+
+#elif defined(__GLIBC__)
+
+  cpu_set_t set;
+
+  CPU_ZERO(&set);
+  CPU_SET(core, &set);
+
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+#else
+
+  static_cast<void>(core);
+
+#endif
+}
+
+
+static bool popShared(Job* job)
+{
+  if (__atomic_load_n(&nShared, __ATOMIC_ACQUIRE) == 0) {
+    return false;
+  }
+
+  bool hasJob = false;
+
+  sharedLock.lock();
+
+  if (!sharedJobs.isEmpty()) {
+    *job   = sharedJobs.popLast();
+    hasJob = true;
+
+    __atomic_store_n(&nShared, sharedJobs.length(), __ATOMIC_RELEASE);
+  }
+
+  sharedLock.unlock();
+
+  return hasJob;
+}
+
+static bool findJob(Worker* self, Job* job)
+{
+  if (self != nullptr && self->deque.pop(job)) {
+    return true;
+  }
+  if (popShared(job)) {
+    return true;
+  }
+
+  // Steal, starting at a random victim to spread contention (xorshift).
+  if (randomState == 0) {
+    randomState = uint(reinterpret_cast<size_t>(&randomState)) | 1u;
+  }
+
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+
+  int start = int(randomState % uint(poolSize));
+
+  for (int i = 0; i < poolSize; ++i) {
+    Worker* victim = &workers[(start + i) % poolSize];
+
+    if (victim != self && victim->deque.steal(job)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool hasWork()
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  if (__atomic_load_n(&nShared, __ATOMIC_SEQ_CST) != 0) {
+    return true;
+  }
+
+  for (int i = 0; i < poolSize; ++i) {
+    if (!workers[i].deque.isEmpty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void wakeWorker()
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  if (__atomic_load_n(&nSleeping, __ATOMIC_SEQ_CST) != 0) {
+    __atomic_add_fetch(&wakeSequence, 1, __ATOMIC_SEQ_CST);
+    Futex::wakeOne(&wakeSequence);
+  }
+}
+
+static void forMain(void* data)
+{
+  ForRange* range = static_cast<ForRange*>(data);
+
+  while (true) {
+    int begin = __atomic_fetch_add(&range->next, range->grainSize, __ATOMIC_RELAXED);
+
+    if (begin >= range->end) {
+      break;
+    }
+
+    range->function(range->data, begin, min(begin + range->grainSize, range->end));
+  }
+}
+
+// Functions that need access to `Group` internals.
+struct Jobs::Pool
+{
+  static void execute(const Job& job);
+  static void workerMain(void* data);
+};
+
+OZ_INTERNAL
+void Jobs::Pool::execute(const Job& job)
+{
+  job.function(job.data);
+
+  __atomic_sub_fetch(&job.group->nPending, 1, __ATOMIC_RELEASE);
+}
+
+OZ_INTERNAL
+void Jobs::Pool::workerMain(void* data)
+{
+  Worker* self      = static_cast<Worker*>(data);
+  int     nFailures = 0;
+
+  currentWorker = self;
+
+  if (doPin) {
+    pinThread(self->index);
+  }
+
+  while (__atomic_load_n(&isAlive, __ATOMIC_ACQUIRE)) {
+    Job job;
+
+    if (findJob(self, &job)) {
+      execute(job);
+      nFailures = 0;
+    }
+    else if (nFailures < SPIN_ROUNDS) {
+      Futex::pause();
+      ++nFailures;
+    }
+    else {
+      // Sleeping counter must be raised before checking for work, so a concurrent `run()` either
+      // sees it and bumps the sequence or its job is found here. A bump after the sequence has
+      // been read makes the futex wait return immediately.
+      int sequence = __atomic_load_n(&wakeSequence, __ATOMIC_SEQ_CST);
+
+      __atomic_add_fetch(&nSleeping, 1, __ATOMIC_SEQ_CST);
+
+      if (!hasWork() && __atomic_load_n(&isAlive, __ATOMIC_SEQ_CST)) {
+        Futex::wait(&wakeSequence, sequence);
+      }
+
+      __atomic_sub_fetch(&nSleeping, 1, __ATOMIC_SEQ_CST);
+      nFailures = 0;
+    }
+  }
+
+  currentWorker = nullptr;
+}
+
+int Jobs::nThreads()
+{
+  return poolSize;
+}
+
+int Jobs::threadIndex()
+{
+  return currentWorker == nullptr ? -1 : currentWorker->index;
+}
+
+void Jobs::run(Group* group, Function* function, void* data)
+{
+  Job     job  = { function, data, group };
+  Worker* self = currentWorker;
+
+  __atomic_add_fetch(&group->nPending, 1, __ATOMIC_RELAXED);
+
+  if (workers == nullptr) {
+    Pool::execute(job);
+    return;
+  }
+
+  if (self != nullptr) {
+    if (!self->deque.push(job)) {
+      Pool::execute(job);
+      return;
+    }
+  }
+  else {
+    sharedLock.lock();
+
+    sharedJobs.add(job);
+    __atomic_store_n(&nShared, sharedJobs.length(), __ATOMIC_RELEASE);
+
+    sharedLock.unlock();
+  }
+
+  wakeWorker();
+}
+
+void Jobs::wait(Group* group)
+{
+  Worker* self = currentWorker;
+
+  while (!group->isDone()) {
+    Job job;
+
+    if (findJob(self, &job)) {
+      Pool::execute(job);
+    }
+    else {
+      Futex::pause();
+    }
+  }
+}
+
+void Jobs::parallelFor(int begin, int end, int grainSize, RangeFunction* function, void* data)
+{
+  if (begin >= end) {
+    return;
+  }
+
+  grainSize = max(grainSize, 1);
+
+  int      nChunks = (end - begin - 1) / grainSize + 1;
+  int      nJobs   = min(nChunks, poolSize);
+  ForRange range   = { function, data, end, grainSize, begin };
+  Group    group;
+
+  for (int i = 1; i < nJobs; ++i) {
+    run(&group, forMain, &range);
+  }
+
+  forMain(&range);
+  wait(&group);
+}
+
+void Jobs::init(int nWorkers, bool pinThreads)
+{
+  if (workers != nullptr) {
+    OZ_ERROR("oz::Jobs: Already initialised");
+  }
+
+  nWorkers = max(nWorkers, 0);
+
+  poolSize = nWorkers + 1;
+  doPin    = pinThreads;
+  workers  = new Worker[poolSize];
+  isAlive  = true;
+
+  for (int i = 0; i < poolSize; ++i) {
+    workers[i].deque.top    = 0;
+    workers[i].deque.bottom = 0;
+    workers[i].index        = i;
+  }
+
+  currentWorker = &workers[0];
+
+  for (int i = 1; i < poolSize; ++i) {
+    char name[Thread::NAME_LENGTH + 1];
+    snprintf(name, sizeof(name), "job%d", i);
+
+    workers[i].thread = Thread(name, Pool::workerMain, &workers[i]);
+  }
+}
+
+void Jobs::destroy()
+{
+  if (workers == nullptr) {
+    return;
+  }
+
+  // Drain all queues before stopping workers.
+  Job job;
+
+  do {
+    while (findJob(currentWorker, &job)) {
+      Pool::execute(job);
+    }
+  }
+  while (hasWork());
+
+  __atomic_store_n(&isAlive, false, __ATOMIC_SEQ_CST);
+  __atomic_add_fetch(&wakeSequence, 1, __ATOMIC_SEQ_CST);
+  Futex::wakeAll(&wakeSequence);
+
+  for (int i = 1; i < poolSize; ++i) {
+    workers[i].thread.join();
+  }
+
+  delete[] workers;
+
+  workers       = nullptr;
+  poolSize      = 1;
+  currentWorker = nullptr;
+
+  sharedJobs.clear();
+  sharedJobs.trim();
+}
+
+}
@@ -0,0 +1,189 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/Jobs.hh
+ *
+ * `Jobs` class.
+ */
+
+#pragma once
+
+#include "Thread.hh"
+
+namespace oz
+{
+
+/**
+ * Work-stealing job scheduler.
+ *
+ * `init()` starts a pool of worker threads. Each worker and the thread that called `init()` own a
+ * fixed-size Chase-Lev deque: jobs are pushed to and popped from the bottom of the owner's deque
+ * (LIFO, cache-friendly for fork/join) while idle workers steal from the top of other deques.
+ * Jobs submitted from other threads go to a shared queue. Idle workers sleep on a futex word.
+ *
+ * Jobs are forked into a `Group` and joined by `wait()`, which executes pending jobs instead of
+ * blocking, so jobs may safely fork and wait for nested groups. If the scheduler is not initialised
+ * or the submitting thread's deque is full, a job is executed immediately on the calling thread.
+ *
+ * @sa `oz::Thread`
+ */
+class Jobs
+{
+public:
+
+  /// Maximum number of pending jobs per thread. Further jobs are executed immediately.
+  static const int DEQUE_SIZE = 4096;
+
+  /// %Job function type.
+  typedef void Function(void* data);
+
+  /// %Range function type for `parallelFor()`, called for sub-ranges [`begin`, `end`).
+  typedef void RangeFunction(void* data, int begin, int end);
+
+private:
+
+  struct Pool;
+
+public:
+
+  /**
+   * Set of jobs that can be waited for.
+   */
+  class Group
+  {
+  private:
+
+    friend class Jobs;
+    friend struct Jobs::Pool;
+
+    volatile int nPending = 0; ///< Number of jobs that are queued or running.
+
+  public:
+
+    /**
+     * Create an empty group.
+     */
+    Group() = default;
+
+    /**
+     * Copying or moving is not possible.
+     */
+    Group(const Group&) = delete;
+
+    /**
+     * Copying or moving is not possible.
+     */
+    Group& operator = (const Group&) = delete;
+
+    /**
+     * True iff all jobs in the group have finished.
+     */
+    OZ_ALWAYS_INLINE
+    bool isDone() const
+    {
+      return __atomic_load_n(&nPending, __ATOMIC_ACQUIRE) == 0;
+    }
+
+  };
+
+private:
+
+  template <class Func>
+  static void rangeMain(void* data, int begin, int end)
+  {
+    (*static_cast<const Func*>(data))(begin, end);
+  }
+
+public:
+
+  /**
+   * Forbid instances.
+   */
+  Jobs() = delete;
+
+  /**
+   * Number of threads executing jobs, including the thread that called `init()`, 1 if not
+   * initialised.
+   */
+  static int nThreads();
+
+  /**
+   * Index of the current thread in the pool: 0 for the thread that called `init()`, 1 to
+   * `nThreads() - 1` for workers and -1 for other threads.
+   */
+  static int threadIndex();
+
+  /**
+   * Add a job to a group.
+   *
+   * The job is pushed onto the current thread's deque or onto the shared queue if the current
+   * thread is not in the pool.
+   */
+  static void run(Group* group, Function* function, void* data = nullptr);
+
+  /**
+   * Execute pending jobs until all jobs in a group have finished.
+   */
+  static void wait(Group* group);
+
+  /**
+   * Call `function(data, begin, end)` for sub-ranges of [`begin`, `end`) in parallel and wait.
+   *
+   * The range is split into chunks of `grainSize` elements that threads take dynamically, so
+   * uneven per-element cost is balanced. The calling thread takes part in the work.
+   */
+  static void parallelFor(int begin, int end, int grainSize, RangeFunction* function, void* data);
+
+  /**
+   * Call `func(begin, end)` for sub-ranges of [`begin`, `end`) in parallel and wait.
+   */
+  template <class Func>
+  static void parallelFor(int begin, int end, int grainSize, const Func& func)
+  {
+    parallelFor(begin, end, grainSize, rangeMain<Func>,
+                const_cast<void*>(static_cast<const void*>(&func)));
+  }
+
+  /**
+   * Start worker threads.
+   *
+   * The calling thread becomes a member of the pool with index 0, so it should also be the one that
+   * submits and waits for most jobs, typically the main thread.
+   *
+   * @param nWorkers number of worker threads to start (with 0, jobs are only executed by threads
+   *        waiting for them).
+   * @param pinThreads pin worker `i` to CPU core `i` where supported (the calling thread is left
+   *        alone).
+   */
+  static void init(int nWorkers = Thread::nCores() - 1, bool pinThreads = false);
+
+  /**
+   * Finish pending jobs and stop worker threads.
+   *
+   * Jobs must not be submitted from other threads during and after this call.
+   */
+  static void destroy();
+
+};
+
+}
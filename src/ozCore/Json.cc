@@ -27,12 +27,15 @@
 #include "Json.hh"
 
 #include "List.hh"
-#include "SList.hh"
 #include "Map.hh"
 #include "Log.hh"
 
 #define OZ_PARSE_ERROR(charBias, message) \
-  OZ_ERROR("oz::Json: " message " at %s:%d:%d", path, line, column + (charBias));
+  { \
+    int line, column; \
+    position(&line, &column); \
+    OZ_ERROR("oz::Json: " message " at %s:%d:%d", path, line, column + (charBias)); \
+  }
 
 static_assert(sizeof(double) >= sizeof(void*),
               "Pointer must fit into double for internal oz::Json union to work properly");
@@ -52,58 +55,164 @@ struct ArrayData
   List<Json> list;
 };
 
+/*
+ * Object entries are kept in a flat list in insertion order. Objects with more than
+ * `INDEX_THRESHOLD` entries additionally get an open-addressing hash index, smaller ones are
+ * searched linearly, which is faster than hashing for a few short keys.
+ */
 struct ObjectData
 {
-  Map<String, Json> map;
-};
+  typedef Map<String, Json>::Pair Entry;
 
-struct Json::Parser
-{
-  enum BlanksMode
+  static const int INDEX_THRESHOLD = 8;
+
+  List<Entry> entries; ///< Entries in insertion order.
+  List<int>   index;   ///< Hash table of entry positions + 1 (0 is empty), empty if not indexed.
+
+  OZ_INTERNAL
+  int find(const char* key) const
   {
-    WHITESPACE,
-    LINE_COMMENT,
-    MULTILINE_COMMENT
-  };
+    if (index.isEmpty()) {
+      for (int i = 0; i < entries.length(); ++i) {
+        if (String::equals(entries[i].key, key)) {
+          return i;
+        }
+      }
+      return -1;
+    }
 
-  Stream*     is;
-  const char* path;
-  int         line;
-  int         column;
-  int         oldLine;
-  int         oldColumn;
+    uint mask = uint(index.length() - 1);
+
+    for (uint slot = uint(Hash<const char*>()(key)) & mask; index[slot] != 0;
+         slot = (slot + 1) & mask)
+    {
+      int i = index[slot] - 1;
+
+      if (String::equals(entries[i].key, key)) {
+        return i;
+      }
+    }
+    return -1;
+  }
 
   OZ_INTERNAL
-  char readChar()
+  void indexEntry(int i)
   {
-    if (is->available() == 0) {
-      OZ_PARSE_ERROR(0, "Unexpected end of file");
+    uint mask = uint(index.length() - 1);
+    uint slot = uint(Hash<const char*>()(entries[i].key)) & mask;
+
+    while (index[slot] != 0) {
+      slot = (slot + 1) & mask;
     }
+    index[slot] = i + 1;
+  }
 
-    oldLine   = line;
-    oldColumn = column;
+  OZ_INTERNAL
+  void rebuildIndex()
+  {
+    if (entries.length() <= INDEX_THRESHOLD) {
+      index.clear();
+      index.trim();
+      return;
+    }
+
+    // Keep the load factor at most 1/2.
+    int size = 4 * INDEX_THRESHOLD;
+    while (size < 2 * entries.length()) {
+      size *= 2;
+    }
+
+    index.resize(size, true);
+    Arrays::fill(index.begin(), size, 0);
+
+    for (int i = 0; i < entries.length(); ++i) {
+      indexEntry(i);
+    }
+  }
+
+  template <typename Key_, typename Value_>
+  OZ_INTERNAL
+  Entry& insert(Key_&& key, Value_&& value, bool overwrite)
+  {
+    int i = find(key);
+
+    if (i >= 0) {
+      if (overwrite) {
+        entries[i].value = static_cast<Value_&&>(value);
+      }
+      return entries[i];
+    }
 
-    char ch = is->readChar();
+    entries.add(Entry{ static_cast<Key_&&>(key), static_cast<Value_&&>(value) });
 
-    if (ch == '\n') {
-      ++line;
-      column = 0;
+    if (2 * entries.length() > index.length()) {
+      rebuildIndex();
     }
     else {
-      ++column;
+      indexEntry(entries.length() - 1);
     }
-    return ch;
+    return entries.last();
   }
 
   OZ_INTERNAL
-  void backChar()
+  bool exclude(const char* key)
   {
-    hard_assert(line != oldLine || column != oldColumn);
+    int i = find(key);
 
-    is->seek(is->tell() - 1);
+    if (i < 0) {
+      return false;
+    }
 
-    line   = oldLine;
-    column = oldColumn;
+    entries.erase(i);
+    rebuildIndex();
+    return true;
+  }
+};
+
+/*
+ * The parser scans the stream buffer directly instead of reading it character by character. Strings
+ * without escape sequences are copied from the buffer in one go and line/column of the current
+ * position are only computed when reporting an error.
+ */
+struct Json::Parser
+{
+  const char* begin;
+  const char* pos;
+  const char* end;
+  const char* path;
+  List<char>  buffer;
+
+  OZ_INTERNAL
+  void position(int* line, int* column) const
+  {
+    const char* lineBegin = begin;
+
+    *line = 1;
+
+    for (const char* i = begin; i < pos; ++i) {
+      if (*i == '\n') {
+        lineBegin = i + 1;
+        ++*line;
+      }
+    }
+    *column = int(pos - lineBegin);
+  }
+
+  OZ_INTERNAL
+  char readChar()
+  {
+    if (pos == end) {
+      OZ_PARSE_ERROR(0, "Unexpected end of file");
+    }
+    return *pos++;
+  }
+
+  OZ_INTERNAL
+  void backChar()
+  {
+    hard_assert(pos != begin);
+
+    --pos;
   }
 
   OZ_INTERNAL
@@ -124,9 +233,9 @@ struct Json::Parser
         break;
       }
       case OBJECT: {
-        Map<String, Json>& map = static_cast<ObjectData*>(value->data)->map;
+        List<ObjectData::Entry>& entries = static_cast<ObjectData*>(value->data)->entries;
 
-        for (auto& i : map) {
+        for (auto& i : entries) {
           setAccessed(&i.value);
         }
         break;
@@ -137,17 +246,18 @@ struct Json::Parser
   OZ_INTERNAL
   static Json parse(Stream* is, const char* path)
   {
-    Parser parser(is, path);
+    Parser parser(is->begin(), is->begin() + is->tell(), is->end(), path);
 
     Json root = parser.parseValue();
 
     parser.finish();
+    is->seek(int(parser.pos - parser.begin));
     return root;
   }
 
   OZ_INTERNAL
-  explicit Parser(Stream* is_, const char* path_) :
-    is(is_), path(path_), line(1), column(0), oldLine(1), oldColumn(0)
+  explicit Parser(const char* begin_, const char* pos_, const char* end_, const char* path_) :
+    begin(begin_), pos(pos_), end(end_), path(path_)
   {}
 
   OZ_INTERNAL
@@ -200,11 +310,28 @@ struct Json::Parser
   OZ_INTERNAL
   String parseString()
   {
-    List<char> chars;
+    const char* first = pos;
+
+    while (pos != end && *pos != '"' && *pos != '\\' && *pos != '\n' && *pos != '\r') {
+      ++pos;
+    }
+
+    if (pos == end) {
+      OZ_PARSE_ERROR(0, "End of file while looking for end of string (Is ending \" missing?)");
+    }
+    else if (*pos == '"') {
+      ++pos;
+      return String(first, int(pos - 1 - first));
+    }
+
+    // Slow path for strings containing escape sequences or line breaks.
+    buffer.clear();
+    buffer.addAll(first, int(pos - first));
+
     char ch = '"';
 
-    do {
-      ch = readChar();
+    while (pos != end) {
+      ch = *pos++;
 
       if (ch == '\n' || ch == '\r') {
         continue;
@@ -243,16 +370,119 @@ struct Json::Parser
         break;
       }
 
-      chars.add(ch);
+      buffer.add(ch);
     }
-    while (is->available() != 0);
 
     if (ch != '"') {
       OZ_PARSE_ERROR(0, "End of file while looking for end of string (Is ending \" missing?)");
     }
-    chars.add('\0');
 
-    return String(chars.begin(), chars.length() - 1);
+    return String(buffer.begin(), buffer.length());
+  }
+
+  /*
+   * Numbers with at most 15 significant digits and a small exponent are exactly representable as
+   * `m * 10^e` or `m / 10^e`, where both `m` and `10^e` are exact doubles, so a single rounding
+   * gives the same result as `strtod()`. Returns false if the fast path does not apply.
+   */
+  OZ_INTERNAL
+  static bool parseSimpleNumber(const char* first, const char* last, double* number)
+  {
+    static const double POWERS[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* s        = first;
+    bool        negative = s != last && *s == '-';
+    ulong64     mantissa = 0;
+    int         nDigits  = 0;
+    int         exponent = 0;
+
+    s += negative;
+
+    if (s == last || !String::isDigit(*s)) {
+      return false;
+    }
+
+    for (; s != last && String::isDigit(*s); ++s) {
+      mantissa = mantissa * 10 + ulong64(*s - '0');
+      nDigits += mantissa != 0;
+    }
+    if (s != last && *s == '.') {
+      ++s;
+
+      if (s == last || !String::isDigit(*s)) {
+        return false;
+      }
+
+      for (; s != last && String::isDigit(*s); ++s) {
+        mantissa = mantissa * 10 + ulong64(*s - '0');
+        nDigits += mantissa != 0;
+        --exponent;
+      }
+    }
+    if (s != last && (*s == 'e' || *s == 'E')) {
+      ++s;
+
+      bool negativeExp = s != last && *s == '-';
+      int  exp         = 0;
+
+      s += s != last && (*s == '-' || *s == '+');
+
+      if (s == last || !String::isDigit(*s)) {
+        return false;
+      }
+
+      for (; s != last && String::isDigit(*s) && exp < 1000; ++s) {
+        exp = exp * 10 + (*s - '0');
+      }
+      exponent += negativeExp ? -exp : exp;
+    }
+
+    if (s != last || nDigits > 15 || exponent < -22 || exponent > 22) {
+      return false;
+    }
+
+    double value = double(mantissa);
+
+    value   = exponent < 0 ? value / POWERS[-exponent] : value * POWERS[exponent];
+    *number = negative ? -value : value;
+    return true;
+  }
+
+  OZ_INTERNAL
+  Json parseNumber()
+  {
+    const char* first = pos - 1;
+
+    while (pos != end && !String::isBlank(*pos) && *pos != ',' && *pos != '}' && *pos != ']') {
+      ++pos;
+    }
+
+    int    length = int(pos - first);
+    double number;
+
+    if (length > 31) {
+      pos = first + 32;
+      OZ_PARSE_ERROR(-31, "Too long number");
+    }
+
+    if (!parseSimpleNumber(first, pos, &number)) {
+      char chars[32];
+
+      Arrays::copy<char>(first, length, chars);
+      chars[length] = '\0';
+
+      const char* numberEnd;
+      number = String::parseDouble(chars, &numberEnd);
+
+      if (numberEnd == chars) {
+        OZ_PARSE_ERROR(-length, "Unknown value type");
+      }
+    }
+
+    return Json(number);
   }
 
   OZ_INTERNAL
@@ -262,54 +492,33 @@ struct Json::Parser
 
     switch (ch) {
       case 'n': {
-        if (is->available() < 3 || readChar() != 'u' || readChar() != 'l' || readChar() != 'l') {
-          OZ_PARSE_ERROR(-3, "Unknown value type");
+        if (end - pos >= 3 && pos[0] == 'u' && pos[1] == 'l' && pos[2] == 'l') {
+          pos += 3;
+          return Json(nullptr, NIL);
         }
 
-        return Json(nullptr, NIL);
+        // `nan`
+        return parseNumber();
       }
       case 'f': {
-        if (is->available() < 4 || readChar() != 'a' || readChar() != 'l' || readChar() != 's' ||
-            readChar() != 'e')
-        {
-          OZ_PARSE_ERROR(-4, "Unknown value type");
+        if (end - pos < 4 || pos[0] != 'a' || pos[1] != 'l' || pos[2] != 's' || pos[3] != 'e') {
+          ++pos;
+          OZ_PARSE_ERROR(-1, "Unknown value type");
         }
 
+        pos += 4;
         return Json(false);
       }
       case 't': {
-        if (is->available() < 4 || readChar() != 'r' || readChar() != 'u' || readChar() != 'e') {
-          OZ_PARSE_ERROR(-3, "Unknown value type");
+        if (end - pos < 3 || pos[0] != 'r' || pos[1] != 'u' || pos[2] != 'e') {
+          OZ_PARSE_ERROR(0, "Unknown value type");
         }
 
+        pos += 3;
         return Json(true);
       }
-      default: { // Number.
-        SList<char, 32> chars;
-        chars.add(ch);
-
-        while (is->available() != 0) {
-          ch = readChar();
-
-          if (String::isBlank(ch) || ch == ',' || ch == '}' || ch == ']') {
-            backChar();
-            break;
-          }
-          if (chars.length() >= 31) {
-            OZ_PARSE_ERROR(-chars.length(), "Too long number");
-          }
-          chars.add(ch);
-        }
-        chars.add('\0');
-
-        const char* end;
-        double number = String::parseDouble(chars.begin(), &end);
-
-        if (end == chars.begin()) {
-          OZ_PARSE_ERROR(-chars.length(), "Unknown value type");
-        }
-
-        return Json(number);
+      default: {
+        return parseNumber();
       }
       case '"': {
         return Json(new StringData{ parseString() }, STRING);
@@ -352,7 +561,7 @@ struct Json::Parser
   Json parseObject()
   {
     Json objectValue(new ObjectData(), OBJECT);
-    Map<String, Json>& map = static_cast<ObjectData*>(objectValue.data)->map;
+    ObjectData* objectData = static_cast<ObjectData*>(objectValue.data);
 
     char ch = skipBlanks();
     if (ch != '}') {
@@ -373,7 +582,7 @@ struct Json::Parser
       }
 
       Json value = parseValue();
-      map.add(static_cast<String&&>(key), static_cast<Json&&>(value));
+      objectData->insert(static_cast<String&&>(key), static_cast<Json&&>(value), true);
 
       ch = skipBlanks();
 
@@ -388,8 +597,8 @@ struct Json::Parser
   OZ_INTERNAL
   void finish()
   {
-    while (is->available() != 0) {
-      char ch = readChar();
+    while (pos != end) {
+      char ch = *pos++;
 
       if (!String::isBlank(ch)) {
         OZ_PARSE_ERROR(0, "End of file expected but some content found after");
@@ -540,22 +749,39 @@ struct Json::Formatter
     os->writeChar(']');
   }
 
+  struct EntryLess
+  {
+    OZ_INTERNAL
+    bool operator () (const ObjectData::Entry* a, const ObjectData::Entry* b) const
+    {
+      return a->key < b->key;
+    }
+  };
+
   OZ_INTERNAL
   void writeObject(const Json& value)
   {
-    const Map<String, Json>& map = static_cast<const ObjectData*>(value.data)->map;
+    const List<ObjectData::Entry>& entries = static_cast<const ObjectData*>(value.data)->entries;
 
-    if (map.isEmpty()) {
+    if (entries.isEmpty()) {
       os->write("{}", 2);
       return;
     }
 
+    // Entries are written sorted by key, so saved files do not depend on the insertion order.
+    List<const ObjectData::Entry*> sortedEntries(entries.length());
+
+    for (int i = 0; i < entries.length(); ++i) {
+      sortedEntries[i] = &entries[i];
+    }
+    Arrays::sort<const ObjectData::Entry*, EntryLess>(sortedEntries.begin(), entries.length());
+
     os->writeChar('{');
     os->write(format->lineEnd, lineEndLength);
 
     ++indentLevel;
 
-    for (int i = 0; i < map.length(); ++i) {
+    for (int i = 0; i < sortedEntries.length(); ++i) {
       if (i != 0) {
         os->writeChar(',');
         os->write(format->lineEnd, lineEndLength);
@@ -565,8 +791,8 @@ struct Json::Formatter
         os->write("  ", 2);
       }
 
-      const String& entryKey   = map[i].key;
-      const Json&   entryValue = map[i].value;
+      const String& entryKey   = sortedEntries[i]->key;
+      const Json&   entryValue = sortedEntries[i]->value;
 
       int keyLength = writeString(entryKey);
       os->writeChar(':');
@@ -727,10 +953,10 @@ Json::Json(InitialiserList<Json> l) :
 Json::Json(InitialiserList<Pair> l) :
   data(new ObjectData()), valueType(OBJECT), wasAccessed(false)
 {
-  Map<String, Json>& map = static_cast<ObjectData*>(data)->map;
+  ObjectData* objectData = static_cast<ObjectData*>(data);
 
   for (const auto& i : l) {
-    map.add(i.key, i.value);
+    objectData->insert(i.key, i.value, true);
   }
 }
 
@@ -864,10 +1090,21 @@ bool Json::operator == (const Json& j) const
       return l1 == l2;
     }
     case OBJECT: {
-      const Map<String, Json>& m1 = static_cast<const ObjectData*>(data)->map;
-      const Map<String, Json>& m2 = static_cast<const ObjectData*>(j.data)->map;
+      const ObjectData* o1 = static_cast<const ObjectData*>(data);
+      const ObjectData* o2 = static_cast<const ObjectData*>(j.data);
 
-      return m1 == m2;
+      if (o1->entries.length() != o2->entries.length()) {
+        return false;
+      }
+
+      for (const auto& i : o1->entries) {
+        int index = o2->find(i.key);
+
+        if (index < 0 || o2->entries[index].value != i.value) {
+          return false;
+        }
+      }
+      return true;
     }
   }
 }
@@ -908,10 +1145,10 @@ Json::ArrayIterator Json::arrayIter()
 Json::ObjectCIterator Json::objectCIter() const
 {
   if (valueType == OBJECT) {
-    const Map<String, Json>& map = static_cast<const ObjectData*>(data)->map;
+    const List<ObjectData::Entry>& entries = static_cast<const ObjectData*>(data)->entries;
 
     wasAccessed = true;
-    return map.citerator();
+    return entries.citerator();
   }
   else {
     wasAccessed |= valueType == NIL;
@@ -922,10 +1159,10 @@ Json::ObjectCIterator Json::objectCIter() const
 Json::ObjectIterator Json::objectIter()
 {
   if (valueType == OBJECT) {
-    Map<String, Json>& map = static_cast<ObjectData*>(data)->map;
+    List<ObjectData::Entry>& entries = static_cast<ObjectData*>(data)->entries;
 
     wasAccessed = true;
-    return map.iterator();
+    return entries.iterator();
   }
   else {
     wasAccessed |= valueType == NIL;
@@ -947,10 +1184,10 @@ int Json::length() const
       return list.length();
     }
     case OBJECT: {
-      const Map<String, Json>& map = static_cast<const ObjectData*>(data)->map;
+      const List<ObjectData::Entry>& entries = static_cast<const ObjectData*>(data)->entries;
 
       wasAccessed = true;
-      return map.length();
+      return entries.length();
     }
   }
 }
@@ -981,17 +1218,19 @@ const Json& Json::operator [] (const char* key) const
     return NIL_VALUE;
   }
 
-  const Map<String, Json>& map = static_cast<const ObjectData*>(data)->map;
-  const Json* value = map.find(key);
+  const ObjectData* objectData = static_cast<const ObjectData*>(data);
+  int               index      = objectData->find(key);
 
   wasAccessed = true;
 
-  if (value == nullptr) {
+  if (index < 0) {
     return NIL_VALUE;
   }
 
-  value->wasAccessed = true;
-  return *value;
+  const Json& value = objectData->entries[index].value;
+
+  value.wasAccessed = true;
+  return value;
 }
 
 bool Json::contains(const char* key) const
@@ -1001,16 +1240,16 @@ bool Json::contains(const char* key) const
     return false;
   }
 
-  const Map<String, Json>& map = static_cast<const ObjectData*>(data)->map;
-  const Json* value = map.find(key);
+  const ObjectData* objectData = static_cast<const ObjectData*>(data);
+  int               index      = objectData->find(key);
 
   wasAccessed = true;
 
-  if (value == nullptr) {
+  if (index < 0) {
     return false;
   }
 
-  value->wasAccessed = true;
+  objectData->entries[index].value.wasAccessed = true;
   return true;
 }
 
@@ -1123,8 +1362,8 @@ Json& Json::add(const char* key, const Json& json)
              key, toString().c());
   }
 
-  Map<String, Json>& map = static_cast<ObjectData*>(data)->map;
-  return map.add(key, json).value;
+  ObjectData* objectData = static_cast<ObjectData*>(data);
+  return objectData->insert(key, json, true).value;
 }
 
 Json& Json::add(const char* key, Json&& json)
@@ -1134,8 +1373,8 @@ Json& Json::add(const char* key, Json&& json)
              key, toString().c());
   }
 
-  Map<String, Json>& map = static_cast<ObjectData*>(data)->map;
-  return map.add(key, static_cast<Json&&>(json)).value;
+  ObjectData* objectData = static_cast<ObjectData*>(data);
+  return objectData->insert(key, static_cast<Json&&>(json), true).value;
 }
 
 Json& Json::include(const char* key, const Json& json)
@@ -1145,8 +1384,8 @@ Json& Json::include(const char* key, const Json& json)
              key, toString().c());
   }
 
-  Map<String, Json>& map = static_cast<ObjectData*>(data)->map;
-  return map.include(key, json).value;
+  ObjectData* objectData = static_cast<ObjectData*>(data);
+  return objectData->insert(key, json, false).value;
 }
 
 Json& Json::include(const char* key, Json&& json)
@@ -1156,8 +1395,8 @@ Json& Json::include(const char* key, Json&& json)
              key, toString().c());
   }
 
-  Map<String, Json>& map = static_cast<ObjectData*>(data)->map;
-  return map.include(key, static_cast<Json&&>(json)).value;
+  ObjectData* objectData = static_cast<ObjectData*>(data);
+  return objectData->insert(key, static_cast<Json&&>(json), false).value;
 }
 
 bool Json::erase(int index)
@@ -1184,9 +1423,8 @@ bool Json::exclude(const char* key)
              toString().c());
   }
 
-  Map<String, Json>& map = static_cast<ObjectData*>(data)->map;
-
-  return map.exclude(key) >= 0;
+  ObjectData* objectData = static_cast<ObjectData*>(data);
+  return objectData->exclude(key);
 }
 
 bool Json::clear(bool warnUnused)
@@ -1225,7 +1463,7 @@ bool Json::clear(bool warnUnused)
       ObjectData* objectData = static_cast<ObjectData*>(data);
 
       if (warnUnused) {
-        for (auto& i : objectData->map) {
+        for (auto& i : objectData->entries) {
           hasUnused |= i.value.clear(true);
         }
       }
@@ -1278,16 +1516,16 @@ String Json::toString() const
       return s + " ]";
     }
     case OBJECT: {
-      const Map<String, Json>& map = static_cast<const ObjectData*>(data)->map;
+      const List<ObjectData::Entry>& entries = static_cast<const ObjectData*>(data)->entries;
 
-      if (map.isEmpty()) {
+      if (entries.isEmpty()) {
         return "{}";
       }
 
       String s = "{ ";
 
       bool isFirst = true;
-      for (const auto& i : map) {
+      for (const auto& i : entries) {
         s += String::format(isFirst ? "\"%s\": %s" : ", \"%s\": %s",
                             i.key.c(), i.value.toString().c());
         isFirst = false;
@@ -1309,6 +1547,104 @@ String Json::toFormattedString(const Format& format) const
   return String(os.begin(), os.tell());
 }
 
+void Json::read(Stream* is)
+{
+  clear();
+
+  valueType   = Type(is->readUByte());
+  wasAccessed = false;
+
+  switch (valueType) {
+    default: {
+      valueType = NIL;
+      break;
+    }
+    case BOOLEAN: {
+      boolean = is->readBool();
+      break;
+    }
+    case NUMBER: {
+      number = is->readDouble();
+      break;
+    }
+    case STRING: {
+      data = new StringData{ is->readString() };
+      break;
+    }
+    case ARRAY: {
+      ArrayData* arrayData = new ArrayData();
+      int        length    = is->readInt();
+
+      data = arrayData;
+      arrayData->list.resize(length, true);
+
+      for (Json& element : arrayData->list) {
+        element.read(is);
+      }
+      break;
+    }
+    case OBJECT: {
+      ObjectData* objectData = new ObjectData();
+      int         length     = is->readInt();
+
+      data = objectData;
+      objectData->entries.resize(length, true);
+
+      // Keys are unique, so entries are read in place and indexed once at the end.
+      for (ObjectData::Entry& entry : objectData->entries) {
+        entry.key = is->readString();
+        entry.value.read(is);
+      }
+      objectData->rebuildIndex();
+      break;
+    }
+  }
+}
+
+void Json::write(Stream* os) const
+{
+  os->writeUByte(ubyte(valueType));
+
+  switch (valueType) {
+    default: {
+      break;
+    }
+    case BOOLEAN: {
+      os->writeBool(boolean);
+      break;
+    }
+    case NUMBER: {
+      os->writeDouble(number);
+      break;
+    }
+    case STRING: {
+      os->writeString(static_cast<const StringData*>(data)->value);
+      break;
+    }
+    case ARRAY: {
+      const List<Json>& list = static_cast<const ArrayData*>(data)->list;
+
+      os->writeInt(list.length());
+
+      for (const Json& element : list) {
+        element.write(os);
+      }
+      break;
+    }
+    case OBJECT: {
+      const List<ObjectData::Entry>& entries = static_cast<const ObjectData*>(data)->entries;
+
+      os->writeInt(entries.length());
+
+      for (const auto& entry : entries) {
+        os->writeString(entry.key);
+        entry.value.write(os);
+      }
+      break;
+    }
+  }
+}
+
 bool Json::load(const File& file)
 {
   Stream is = file.read();
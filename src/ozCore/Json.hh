@@ -41,6 +41,9 @@ namespace oz
  * - `inf` and `-inf` (case-sensitive) represent positive and negative infinity respectively,
  * - `nan` (case-sensitive) represents not-a-number and
  * - C++-style comments are allowed.
+ *
+ * Object entries are kept in insertion order, which is also the iteration order. Formatted output
+ * lists them sorted by key.
  */
 class Json
 {
@@ -527,6 +530,16 @@ public:
    */
   String toFormattedString(const Format& format = DEFAULT_FORMAT) const;
 
+  /**
+   * Clear existing value and read a value in binary encoding, as written by `write()`.
+   */
+  void read(Stream* is);
+
+  /**
+   * Write value in a compact binary encoding that can be read back without parsing.
+   */
+  void write(Stream* os) const;
+
   /**
    * Clear existing value and read new contents from a JSON file.
    *
@@ -0,0 +1,74 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/Latch.cc
+ */
+
+#include "Latch.hh"
+
+#include "Futex.hh"
+
+namespace oz
+{
+
+void Latch::countDown(int n)
+{
+  int value = __atomic_sub_fetch(&counter, n, __ATOMIC_ACQ_REL);
+
+  if (value <= 0 && value + n > 0) {
+    Futex::wakeAll(&counter);
+  }
+}
+
+void Latch::wait() const
+{
+  // Counter may change several times while we wait, so each wake-up re-reads it.
+  while (true) {
+    int value = __atomic_load_n(&counter, __ATOMIC_ACQUIRE);
+
+    if (value <= 0) {
+      return;
+    }
+
+    Futex::waitWhile(const_cast<volatile int*>(&counter), value);
+  }
+}
+
+bool Barrier::arriveAndWait()
+{
+  int phase = __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+
+  if (__atomic_add_fetch(&nArrived, 1, __ATOMIC_ACQ_REL) == nThreads) {
+    // Others do not touch `nArrived` again until they see the new generation.
+    __atomic_store_n(&nArrived, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&generation, phase + 1, __ATOMIC_RELEASE);
+
+    Futex::wakeAll(&generation);
+    return true;
+  }
+
+  Futex::waitWhile(&generation, phase);
+  return false;
+}
+
+}
@@ -0,0 +1,143 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/Latch.hh
+ *
+ * `Latch` and `Barrier` classes.
+ */
+
+#pragma once
+
+#include "common.hh"
+
+namespace oz
+{
+
+/**
+ * Single-use countdown latch.
+ *
+ * Threads wait until the counter, set on construction, has been counted down to zero. Waiting
+ * spins shortly and then blocks on a futex (or sleeps in short intervals where futexes are not
+ * available).
+ *
+ * @sa `oz::Barrier`, `oz::Event`
+ */
+class Latch
+{
+private:
+
+  volatile int counter; ///< Remaining count.
+
+public:
+
+  /**
+   * Create latch that opens after `count` calls to `countDown()`.
+   */
+  explicit Latch(int count) :
+    counter(count)
+  {}
+
+  /**
+   * Copying or moving is not possible.
+   */
+  Latch(const Latch&) = delete;
+
+  /**
+   * Copying or moving is not possible.
+   */
+  Latch& operator = (const Latch&) = delete;
+
+  /**
+   * True iff counter has reached zero.
+   */
+  bool isOpen() const
+  {
+    return __atomic_load_n(&counter, __ATOMIC_ACQUIRE) <= 0;
+  }
+
+  /**
+   * Decrement counter by `n` and wake all waiting threads if it reaches zero.
+   */
+  void countDown(int n = 1);
+
+  /**
+   * Wait until counter reaches zero.
+   */
+  void wait() const;
+
+  /**
+   * Count down once and wait.
+   */
+  void arriveAndWait()
+  {
+    countDown();
+    wait();
+  }
+
+};
+
+/**
+ * Reusable thread barrier.
+ *
+ * All `count` participating threads block in `arriveAndWait()` until the last one arrives. Then all
+ * are released and the barrier is immediately ready for the next phase.
+ *
+ * @sa `oz::Latch`, `oz::Event`
+ */
+class Barrier
+{
+private:
+
+  int          nThreads;       ///< Number of participating threads.
+  volatile int nArrived   = 0; ///< Threads that have arrived in the current phase.
+  volatile int generation = 0; ///< Incremented each time all threads have arrived.
+
+public:
+
+  /**
+   * Create barrier for `count` threads.
+   */
+  explicit Barrier(int count) :
+    nThreads(count)
+  {}
+
+  /**
+   * Copying or moving is not possible.
+   */
+  Barrier(const Barrier&) = delete;
+
+  /**
+   * Copying or moving is not possible.
+   */
+  Barrier& operator = (const Barrier&) = delete;
+
+  /**
+   * Wait until all threads arrive.
+   *
+   * @return True for exactly one thread per phase, the one that arrived last.
+   */
+  bool arriveAndWait();
+
+};
+
+}
@@ -604,7 +604,7 @@ public:
   }
 
   /**
-   * Sort elements with quicksort.
+   * Sort elements with `Arrays::sort()`.
    */
   template <class LessFunc = Less<void>>
   void sort()
@@ -188,6 +188,19 @@ bool Log::printMemorySummary()
   println("cumulative chunks %7d", Alloc::sumCount);
   println("cumulative amount %7.2f MiB (%lu B)",
           float(Alloc::sumAmount) / (1024.0f * 1024.0f), ulong(Alloc::sumAmount));
+  println("size classes {");
+  indent();
+
+  for (const Alloc::SizeClass& sizeClass : Alloc::sizeClasses) {
+    if (sizeClass.sumCount != 0) {
+      println("%4lu B  current %7d  maximum %7d  cumulative %9d  blocks %7d",
+              ulong(sizeClass.size), sizeClass.count, sizeClass.maxCount, sizeClass.sumCount,
+              sizeClass.nBlocks);
+    }
+  }
+
+  unindent();
+  println("}");
 
   unindent();
   println("}");
@@ -220,8 +233,7 @@ bool Log::printMemoryLeaks()
   bool hasOutput = false;
 
   for (const auto& ci : Alloc::objectCIter()) {
-    println("Leaked object at %p of size %lu B allocated",
-            static_cast<const void*>(&ci), ulong(ci.size));
+    println("Leaked object at %p of size %lu B allocated", ci.address, ulong(ci.size));
     indent();
     printTrace(ci.stackTrace);
     unindent();
@@ -230,8 +242,7 @@ bool Log::printMemoryLeaks()
   }
 
   for (const auto& ci : Alloc::arrayCIter()) {
-    println("Leaked array at %p of size %lu B allocated",
-            static_cast<const void*>(&ci), ulong(ci.size));
+    println("Leaked array at %p of size %lu B allocated", ci.address, ulong(ci.size));
     indent();
     printTrace(ci.stackTrace);
     unindent();
@@ -141,7 +141,7 @@ public:
   static void printTrace(const StackTrace& st);
 
   /**
-   * Print summary about memory usage (`Alloc`'s -`count` and -`size` fields).
+   * Print summary about memory usage (`Alloc`'s -`count` and -`size` fields and size classes).
    *
    * If new/delete operators haven't been overloaded or no memory allocation have been made nothing
    * is printed.
@@ -153,7 +153,7 @@ public:
   static bool printMemorySummary();
 
   /**
-   * Print memory chunks allocated via `new` and `new[]` operators, tracked by `Alloc` class.
+   * Print sampled memory chunks allocated via `new` and `new[]` operators, tracked by `Alloc`.
    *
    * @return true iff there have been any memory chunks printed.
    *
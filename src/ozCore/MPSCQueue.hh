@@ -0,0 +1,208 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/MPSCQueue.hh
+ *
+ * `MPSCQueue` class template.
+ */
+
+#pragma once
+
+#include "common.hh"
+
+namespace oz
+{
+
+/**
+ * Bounded lock-free multiple-producer single-consumer queue.
+ *
+ * Each slot carries a sequence number that tells whether it is free for the producer that claimed
+ * its position or already holds an element for the consumer. Producers claim positions with a
+ * compare-and-swap on the tail, so `push()` never blocks another producer once its slot has been
+ * claimed, and the single consumer needs no atomic read-modify-write at all. `push()` fails when the
+ * queue is full.
+ *
+ * @sa `oz::SPSCQueue`, `oz::Event`
+ */
+template <typename Elem, int SIZE>
+class MPSCQueue
+{
+  static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "oz::MPSCQueue size must be a power of two");
+
+private:
+
+  static const int CACHE_LINE = 64; ///< Padding between producer and consumer state.
+
+  /**
+   * Slot with a sequence number.
+   *
+   * `sequence == pos` means free for position `pos`, `sequence == pos + 1` means filled.
+   */
+  struct Slot
+  {
+    uint sequence;
+    Elem elem;
+  };
+
+  uint head = 0;                       ///< Next position to pop (consumer).
+  char headPad[CACHE_LINE - sizeof(uint)];
+  uint tail = 0;                       ///< Next position to claim (producers).
+  char tailPad[CACHE_LINE - sizeof(uint)];
+  Slot slots[SIZE];                    ///< Ring buffer.
+
+  /**
+   * Claim a slot at the tail, return nullptr if full.
+   */
+  OZ_ALWAYS_INLINE
+  Slot* claim()
+  {
+    uint pos = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+
+    while (true) {
+      Slot* slot = &slots[pos & (SIZE - 1)];
+      int   diff = int(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - pos);
+
+      if (diff == 0) {
+        if (__atomic_compare_exchange_n(&tail, &pos, pos + 1, true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED))
+        {
+          return slot;
+        }
+      }
+      else if (diff < 0) {
+        return nullptr;
+      }
+      else {
+        pos = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+      }
+    }
+  }
+
+public:
+
+  /**
+   * Create an empty queue.
+   */
+  MPSCQueue()
+  {
+    for (int i = 0; i < SIZE; ++i) {
+      slots[i].sequence = uint(i);
+    }
+  }
+
+  /**
+   * Copying or moving is not possible.
+   */
+  MPSCQueue(const MPSCQueue&) = delete;
+
+  /**
+   * Copying or moving is not possible.
+   */
+  MPSCQueue& operator = (const MPSCQueue&) = delete;
+
+  /**
+   * Capacity.
+   */
+  static constexpr int capacity()
+  {
+    return SIZE;
+  }
+
+  /**
+   * Approximate number of elements, claimed slots that are still being filled are counted too.
+   */
+  int length() const
+  {
+    return int(__atomic_load_n(&tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&head, __ATOMIC_ACQUIRE));
+  }
+
+  /**
+   * True iff empty, approximate in the same way as `length()`.
+   */
+  bool isEmpty() const
+  {
+    return length() == 0;
+  }
+
+  /**
+   * Copy an element to the tail (any thread).
+   *
+   * @return False iff the queue is full.
+   */
+  bool push(const Elem& elem)
+  {
+    Slot* slot = claim();
+
+    if (slot == nullptr) {
+      return false;
+    }
+
+    slot->elem = elem;
+    __atomic_store_n(&slot->sequence, slot->sequence + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  /**
+   * Move an element to the tail (any thread).
+   *
+   * @return False iff the queue is full.
+   */
+  bool push(Elem&& elem)
+  {
+    Slot* slot = claim();
+
+    if (slot == nullptr) {
+      return false;
+    }
+
+    slot->elem = static_cast<Elem&&>(elem);
+    __atomic_store_n(&slot->sequence, slot->sequence + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  /**
+   * Move the head element into `elem` (consumer only).
+   *
+   * Returns false also when the head slot has been claimed by a producer that has not finished
+   * writing it yet.
+   *
+   * @return False iff no element is ready.
+   */
+  bool pop(Elem* elem)
+  {
+    uint  pos  = head;
+    Slot* slot = &slots[pos & (SIZE - 1)];
+
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != pos + 1) {
+      return false;
+    }
+
+    *elem = static_cast<Elem&&>(slot->elem);
+    __atomic_store_n(&slot->sequence, pos + uint(SIZE), __ATOMIC_RELEASE);
+    __atomic_store_n(&head, pos + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+};
+
+}
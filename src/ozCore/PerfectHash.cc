@@ -0,0 +1,228 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/PerfectHash.cc
+ */
+
+#include "PerfectHash.hh"
+
+#include "Bitset.hh"
+#include "String.hh"
+
+namespace oz
+{
+
+// Average number of keys per bucket.
+static const int BUCKET_SIZE = 4;
+
+static ulong64 hashKey(const char* key)
+{
+  ulong64 value = 14695981039346656037ull;
+
+  for (const char* c = key; *c != '\0'; ++c) {
+    value = (value ^ ubyte(*c)) * 1099511628211ull;
+  }
+  return value;
+}
+
+static int bucketOf(ulong64 hash, int nBuckets)
+{
+  return int(uint(hash >> 32) % uint(nBuckets));
+}
+
+// The mix is a bijection on 64-bit values, so keys with different hashes never share slots for
+// every seed.
+static int slotOf(ulong64 hash, int seed, int nSlots)
+{
+  ulong64 value = hash ^ (ulong64(seed) * 0x9e3779b97f4a7c15ull);
+
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdull;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ull;
+  value ^= value >> 33;
+
+  return int(value % ulong64(nSlots));
+}
+
+int PerfectHash::index(const char* key) const
+{
+  if (indices.isEmpty()) {
+    return -1;
+  }
+
+  ulong64 hash = hashKey(key);
+  int     seed = seeds[bucketOf(hash, seeds.length())];
+
+  return indices[slotOf(hash, seed, indices.length())];
+}
+
+bool PerfectHash::build(const char* const* keys, int count)
+{
+  clear();
+
+  if (count == 0) {
+    return true;
+  }
+
+  int nBuckets = (count + BUCKET_SIZE - 1) / BUCKET_SIZE;
+
+  List<ulong64> hashes(count);
+  List<int>     bucketStarts(nBuckets + 1);
+  List<int>     bucketKeys(count);
+
+  Arrays::fill(bucketStarts.begin(), bucketStarts.length(), 0);
+
+  // Counting sort of keys by buckets.
+  for (int i = 0; i < count; ++i) {
+    hashes[i] = hashKey(keys[i]);
+    ++bucketStarts[bucketOf(hashes[i], nBuckets) + 1];
+  }
+  for (int i = 0; i < nBuckets; ++i) {
+    bucketStarts[i + 1] += bucketStarts[i];
+  }
+
+  List<int> bucketEnds(bucketStarts.begin(), nBuckets);
+
+  for (int i = 0; i < count; ++i) {
+    bucketKeys[bucketEnds[bucketOf(hashes[i], nBuckets)]++] = i;
+  }
+
+  // Repeated keys are dropped from their buckets, so they map to their first occurrence. Different
+  // keys with equal hashes cannot be separated by any seed.
+  List<int> bucketSizes(nBuckets);
+  int       maxBucketSize = 0;
+
+  for (int i = 0; i < nBuckets; ++i) {
+    int end = bucketStarts[i];
+
+    for (int j = bucketStarts[i]; j < bucketStarts[i + 1]; ++j) {
+      int  key      = bucketKeys[j];
+      bool isRepeat = false;
+
+      for (int k = bucketStarts[i]; k < end; ++k) {
+        if (hashes[bucketKeys[k]] == hashes[key]) {
+          if (!String::equals(keys[bucketKeys[k]], keys[key])) {
+            return false;
+          }
+
+          isRepeat = true;
+          break;
+        }
+      }
+
+      if (!isRepeat) {
+        bucketKeys[end] = key;
+        ++end;
+      }
+    }
+
+    bucketSizes[i] = end - bucketStarts[i];
+    maxBucketSize  = max(maxBucketSize, bucketSizes[i]);
+  }
+
+  seeds.resize(nBuckets, true);
+  indices.resize(count, true);
+
+  Arrays::fill(seeds.begin(), nBuckets, 0);
+  Arrays::fill(indices.begin(), count, 0);
+
+  Bitset    usedSlots(count);
+  List<int> bucketSlots(maxBucketSize);
+
+  // Larger buckets are placed first, while most slots are still free.
+  for (int size = maxBucketSize; size > 0; --size) {
+    for (int i = 0; i < nBuckets; ++i) {
+      int start = bucketStarts[i];
+
+      if (bucketSizes[i] != size) {
+        continue;
+      }
+
+      for (int seed = 1; ; ++seed) {
+        int nPlaced = 0;
+
+        for (; nPlaced < size; ++nPlaced) {
+          int slot = slotOf(hashes[bucketKeys[start + nPlaced]], seed, count);
+
+          if (usedSlots.get(slot)) {
+            break;
+          }
+
+          usedSlots.set(slot);
+          bucketSlots[nPlaced] = slot;
+        }
+
+        if (nPlaced == size) {
+          for (int j = 0; j < size; ++j) {
+            indices[bucketSlots[j]] = bucketKeys[start + j];
+          }
+
+          seeds[i] = seed;
+          break;
+        }
+
+        for (int j = 0; j < nPlaced; ++j) {
+          usedSlots.clear(bucketSlots[j]);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void PerfectHash::read(Stream* is)
+{
+  seeds.resize(is->readInt(), true);
+  indices.resize(is->readInt(), true);
+
+  for (int& seed : seeds) {
+    seed = is->readInt();
+  }
+  for (int& index : indices) {
+    index = is->readInt();
+  }
+}
+
+void PerfectHash::write(Stream* os) const
+{
+  os->writeInt(seeds.length());
+  os->writeInt(indices.length());
+
+  for (int seed : seeds) {
+    os->writeInt(seed);
+  }
+  for (int index : indices) {
+    os->writeInt(index);
+  }
+}
+
+void PerfectHash::clear()
+{
+  seeds.clear();
+  seeds.trim();
+  indices.clear();
+  indices.trim();
+}
+
+}
@@ -0,0 +1,113 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/PerfectHash.hh
+ *
+ * `PerfectHash` class.
+ */
+
+#pragma once
+
+#include "List.hh"
+#include "Stream.hh"
+
+namespace oz
+{
+
+/**
+ * Minimal perfect hash function for a fixed set of strings.
+ *
+ * It is built with the hash-and-displace algorithm. Keys are first hashed into buckets of about
+ * four keys each. Then buckets are processed from the largest down, and each one gets the first
+ * seed that puts all its keys into free slots. A lookup hashes the key once and reads two tables.
+ *
+ * Keys outside the set map to arbitrary indices, so the caller must compare the key at the returned
+ * index. Tables are plain integer arrays and can be written to a stream and read back as they are,
+ * which lets a hash built offline be used without rebuilding it.
+ */
+class PerfectHash
+{
+private:
+
+  List<int> seeds;   ///< Displacement seed for each bucket.
+  List<int> indices; ///< Key index for each slot.
+
+public:
+
+  /**
+   * Create an empty hash function.
+   */
+  PerfectHash() = default;
+
+  /**
+   * Number of keys.
+   */
+  OZ_ALWAYS_INLINE
+  int length() const
+  {
+    return indices.length();
+  }
+
+  /**
+   * True iff there are no keys.
+   */
+  OZ_ALWAYS_INLINE
+  bool isEmpty() const
+  {
+    return indices.isEmpty();
+  }
+
+  /**
+   * Index of a given key in the array the hash was built from, or -1 if the hash is empty.
+   *
+   * For a key outside the set, some valid index is returned.
+   */
+  int index(const char* key) const;
+
+  /**
+   * Build hash function for an array of keys.
+   *
+   * A repeated key maps to the index of its first occurrence and leaves an unused slot.
+   *
+   * @return False iff two different keys have equal 64-bit hashes, the hash is left empty then.
+   */
+  bool build(const char* const* keys, int count);
+
+  /**
+   * Clear existing tables and read them from a stream.
+   */
+  void read(Stream* is);
+
+  /**
+   * Write tables to a stream.
+   */
+  void write(Stream* os) const;
+
+  /**
+   * Clear tables and free allocated storage.
+   */
+  void clear();
+
+};
+
+}
@@ -0,0 +1,182 @@
+/*
+ * ozCore - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file ozCore/SPSCQueue.hh
+ *
+ * `SPSCQueue` class template.
+ */
+
+#pragma once
+
+#include "common.hh"
+
+namespace oz
+{
+
+/**
+ * Bounded lock-free single-producer single-consumer queue.
+ *
+ * Elements are stored in a static ring buffer, so `push()` fails when the queue is full instead of
+ * allocating. Exactly one thread may push and exactly one (possibly other) thread may pop at a time.
+ * Producer and consumer indices lie on separate cache lines and each side keeps a cached copy of
+ * the other side's index, so they only touch the shared line when the cached copy runs out.
+ *
+ * @sa `oz::MPSCQueue`, `oz::Event`
+ */
+template <typename Elem, int SIZE>
+class SPSCQueue
+{
+  static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "oz::SPSCQueue size must be a power of two");
+
+private:
+
+  static const int CACHE_LINE = 64; ///< Padding between producer and consumer state.
+
+  uint head       = 0;                               ///< Next slot to pop (consumer).
+  uint cachedTail = 0;                               ///< Consumer's copy of `tail`.
+  char headPad[CACHE_LINE - 2 * sizeof(uint)];
+  uint tail       = 0;                               ///< Next slot to push (producer).
+  uint cachedHead = 0;                               ///< Producer's copy of `head`.
+  char tailPad[CACHE_LINE - 2 * sizeof(uint)];
+  Elem data[SIZE];                                   ///< Ring buffer.
+
+  /**
+   * Reserve a slot at the tail, return nullptr if full.
+   */
+  OZ_ALWAYS_INLINE
+  Elem* reserve()
+  {
+    uint t = tail;
+
+    if (t - cachedHead == uint(SIZE)) {
+      cachedHead = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+
+      if (t - cachedHead == uint(SIZE)) {
+        return nullptr;
+      }
+    }
+    return &data[t & (SIZE - 1)];
+  }
+
+public:
+
+  /**
+   * Create an empty queue.
+   */
+  SPSCQueue() = default;
+
+  /**
+   * Copying or moving is not possible.
+   */
+  SPSCQueue(const SPSCQueue&) = delete;
+
+  /**
+   * Copying or moving is not possible.
+   */
+  SPSCQueue& operator = (const SPSCQueue&) = delete;
+
+  /**
+   * Capacity.
+   */
+  static constexpr int capacity()
+  {
+    return SIZE;
+  }
+
+  /**
+   * Number of elements, exact only when called from producer or consumer while the other is idle.
+   */
+  int length() const
+  {
+    return int(__atomic_load_n(&tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&head, __ATOMIC_ACQUIRE));
+  }
+
+  /**
+   * True iff empty, approximate in the same way as `length()`.
+   */
+  bool isEmpty() const
+  {
+    return length() == 0;
+  }
+
+  /**
+   * Copy an element to the tail (producer only).
+   *
+   * @return False iff the queue is full.
+   */
+  bool push(const Elem& elem)
+  {
+    Elem* slot = reserve();
+
+    if (slot == nullptr) {
+      return false;
+    }
+
+    *slot = elem;
+    __atomic_store_n(&tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  /**
+   * Move an element to the tail (producer only).
+   *
+   * @return False iff the queue is full.
+   */
+  bool push(Elem&& elem)
+  {
+    Elem* slot = reserve();
+
+    if (slot == nullptr) {
+      return false;
+    }
+
+    *slot = static_cast<Elem&&>(elem);
+    __atomic_store_n(&tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  /**
+   * Move the head element into `elem` (consumer only).
+   *
+   * @return False iff the queue is empty.
+   */
+  bool pop(Elem* elem)
+  {
+    uint h = head;
+
+    if (h == cachedTail) {
+      cachedTail = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+
+      if (h == cachedTail) {
+        return false;
+      }
+    }
+
+    *elem = static_cast<Elem&&>(data[h & (SIZE - 1)]);
+    __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+};
+
+}
@@ -37,10 +37,12 @@
 #if defined(__ANDROID__)
 # include <jni.h>
 # include <pthread.h>
+# include <unistd.h>
 #elif defined(_WIN32)
 # include <windows.h>
 #else
 # include <pthread.h>
+# include <unistd.h>
 #endif
 
 namespace oz
@@ -140,6 +142,19 @@ bool Thread::isMain()
 #endif
 }
 
+int Thread::nCores()
+{
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+
+  int nCores = int(info.dwNumberOfProcessors);
+#else
+  int nCores = int(sysconf(_SC_NPROCESSORS_ONLN));
+#endif
+  return nCores < 1 ? 1 : nCores;
+}
+
 Thread::Thread(const char* name, Main* main, void* data)
 {
   if (descriptor != nullptr) {
@@ -69,6 +69,11 @@ public:
    */
   static bool isMain();
 
+  /**
+   * Number of online CPU cores (at least 1).
+   */
+  static int nCores();
+
   /**
    * Create an empty instance, no thread is started.
    */
@@ -44,8 +44,13 @@
 #include "SpinLock.hh"
 #include "Mutex.hh"
 #include "Semaphore.hh"
+#include "Event.hh"
+#include "Latch.hh"
 #include "CallOnce.hh"
 #include "Thread.hh"
+#include "Jobs.hh"
+#include "SPSCQueue.hh"
+#include "MPSCQueue.hh"
 #include "StackTrace.hh"
 
 /*
@@ -64,17 +69,22 @@
  */
 #include "Alloc.hh"
 #include "Pool.hh"
+#include "Arena.hh"
 
 /*
  * Containers.
  */
 #include "List.hh"
+#include "ArenaList.hh"
 #include "SList.hh"
 #include "Heap.hh"
 #include "Set.hh"
 #include "Map.hh"
 #include "HashSet.hh"
 #include "HashMap.hh"
+#include "FlatHashSet.hh"
+#include "FlatHashMap.hh"
+#include "PerfectHash.hh"
 
 /*
  * Bit arrays.
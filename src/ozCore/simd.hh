@@ -33,6 +33,8 @@
 #ifdef OZ_SIMD
 # if defined(__ARM_NEON__)
 #  include <arm_neon.h>
+# elif defined(__SSE2__)
+#  include <emmintrin.h>
 # elif defined(__SSE__)
 #  include <xmmintrin.h>
 # endif
@@ -183,6 +185,34 @@ inline float4 vDot(float4 a, float4 b)
   return p;
 }
 
+/**
+ * Truncate float vector components to integers and store them into four bytes with signed
+ * saturation.
+ */
+OZ_ALWAYS_INLINE
+inline void vStoreBytes(float4 a, byte* dest)
+{
+#if defined(__ARM_NEON__)
+  int16x4_t shorts = vqmovn_s32(vcvtq_s32_f32(a));
+  int8x8_t  bytes  = vqmovn_s16(vcombine_s16(shorts, shorts));
+
+  vst1_lane_u32(reinterpret_cast<uint*>(dest), vreinterpret_u32_s8(bytes), 0);
+#elif defined(__SSE2__)
+  __m128i ints   = _mm_cvttps_epi32(a);
+  __m128i shorts = _mm_packs_epi32(ints, ints);
+  int     bytes  = _mm_cvtsi128_si32(_mm_packs_epi16(shorts, shorts));
+
+  __builtin_memcpy(dest, &bytes, sizeof(bytes));
+#else
+  float4 c = vMin(vMax(a, vFill(-128.0f)), vFill(127.0f));
+
+  dest[0] = byte(c[0]);
+  dest[1] = byte(c[1]);
+  dest[2] = byte(c[2]);
+  dest[3] = byte(c[3]);
+#endif
+}
+
 #endif // OZ_SIMD
 
 /**
@@ -31,7 +31,27 @@
 namespace oz
 {
 
-int Lua::randomSeed = 0;
+// Instructions between two count hook invocations.
+static const int HOOK_INTERVAL = 100;
+
+// Instruction counter of the innermost accounted call on the current thread.
+static thread_local int* callInstructions = nullptr;
+
+static void countHook(lua_State* l, lua_Debug*)
+{
+  if (callInstructions != nullptr) {
+    *callInstructions += HOOK_INTERVAL;
+
+    if (Lua::abortOverruns && Lua::callBudget != 0 && *callInstructions > Lua::callBudget) {
+      luaL_error(l, "Instruction budget (%d) exceeded", Lua::callBudget);
+    }
+  }
+}
+
+int  Lua::randomSeed    = 0;
+bool Lua::profileCalls  = false;
+int  Lua::callBudget    = 0;
+bool Lua::abortOverruns = false;
 
 void Lua::readValue(lua_State* l, Stream* is)
 {
@@ -281,8 +301,75 @@ void Lua::loadDir(const File& dir) const
   }
 }
 
-void Lua::init()
+int Lua::functionRef(const char* name) const
+{
+  if (String::isEmpty(name)) {
+    return -1;
+  }
+
+  lua_getglobal(l, name);
+
+  if (lua_type(l, -1) != LUA_TFUNCTION) {
+    lua_pop(l, 1);
+    return -1;
+  }
+  return luaL_ref(l, LUA_REGISTRYINDEX);
+}
+
+void Lua::releaseRef(int ref) const
+{
+  if (ref >= 0) {
+    luaL_unref(l, LUA_REGISTRYINDEX, ref);
+  }
+}
+
+int Lua::pcall(int nArgs, int nResults, const char* funcName, const char* context)
+{
+  if (!profileCalls && callBudget == 0) {
+    return lua_pcall(l, nArgs, nResults, 0);
+  }
+
+  int* outerInstructions = callInstructions;
+  int  instructions      = 0;
+  uint beginMicros       = Time::uclock();
+
+  callInstructions = &instructions;
+  int result = lua_pcall(l, nArgs, nResults, 0);
+  callInstructions = outerInstructions;
+
+  uint micros    = Time::uclock() - beginMicros;
+  bool isOverrun = callBudget != 0 && instructions > callBudget;
+
+  if (!profileCalls && !isOverrun) {
+    return result;
+  }
+
+  String key   = context == nullptr ? String(funcName) : String::format("%s (%s)", funcName, context);
+  Usage* usage = usages.find(key);
+
+  if (usage == nullptr) {
+    usage = &usages.add(key, Usage{ 0, 0, 0, 0 }).value;
+  }
+
+  usage->micros       += micros;
+  usage->instructions += ulong64(instructions);
+  usage->calls        += 1;
+
+  if (isOverrun) {
+    // Only report the first overrun of each function to avoid flooding the log every tick.
+    if (usage->overruns == 0) {
+      Log::println("Lua[%s] %s exceeded instruction budget: %d > %d%s", envName, key.c(),
+                   instructions, callBudget, abortOverruns ? ", aborted" : "");
+    }
+    ++usage->overruns;
+  }
+  return result;
+}
+
+void Lua::init(const char* envName_)
 {
+  envName = envName_;
+
   l = luaL_newstate();
   if (l == nullptr) {
     OZ_ERROR("oz::Lua: Failed to create Lua state");
@@ -297,6 +384,13 @@ void Lua::init()
   lua_pcall(l, 0, 0, 0);
   lua_pushcfunction(l, luaopen_math);
   lua_pcall(l, 0, 0, 0);
+# ifdef LUAJIT_VERSION
+  // JIT compiler is only turned on when `jit` library is opened.
+  lua_pushcfunction(l, luaopen_bit);
+  lua_pcall(l, 0, 0, 0);
+  lua_pushcfunction(l, luaopen_jit);
+  lua_pcall(l, 0, 0, 0);
+# endif
 #else
   luaL_requiref(l, "",              luaopen_base,   true);
   luaL_requiref(l, LUA_TABLIBNAME,  luaopen_table,  true);
@@ -310,10 +404,35 @@ void Lua::init()
   if (lua_gettop(l) != 0) {
     OZ_ERROR("oz::Lua: Failed to initialise Lua libraries");
   }
+
+  if (profileCalls || callBudget != 0) {
+    lua_sethook(l, countHook, LUA_MASKCOUNT, HOOK_INTERVAL);
+  }
 }
 
 void Lua::destroy()
 {
+  if (!usages.isEmpty()) {
+    Log::println("Lua[%s] script statistics {", envName);
+    Log::indent();
+
+    for (const auto& i : usages) {
+      const Usage& usage = i.value;
+
+      Log::println("%.6f s %10llu instr %8d calls %6d overruns  %s",
+                   double(usage.micros) / 1e6, usage.instructions, usage.calls, usage.overruns,
+                   i.key.c());
+
+      Profiler::add(String::format("Lua[%s] %s", envName, i.key.c()), uint(usage.micros));
+    }
+
+    Log::unindent();
+    Log::println("}");
+
+    usages.clear();
+    usages.trim();
+  }
+
   lua_close(l);
   l = nullptr;
 }
@@ -53,11 +53,30 @@ public:
 
 public:
 
-  static int randomSeed; ///< Random seed for Lua environments.
+  static int  randomSeed;    ///< Random seed for Lua environments.
+  static bool profileCalls;  ///< Account time and instructions spent in each script function.
+  static int  callBudget;    ///< Instruction budget for a single script call, 0 for unlimited.
+  static bool abortOverruns; ///< Abort script calls that exceed `callBudget`.
+
+private:
+
+  /**
+   * Accumulated resource usage of a script function.
+   */
+  struct Usage
+  {
+    ulong64 micros;       ///< Time spent in the function.
+    ulong64 instructions; ///< Approximate number of executed VM instructions.
+    int     calls;        ///< Number of calls.
+    int     overruns;     ///< Number of calls that exceeded `callBudget`.
+  };
+
+  HashMap<String, Usage> usages; ///< Usage statistics per function (and context).
 
 protected:
 
-  lua_State* l = nullptr; ///< Lua state descriptor.
+  lua_State*  l       = nullptr; ///< Lua state descriptor.
+  const char* envName = "?";     ///< Environment name used in reports.
 
 public:
 
@@ -86,10 +105,35 @@ public:
    */
   void loadDir(const File& dir) const;
 
+  /**
+   * Create a registry reference to a global function.
+   *
+   * A referenced function can be pushed on the stack with `lua_rawgeti(l, LUA_REGISTRYINDEX, ref)`
+   * without looking up its name in the global table on each call. -1 is returned if the name is
+   * empty or there is no global function with that name.
+   */
+  int functionRef(const char* name) const;
+
+  /**
+   * Release a reference obtained from `functionRef()`. Negative references are ignored.
+   */
+  void releaseRef(int ref) const;
+
+  /**
+   * Call a function on the stack like `lua_pcall()` and account its time and instructions.
+   *
+   * `funcName` and optional `context` (e.g. object class name) identify the call in statistics and
+   * budget overrun reports. Accounting is only performed if `profileCalls` is on or `callBudget` is
+   * set. Instructions are counted from a count hook, so with LuaJIT only interpreted code is covered.
+   */
+  int pcall(int nArgs, int nResults, const char* funcName, const char* context = nullptr);
+
   /**
    * Common initialisation for Lua classes.
+   *
+   * `envName` is used to identify the environment in usage statistics.
    */
-  void init();
+  void init(const char* envName);
 
   /**
    * Common clean-up for Lua classes.
@@ -0,0 +1,90 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tests/alloc.cc
+ *
+ * Benchmark of overloaded `new`/`delete` operators: mixed small and large allocations with a
+ * sliding window of live blocks, for increasing numbers of threads.
+ */
+
+#include <ozCore/ozCore.hh>
+
+#include <cstdio>
+
+using namespace oz;
+
+static const int N_OPERATIONS = 1 << 21;
+static const int WINDOW       = 256;
+
+static void allocMain(void* data)
+{
+  int    nOperations = *static_cast<int*>(data);
+  char*  live[WINDOW] = {};
+  uint   seed         = 42;
+
+  for (int i = 0; i < nOperations; ++i) {
+    seed = seed * 1103515245u + 12345u;
+
+    int  slot = int(seed >> 8) % WINDOW;
+    uint size = (seed >> 16) % 16 == 0 ? 4096 + (seed >> 20) % 8192 : 1 + (seed >> 20) % 256;
+
+    delete[] live[slot];
+    live[slot]    = new char[size];
+    live[slot][0] = char(i);
+  }
+
+  for (char* block : live) {
+    delete[] block;
+  }
+}
+
+int main()
+{
+  System::init();
+
+  int nCores = Thread::nCores();
+
+  printf("%d cores, %d operations per run\n\n", nCores, N_OPERATIONS);
+  printf("%-8s %12s %12s\n", "threads", "time [ms]", "ns/op");
+
+  for (int nThreads = 1; nThreads <= max(nCores, 4); nThreads *= 2) {
+    List<Thread> threads(nThreads);
+    int          nOperations = N_OPERATIONS / nThreads;
+    long64       beginTime   = Time::uclock();
+
+    for (Thread& thread : threads) {
+      thread = Thread("alloc", allocMain, &nOperations);
+    }
+    for (Thread& thread : threads) {
+      thread.join();
+    }
+
+    long64 time = Time::uclock() - beginTime;
+
+    printf("%-8d %12.2f %12.2f\n", nThreads, float(time) / 1000.0f,
+           float(time) * 1000.0f / float(N_OPERATIONS));
+  }
+
+  printf("\n");
+
+  Log::printMemorySummary();
+  Log::printMemoryLeaks();
+  return 0;
+}
@@ -19,12 +19,19 @@
 
 /**
  * @file tests/containers.cc
+ *
+ * Benchmark of chaining `HashMap` against open-addressing `FlatHashMap` on int and String keys.
  */
 
 #include <ozCore/ozCore.hh>
 
+#include <cstdio>
+
 using namespace oz;
 
+static const int N_KEYS   = 200000;
+static const int N_ROUNDS = 10;
+
 struct Foo
 {
   int number;
@@ -93,8 +100,122 @@ inline Type operator | (const Json& json, const Type& defaultValue)
   return json.get(defaultValue);
 }
 
+template <class Table, typename Key>
+static void benchmark(const char* title, const List<Key>& keys, const List<Key>& misses)
+{
+  // Look keys up in a different order than they were inserted, so neither table can benefit from
+  // elements being allocated in the lookup order.
+  List<Key> hits = keys;
+
+  for (int i = hits.length() - 1; i > 0; --i) {
+    swap(hits[i], hits[Math::rand(i + 1)]);
+  }
+
+  uint insertTime  = 0;
+  uint hitTime     = 0;
+  uint missTime    = 0;
+  uint iterateTime = 0;
+  uint excludeTime = 0;
+  long sum         = 0;
+
+  for (int round = 0; round < N_ROUNDS; ++round) {
+    Table table;
+
+    uint t0 = Time::uclock();
+
+    for (int i = 0; i < keys.length(); ++i) {
+      table.add(keys[i], i);
+    }
+
+    uint t1 = Time::uclock();
+
+    for (int i = 0; i < hits.length(); ++i) {
+      sum += *table.find(hits[i]);
+    }
+
+    uint t2 = Time::uclock();
+
+    for (int i = 0; i < misses.length(); ++i) {
+      sum += table.find(misses[i]) == nullptr;
+    }
+
+    uint t3 = Time::uclock();
+
+    for (const auto& pair : table) {
+      sum += pair.value;
+    }
+
+    uint t4 = Time::uclock();
+
+    for (int i = 0; i < keys.length(); i += 2) {
+      table.exclude(keys[i]);
+    }
+
+    uint t5 = Time::uclock();
+
+    if (table.length() != keys.length() / 2) {
+      OZ_ERROR("%s: %d elements left, expected %d", title, table.length(), keys.length() / 2);
+    }
+
+    insertTime  += t1 - t0;
+    hitTime     += t2 - t1;
+    missTime    += t3 - t2;
+    iterateTime += t4 - t3;
+    excludeTime += t5 - t4;
+  }
+
+  printf("%-24s %8.2f %8.2f %8.2f %8.2f %8.2f  (%ld)\n", title,
+         float(insertTime) / 1000.0f / N_ROUNDS, float(hitTime) / 1000.0f / N_ROUNDS,
+         float(missTime) / 1000.0f / N_ROUNDS, float(iterateTime) / 1000.0f / N_ROUNDS,
+         float(excludeTime) / 1000.0f / N_ROUNDS, sum);
+}
+
 int main()
 {
   System::init();
+
+  List<int>    seqKeys;
+  List<int>    seqMisses;
+  List<int>    randKeys;
+  List<int>    randMisses;
+  List<String> strKeys;
+  List<String> strMisses;
+
+  Math::seed(42);
+
+  for (int i = 0; i < N_KEYS; ++i) {
+    seqKeys.add(i);
+    seqMisses.add(N_KEYS + i);
+
+    // Unique object indices as generated by Orbis, slot in low bits and generation above them.
+    randKeys.add((Math::rand(1 << 13) << 3 | i >> 15) << 15 | (i & 0x7fff));
+    randMisses.add(-1 - i);
+
+    strKeys.add(String::format("key_%d", i));
+    strMisses.add(String::format("miss_%d", i));
+  }
+
+  // Insert keys in a random order, so the chaining table does not walk its buckets sequentially.
+  for (int i = N_KEYS - 1; i > 0; --i) {
+    int j = Math::rand(i + 1);
+
+    swap(seqKeys[i], seqKeys[j]);
+    swap(seqMisses[i], seqMisses[j]);
+    swap(randKeys[i], randKeys[j]);
+    swap(randMisses[i], randMisses[j]);
+    swap(strKeys[i], strKeys[j]);
+    swap(strMisses[i], strMisses[j]);
+  }
+
+  printf("%d keys, average of %d rounds [ms]\n", N_KEYS, N_ROUNDS);
+  printf("%-24s %8s %8s %8s %8s %8s\n", "", "insert", "hit", "miss", "iterate", "exclude");
+
+  benchmark<HashMap<int, int>>("HashMap<int> seq", seqKeys, seqMisses);
+  benchmark<FlatHashMap<int, int>>("FlatHashMap<int> seq", seqKeys, seqMisses);
+  benchmark<HashMap<int, int>>("HashMap<int> index", randKeys, randMisses);
+  benchmark<FlatHashMap<int, int>>("FlatHashMap<int> index", randKeys, randMisses);
+  benchmark<HashMap<String, int>>("HashMap<String>", strKeys, strMisses);
+  benchmark<FlatHashMap<String, int>>("FlatHashMap<String>", strKeys, strMisses);
+
   return 0;
 }
@@ -0,0 +1,209 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file tests/culling.cc
+ *
+ * Headless frustum culling test.
+ *
+ * Populates orbis with random objects and fragments, checks that `Frustum::isVisible8()` agrees
+ * with the scalar test and that `Culler` returns the same entities as a serial reference for
+ * different numbers of threads. Average culling times are printed.
+ */
+
+#include <matrix/Synapse.hh>
+#include <client/Culler.hh>
+#include <client/FragPool.hh>
+
+#include <cstdio>
+
+using namespace oz;
+using namespace oz::client;
+
+static const int N_OBJECTS = 20000;
+static const int N_FRAGS   = 4000;
+static const int N_VIEWS   = 64;
+static const int N_ROUNDS  = 50;
+
+static List<const Object*> refObjects;
+static List<const Frag*>   refFrags;
+
+static float randRange(float a, float b)
+{
+  return a + (b - a) * Math::rand();
+}
+
+static void cullReference(const Frustum& frustum, const Span& span, const Point& eye,
+                          const Vec3& at, float mag)
+{
+  refObjects.clear();
+  refFrags.clear();
+
+  for (int i = span.minX; i <= span.maxX; ++i) {
+    for (int j = span.minY; j <= span.maxY; ++j) {
+      float x = float((i - Orbis::CELLS / 2) * Cell::SIZE + Cell::SIZE / 2);
+      float y = float((j - Orbis::CELLS / 2) * Cell::SIZE + Cell::SIZE / 2);
+
+      if (!frustum.isVisible(x, y, Culler::CELL_RADIUS)) {
+        continue;
+      }
+
+      const Cell& cell = orbis.cells[i][j];
+
+      for (const Object* obj = cell.objects.first(); obj != nullptr; obj = obj->next[0]) {
+        float radius = obj->dim.fastN();
+
+        if (obj->flags & Object::WIDE_CULL_BIT) {
+          radius *= Culler::WIDE_CULL_FACTOR;
+        }
+
+        float distance = (obj->p - eye).fastN();
+
+        if (frustum.isVisible(obj->p, radius) &&
+            radius / (distance * mag) >= Culler::OBJECT_VISIBILITY_COEF)
+        {
+          refObjects.add(obj);
+        }
+      }
+
+      for (const Frag& frag : cell.frags) {
+        float dist = (frag.p - eye) * at;
+
+        if (dist <= Culler::FRAG_VISIBILITY_RANGE2 &&
+            frustum.isVisible(frag.p, client::FragPool::FRAG_RADIUS))
+        {
+          refFrags.add(&frag);
+        }
+      }
+    }
+  }
+}
+
+template <typename Elem>
+static bool equals(List<const Elem*>& a, List<const Elem*>& b)
+{
+  Arrays::sort(a.begin(), a.length());
+  Arrays::sort(b.begin(), b.length());
+
+  return a == b;
+}
+
+static bool checkSimd(const Frustum& frustum)
+{
+  float x[8], y[8], z[8], radius[8];
+
+  for (int i = 0; i < 1000; ++i) {
+    for (int j = 0; j < 8; ++j) {
+      x[j]      = randRange(-Orbis::DIM, Orbis::DIM);
+      y[j]      = randRange(-Orbis::DIM, Orbis::DIM);
+      z[j]      = randRange(-100.0f, 100.0f);
+      radius[j] = randRange(0.0f, 20.0f);
+    }
+
+    int mask = frustum.isVisible8(x, y, z, radius);
+
+    for (int j = 0; j < 8; ++j) {
+      if (bool(mask & 1 << j) != frustum.isVisible(Point(x[j], y[j], z[j]), radius[j])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main()
+{
+  System::init();
+  Math::seed(42);
+
+  orbis.init();
+
+  ObjectClass* clazz = ObjectClass::createClass();
+  clazz->init({ Json::Pair { "dim", Vec3(0.5f, 0.5f, 1.0f) }, { "life", 100.0f } }, "box");
+
+  oz::FragPool pool(Json(), "frag", 0);
+
+  for (int i = 0; i < N_OBJECTS; ++i) {
+    Point p(randRange(-Orbis::DIM, Orbis::DIM), randRange(-Orbis::DIM, Orbis::DIM),
+            randRange(-50.0f, 150.0f));
+    synapse.add(clazz, p, NORTH, true);
+  }
+  for (int i = 0; i < N_FRAGS; ++i) {
+    Point p(randRange(-Orbis::DIM, Orbis::DIM), randRange(-Orbis::DIM, Orbis::DIM),
+            randRange(-50.0f, 150.0f));
+    synapse.add(&pool, p, Vec3::ZERO);
+  }
+
+  Frustum frustum;
+  Span    spans[N_VIEWS];
+  Point   eyes[N_VIEWS];
+  Mat4    rots[N_VIEWS];
+
+  for (int i = 0; i < N_VIEWS; ++i) {
+    eyes[i] = Point(randRange(-Orbis::DIM, Orbis::DIM), randRange(-Orbis::DIM, Orbis::DIM),
+                    randRange(0.0f, 100.0f));
+    rots[i] = Mat4::rotationZXZ(randRange(0.0f, Math::TAU), randRange(0.0f, Math::TAU / 2.0f),
+                                0.0f);
+  }
+
+  bool isOK = true;
+
+  for (int nThreads = 1; nThreads <= Culler::MAX_THREADS; nThreads *= 2) {
+    Culler culler;
+    culler.init(nThreads);
+
+    long64 time = 0;
+
+    for (int i = 0; i < N_VIEWS; ++i) {
+      Vec3 at = Vec3(-rots[i].z);
+
+      frustum.set(eyes[i], rots[i], 1.0f, 0.75f, 400.0f);
+      frustum.getExtrems(spans[i], eyes[i]);
+
+      if (nThreads == 1 && !checkSimd(frustum)) {
+        Log::println("isVisible8() does not match isVisible()");
+        isOK = false;
+      }
+
+      long64 t0 = Time::uclock();
+
+      for (int j = 0; j < N_ROUNDS; ++j) {
+        culler.cull(frustum, spans[i], eyes[i], at, 1.0f);
+      }
+
+      time += Time::uclock() - t0;
+
+      cullReference(frustum, spans[i], eyes[i], at, 1.0f);
+
+      if (!equals(culler.objects, refObjects) || !equals(culler.frags, refFrags)) {
+        Log::println("View %d: culled entities differ from reference", i);
+        isOK = false;
+      }
+    }
+
+    Log::println("%d thread(s): %.2f µs per cull", nThreads,
+                 double(time) / double(N_VIEWS * N_ROUNDS));
+
+    culler.destroy();
+  }
+
+  Log::println(isOK ? "Culling test PASSED" : "Culling test FAILED");
+  return isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,125 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tests/jobs.cc
+ *
+ * Scaling benchmark of `Jobs`: `parallelFor()` over a compute-bound loop and fork/join overhead of
+ * fine-grained recursive jobs, for increasing numbers of worker threads.
+ */
+
+#include <ozCore/ozCore.hh>
+
+#include <cstdio>
+
+using namespace oz;
+
+static const int N_ELEMENTS = 1 << 20;
+static const int N_ROUNDS   = 5;
+static const int FIB_N      = 25;
+
+static float* values = nullptr;
+
+static void transform(int begin, int end)
+{
+  for (int i = begin; i < end; ++i) {
+    float x = float(i);
+
+    for (int j = 0; j < 32; ++j) {
+      x = Math::sqrt(x * x + 1.0f) * 0.999f;
+    }
+    values[i] = x;
+  }
+}
+
+struct Fibonacci
+{
+  int n;
+  int result;
+};
+
+static void fibonacciMain(void* data)
+{
+  Fibonacci* fib = static_cast<Fibonacci*>(data);
+
+  if (fib->n < 2) {
+    fib->result = fib->n;
+    return;
+  }
+
+  Fibonacci   a = { fib->n - 1, 0 };
+  Fibonacci   b = { fib->n - 2, 0 };
+  Jobs::Group group;
+
+  Jobs::run(&group, fibonacciMain, &a);
+  fibonacciMain(&b);
+  Jobs::wait(&group);
+
+  fib->result = a.result + b.result;
+}
+
+int main()
+{
+  System::init();
+
+  int nCores = Thread::nCores();
+
+  values = new float[N_ELEMENTS];
+
+  printf("%d cores, average of %d rounds [us]\n\n", nCores, N_ROUNDS);
+  printf("%-8s %12s %12s %12s\n", "threads", "serial", "parallelFor", "fork/join");
+
+  long64 t0 = Time::uclock();
+  for (int i = 0; i < N_ROUNDS; ++i) {
+    transform(0, N_ELEMENTS);
+  }
+  long64 serialTime = (Time::uclock() - t0) / N_ROUNDS;
+
+  for (int nThreads = 1; nThreads <= max(nCores, 4); nThreads *= 2) {
+    Jobs::init(nThreads - 1);
+
+    long64 t1 = Time::uclock();
+    for (int i = 0; i < N_ROUNDS; ++i) {
+      Jobs::parallelFor(0, N_ELEMENTS, 1024, [](int begin, int end)
+      {
+        transform(begin, end);
+      });
+    }
+    long64 t2 = Time::uclock();
+    for (int i = 0; i < N_ROUNDS; ++i) {
+      Fibonacci fib = { FIB_N, 0 };
+      fibonacciMain(&fib);
+
+      if (fib.result != 75025) {
+        OZ_ERROR("Wrong result %d", fib.result);
+      }
+    }
+    long64 t3 = Time::uclock();
+
+    Jobs::destroy();
+
+    printf("%-8d %12d %12d %12d\n", nThreads, int(serialTime), int((t2 - t1) / N_ROUNDS),
+           int((t3 - t2) / N_ROUNDS));
+  }
+
+  delete[] values;
+
+  Log::printMemoryLeaks();
+  return 0;
+}
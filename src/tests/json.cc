@@ -0,0 +1,166 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file tests/json.cc
+ *
+ * Benchmark of `Json` parsing, formatting and binary serialisation throughput and of key lookups in
+ * large objects.
+ */
+
+#include <ozCore/ozCore.hh>
+
+#include <cstdio>
+
+using namespace oz;
+
+static const int  N_OBJECTS   = 20000;
+static const int  N_KEYS      = 2000;
+static const int  N_ROUNDS    = 10;
+static const char FILE_NAME[] = "json-benchmark.json";
+
+static Json generate()
+{
+  Json root(Json::OBJECT);
+  Json& objects = root.add("objects", Json::ARRAY);
+
+  Math::seed(42);
+
+  for (int i = 0; i < N_OBJECTS; ++i) {
+    Json& object = objects.add(Json::OBJECT);
+
+    object.add("name",     String::format("object%d", i));
+    object.add("title",    String::format("Object \"%d\"\twith escapes", i));
+    object.add("id",       i);
+    object.add("life",     Math::rand() * 1000.0f);
+    object.add("mass",     Math::rand() * 100.0f);
+    object.add("dim",      Vec3(Math::rand(), Math::rand(), Math::rand()));
+    object.add("rot",      Quat(0.0f, 0.0f, 0.0f, 1.0f));
+    object.add("flags",    Json{ "solid", "cylinder", "climber" });
+    object.add("enabled",  Math::rand(2) == 0);
+    object.add("parent",   nullptr);
+  }
+
+  Json& table = root.add("table", Json::OBJECT);
+
+  for (int i = 0; i < N_KEYS; ++i) {
+    table.add(String::format("key%d", i), i);
+  }
+  return root;
+}
+
+static void report(const char* name, long64 time, int size)
+{
+  printf("%-18s %8.2f ms %8.1f MiB/s\n", name, float(time) / 1000.0f,
+         float(size) / float(time) * 1e6f / float(1024 * 1024));
+}
+
+int main()
+{
+  System::init();
+
+  Json   source = generate();
+  String text   = source.toFormattedString();
+  File   file   = FILE_NAME;
+
+  if (!file.write(text, text.length())) {
+    OZ_ERROR("Failed to write '%s'", FILE_NAME);
+  }
+
+  printf("%d B formatted, average of %d rounds\n\n", text.length(), N_ROUNDS);
+
+  long64 parseTime  = 0;
+  long64 formatTime = 0;
+  long64 writeTime  = 0;
+  long64 readTime   = 0;
+  long64 lookupTime = 0;
+  int    binarySize = 0;
+  int    nFound     = 0;
+
+  for (int i = 0; i < N_ROUNDS; ++i) {
+    Json json;
+
+    long64 t0 = Time::uclock();
+    json.load(file);
+    long64 t1 = Time::uclock();
+    String formatted = json.toFormattedString();
+    long64 t2 = Time::uclock();
+
+    if (formatted != text) {
+      OZ_ERROR("Formatted text differs from the source");
+    }
+
+    Stream os(0);
+
+    long64 t3 = Time::uclock();
+    json.write(&os);
+    long64 t4 = Time::uclock();
+
+    Stream is(os.begin(), os.begin() + os.tell());
+    Json   copy;
+
+    long64 t5 = Time::uclock();
+    copy.read(&is);
+    long64 t6 = Time::uclock();
+
+    if (copy != json) {
+      OZ_ERROR("Binary copy differs from the source");
+    }
+
+    const Json& table = json["table"];
+
+    long64 t7 = Time::uclock();
+    for (int j = 0; j < N_KEYS; ++j) {
+      char key[16];
+      snprintf(key, sizeof(key), "key%d", j);
+
+      nFound += table[key].get(-1.0) == j;
+    }
+    long64 t8 = Time::uclock();
+
+    parseTime  += t1 - t0;
+    formatTime += t2 - t1;
+    writeTime  += t4 - t3;
+    readTime   += t6 - t5;
+    lookupTime += t8 - t7;
+    binarySize  = os.tell();
+
+    json.clear(false);
+    copy.clear(false);
+  }
+
+  file.remove();
+
+  if (nFound != N_KEYS * N_ROUNDS) {
+    OZ_ERROR("Lookup failed for %d keys", N_KEYS * N_ROUNDS - nFound);
+  }
+
+  report("parse",        parseTime / N_ROUNDS,  text.length());
+  report("format",       formatTime / N_ROUNDS, text.length());
+  report("binary write", writeTime / N_ROUNDS,  binarySize);
+  report("binary read",  readTime / N_ROUNDS,   binarySize);
+  printf("%-18s %8.2f us / %d keys\n", "lookup", float(lookupTime / N_ROUNDS), N_KEYS);
+
+  source.clear(false);
+  text = "";
+  file = "";
+
+  Log::printMemoryLeaks();
+  return 0;
+}
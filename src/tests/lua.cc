@@ -0,0 +1,224 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file tests/lua.cc
+ *
+ * Microbenchmark for calling Lua handlers from C++ and Lua API functions from scripts.
+ */
+
+#include <ozCore/ozCore.hh>
+#include <ozEngine/ozEngine.hh>
+
+#include <lua.hpp>
+
+#include <cstdio>
+
+#if LUA_VERSION_NUM < 502
+# define lua_rawlen lua_objlen
+#endif
+
+using namespace oz;
+
+static const int N_CALLS   = 1000000;
+static const int N_OBJECTS = 256;
+static const int N_QUERIES = 2000;
+
+static const char SCRIPT[] =
+  "ozLocalData = {}\n"
+  "for i = 0, 255 do ozLocalData[i] = { counter = 0 } end\n"
+  "function onUpdate(localData) localData.counter = localData.counter + 1 return true end\n"
+  "function queryEach(indices)\n"
+  "  local sum = 0\n"
+  "  for i = 1, #indices do\n"
+  "    local x, y, z = benchGetPos(indices[i])\n"
+  "    local life = benchGetLife(indices[i])\n"
+  "    local flags = benchGetFlags(indices[i])\n"
+  "    sum = sum + x + y + z + life + flags\n"
+  "  end\n"
+  "  return sum\n"
+  "end\n"
+  "local result = {}\n"
+  "function queryBatched(indices)\n"
+  "  local sum = 0\n"
+  "  benchQuery(indices, result)\n"
+  "  for i = 1, 5 * #indices, 5 do\n"
+  "    sum = sum + result[i] + result[i + 1] + result[i + 2] + result[i + 3] + result[i + 4]\n"
+  "  end\n"
+  "  return sum\n"
+  "end\n"
+  "indices = {}\n"
+  "for i = 1, 256 do indices[i] = i - 1 end\n";
+
+struct BenchObject
+{
+  Point p;
+  float life;
+  int   flags;
+};
+
+static BenchObject objects[N_OBJECTS];
+
+static int benchGetPos(lua_State* l)
+{
+  const BenchObject& obj = objects[lua_tointeger(l, 1)];
+
+  lua_pushnumber(l, obj.p.x);
+  lua_pushnumber(l, obj.p.y);
+  lua_pushnumber(l, obj.p.z);
+  return 3;
+}
+
+static int benchGetLife(lua_State* l)
+{
+  lua_pushnumber(l, objects[lua_tointeger(l, 1)].life);
+  return 1;
+}
+
+static int benchGetFlags(lua_State* l)
+{
+  lua_pushinteger(l, objects[lua_tointeger(l, 1)].flags);
+  return 1;
+}
+
+static int benchQuery(lua_State* l)
+{
+  int nObjects = int(lua_rawlen(l, 1));
+
+  for (int i = 0; i < nObjects; ++i) {
+    lua_rawgeti(l, 1, i + 1);
+    const BenchObject& obj = objects[lua_tointeger(l, -1)];
+    lua_pop(l, 1);
+
+    lua_pushnumber(l, obj.p.x);
+    lua_rawseti(l, 2, 5*i + 1);
+    lua_pushnumber(l, obj.p.y);
+    lua_rawseti(l, 2, 5*i + 2);
+    lua_pushnumber(l, obj.p.z);
+    lua_rawseti(l, 2, 5*i + 3);
+    lua_pushnumber(l, obj.life);
+    lua_rawseti(l, 2, 5*i + 4);
+    lua_pushinteger(l, obj.flags);
+    lua_rawseti(l, 2, 5*i + 5);
+  }
+  return 0;
+}
+
+class LuaBench : public Lua
+{
+public:
+
+  void init()
+  {
+    Lua::init("bench");
+
+    import("benchGetPos", benchGetPos);
+    import("benchGetLife", benchGetLife);
+    import("benchGetFlags", benchGetFlags);
+    import("benchQuery", benchQuery);
+
+    if (luaL_dostring(l, SCRIPT) != 0) {
+      OZ_ERROR("%s", lua_tostring(l, -1));
+    }
+
+    lua_getglobal(l, "ozLocalData");
+  }
+
+  // Function looked up by name on each call, the old way of calling object handlers.
+  uint callByName()
+  {
+    uint t0 = Time::uclock();
+
+    for (int i = 0; i < N_CALLS; ++i) {
+      lua_getglobal(l, "onUpdate");
+      lua_rawgeti(l, 1, i % N_OBJECTS);
+      lua_pcall(l, 1, 1, 0);
+      lua_settop(l, 1);
+    }
+    return Time::uclock() - t0;
+  }
+
+  // Function pushed from a registry reference, as done for resolved class handlers.
+  uint callByRef()
+  {
+    int  ref = functionRef("onUpdate");
+    uint t0  = Time::uclock();
+
+    for (int i = 0; i < N_CALLS; ++i) {
+      lua_rawgeti(l, LUA_REGISTRYINDEX, ref);
+      lua_rawgeti(l, 1, i % N_OBJECTS);
+      lua_pcall(l, 1, 1, 0);
+      lua_settop(l, 1);
+    }
+
+    uint time = Time::uclock() - t0;
+    releaseRef(ref);
+    return time;
+  }
+
+  uint query(const char* function)
+  {
+    int  ref = functionRef(function);
+    uint t0  = Time::uclock();
+
+    for (int i = 0; i < N_QUERIES; ++i) {
+      lua_rawgeti(l, LUA_REGISTRYINDEX, ref);
+      lua_getglobal(l, "indices");
+      lua_pcall(l, 1, 1, 0);
+      lua_settop(l, 1);
+    }
+
+    uint time = Time::uclock() - t0;
+    releaseRef(ref);
+    return time;
+  }
+
+  void destroy()
+  {
+    Lua::destroy();
+  }
+};
+
+int main()
+{
+  System::init();
+
+  for (int i = 0; i < N_OBJECTS; ++i) {
+    objects[i] = { Point(float(i), float(2 * i), 0.0f), 100.0f, i };
+  }
+
+  LuaBench lua;
+  lua.init();
+
+  uint byName   = lua.callByName();
+  uint byRef    = lua.callByRef();
+  uint each     = lua.query("queryEach");
+  uint batched  = lua.query("queryBatched");
+
+  printf("%d handler calls\n", N_CALLS);
+  printf("  by global name:        %6u ms\n", byName / 1000);
+  printf("  by registry reference: %6u ms\n", byRef / 1000);
+  printf("%d x %d object queries\n", N_QUERIES, N_OBJECTS);
+  printf("  one call per value:    %6u ms\n", each / 1000);
+  printf("  batched:               %6u ms\n", batched / 1000);
+
+  lua.destroy();
+  return 0;
+}
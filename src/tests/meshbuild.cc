@@ -0,0 +1,252 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file tests/meshbuild.cc
+ *
+ * Model build benchmark.
+ *
+ * Feeds a large shuffled triangle soup, as emitted by model importers, through `builder::Compiler`
+ * with vertex welding and times the build and `writeModel()`. Welding is compared to the former
+ * linear search on a part of the mesh and `builder::MeshOptimiser` passes are timed separately,
+ * printing vertex cache miss ratios before and after. Grids larger than 255 have more than 65536
+ * vertices and are written with 32-bit indices.
+ *
+ * Usage: `meshbuild [gridSize]`
+ */
+
+#include <builder/Compiler.hh>
+#include <builder/MeshOptimiser.hh>
+
+#include <cstdlib>
+
+using namespace oz;
+using namespace oz::builder;
+
+struct GridVertex
+{
+  Point    pos;
+  TexCoord texCoord;
+  Vec3     normal;
+
+  bool operator == (const GridVertex& v) const
+  {
+    return pos == v.pos && texCoord == v.texCoord && normal == v.normal;
+  }
+};
+
+static List<GridVertex> gridVertices;
+static List<int>        gridTriangles;
+
+static void generateGrid(int size)
+{
+  gridVertices.clear();
+  gridTriangles.clear();
+
+  for (int y = 0; y <= size; ++y) {
+    for (int x = 0; x <= size; ++x) {
+      float u = float(x) / float(size);
+      float v = float(y) / float(size);
+      float h = Math::sin(u * 12.0f) * Math::cos(v * 9.0f);
+
+      gridVertices.add(GridVertex{ Point(u * 100.0f, v * 100.0f, h * 4.0f), TexCoord(u, v),
+                                   ~Vec3(-h, h, 1.0f) });
+    }
+  }
+
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      int i = y * (size + 1) + x;
+
+      int quad[] = { i, i + 1, i + size + 2, i, i + size + 2, i + size + 1 };
+
+      gridTriangles.addAll(quad, 6);
+    }
+  }
+
+  // Importers do not give any useful order.
+  for (int i = gridTriangles.length() / 3 - 1; i > 0; --i) {
+    int j = Math::rand(i + 1);
+
+    for (int k = 0; k < 3; ++k) {
+      swap(gridTriangles[i * 3 + k], gridTriangles[j * 3 + k]);
+    }
+  }
+}
+
+static long64 buildModel(int nTriangles, int* nIndices, bool* isVersioned)
+{
+  long64 t0 = Time::uclock();
+
+  compiler.beginModel();
+  compiler.enable(Compiler::UNIQUE);
+
+  compiler.beginMesh();
+  compiler.begin(Compiler::TRIANGLES);
+
+  for (int i = 0; i < nTriangles * 3; ++i) {
+    const GridVertex& v = gridVertices[gridTriangles[i]];
+
+    compiler.texCoord(v.texCoord.u, v.texCoord.v);
+    compiler.normal(v.normal);
+    compiler.vertex(v.pos);
+  }
+
+  compiler.end();
+  compiler.endMesh();
+
+  compiler.beginNode();
+  compiler.bindMesh(0);
+  compiler.endNode();
+
+  compiler.endModel();
+
+  Stream os(0, Endian::LITTLE);
+  compiler.writeModel(&os);
+
+  long64 time = Time::uclock() - t0;
+
+  os.rewind();
+  *isVersioned = os.readInt() == Model::FORMAT_MAGIC && os.readInt() == Model::FORMAT_VERSION;
+  *nIndices    = nTriangles * 3;
+  return time;
+}
+
+static long64 linearWeld(int nTriangles)
+{
+  long64 t0 = Time::uclock();
+
+  List<GridVertex> vertices;
+  List<uint>       indices;
+
+  for (int i = 0; i < nTriangles * 3; ++i) {
+    const GridVertex& v = gridVertices[gridTriangles[i]];
+
+    indices.add(uint(&vertices.include(v) - vertices.begin()));
+  }
+
+  return Time::uclock() - t0;
+}
+
+int main(int argc, char** argv)
+{
+  System::init();
+  Math::seed(42);
+
+  int gridSize = argc > 1 ? atoi(argv[1]) : 180;
+
+  if (gridSize < 1 || gridSize > 1000) {
+    Log::println("Grid size must be between 1 and 1000");
+    return EXIT_FAILURE;
+  }
+
+  generateGrid(gridSize);
+  compiler.init();
+
+  int nTriangles = gridTriangles.length() / 3;
+  int nPart      = nTriangles / 8;
+  int  nIndices;
+  bool isVersioned;
+
+  long64 linearTime = linearWeld(nPart);
+  long64 partTime   = buildModel(nPart, &nIndices, &isVersioned);
+  long64 fullTime   = buildModel(nTriangles, &nIndices, &isVersioned);
+
+  compiler.destroy();
+
+  // Optimisation passes alone, on the same triangle soup welded by grid vertex index.
+  List<uint>  indices(nIndices);
+  List<Point> positions(gridVertices.length());
+  List<int>   remap(gridVertices.length());
+
+  for (int i = 0; i < nIndices; ++i) {
+    indices[i] = uint(gridTriangles[i]);
+  }
+  for (int i = 0; i < gridVertices.length(); ++i) {
+    positions[i] = gridVertices[i].pos;
+  }
+
+  float      inputACMR = MeshOptimiser::acmr(indices.begin(), nIndices);
+  List<uint> cacheOnly = indices;
+
+  long64 t0 = Time::uclock();
+
+  MeshOptimiser::reorderTriangles(cacheOnly.begin(), nIndices, gridVertices.length(), nullptr);
+
+  long64 tipsifyTime = Time::uclock() - t0;
+  float  tipsifyACMR = MeshOptimiser::acmr(cacheOnly.begin(), nIndices);
+
+  List<uint> optimised = indices;
+
+  t0 = Time::uclock();
+
+  MeshOptimiser::reorderTriangles(optimised.begin(), nIndices, gridVertices.length(),
+                                  positions.begin());
+
+  long64 overdrawTime  = Time::uclock() - t0;
+  float  optimisedACMR = MeshOptimiser::acmr(optimised.begin(), nIndices);
+
+  // Reordering must keep the same triangles with the same winding.
+  List<ulong64> inputKeys;
+  List<ulong64> outputKeys;
+
+  for (int i = 0; i < nIndices; i += 3) {
+    for (int j = 0; j < 2; ++j) {
+      const uint* tri   = j == 0 ? &indices[i] : &optimised[i];
+      int         first = tri[0] < tri[1] ? (tri[0] < tri[2] ? 0 : 2) : (tri[1] < tri[2] ? 1 : 2);
+      ulong64     key   = ulong64(tri[first]) << 42 | ulong64(tri[(first + 1) % 3]) << 21 |
+                          ulong64(tri[(first + 2) % 3]);
+
+      (j == 0 ? inputKeys : outputKeys).add(key);
+    }
+  }
+  inputKeys.sort();
+  outputKeys.sort();
+
+  t0 = Time::uclock();
+
+  MeshOptimiser::reorderVertices(optimised.begin(), nIndices, gridVertices.length(),
+                                 remap.begin());
+
+  long64 fetchTime = Time::uclock() - t0;
+
+  bool isOK = isVersioned && inputKeys == outputKeys && optimisedACMR < inputACMR;
+
+  // Vertices must be numbered in order of first use.
+  int nextVertex = 0;
+
+  for (int i = 0; i < nIndices; ++i) {
+    isOK &= optimised[i] <= nextVertex;
+    nextVertex += optimised[i] == nextVertex;
+  }
+
+  Log::println("%d triangles, %d vertices", nTriangles, gridVertices.length());
+  Log::println("linear weld, %6d triangles: %10.2f ms", nPart, double(linearTime) / 1000.0);
+  Log::println("hashed build, %6d triangles: %9.2f ms", nPart, double(partTime) / 1000.0);
+  Log::println("hashed build, %6d triangles: %9.2f ms", nTriangles, double(fullTime) / 1000.0);
+  Log::println("Tipsify:             %8.2f ms, ACMR %.3f -> %.3f",
+               double(tipsifyTime) / 1000.0, inputACMR, tipsifyACMR);
+  Log::println("Tipsify + overdraw:  %8.2f ms, ACMR %.3f -> %.3f",
+               double(overdrawTime) / 1000.0, inputACMR, optimisedACMR);
+  Log::println("vertex fetch order:  %8.2f ms", double(fetchTime) / 1000.0);
+
+  Log::println(isOK ? "Mesh build test PASSED" : "Mesh build test FAILED");
+  return isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
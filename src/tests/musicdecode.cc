@@ -0,0 +1,180 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file tests/musicdecode.cc
+ *
+ * Offline music decoding benchmark.
+ *
+ * Decodes a track to PCM with `client::MusicStream` as fast as possible, first directly and then
+ * through `client::MusicRing` with a producer thread as in the game, and prints throughput.
+ *
+ * Usage: `musicdecode <track.ogg|mp3|aac> [passes]`
+ */
+
+#include <client/MusicRing.hh>
+#include <client/MusicStream.hh>
+
+#include <cstdlib>
+
+using namespace oz;
+using namespace oz::client;
+
+struct Producer
+{
+  MusicStream* stream;
+  MusicRing*   ring;
+  File         file;
+  int          nPasses;
+};
+
+static void produce(void* data)
+{
+  Producer* producer = static_cast<Producer*>(data);
+
+  for (int pass = 0; pass < producer->nPasses; ++pass) {
+    producer->stream->open(producer->file);
+
+    int size;
+    do {
+      MusicRing::Block* block;
+
+      while ((block = producer->ring->beginWrite()) == nullptr) {
+        Time::usleep(50);
+      }
+
+      size = producer->stream->decode(block->data, MusicRing::BLOCK_SIZE);
+
+      block->size       = size;
+      block->generation = uint(pass);
+      producer->ring->endWrite();
+    }
+    while (size != 0);
+  }
+
+  producer->stream->close();
+}
+
+static void printThroughput(const char* name, ulong64 bytes, long64 micros, int rate, int channels)
+{
+  double megabytes = double(bytes) / double(1024 * 1024);
+  double seconds   = double(micros) * 1.0e-6;
+  double duration  = double(bytes) / double(rate * channels * 2);
+
+  Log::println("%-8s %8.2f MB in %8.3f s: %8.2f MB/s, %8.1fx real time",
+               name, megabytes, seconds, megabytes / seconds, duration / seconds);
+}
+
+int main(int argc, char** argv)
+{
+  System::init();
+
+  if (argc < 2) {
+    Log::println("Usage: %s <track.ogg|mp3|aac> [passes]", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int  nPasses = argc < 3 ? 4 : max(1, int(strtol(argv[2], nullptr, 10)));
+  File track   = File(argv[1]).toNative();
+
+  File::init();
+  MusicStream::initLibs();
+
+  if (!track.directory().mountAt(nullptr)) {
+    Log::println("Failed to mount directory of '%s'", track.c());
+    return EXIT_FAILURE;
+  }
+
+  File file = "@" + track.name();
+
+  static MusicStream stream;
+  static char        buffer[MusicRing::BLOCK_SIZE];
+
+  ulong64 directBytes = 0;
+  int     rate        = 0;
+  int     channels    = 0;
+  long64  t0          = Time::uclock();
+
+  for (int pass = 0; pass < nPasses; ++pass) {
+    stream.open(file);
+
+    rate     = stream.sampleRate();
+    channels = stream.nChannels();
+
+    int size;
+    while ((size = stream.decode(buffer, MusicRing::BLOCK_SIZE)) != 0) {
+      directBytes += ulong64(size);
+    }
+  }
+  stream.close();
+
+  long64 directTime = Time::uclock() - t0;
+
+  if (directBytes == 0) {
+    Log::println("No PCM data decoded from '%s'", track.c());
+    Log::println("Music decode test FAILED");
+    return EXIT_FAILURE;
+  }
+
+  MusicRing ring;
+  ring.init(8);
+
+  Producer producer = { &stream, &ring, file, nPasses };
+  ulong64  ringBytes = 0;
+  ulong64  nPolls    = 0;
+  int      nEnds     = 0;
+
+  t0 = Time::uclock();
+
+  Thread producerThread("producer", produce, &producer);
+
+  while (nEnds != nPasses) {
+    const MusicRing::Block* block = ring.beginRead();
+
+    if (block == nullptr) {
+      ++nPolls;
+      Time::usleep(50);
+      continue;
+    }
+
+    ringBytes += ulong64(block->size);
+    nEnds     += block->size == 0;
+    ring.endRead();
+  }
+
+  producerThread.join();
+
+  long64 ringTime = Time::uclock() - t0;
+
+  Log::println("%s: %d Hz, %d channel(s), %d pass(es)", track.c(), rate, channels, nPasses);
+  printThroughput("direct", directBytes, directTime, rate, channels);
+  printThroughput("ring", ringBytes, ringTime, rate, channels);
+  Log::println("ring: %d blocks, peak depth %d, %lu empty polls", ring.length(), ring.nPeakDepth,
+               ulong(nPolls));
+
+  ring.destroy();
+  MusicStream::destroyLibs();
+  File::destroy();
+
+  bool isOK = ringBytes == directBytes;
+
+  Log::println(isOK ? "Music decode test PASSED" : "Music decode test FAILED");
+  return isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,133 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file tests/particles.cc
+ *
+ * Headless particle update benchmark.
+ *
+ * Updates 100k particles with `client::PartBuffer` and with the former array-of-structures update
+ * using `Math::normalRand()`, then builds billboards. Average times are printed.
+ */
+
+#include <client/PartBuffer.hh>
+
+using namespace oz;
+using namespace oz::client;
+
+static const int   N_PARTS   = 100000;
+static const int   N_UPDATES = 500;
+static const float TIME_STEP = 1.0f / 60.0f;
+
+struct Part
+{
+  Vec3  p;
+  Vec3  velocity;
+  float life;
+};
+
+static void updateReference(List<Part>& parts, const PartBuffer::Emitter& emitter)
+{
+  float drag = Math::pow(emitter.drag, TIME_STEP);
+
+  for (Part& part : parts) {
+    if (part.life <= 0.0f) {
+      Vec3 localVel = emitter.velocity + Vec3(emitter.velocitySpread * Math::normalRand(),
+                                              emitter.velocitySpread * Math::normalRand(),
+                                              emitter.velocitySpread * Math::normalRand());
+
+      part.p        = Vec3(emitter.transf.w);
+      part.velocity = emitter.transf * localVel;
+      part.life     = emitter.lifeTime * (0.5f + 0.5f * Math::rand());
+    }
+
+    part.p          += part.velocity * TIME_STEP;
+    part.velocity.z += emitter.gravity * TIME_STEP;
+    part.velocity   *= drag;
+    part.life       -= TIME_STEP;
+  }
+}
+
+int main()
+{
+  System::init();
+  Math::seed(42);
+
+  PartBuffer::Emitter emitter = {
+    Mat4::translation(Vec3(10.0f, 20.0f, 30.0f)) ^ Mat4::rotationZ(Math::TAU / 8.0f),
+    Vec3(0.0f, 0.0f, 5.0f), 2.0f, 3.0f, -9.81f, 0.5f
+  };
+
+  List<Part> parts(N_PARTS);
+  for (Part& part : parts) {
+    part.life = 0.0f;
+  }
+
+  long64 t0 = Time::uclock();
+
+  for (int i = 0; i < N_UPDATES; ++i) {
+    updateReference(parts, emitter);
+  }
+
+  long64 referenceTime = Time::uclock() - t0;
+
+  PartBuffer buffer;
+  buffer.resize(N_PARTS);
+
+  t0 = Time::uclock();
+
+  for (int i = 0; i < N_UPDATES; ++i) {
+    buffer.update(emitter, TIME_STEP);
+  }
+
+  long64 bufferTime = Time::uclock() - t0;
+
+  List<PartBuffer::Vertex> vertices(N_PARTS * PartBuffer::BILLBOARD_VERTICES);
+
+  t0 = Time::uclock();
+
+  for (int i = 0; i < N_UPDATES; ++i) {
+    buffer.buildBillboards(Vec3(1.0f, 0.0f, 0.0f), Vec3(0.0f, 0.0f, 1.0f), 0.1f,
+                           vertices.begin());
+  }
+
+  long64 billboardTime = Time::uclock() - t0;
+
+  // Particles must stay alive within their life time and be displaced from the emitter by
+  // reasonable distances.
+  bool isOK = true;
+
+  for (int i = 0; i < buffer.length(); ++i) {
+    float distance = !(buffer.position(i) - Point(10.0f, 20.0f, 30.0f));
+
+    isOK &= buffer.life(i) > -TIME_STEP && buffer.life(i) <= emitter.lifeTime;
+    isOK &= Math::isFinite(distance) && distance < 100.0f;
+  }
+
+  Log::println("%d particles, %d updates", N_PARTS, N_UPDATES);
+  Log::println("reference update: %8.2f µs", double(referenceTime) / double(N_UPDATES));
+  Log::println("SoA update:       %8.2f µs (%.2f ns per particle)",
+               double(bufferTime) / double(N_UPDATES),
+               double(bufferTime) * 1000.0 / double(N_UPDATES) / double(N_PARTS));
+  Log::println("billboards:       %8.2f µs", double(billboardTime) / double(N_UPDATES));
+
+  Log::println(isOK ? "Particle test PASSED" : "Particle test FAILED");
+  return isOK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -19,177 +19,227 @@
 
 /**
  * @file tests/quicksort.cc
+ *
+ * Benchmark of `Arrays::sort()` and `Arrays::parallelSort()` against the former last-element-pivot
+ * quicksort on random, sorted and nearly sorted input.
  */
 
 #include <ozCore/ozCore.hh>
 
-#include <cstdlib>
 #include <cstdio>
 
 using namespace oz;
 
-template <typename Type, int STACK_SIZE>
-inline void aSort(Type* array, int count)
-{
-  Type*  stack[STACK_SIZE];
-  Type** sp = stack;
-  Type*  first = array;
-  Type*  last = array + count - 1;
-
-  *(++sp) = first;
-  *(++sp) = last;
-
-  do {
-    last = *(--sp);
-    first = *(--sp);
-
-    if (first < last) {
-      if (last - first > 10) {
-        int pivotValue = *last;
-        Type* top = first;
-        Type* bottom = last - 1;
-
-        do {
-          while (top <= bottom && *top <= pivotValue) {
-            ++top;
-          }
-          while (top < bottom && *bottom > pivotValue) {
-            --bottom;
-          }
-          if (top >= bottom) {
-            break;
-          }
-          swap(*top, *bottom);
-        }
-        while (true);
+static const int SMALL_COUNT  = 10000;
+static const int SMALL_ROUNDS = 200;
+static const int LARGE_COUNT  = 1 << 21;
+static const int LARGE_ROUNDS = 4;
+
+/**
+ * Former `Arrays::sort()` implementation, kept as a reference.
+ */
+static void legacySort(int* first, int* last)
+{
+  if (last - first > 11) {
+    int* top    = first;
+    int* bottom = last - 1;
 
-        swap(*top, *last);
+    do {
+      for (; !(*last < *top) && top <= bottom; ++top);
+      for (; *last < *bottom && top < bottom; --bottom);
 
-        *(++sp) = first;
-        *(++sp) = top - 1;
-        *(++sp) = top + 1;
-        *(++sp) = last;
+      if (top >= bottom) {
+        break;
       }
-      else {
-        // selection sort
-        for (Type* i = first; i < last;) {
-          Type* pivot = i;
-          Type* min = i;
-          ++i;
-
-          for (Type* j = i; j <= last; ++j) {
-            if (*j < *min) {
-              min = j;
-            }
-          }
-          swap(*pivot, *min);
+
+      swap(*top, *bottom);
+    }
+    while (true);
+
+    if (top != last) {
+      swap(*top, *last);
+      legacySort(top + 1, last);
+    }
+    legacySort(first, top - 1);
+  }
+  else {
+    for (int* i = first; i < last;) {
+      int* pivot = i;
+      int* min   = i;
+      ++i;
+
+      for (int* j = i; j <= last; ++j) {
+        if (*j < *min) {
+          min = j;
         }
       }
+      if (min != pivot) {
+        swap(*min, *pivot);
+      }
     }
   }
-  while (sp != stack);
 }
 
-template <typename Type>
-inline void arSort(Type* first, Type* last)
+static void legacySort(int* array, int count)
 {
-  if (first < last) {
-    if (last - first > 1) {
-      int pivotValue = *last;
-      Type* top = first;
-      Type* bottom = last - 1;
+  legacySort(array, array + count - 1);
+}
 
-      do {
-        while (top <= bottom && *top <= pivotValue) {
-          ++top;
-        }
-        while (top < bottom && *bottom > pivotValue) {
-          --bottom;
-        }
-        if (top >= bottom) {
-          break;
-        }
-        swap(*top, *bottom);
-      }
-      while (true);
+static void introSort(int* array, int count)
+{
+  Arrays::sort(array, count);
+}
 
-      swap(*top, *last);
+static void parallelSort(int* array, int count)
+{
+  Arrays::parallelSort(array, count);
+}
 
-      arSort(first, top - 1);
-      arSort(top + 1, last);
-    }
-    else if (*first > *last) {
-      swap(*first, *last);
-    }
+static void randomInput(int* array, int count)
+{
+  for (int i = 0; i < count; ++i) {
+    array[i] = Math::rand(count);
+  }
+}
+
+static void sortedInput(int* array, int count)
+{
+  for (int i = 0; i < count; ++i) {
+    array[i] = i;
+  }
+}
+
+static void reversedInput(int* array, int count)
+{
+  for (int i = 0; i < count; ++i) {
+    array[i] = count - i;
+  }
+}
+
+// Distances to the camera in the next frame: sorted, each element moved by a small amount.
+static void jitteredInput(int* array, int count)
+{
+  for (int i = 0; i < count; ++i) {
+    array[i] = 16 * i + Math::rand(64);
   }
 }
 
-template <typename Type>
-static void oaSort(Type* array, int begin, int end)
+// Sorted with 1 % of elements swapped at random positions.
+static void nearlySortedInput(int* array, int count)
 {
-  int first = begin;
-  int last = end - 1;
+  sortedInput(array, count);
 
-  if (first < last) {
-    if (first + 1 == last) {
-      if (array[first] > array[last]) {
-        swap(array[first], array[last]);
+  for (int i = 0; i < count / 100; ++i) {
+    swap(array[Math::rand(count)], array[Math::rand(count)]);
+  }
+}
+
+static void duplicatesInput(int* array, int count)
+{
+  for (int i = 0; i < count; ++i) {
+    array[i] = Math::rand(16);
+  }
+}
+
+static void organPipeInput(int* array, int count)
+{
+  for (int i = 0; i < count; ++i) {
+    array[i] = i < count / 2 ? i : count - i;
+  }
+}
+
+struct Pattern
+{
+  const char* name;
+  void (* generate)(int* array, int count);
+};
+
+struct Algorithm
+{
+  const char* name;
+  void (* sort)(int* array, int count);
+};
+
+static const Pattern PATTERNS[] = {
+  { "random",        randomInput       },
+  { "sorted",        sortedInput       },
+  { "reversed",      reversedInput     },
+  { "jittered",      jitteredInput     },
+  { "nearly sorted", nearlySortedInput },
+  { "duplicates",    duplicatesInput   },
+  { "organ pipe",    organPipeInput    }
+};
+
+static long64 benchmark(const Algorithm& algorithm, const Pattern& pattern, int* array, int count,
+                        int nRounds)
+{
+  long64 time = 0;
+
+  Math::seed(42);
+
+  for (int i = 0; i < nRounds; ++i) {
+    pattern.generate(array, count);
+
+    long64 t0 = Time::uclock();
+    algorithm.sort(array, count);
+    time += Time::uclock() - t0;
+
+    for (int j = 1; j < count; ++j) {
+      if (array[j] < array[j - 1]) {
+        OZ_ERROR("%s: %s input not sorted", algorithm.name, pattern.name);
       }
     }
-    else {
-      int pivotValue = array[last];
-      int top = first;
-      int bottom = last - 1;
-
-      do {
-        while (top <= bottom && array[top] <= pivotValue) {
-          ++top;
-        }
-        while (top < bottom && array[bottom] > pivotValue) {
-          --bottom;
-        }
-        if (top < bottom) {
-          swap(array[top], array[bottom]);
-        }
-        else {
-          break;
-        }
-      }
-      while (true);
+  }
+  return time / nRounds;
+}
+
+static void run(const Algorithm* algorithms, int nAlgorithms, int count, int nRounds)
+{
+  int* array = new int[count];
 
-      swap(array[top], array[last]);
-      oaSort(array, begin, top);
-      oaSort(array, top + 1, end);
+  printf("%d elements, average of %d rounds [us]\n\n%-14s", count, nRounds, "");
+  for (int i = 0; i < nAlgorithms; ++i) {
+    printf(" %12s", algorithms[i].name);
+  }
+  printf("\n");
+
+  for (const Pattern& pattern : PATTERNS) {
+    printf("%-14s", pattern.name);
+
+    for (int i = 0; i < nAlgorithms; ++i) {
+      printf(" %12d", int(benchmark(algorithms[i], pattern, array, count, nRounds)));
+      fflush(stdout);
     }
+    printf("\n");
   }
-}
+  printf("\n");
 
-#define MAX 10000
-#define TESTS 2000
+  delete[] array;
+}
 
 int main()
 {
   System::init();
 
-  int array[MAX];
+  // Legacy quicksort recurses O(n) deep on sorted input, so it is only run on small arrays, which
+  // is also the typical size of per-frame lists that `Render` sorts.
+  Algorithm smallAlgorithms[] = {
+    { "legacy",   legacySort },
+    { "sort",     introSort  }
+  };
+  Algorithm largeAlgorithms[] = {
+    { "sort",     introSort    },
+    { "parallel", parallelSort }
+  };
 
-  srand(32);
+  printf("%d cores\n\n", Thread::nCores());
 
-  long64 t0 = Time::clock();
-  for (int i = 0; i < TESTS; ++i) {
-    for (int j = 0; j < MAX; ++j) {
-      array[j] = rand() % MAX;
-    }
-    //sort(array, 0, MAX);
-    //quickSort(array, MAX);
-    //arSort(array, array + MAX - 1);
-    Arrays::sort(array, MAX);
-    //aSort<int, 100>(array, MAX);
-  }
-  printf("%d ms\n", int(Time::clock() - t0));
-//   for (int i = 0; i < MAX; ++i) {
-//     printf("%d ", array[i]);
-//   }
+  Jobs::init();
+
+  run(smallAlgorithms, Arrays::length(smallAlgorithms), SMALL_COUNT, SMALL_ROUNDS);
+  run(largeAlgorithms, Arrays::length(largeAlgorithms), LARGE_COUNT, LARGE_ROUNDS);
+
+  Jobs::destroy();
 
   Log::printMemoryLeaks();
   return 0;
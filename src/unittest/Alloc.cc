@@ -28,6 +28,128 @@
 
 using namespace oz;
 
+static const int N_THREADS = 4;
+static const int N_ALLOCS  = 50000;
+
+static char* crossBlocks[N_ALLOCS];
+
+// Allocate and free blocks of varying sizes, freeing also blocks allocated by the main thread.
+static void allocMain(void* data)
+{
+  int   index = int(reinterpret_cast<size_t>(data));
+  char* live[64] = {};
+
+  for (int i = 0; i < N_ALLOCS; ++i) {
+    int slot = i % 64;
+
+    delete[] live[slot];
+    live[slot] = new char[1 + (i * 37 + index * 11) % 3000];
+    live[slot][0] = char(i);
+  }
+  for (char* block : live) {
+    delete[] block;
+  }
+
+  for (int i = index; i < N_ALLOCS; i += N_THREADS) {
+    delete[] crossBlocks[i];
+  }
+}
+
+static void testSizeClasses()
+{
+  // Upper bound for per-block meta data.
+  static const size_t MAX_META_SIZE = 16;
+
+  for (size_t size = 1; size <= 3000; size += 7) {
+    int counts[Alloc::N_SIZE_CLASSES];
+
+    for (int i = 0; i < Alloc::N_SIZE_CLASSES; ++i) {
+      counts[i] = Alloc::sizeClasses[i].sumCount;
+    }
+
+    // Volatile, so the compiler cannot elide the allocation.
+    char* volatile block = new char[size];
+    int            nHits = 0;
+
+    for (int i = 0; i < Alloc::N_SIZE_CLASSES; ++i) {
+      if (Alloc::sizeClasses[i].sumCount != counts[i]) {
+        OZ_CHECK(Alloc::sizeClasses[i].size > size);
+        OZ_CHECK(i == 0 || Alloc::sizeClasses[i - 1].size < size + MAX_META_SIZE);
+        ++nHits;
+      }
+    }
+
+    if (size + MAX_META_SIZE <= Alloc::MAX_SMALL_SIZE) {
+      OZ_CHECK(nHits == 1);
+    }
+    else if (size >= Alloc::MAX_SMALL_SIZE) {
+      OZ_CHECK(nHits == 0);
+    }
+
+    delete[] block;
+  }
+
+  for (const Alloc::SizeClass& sizeClass : Alloc::sizeClasses) {
+    OZ_CHECK(sizeClass.size % OZ_ALIGNMENT == 0);
+    OZ_CHECK(0 <= sizeClass.count && sizeClass.count <= sizeClass.maxCount);
+    OZ_CHECK(sizeClass.count <= sizeClass.nBlocks);
+  }
+}
+
+static void testSampling()
+{
+  int oInterval = Alloc::sampleInterval;
+
+  Alloc::sampleInterval = 1;
+
+  Foo* object = new Foo();
+  int* array  = new int[100];
+  bool hasObject = false;
+  bool hasArray  = false;
+
+  for (const Alloc::ChunkInfo& ci : Alloc::objectCIter()) {
+    OZ_CHECK(ci.address != array);
+    hasObject |= ci.address == object && ci.size == sizeof(Foo);
+  }
+  for (const Alloc::ChunkInfo& ci : Alloc::arrayCIter()) {
+    OZ_CHECK(ci.address != object);
+    hasArray |= ci.address == array && ci.size == 100 * sizeof(int);
+  }
+  OZ_CHECK(hasObject && hasArray);
+
+  delete object;
+  delete[] array;
+
+  for (const Alloc::ChunkInfo& ci : Alloc::objectCIter()) {
+    OZ_CHECK(ci.address != object);
+  }
+  for (const Alloc::ChunkInfo& ci : Alloc::arrayCIter()) {
+    OZ_CHECK(ci.address != array);
+  }
+
+  Alloc::sampleInterval = oInterval;
+}
+
+static void testThreads()
+{
+  int oCount = Alloc::count;
+
+  for (int i = 0; i < N_ALLOCS; ++i) {
+    crossBlocks[i] = new char[1 + i % 500];
+  }
+
+  Thread threads[N_THREADS];
+
+  for (int i = 0; i < N_THREADS; ++i) {
+    threads[i] = Thread("alloc", allocMain, reinterpret_cast<void*>(size_t(i)));
+  }
+  for (Thread& thread : threads) {
+    thread.join();
+  }
+
+  OZ_CHECK(Alloc::count == oCount);
+}
+
 void test_Alloc()
 {
   Log() << "+ Alloc";
@@ -57,6 +179,10 @@ void test_Alloc()
   OZ_CHECK(Alloc::count == oCount + 0);
   OZ_CHECK(Alloc::sumCount == oSumCount + 2);
 
+  testSizeClasses();
+  testSampling();
+  testThreads();
+
   OZ_CHECK(Alloc::alignDown(0) == 0);
   OZ_CHECK(Alloc::alignDown(1) == 0);
   OZ_CHECK(Alloc::alignDown(OZ_ALIGNMENT - 1) == 0);
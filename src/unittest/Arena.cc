@@ -0,0 +1,250 @@
+/*
+ * liboz - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file unittest/Arena.cc
+ */
+
+#include "unittest.hh"
+
+using namespace oz;
+
+struct Tracked
+{
+  static Arena arena;
+  static int   nLive;
+
+  int value;
+
+  Tracked(int value_ = 0) :
+    value(value_)
+  {
+    ++nLive;
+  }
+
+  Tracked(const Tracked& t) :
+    value(t.value)
+  {
+    ++nLive;
+  }
+
+  ~Tracked()
+  {
+    --nLive;
+  }
+
+  Tracked& operator = (const Tracked&) = default;
+
+  bool operator == (const Tracked& t) const
+  {
+    return value == t.value;
+  }
+
+  OZ_STATIC_ARENA_ALLOC(arena)
+};
+
+Arena Tracked::arena(1024);
+int   Tracked::nLive = 0;
+
+static const int N_THREADS     = 4;
+static const int N_THREAD_REPS = 10000;
+
+static Arena  sharedArena(4096);
+static int*   threadBlocks[N_THREADS][N_THREAD_REPS];
+
+static void allocateMain(void* data)
+{
+  int id = int(reinterpret_cast<size_t>(data));
+
+  for (int i = 0; i < N_THREAD_REPS; ++i) {
+    int* block = static_cast<int*>(sharedArena.allocate(sizeof(int[2])));
+
+    block[0] = id;
+    block[1] = i;
+    threadBlocks[id][i] = block;
+  }
+}
+
+static void testArena()
+{
+  Arena arena(1024);
+
+  OZ_CHECK(arena.length() == 0 && arena.capacity() == 0);
+
+  char* first = static_cast<char*>(arena.allocate(1));
+  char* prev  = first;
+
+  OZ_CHECK(size_t(first) % OZ_ALIGNMENT == 0);
+
+  for (int i = 1; i < 100; ++i) {
+    char* ptr = static_cast<char*>(arena.allocate(size_t(i)));
+
+    OZ_CHECK(size_t(ptr) % OZ_ALIGNMENT == 0);
+    OZ_CHECK(ptr != prev);
+    prev = ptr;
+  }
+
+  // Allocations larger than the block size get a block of their own.
+  char* large = static_cast<char*>(arena.allocate(10000));
+  large[9999] = 1;
+
+  OZ_CHECK(arena.length() == 101);
+
+  size_t capacity = arena.capacity();
+
+  // Blocks are reused after reset, so replaying the same allocations doesn't grow the arena.
+  arena.reset();
+
+  OZ_CHECK(arena.length() == 0);
+  OZ_CHECK(arena.allocate(1) == first);
+
+  for (int i = 1; i < 100; ++i) {
+    arena.allocate(size_t(i));
+  }
+  arena.allocate(10000);
+
+  OZ_CHECK(arena.length() == 101);
+  OZ_CHECK(arena.capacity() == capacity);
+
+  arena.free();
+
+  OZ_CHECK(arena.length() == 0 && arena.capacity() == 0);
+}
+
+static void testStaticAlloc()
+{
+  Tracked* a = new Tracked(1);
+  Tracked* b = new Tracked(2);
+
+  OZ_CHECK(Tracked::arena.length() == 2);
+  OZ_CHECK(a->value == 1 && b->value == 2);
+
+  delete a;
+  delete b;
+
+  OZ_CHECK(Tracked::nLive == 0);
+
+  Tracked::arena.reset();
+  OZ_CHECK(new Tracked(3) == a);
+
+  Tracked::arena.free();
+  Tracked::nLive = 0;
+}
+
+static void testArenaList()
+{
+  Arena arena(256);
+
+  {
+    ArenaList<Tracked> list(&arena);
+
+    OZ_CHECK(list.isEmpty() && list.capacity() == 0);
+
+    for (int i = 0; i < 100; ++i) {
+      list.add(Tracked(i));
+    }
+
+    OZ_CHECK(list.length() == 100 && list.capacity() >= 100);
+    OZ_CHECK(Tracked::nLive == list.capacity());
+
+    for (int i = 0; i < 100; ++i) {
+      OZ_CHECK(list[i].value == i);
+    }
+
+    OZ_CHECK(list.contains(Tracked(42)));
+    OZ_CHECK(list.index(Tracked(42)) == 42);
+    OZ_CHECK(&list.include(Tracked(42)) == &list[42]);
+
+    list.include(Tracked(100));
+    OZ_CHECK(list.length() == 101 && list.last().value == 100);
+
+    list.eraseUnordered(0);
+    OZ_CHECK(list.length() == 100 && list[0].value == 100);
+
+    ArenaList<Tracked> moved = static_cast<ArenaList<Tracked>&&>(list);
+
+    OZ_CHECK(list.isEmpty() && list.capacity() == 0);
+    OZ_CHECK(moved.length() == 100);
+
+    int sum = 0;
+    for (const Tracked& t : moved) {
+      sum += t.value;
+    }
+    OZ_CHECK(sum == 5050);
+
+    moved.clear();
+    OZ_CHECK(moved.isEmpty() && moved.capacity() >= 100);
+  }
+
+  // Destructors of all constructed elements have been called.
+  OZ_CHECK(Tracked::nLive == 0);
+
+  size_t capacity = arena.capacity();
+
+  for (int rep = 0; rep < 10; ++rep) {
+    arena.reset();
+
+    ArenaList<int> list(&arena, 4);
+
+    for (int i = 0; i < 1000; ++i) {
+      list.add(i);
+    }
+    OZ_CHECK(list.length() == 1000 && list[999] == 999);
+
+    if (rep == 0) {
+      capacity = arena.capacity();
+    }
+    OZ_CHECK(arena.capacity() == capacity);
+  }
+}
+
+static void testThreads()
+{
+  Thread threads[N_THREADS];
+
+  for (int i = 0; i < N_THREADS; ++i) {
+    threads[i] = Thread("arena", allocateMain, reinterpret_cast<void*>(size_t(i)));
+  }
+  for (Thread& thread : threads) {
+    thread.join();
+  }
+
+  OZ_CHECK(sharedArena.length() == N_THREADS * N_THREAD_REPS);
+
+  for (int i = 0; i < N_THREADS; ++i) {
+    for (int j = 0; j < N_THREAD_REPS; ++j) {
+      OZ_CHECK(threadBlocks[i][j][0] == i && threadBlocks[i][j][1] == j);
+    }
+  }
+
+  sharedArena.free();
+}
+
+void test_Arena()
+{
+  Log() << "+ Arena";
+
+  testArena();
+  testStaticAlloc();
+  testArenaList();
+  testThreads();
+}
@@ -0,0 +1,203 @@
+/*
+ * liboz - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file unittest/FlatHashSet.cc
+ */
+
+#include "unittest.hh"
+
+using namespace oz;
+
+void test_FlatHashSet()
+{
+  Log() << "+ FlatHashSet";
+
+  // Insertion and lookup.
+  FlatHashSet<int> s;
+
+  OZ_CHECK(s.isEmpty() && s.capacity() == 0);
+  OZ_CHECK(!s.contains(0) && !s.exclude(0));
+
+  for (int i = 0; i < 1000; ++i) {
+    s.add(i * 7);
+  }
+  OZ_CHECK(s.length() == 1000);
+
+  for (int i = 0; i < 1000; ++i) {
+    OZ_CHECK(s.contains(i * 7));
+    OZ_CHECK(!s.contains(i * 7 + 1));
+  }
+
+  s.include(0);
+  s.add(7);
+  OZ_CHECK(s.length() == 1000);
+
+  // Erasure and re-insertion into freed slots.
+  int capacity = s.capacity();
+
+  for (int i = 0; i < 1000; i += 2) {
+    OZ_CHECK(s.exclude(i * 7));
+    OZ_CHECK(!s.exclude(i * 7));
+  }
+  OZ_CHECK(s.length() == 500);
+
+  for (int i = 0; i < 1000; ++i) {
+    OZ_CHECK(s.contains(i * 7) == (i % 2 != 0));
+  }
+  for (int i = 0; i < 1000; i += 2) {
+    s.add(i * 7);
+  }
+  OZ_CHECK(s.length() == 1000 && s.capacity() == capacity);
+
+  // Keys keep leaving and entering, deleted slots must be reused or purged by an in-place rehash
+  // rather than make the table grow indefinitely.
+  FlatHashSet<int> churn;
+
+  for (int i = 0; i < 40; ++i) {
+    churn.add(i);
+  }
+
+  int churnCapacity = churn.capacity();
+
+  for (int i = 40; i < 20040; ++i) {
+    OZ_CHECK(churn.exclude(i - 40));
+    churn.add(i);
+  }
+  OZ_CHECK(churn.length() == 40 && churn.capacity() <= 2 * churnCapacity);
+
+  for (int i = 0; i < 20040; ++i) {
+    OZ_CHECK(churn.contains(i) == (i >= 20000));
+  }
+
+  // Growth, rehashing and trimming.
+  FlatHashSet<int> g;
+
+  for (int i = 0; i < 10000; ++i) {
+    g.add(i);
+
+    int size = g.capacity();
+    OZ_CHECK(size >= g.length() && (size & (size - 1)) == 0);
+  }
+  for (int i = 10; i < 10000; ++i) {
+    g.exclude(i);
+  }
+
+  g.trim();
+  OZ_CHECK(g.length() == 10 && g.capacity() == 16);
+
+  for (int i = 0; i < 10000; ++i) {
+    OZ_CHECK(g.contains(i) == (i < 10));
+  }
+
+  g.add(10);
+  OZ_CHECK(g.contains(10) && g.length() == 11);
+
+  g.clear();
+  OZ_CHECK(g.isEmpty() && g.capacity() == 16 && !g.contains(0));
+
+  g.trim();
+  OZ_CHECK(g.capacity() == 0);
+
+  g.add(1);
+  OZ_CHECK(g.contains(1) && g.length() == 1);
+
+  // Copying and moving.
+  FlatHashMap<int, Foo> a = { { 1, 10 }, { 2, 20 }, { 3, 30 } };
+  FlatHashMap<int, Foo> b(a);
+
+  OZ_CHECK(a == b && b.length() == 3);
+  OZ_CHECK(b.find(2) != nullptr && *b.find(2) == 20);
+
+  b.add(4, 40);
+  OZ_CHECK(a != b && a.length() == 3);
+
+  Foo::allowCopy = false;
+
+  FlatHashMap<int, Foo> c(static_cast<FlatHashMap<int, Foo>&&>(b));
+
+  OZ_CHECK(c.length() == 4 && *c.find(4) == 40);
+  OZ_CHECK(b.isEmpty() && b.capacity() == 0 && b.find(1) == nullptr);
+
+  a = static_cast<FlatHashMap<int, Foo>&&>(c);
+
+  OZ_CHECK(a.length() == 4 && *a.find(1) == 10 && *a.find(4) == 40);
+  OZ_CHECK(c.isEmpty() && c.capacity() == 0);
+
+  Foo::allowCopy = true;
+
+  b = a;
+  OZ_CHECK(a == b && b.length() == 4 && *b.find(3) == 30);
+
+  c = a;
+  c.exclude(1);
+  OZ_CHECK(a.contains(1) && !c.contains(1) && c.length() == 3);
+
+  // String keys.
+  FlatHashMap<String, int> m;
+
+  for (int i = 0; i < 500; ++i) {
+    m.add(String::format("key%d", i), i);
+  }
+  OZ_CHECK(m.length() == 500);
+
+  for (int i = 0; i < 500; ++i) {
+    const int* value = m.find(String::format("key%d", i));
+    OZ_CHECK(value != nullptr && *value == i);
+  }
+  OZ_CHECK(m.find("key500") == nullptr && m.find("") == nullptr);
+  OZ_CHECK(m.find("key7") != nullptr && *m.find("key7") == 7);
+
+  m.add("key3", 33);
+  m.include("key3", 0);
+  OZ_CHECK(*m.find("key3") == 33 && m.length() == 500);
+
+  OZ_CHECK(m.exclude("key3") && m.find("key3") == nullptr && m.length() == 499);
+
+  m.add(String("key3"), 3);
+  OZ_CHECK(*m.find("key3") == 3 && m.length() == 500);
+
+  // Iteration after erasure visits each remaining element exactly once.
+  FlatHashMap<int, int> squares;
+  int                   nVisits[1000] = {};
+
+  for (int i = 0; i < 1000; ++i) {
+    squares.add(i, i * i);
+  }
+  for (int i = 0; i < 1000; i += 3) {
+    squares.exclude(i);
+  }
+
+  for (const auto& pair : squares) {
+    OZ_CHECK(uint(pair.key) < 1000u && pair.value == pair.key * pair.key);
+    ++nVisits[pair.key];
+  }
+  for (int i = 0; i < 1000; ++i) {
+    OZ_CHECK(nVisits[i] == (i % 3 == 0 ? 0 : 1));
+  }
+
+  int nElements = 0;
+  for (auto i = squares.citerator(); i.isValid(); ++i) {
+    ++nElements;
+  }
+  OZ_CHECK(nElements == squares.length() && nElements == 666);
+}
@@ -0,0 +1,182 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file unittest/GlyphAtlas.cc
+ *
+ * Headless test of `client::ui::GlyphAtlas` packing, caching and text layout with box glyphs.
+ */
+
+#include "unittest.hh"
+
+#include <client/ui/GlyphAtlas.hh>
+
+using namespace oz;
+using namespace oz::client::ui;
+
+static const int GLYPH_WIDTH   = 8;
+static const int GLYPH_HEIGHT  = 10;
+static const int GLYPH_ADVANCE = 9;
+static const int SPACE_ADVANCE = 4;
+static const int LINE_HEIGHT   = 12;
+
+static int nFlushes     = 0;
+static int nFlushGlyphs = 0;
+
+// Stands in for `TextBatch::flush()`, records whether old glyphs are still there.
+static void countFlush(void* data)
+{
+  const GlyphAtlas* atlas = static_cast<const GlyphAtlas*>(data);
+
+  ++nFlushes;
+  nFlushGlyphs = atlas->length();
+}
+
+class BoxSource : public GlyphAtlas::Source
+{
+private:
+
+  char pixels[GLYPH_WIDTH * GLYPH_HEIGHT * 4];
+
+public:
+
+  int nRasterised = 0;
+
+  BoxSource()
+  {
+    for (int i = 0; i < GLYPH_WIDTH * GLYPH_HEIGHT * 4; ++i) {
+      pixels[i] = char(0xff);
+    }
+  }
+
+  int lineHeight() const override
+  {
+    return LINE_HEIGHT;
+  }
+
+  bool rasterise(uint codePoint, GlyphAtlas::Bitmap* bitmap) override
+  {
+    ++nRasterised;
+
+    if (codePoint < ' ') {
+      return false;
+    }
+    else if (codePoint == ' ') {
+      *bitmap = { nullptr, 0, 0, 0, SPACE_ADVANCE };
+    }
+    else {
+      *bitmap = { pixels, GLYPH_WIDTH, GLYPH_HEIGHT, GLYPH_WIDTH * 4, GLYPH_ADVANCE };
+    }
+    return true;
+  }
+};
+
+void test_GlyphAtlas()
+{
+  Log() << "+ GlyphAtlas";
+
+  const char* s = "a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\xff\xc0\x80";
+
+  OZ_CHECK(GlyphAtlas::decodeUTF8(&s) == 'a');
+  OZ_CHECK(GlyphAtlas::decodeUTF8(&s) == 0xe9);
+  OZ_CHECK(GlyphAtlas::decodeUTF8(&s) == 0x20ac);
+  OZ_CHECK(GlyphAtlas::decodeUTF8(&s) == 0x1f600);
+  OZ_CHECK(GlyphAtlas::decodeUTF8(&s) == 0xfffd);
+  OZ_CHECK(GlyphAtlas::decodeUTF8(&s) == 0xfffd);
+  OZ_CHECK(*s == '\0');
+
+  BoxSource                source;
+  GlyphAtlas               atlas;
+  List<GlyphAtlas::Quad>   quads;
+  int                      width, height;
+  int                      minY, maxY;
+
+  atlas.init(64);
+
+  OZ_CHECK(atlas.takeDirtyRows(&minY, &maxY) && minY == 0 && maxY == 64);
+  OZ_CHECK(!atlas.takeDirtyRows(&minY, &maxY));
+
+  // Each glyph is rasterised once per font, spaces take no atlas space.
+  atlas.layout(&source, 0, "ab a", 0, &quads, &width, &height);
+
+  OZ_CHECK(quads.length() == 3);
+  OZ_CHECK(quads[0].x == 0 && quads[1].x == 9 && quads[2].x == 22);
+  OZ_CHECK(quads[2].u == quads[0].u && quads[2].v == quads[0].v);
+  OZ_CHECK(width == 30 && height == LINE_HEIGHT);
+  OZ_CHECK(atlas.length() == 3 && atlas.nMisses == 3 && atlas.nHits == 1);
+  OZ_CHECK(source.nRasterised == 3);
+  OZ_CHECK(atlas.takeDirtyRows(&minY, &maxY) && minY == 0 && maxY == GLYPH_HEIGHT);
+
+  atlas.layout(&source, 1, "a", 0, &quads, &width, &height);
+
+  OZ_CHECK(atlas.length() == 4 && source.nRasterised == 4);
+  OZ_CHECK(atlas.find(0, 'a') != atlas.find(1, 'a'));
+
+  // Explicit line breaks and unrenderable code points.
+  atlas.layout(&source, 0, "a\n\x01" "b", 0, &quads, &width, &height);
+
+  OZ_CHECK(quads.length() == 2);
+  OZ_CHECK(quads[1].x == 0 && quads[1].y == LINE_HEIGHT);
+  OZ_CHECK(width == GLYPH_WIDTH && height == 2 * LINE_HEIGHT);
+  OZ_CHECK(atlas.find(0, 1) != nullptr && atlas.find(0, 1)->advance == 0);
+
+  // Word wrap moves the last word to the next line.
+  atlas.layout(&source, 0, "aa aa", 30, &quads, &width, &height);
+
+  OZ_CHECK(quads.length() == 4);
+  OZ_CHECK(quads[1].x == 9 && quads[1].y == 0);
+  OZ_CHECK(quads[2].x == 0 && quads[2].y == LINE_HEIGHT);
+  OZ_CHECK(quads[3].x == 9 && quads[3].y == LINE_HEIGHT);
+  OZ_CHECK(width == 17 && height == 2 * LINE_HEIGHT);
+
+  // A word longer than the wrap width stays on its line.
+  atlas.layout(&source, 0, "aaaa", 20, &quads, &width, &height);
+
+  OZ_CHECK(quads.length() == 4 && height == LINE_HEIGHT);
+
+  atlas.destroy();
+
+  // 32 x 32 atlas holds 3 x 3 glyphs, a full atlas is cleared and layout starts over.
+  atlas.init(32, countFlush, &atlas);
+
+  atlas.layout(&source, 0, "abcdefghi", 0, &quads, &width, &height);
+
+  int generation = atlas.generation;
+
+  OZ_CHECK(quads.length() == 9 && atlas.nResets == 0);
+  OZ_CHECK(quads[8].u == 18 && quads[8].v == 22);
+  OZ_CHECK(nFlushes == 0);
+
+  atlas.layout(&source, 0, "jk", 0, &quads, &width, &height);
+
+  // Pending text is flushed while the atlas still holds its glyphs.
+  OZ_CHECK(nFlushes == 1 && nFlushGlyphs == 9);
+  OZ_CHECK(quads.length() == 2 && atlas.nResets == 1);
+  OZ_CHECK(atlas.generation == generation + 1);
+  OZ_CHECK(atlas.find(0, 'a') == nullptr && atlas.length() == 2);
+  OZ_CHECK(quads[0].u == 0 && quads[0].v == 0);
+
+  // Text that cannot fit even into an empty atlas is cut short after one reset.
+  atlas.layout(&source, 0, "abcdefghijk", 0, &quads, &width, &height);
+
+  OZ_CHECK(quads.length() == 9 && atlas.nResets == 2);
+
+  atlas.destroy();
+}
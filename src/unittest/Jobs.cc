@@ -0,0 +1,171 @@
+/*
+ * liboz - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file unittest/Jobs.cc
+ */
+
+#include "unittest.hh"
+
+using namespace oz;
+
+static volatile int counter = 0;
+
+static void incrementMain(void*)
+{
+  __atomic_add_fetch(&counter, 1, __ATOMIC_RELAXED);
+}
+
+struct Fibonacci
+{
+  int n;
+  int result;
+};
+
+// Naive recursive Fibonacci, forking one branch per level to exercise nested groups and stealing.
+static void fibonacciMain(void* data)
+{
+  Fibonacci* fib = static_cast<Fibonacci*>(data);
+
+  if (fib->n < 2) {
+    fib->result = fib->n;
+    return;
+  }
+
+  Fibonacci   a = { fib->n - 1, 0 };
+  Fibonacci   b = { fib->n - 2, 0 };
+  Jobs::Group group;
+
+  Jobs::run(&group, fibonacciMain, &a);
+  fibonacciMain(&b);
+  Jobs::wait(&group);
+
+  fib->result = a.result + b.result;
+}
+
+static void externalMain(void*)
+{
+  OZ_CHECK(Jobs::threadIndex() == -1);
+
+  Jobs::Group group;
+
+  for (int i = 0; i < 1000; ++i) {
+    Jobs::run(&group, incrementMain);
+  }
+  Jobs::wait(&group);
+
+  OZ_CHECK(group.isDone());
+}
+
+static void testRuns()
+{
+  Jobs::Group group;
+
+  counter = 0;
+
+  for (int i = 0; i < 10000; ++i) {
+    Jobs::run(&group, incrementMain);
+  }
+  Jobs::wait(&group);
+
+  OZ_CHECK(group.isDone());
+  OZ_CHECK(counter == 10000);
+
+  Fibonacci fib = { 20, 0 };
+  fibonacciMain(&fib);
+  OZ_CHECK(fib.result == 6765);
+
+  List<int> marks(100003);
+  Arrays::fill(marks.begin(), marks.length(), 0);
+
+  Jobs::parallelFor(0, marks.length(), 64, [&](int begin, int end)
+  {
+    OZ_CHECK(0 <= begin && begin < end && end <= marks.length() && end - begin <= 64);
+    OZ_CHECK(Jobs::threadIndex() < Jobs::nThreads());
+
+    for (int i = begin; i < end; ++i) {
+      ++marks[i];
+    }
+  });
+
+  for (int mark : marks) {
+    OZ_CHECK(mark == 1);
+  }
+
+  int nCalls = 0;
+  Jobs::parallelFor(5, 5, 1, [&](int, int)
+  {
+    ++nCalls;
+  });
+  OZ_CHECK(nCalls == 0);
+}
+
+void test_Jobs()
+{
+  Log() << "+ Jobs";
+
+  // Without workers jobs are executed immediately.
+  OZ_CHECK(Jobs::nThreads() == 1);
+  OZ_CHECK(Jobs::threadIndex() == -1);
+
+  testRuns();
+
+  Jobs::init(3);
+
+  OZ_CHECK(Jobs::nThreads() == 4);
+  OZ_CHECK(Jobs::threadIndex() == 0);
+
+  testRuns();
+
+  // Jobs from threads outside the pool go through the shared queue.
+  counter = 0;
+
+  Thread threads[2] = {
+    Thread("external1", externalMain),
+    Thread("external2", externalMain)
+  };
+
+  threads[0].join();
+  threads[1].join();
+
+  OZ_CHECK(counter == 2000);
+
+  // Overflowing the deque executes jobs immediately.
+  Jobs::Group group;
+
+  counter = 0;
+
+  for (int i = 0; i < 2 * Jobs::DEQUE_SIZE; ++i) {
+    Jobs::run(&group, incrementMain);
+  }
+  Jobs::wait(&group);
+
+  OZ_CHECK(counter == 2 * Jobs::DEQUE_SIZE);
+
+  Jobs::destroy();
+
+  OZ_CHECK(Jobs::nThreads() == 1);
+
+  Jobs::init(1, true);
+  testRuns();
+  Jobs::destroy();
+}
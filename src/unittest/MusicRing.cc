@@ -0,0 +1,129 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file unittest/MusicRing.cc
+ *
+ * Test of `client::MusicRing` ordering and full/empty states, single-threaded and with a producer
+ * thread.
+ */
+
+#include "unittest.hh"
+
+#include <client/MusicRing.hh>
+
+using namespace oz;
+using namespace oz::client;
+
+static const int N_STRESS_BLOCKS = 20000;
+
+static void produceBlocks(void* data)
+{
+  MusicRing* ring = static_cast<MusicRing*>(data);
+
+  for (int i = 0; i < N_STRESS_BLOCKS;) {
+    MusicRing::Block* block = ring->beginWrite();
+
+    if (block != nullptr) {
+      block->size       = i % 4 == 0 ? 4 : 2;
+      block->generation = uint(i);
+      block->data[0]    = char(i);
+
+      ring->endWrite();
+      ++i;
+    }
+  }
+}
+
+void test_MusicRing()
+{
+  Log() << "+ MusicRing";
+
+  MusicRing ring;
+  ring.init(4);
+
+  OZ_CHECK(ring.length() == 4);
+  OZ_CHECK(ring.depth() == 0);
+  OZ_CHECK(ring.beginRead() == nullptr);
+
+  // Fill the ring, the fifth block must be refused.
+  for (int i = 0; i < 4; ++i) {
+    MusicRing::Block* block = ring.beginWrite();
+
+    OZ_CHECK(block != nullptr);
+
+    block->size       = MusicRing::BLOCK_SIZE;
+    block->generation = uint(i);
+    ring.endWrite();
+  }
+  OZ_CHECK(ring.beginWrite() == nullptr);
+  OZ_CHECK(ring.depth() == 4 && ring.nPeakDepth == 4);
+  OZ_CHECK(ring.nWrites == 4 && ring.nWrittenBytes == 4 * ulong64(MusicRing::BLOCK_SIZE));
+
+  // Blocks come out in order and free their slots.
+  for (int i = 0; i < 3; ++i) {
+    const MusicRing::Block* block = ring.beginRead();
+
+    OZ_CHECK(block != nullptr && block->generation == uint(i));
+    ring.endRead();
+  }
+  OZ_CHECK(ring.depth() == 1 && ring.nReads == 3);
+
+  // Wrap around.
+  MusicRing::Block* block = ring.beginWrite();
+
+  OZ_CHECK(block != nullptr);
+
+  block->size       = 0;
+  block->generation = 4;
+  ring.endWrite();
+
+  OZ_CHECK(ring.beginRead()->generation == 3);
+  ring.endRead();
+  OZ_CHECK(ring.beginRead()->generation == 4 && ring.beginRead()->size == 0);
+  ring.endRead();
+  OZ_CHECK(ring.beginRead() == nullptr && ring.depth() == 0);
+
+  ring.resetCounters();
+  OZ_CHECK(ring.nWrites == 0 && ring.nReads == 0 && ring.nPeakDepth == 0);
+
+  // Producer thread against a consumer on this thread.
+  Thread producer("producer", produceBlocks, &ring);
+
+  for (int i = 0; i < N_STRESS_BLOCKS;) {
+    const MusicRing::Block* readBlock = ring.beginRead();
+
+    if (readBlock != nullptr) {
+      OZ_CHECK(readBlock->data[0] == char(i) && readBlock->generation == uint(i));
+      OZ_CHECK(readBlock->size == (i % 4 == 0 ? 4 : 2));
+
+      ring.endRead();
+      ++i;
+    }
+  }
+
+  producer.join();
+
+  OZ_CHECK(ring.depth() == 0);
+  OZ_CHECK(ring.nWrites == ulong64(N_STRESS_BLOCKS) && ring.nReads == ulong64(N_STRESS_BLOCKS));
+  OZ_CHECK(ring.nPeakDepth <= 4);
+
+  ring.destroy();
+}
@@ -0,0 +1,185 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file unittest/OcclusionBuffer.cc
+ *
+ * Headless test of `client::OcclusionBuffer` rasterisation and hierarchical-Z tests.
+ */
+
+#include "unittest.hh"
+
+#include <client/OcclusionBuffer.hh>
+
+using namespace oz;
+using namespace oz::client;
+
+void test_OcclusionBuffer()
+{
+  Log() << "+ OcclusionBuffer";
+
+  // Symmetric perspective projection with 90° field of view, near = 0.1, far = 100, looking -Z.
+  float near = 0.1f;
+  float far  = 100.0f;
+  Mat4  proj = Mat4(1.0f, 0.0f, 0.0f,                              0.0f,
+                    0.0f, 1.0f, 0.0f,                              0.0f,
+                    0.0f, 0.0f, -(far + near) / (far - near),      -1.0f,
+                    0.0f, 0.0f, -2.0f * far * near / (far - near), 0.0f);
+
+  // Square occluder 10 m wide, 10 m in front of the camera, covering the middle of the screen.
+  Point  quad[]    = {
+    Point(-5.0f, -5.0f, -10.0f), Point(5.0f, -5.0f, -10.0f),
+    Point(5.0f, 5.0f, -10.0f), Point(-5.0f, 5.0f, -10.0f)
+  };
+  ushort indices[] = { 0, 1, 2, 0, 2, 3 };
+
+  OcclusionBuffer buffer;
+  buffer.init(126, 64);
+
+  OZ_CHECK(buffer.width() == 128 && buffer.height() == 64);
+
+  // Nothing is occluded by an empty buffer.
+  buffer.begin(proj);
+  buffer.end();
+
+  OZ_CHECK(buffer.isVisible(Point(-1.0f, -1.0f, -22.0f), Point(1.0f, 1.0f, -20.0f)));
+
+  buffer.begin(proj);
+  buffer.drawOccluder(Mat4::ID, quad, 4, indices, 6);
+  buffer.end();
+
+  OZ_CHECK(buffer.nTriangles == 2);
+
+  // Covered pixels hold 1/w of the occluder, other pixels are cleared.
+  OZ_CHECK(abs(buffer.depth(64, 32) - 0.1f) < 1.0e-4f);
+  OZ_CHECK(buffer.depth(2, 2) == 0.0f);
+  OZ_CHECK(buffer.depth(125, 61) == 0.0f);
+
+  // Behind the occluder.
+  OZ_CHECK(!buffer.isVisible(Point(-1.0f, -1.0f, -22.0f), Point(1.0f, 1.0f, -20.0f)));
+  OZ_CHECK(!buffer.isVisible(Point(-9.0f, -9.0f, -50.0f), Point(9.0f, 9.0f, -40.0f)));
+  // In front of the occluder.
+  OZ_CHECK(buffer.isVisible(Point(-1.0f, -1.0f, -8.0f), Point(1.0f, 1.0f, -6.0f)));
+  // Intersecting the occluder.
+  OZ_CHECK(buffer.isVisible(Point(-1.0f, -1.0f, -12.0f), Point(1.0f, 1.0f, -9.0f)));
+  // Beside and partially beside the occluder.
+  OZ_CHECK(buffer.isVisible(Point(12.0f, -1.0f, -22.0f), Point(14.0f, 1.0f, -20.0f)));
+  OZ_CHECK(buffer.isVisible(Point(8.0f, -1.0f, -22.0f), Point(12.0f, 1.0f, -20.0f)));
+  // Crossing the near plane.
+  OZ_CHECK(buffer.isVisible(Point(-1.0f, -1.0f, -1.0f), Point(1.0f, 1.0f, 1.0f)));
+
+  // Translated occluder.
+  buffer.begin(proj);
+  buffer.drawOccluder(Mat4::translation(Vec3(20.0f, 0.0f, -10.0f)), quad, 4, indices, 6);
+  buffer.end();
+
+  OZ_CHECK(buffer.isVisible(Point(-1.0f, -1.0f, -22.0f), Point(1.0f, 1.0f, -20.0f)));
+  OZ_CHECK(!buffer.isVisible(Point(38.0f, -1.0f, -42.0f), Point(40.0f, 1.0f, -40.0f)));
+
+  // Occluder crossing the near plane is clipped and its visible part still occludes.
+  Point slope[] = {
+    Point(-50.0f, -50.0f, 5.0f), Point(50.0f, -50.0f, 5.0f),
+    Point(50.0f, 50.0f, -25.0f), Point(-50.0f, 50.0f, -25.0f)
+  };
+
+  buffer.begin(proj);
+  buffer.drawOccluder(Mat4::ID, slope, 4, indices, 6);
+  buffer.end();
+
+  bool isFinite = true;
+
+  for (int y = 0; y < buffer.height(); ++y) {
+    for (int x = 0; x < buffer.width(); ++x) {
+      float depth = buffer.depth(x, y);
+      isFinite &= Math::isFinite(depth) && depth >= 0.0f && depth <= 1.0f / OcclusionBuffer::MIN_W;
+    }
+  }
+
+  OZ_CHECK(buffer.nTriangles != 0);
+  OZ_CHECK(isFinite);
+  OZ_CHECK(!buffer.isVisible(Point(-1.0f, -1.0f, -32.0f), Point(1.0f, 1.0f, -30.0f)));
+  OZ_CHECK(buffer.isVisible(Point(-1.0f, -1.0f, -6.0f), Point(1.0f, 1.0f, -5.0f)));
+
+  buffer.destroy();
+
+  // Occluder mesh in the trailer of a BSP model stream.
+  Vec4         waterFog = Vec4(0.0f, 0.1f, 0.2f, 1.0f);
+  Vec4         lavaFog  = Vec4(0.8f, 0.2f, 0.0f, 1.0f);
+  List<Point>  occluderVertices;
+  List<ushort> occluderIndices;
+
+  // Version 0 models end with fog colours only. The last int here happens to be the magic, but it
+  // must not be taken for the occluder trailer.
+  Stream legacy(0, Endian::LITTLE);
+
+  legacy.writeVec3(Vec3(1.0f, 2.0f, 3.0f));
+  legacy.writeString("mesh");
+  legacy.writeVec4(waterFog);
+  legacy.writeVec4(lavaFog);
+  legacy.seek(legacy.tell() - int(sizeof(int)));
+  legacy.writeInt(OcclusionBuffer::OCCLUDER_MAGIC);
+
+  occluderVertices.add(Point::ORIGIN);
+  occluderIndices.add(0);
+
+  Stream is(legacy.begin(), legacy.begin() + legacy.tell(), Endian::LITTLE);
+
+  OZ_CHECK(!OcclusionBuffer::readOccluder(&is, 0, &occluderVertices, &occluderIndices));
+  OZ_CHECK(occluderVertices.isEmpty() && occluderIndices.isEmpty());
+  OZ_CHECK(is.readVec4() == waterFog);
+  OZ_CHECK(is.readVec4().x == 0.8f && is.available() == 0);
+
+  // Version 1 models carry the occluder mesh.
+  Stream versioned(0, Endian::LITTLE);
+
+  versioned.writeVec3(Vec3(1.0f, 2.0f, 3.0f));
+
+  int occludersPos = versioned.tell();
+
+  versioned.writeInt(4);
+  for (const Point& p : quad) {
+    versioned.writePoint(p);
+  }
+  versioned.writeInt(6);
+  for (ushort i : indices) {
+    versioned.writeUShort(i);
+  }
+  versioned.writeVec4(waterFog);
+  versioned.writeVec4(lavaFog);
+  versioned.writeInt(occludersPos);
+  versioned.writeInt(OcclusionBuffer::OCCLUDER_MAGIC);
+
+  is = Stream(versioned.begin(), versioned.begin() + versioned.tell(), Endian::LITTLE);
+
+  OZ_CHECK(OcclusionBuffer::readOccluder(&is, 1, &occluderVertices, &occluderIndices));
+  OZ_CHECK(occluderVertices.length() == 4 && occluderVertices[2] == quad[2]);
+  OZ_CHECK(occluderIndices.length() == 6 && occluderIndices[5] == 3);
+  OZ_CHECK(is.readVec4() == waterFog && is.readVec4() == lavaFog);
+
+  // Version 1 model without the magic falls back to fog colours only.
+  versioned.seek(versioned.tell() - int(sizeof(int)));
+  versioned.writeInt(0);
+
+  is = Stream(versioned.begin(), versioned.begin() + versioned.tell(), Endian::LITTLE);
+
+  OZ_CHECK(!OcclusionBuffer::readOccluder(&is, 1, &occluderVertices, &occluderIndices));
+  OZ_CHECK(occluderVertices.isEmpty() && occluderIndices.isEmpty());
+  OZ_CHECK(is.available() == 2 * int(sizeof(float[4])));
+}
@@ -0,0 +1,93 @@
+/*
+ * liboz - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file unittest/PerfectHash.cc
+ */
+
+#include "unittest.hh"
+
+using namespace oz;
+
+void test_PerfectHash()
+{
+  Log() << "+ PerfectHash";
+
+  PerfectHash hash;
+
+  OZ_CHECK(hash.isEmpty());
+  OZ_CHECK(hash.index("foo") == -1);
+  OZ_CHECK(hash.build(nullptr, 0));
+  OZ_CHECK(hash.isEmpty());
+
+  List<String>      names;
+  List<const char*> keys;
+
+  for (int i = 0; i < 1000; ++i) {
+    names.add(String::format("tex/%d/%x", i % 7, i * 2654435761u));
+  }
+  for (const String& name : names) {
+    keys.add(name.c());
+  }
+
+  OZ_CHECK(hash.build(keys.begin(), keys.length()));
+  OZ_CHECK(hash.length() == 1000);
+
+  for (int i = 0; i < keys.length(); ++i) {
+    OZ_CHECK(hash.index(keys[i]) == i);
+  }
+
+  int index = hash.index("not/a/key");
+  OZ_CHECK(uint(index) < uint(keys.length()));
+
+  Stream os(0);
+  hash.write(&os);
+
+  PerfectHash readHash;
+  Stream      is(os.begin(), os.begin() + os.tell());
+
+  readHash.read(&is);
+  OZ_CHECK(is.available() == 0);
+  OZ_CHECK(readHash.length() == 1000);
+
+  for (int i = 0; i < keys.length(); ++i) {
+    OZ_CHECK(readHash.index(keys[i]) == i);
+  }
+
+  const char* single[] = { "a" };
+
+  OZ_CHECK(hash.build(single, 1));
+  OZ_CHECK(hash.index("a") == 0);
+  OZ_CHECK(hash.index("b") == 0);
+
+  const char* repeated[] = { "a", "b", "c", "b", "a" };
+
+  OZ_CHECK(hash.build(repeated, 5));
+  OZ_CHECK(hash.length() == 5);
+  OZ_CHECK(hash.index("a") == 0);
+  OZ_CHECK(hash.index("b") == 1);
+  OZ_CHECK(hash.index("c") == 2);
+
+  hash.clear();
+  readHash.clear();
+  OZ_CHECK(readHash.index("a") == -1);
+}
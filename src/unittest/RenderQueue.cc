@@ -0,0 +1,133 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file unittest/RenderQueue.cc
+ *
+ * Headless test of `client::RenderQueue` key ordering.
+ */
+
+#include "unittest.hh"
+
+#include <client/RenderQueue.hh>
+
+using namespace oz;
+using namespace oz::client;
+
+void test_RenderQueue()
+{
+  Log() << "+ RenderQueue";
+
+  RenderQueue queue;
+
+  // Index is preserved and does not affect order of otherwise different keys.
+  ulong64 key = RenderQueue::key(RenderQueue::STATE_MAJOR, 3, 1000, 0.5f, 12345);
+  OZ_CHECK(RenderQueue::index(key) == 12345);
+
+  // Depth is clamped.
+  OZ_CHECK(RenderQueue::key(RenderQueue::DEPTH_MAJOR, 0, 0, -1.0f, 0) ==
+           RenderQueue::key(RenderQueue::DEPTH_MAJOR, 0, 0, 0.0f, 0));
+  OZ_CHECK(RenderQueue::key(RenderQueue::DEPTH_MAJOR, 0, 0, 2.0f, 0) ==
+           RenderQueue::key(RenderQueue::DEPTH_MAJOR, 0, 0, 1.0f, 0));
+
+  const int COUNT = 5000;
+
+  int   shaders[COUNT];
+  int   models[COUNT];
+  float depths[COUNT];
+
+  for (int i = 0; i < COUNT; ++i) {
+    shaders[i] = Math::rand(4);
+    models[i]  = Math::rand(300);
+    depths[i]  = Math::rand();
+  }
+
+  RenderQueue::Layout layouts[] = {
+    RenderQueue::STATE_MAJOR, RenderQueue::DEPTH_MAJOR, RenderQueue::BACK_TO_FRONT
+  };
+
+  for (RenderQueue::Layout layout : layouts) {
+    queue.clear();
+
+    for (int i = 0; i < COUNT; ++i) {
+      queue.add(RenderQueue::key(layout, shaders[i], models[i], depths[i], i));
+    }
+    queue.sort();
+
+    OZ_CHECK(queue.length() == COUNT);
+
+    bool isPermutation = true;
+    bool isOrdered     = true;
+    bool seen[COUNT]   = {};
+    int  nStateChanges = 0;
+
+    for (int i = 0; i < queue.length(); ++i) {
+      int curr = RenderQueue::index(queue.begin()[i]);
+
+      isPermutation &= !seen[curr];
+      seen[curr] = true;
+
+      if (i == 0) {
+        continue;
+      }
+
+      int prev = RenderQueue::index(queue.begin()[i - 1]);
+
+      // Depths may only be equal after quantisation, so allow for a quantisation step.
+      float depthStep = 1.0f / float((1 << RenderQueue::DEPTH_BITS) - 1);
+      bool  sameState = shaders[prev] == shaders[curr] && models[prev] == models[curr];
+
+      nStateChanges += !sameState;
+
+      switch (layout) {
+        case RenderQueue::STATE_MAJOR: {
+          isOrdered &= shaders[prev] < shaders[curr] ||
+                       (shaders[prev] == shaders[curr] && models[prev] < models[curr]) ||
+                       (sameState && depths[prev] <= depths[curr] + depthStep);
+          break;
+        }
+        case RenderQueue::DEPTH_MAJOR: {
+          isOrdered &= depths[prev] <= depths[curr] + depthStep;
+          break;
+        }
+        case RenderQueue::BACK_TO_FRONT: {
+          isOrdered &= depths[prev] + depthStep >= depths[curr];
+          break;
+        }
+      }
+    }
+
+    OZ_CHECK(isPermutation);
+    OZ_CHECK(isOrdered);
+
+    // State-major order changes state once per distinct (shader, model) pair at most.
+    if (layout == RenderQueue::STATE_MAJOR) {
+      OZ_CHECK(nStateChanges < 4 * 300);
+    }
+  }
+
+  // Sorting an already sorted queue is a no-op and clearing empties it.
+  ulong64 first = queue.begin()[0];
+  queue.sort();
+  OZ_CHECK(queue.begin()[0] == first);
+
+  queue.clear();
+  OZ_CHECK(queue.isEmpty());
+  queue.trim();
+}
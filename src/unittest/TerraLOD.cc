@@ -0,0 +1,190 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file unittest/TerraLOD.cc
+ *
+ * Headless test of `client::TerraLOD` index generation and tile selection.
+ */
+
+#include "unittest.hh"
+
+#include <client/TerraLOD.hh>
+
+using namespace oz;
+using namespace oz::client;
+
+static const int TILES = 4;
+
+void test_TerraLOD()
+{
+  Log() << "+ TerraLOD";
+
+  TerraLOD terraLOD;
+  terraLOD.init(TILES);
+
+  const int TILE_QUADS = TerraLOD::TILE_QUADS;
+  const int TILE_VERTS = TerraLOD::TILE_VERTS;
+
+  OZ_CHECK(terraLOD.ranges[0][0].count == TILE_QUADS * TILE_QUADS * 6);
+  OZ_CHECK(terraLOD.ranges[TerraLOD::LODS - 1][0].count == 6);
+
+  // Every range must cover the whole tile with clockwise triangles and stitched edges must only
+  // use vertices of the next coarser level.
+  bool isCovered   = true;
+  bool isClockwise = true;
+  bool isStitched  = true;
+
+  for (int lod = 0; lod < TerraLOD::LODS; ++lod) {
+    for (int stitches = 0; stitches < TerraLOD::STITCHES; ++stitches) {
+      const TerraLOD::Range& range  = terraLOD.ranges[lod][stitches];
+      const ushort*          tris   = &terraLOD.indices[range.offset];
+      int                    area   = 0;
+      int                    stride = lod == TerraLOD::LODS - 1 ? 1 << lod : 2 << lod;
+
+      for (int i = 0; i < range.count; i += 3) {
+        int x[3], y[3];
+
+        for (int k = 0; k < 3; ++k) {
+          x[k] = tris[i + k] / TILE_VERTS;
+          y[k] = tris[i + k] % TILE_VERTS;
+
+          if (((stitches & TerraLOD::NEG_X_BIT) && x[k] == 0) ||
+              ((stitches & TerraLOD::POS_X_BIT) && x[k] == TILE_QUADS))
+          {
+            isStitched &= y[k] % stride == 0;
+          }
+          if (((stitches & TerraLOD::NEG_Y_BIT) && y[k] == 0) ||
+              ((stitches & TerraLOD::POS_Y_BIT) && y[k] == TILE_QUADS))
+          {
+            isStitched &= x[k] % stride == 0;
+          }
+        }
+
+        int cross = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+
+        isClockwise &= cross < 0;
+        area        -= cross;
+      }
+
+      isCovered &= area == 2 * TILE_QUADS * TILE_QUADS;
+    }
+  }
+
+  OZ_CHECK(isCovered);
+  OZ_CHECK(isClockwise);
+  OZ_CHECK(isStitched);
+
+  // Each snapped vertex on a stitched edge removes one triangle.
+  OZ_CHECK(terraLOD.ranges[0][TerraLOD::NEG_X_BIT].count / 3 ==
+           TILE_QUADS * TILE_QUADS * 2 - TILE_QUADS / 2);
+
+  // Flat terrain with a bump in the middle of the tile (0, 0), zero on its edges.
+  List<Point> vertices(TILE_VERTS * TILE_VERTS);
+
+  for (int i = 0; i < TILES; ++i) {
+    for (int j = 0; j < TILES; ++j) {
+      for (int k = 0; k < TILE_VERTS; ++k) {
+        for (int l = 0; l < TILE_VERTS; ++l) {
+          float height = 0.0f;
+
+          if (i == 0 && j == 0) {
+            height = 20.0f * Math::sin(Math::TAU / 2.0f * float(k) / float(TILE_QUADS)) *
+                     Math::sin(Math::TAU / 2.0f * float(l) / float(TILE_QUADS));
+          }
+
+          vertices[TerraLOD::vertexIndex(k, l)] = Point(float((i * TILE_QUADS + k) * 8),
+                                                        float((j * TILE_QUADS + l) * 8),
+                                                        height);
+        }
+      }
+
+      terraLOD.setTile(i, j, vertices.begin(), j == TILES - 1 ? -10.0f : Math::INF);
+    }
+  }
+
+  OZ_CHECK(terraLOD.tileError(0, 0, 0) == 0.0f);
+  OZ_CHECK(terraLOD.tileError(0, 0, 1) > 0.0f);
+  OZ_CHECK(terraLOD.tileError(0, 0, TerraLOD::LODS - 1) >= 19.0f);
+  OZ_CHECK(terraLOD.tileError(1, 1, TerraLOD::LODS - 1) == 0.0f);
+  OZ_CHECK(terraLOD.tileMaxs(0, 0).z > 19.0f && abs(terraLOD.tileMins(0, 0).z) < 1.0e-3f);
+  OZ_CHECK(terraLOD.tileMins(2, TILES - 1).z == -10.0f);
+
+  // The eye inside the bumpy tile's box forces full detail, flat tiles could use the coarsest
+  // level, but they are refined so that neighbours differ by at most one level.
+  Point eye = Point(128.0f, 128.0f, 10.0f);
+
+  terraLOD.select(eye, 500.0f, 1.0f, 0, 0, TILES - 1, TILES - 1, nullptr, 0);
+
+  OZ_CHECK(terraLOD.draws.length() == TILES * TILES);
+  OZ_CHECK(terraLOD.nCulled == 0);
+
+  auto expectedLOD = [](int x, int y)
+  {
+    return min(x + y, TerraLOD::LODS - 1);
+  };
+
+  bool isRelaxed    = true;
+  bool isConsistent = true;
+  int  nTriangles   = 0;
+
+  for (const TerraLOD::Draw& draw : terraLOD.draws) {
+    int lod      = expectedLOD(draw.x, draw.y);
+    int stitches = 0;
+
+    if (draw.x != TILES - 1 && expectedLOD(draw.x + 1, draw.y) > lod) {
+      stitches |= TerraLOD::POS_X_BIT;
+    }
+    if (draw.y != TILES - 1 && expectedLOD(draw.x, draw.y + 1) > lod) {
+      stitches |= TerraLOD::POS_Y_BIT;
+    }
+
+    isRelaxed    &= draw.lod == lod;
+    isConsistent &= draw.stitches == stitches;
+    nTriangles   += terraLOD.range(draw).count / 3;
+  }
+
+  OZ_CHECK(isRelaxed);
+  OZ_CHECK(isConsistent);
+  OZ_CHECK(terraLOD.nTriangles == nTriangles);
+
+  // Far away from the bump everything is coarse.
+  terraLOD.select(Point(40000.0f, 40000.0f, 10.0f), 500.0f, 1.0f, 0, 0, TILES - 1, TILES - 1,
+                  nullptr, 0);
+
+  OZ_CHECK(terraLOD.nTriangles == TILES * TILES * 2);
+
+  // Boxes entirely on the negative side of a plane are culled, the span limits candidates.
+  Plane planes[] = { Plane(Vec3(1.0f, 0.0f, 0.0f), 600.0f) };
+
+  terraLOD.select(eye, 500.0f, 1.0f, 1, 0, TILES - 1, TILES - 2, planes, 1);
+
+  OZ_CHECK(terraLOD.nCulled == TILES - 1);
+  OZ_CHECK(terraLOD.draws.length() == (TILES - 2) * (TILES - 1));
+
+  bool isInside = true;
+
+  for (const TerraLOD::Draw& draw : terraLOD.draws) {
+    isInside &= draw.x >= 2 && draw.y <= TILES - 2;
+  }
+  OZ_CHECK(isInside);
+
+  terraLOD.destroy();
+}
@@ -0,0 +1,129 @@
+/*
+ * OpenZone - simple cross-platform FPS/RTS game engine.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file unittest/VoicePool.cc
+ *
+ * Test of `client::VoicePool` with fake source ids in place of an OpenAL backend.
+ */
+
+#include "unittest.hh"
+
+#include <client/VoicePool.hh>
+
+using namespace oz;
+using namespace oz::client;
+
+void test_VoicePool()
+{
+  Log() << "+ VoicePool";
+
+  uint sources[] = { 101, 102, 103, 104 };
+
+  VoicePool pool;
+  pool.init(sources, 4);
+
+  OZ_CHECK(pool.length() == 4);
+  OZ_CHECK(pool.nActive == 0);
+
+  bool isStolen;
+  int  voices[4];
+
+  // Free voices are handed out in order without stealing.
+  for (int i = 0; i < 4; ++i) {
+    voices[i] = pool.acquire(float(i + 1), &isStolen);
+
+    OZ_CHECK(voices[i] == i && !isStolen);
+    OZ_CHECK(pool.source(voices[i]) == sources[i]);
+  }
+  OZ_CHECK(pool.nActive == 4 && pool.nPeakActive == 4);
+
+  // A request less important than all active voices is dropped.
+  OZ_CHECK(pool.acquire(0.5f, &isStolen) == VoicePool::NONE && !isStolen);
+  OZ_CHECK(pool.nDrops == 1);
+
+  // A more important request steals the least important voice.
+  int voice = pool.acquire(2.5f, &isStolen);
+
+  OZ_CHECK(voice == 0 && isStolen);
+  OZ_CHECK(pool.priority(0) == 2.5f);
+  OZ_CHECK(pool.nSteals == 1 && pool.nActive == 4);
+
+  // Raising priority of a looping sound protects it from being stolen.
+  pool.setPriority(1, 10.0f);
+
+  voice = pool.acquire(3.5f, &isStolen);
+  OZ_CHECK(voice == 0 && isStolen);
+
+  voice = pool.acquire(3.75f, &isStolen);
+  OZ_CHECK(voice == 2 && isStolen);
+
+  // Released voices are reused before stealing.
+  pool.release(3);
+  OZ_CHECK(pool.nActive == 3 && !pool.isActive(3));
+
+  voice = pool.acquire(0.1f, &isStolen);
+  OZ_CHECK(voice == 3 && !isStolen && pool.isActive(3));
+
+  OZ_CHECK(pool.nRequests == 9);
+
+  pool.resetCounters();
+  OZ_CHECK(pool.nRequests == 0 && pool.nSteals == 0 && pool.nDrops == 0);
+  OZ_CHECK(pool.nPeakActive == 4);
+
+  // Priority falls with distance beyond reference distance and grows with weight.
+  float near   = VoicePool::priority(1.0f, 1.0f, 2.0f, 0.35f, 1.0f);
+  float far    = VoicePool::priority(1.0f, 50.0f, 2.0f, 0.35f, 1.0f);
+  float strong = VoicePool::priority(1.0f, 50.0f, 2.0f, 0.35f, 4.0f);
+
+  OZ_CHECK(near == 1.0f);
+  OZ_CHECK(far < near && strong > far);
+
+  // Empty pool drops everything.
+  pool.destroy();
+  pool.init(nullptr, 0);
+
+  OZ_CHECK(pool.acquire(1.0f, &isStolen) == VoicePool::NONE);
+
+  pool.destroy();
+
+  // A burst of sounds after earlier one-time sounds have finished and been released reuses their
+  // voices instead of stealing from or dropping sounds that are still playing.
+  pool.init(sources, 4);
+
+  for (int i = 0; i < 4; ++i) {
+    pool.acquire(5.0f, &isStolen);
+  }
+
+  pool.release(1);
+  pool.release(3);
+
+  voice = pool.acquire(0.1f, &isStolen);
+  OZ_CHECK(voice == 3 && !isStolen);
+
+  voice = pool.acquire(0.1f, &isStolen);
+  OZ_CHECK(voice == 1 && !isStolen);
+
+  OZ_CHECK(pool.acquire(0.1f, &isStolen) == VoicePool::NONE);
+  OZ_CHECK(pool.nSteals == 0 && pool.nDrops == 1);
+  OZ_CHECK(pool.nActive == 4);
+
+  pool.destroy();
+}
@@ -28,6 +28,38 @@
 
 using namespace oz;
 
+// Element without a default constructor or copying, for `parallelSort()`.
+struct MoveOnly
+{
+  int value;
+
+  explicit MoveOnly(int value_) :
+    value(value_)
+  {}
+
+  MoveOnly(const MoveOnly&) = delete;
+
+  MoveOnly(MoveOnly&& m) :
+    value(m.value)
+  {
+    m.value = -1;
+  }
+
+  MoveOnly& operator = (const MoveOnly&) = delete;
+
+  MoveOnly& operator = (MoveOnly&& m)
+  {
+    value   = m.value;
+    m.value = -1;
+    return *this;
+  }
+
+  bool operator < (const MoveOnly& m) const
+  {
+    return value < m.value;
+  }
+};
+
 void test_arrays()
 {
   Log() << "+ arrays";
@@ -133,4 +165,66 @@ void test_arrays()
                (r[index] <= i && r[index + 1] > i));
     }
   }
+
+  // Patterns that were O(n^2) for the last-element-pivot quicksort.
+  for (int pattern = 0; pattern < 4; ++pattern) {
+    int r[1000];
+    for (int i = 0; i < 1000; ++i) {
+      r[i] = pattern == 0 ? i :
+             pattern == 1 ? 1000 - i :
+             pattern == 2 ? Math::rand(4) : 8 * i + Math::rand(32);
+    }
+    Arrays::sort(r, 1000);
+
+    for (int i = 1; i < 1000; ++i) {
+      OZ_CHECK(r[i - 1] <= r[i]);
+    }
+  }
+
+  for (int nThreads = 1; nThreads <= 5; ++nThreads) {
+    int  count = 100000 + nThreads;
+    int* r     = new int[count];
+    long sum   = 0;
+
+    for (int i = 0; i < count; ++i) {
+      r[i] = Math::rand(count);
+      sum += r[i];
+    }
+    Arrays::parallelSort(r, count, nThreads);
+
+    for (int i = 1; i < count; ++i) {
+      OZ_CHECK(r[i - 1] <= r[i]);
+      sum -= r[i];
+    }
+    OZ_CHECK(sum == r[0]);
+    delete[] r;
+  }
+
+  Jobs::init(3);
+
+  for (int nThreads = 0; nThreads <= 5; nThreads += 5) {
+    int       count = 100000 + nThreads;
+    char*     block = new char[size_t(count) * sizeof(MoveOnly)];
+    MoveOnly* r     = reinterpret_cast<MoveOnly*>(block);
+    long      sum   = 0;
+
+    for (int i = 0; i < count; ++i) {
+      new(&r[i]) MoveOnly(Math::rand(count));
+      sum += r[i].value;
+    }
+    Arrays::parallelSort(r, count, nThreads);
+
+    for (int i = 1; i < count; ++i) {
+      OZ_CHECK(r[i - 1].value <= r[i].value);
+      sum -= r[i].value;
+    }
+    OZ_CHECK(sum == r[0].value);
+
+    for (int i = 0; i < count; ++i) {
+      r[i].~MoveOnly();
+    }
+    delete[] block;
+  }
+
+  Jobs::destroy();
 }
@@ -32,24 +32,28 @@ void test_iterables()
 {
   Log() << "+ iterables";
 
-  Chain<Foo>::CIterator        icl;
-  Chain<Foo>::Iterator         il;
-  DChain<Foo>::CIterator       icdl;
-  DChain<Foo>::Iterator        idl;
-  List<Foo>::CIterator         icv;
-  List<Foo>::Iterator          iv;
-  SList<Foo, 1>::CIterator     icsv;
-  SList<Foo, 1>::Iterator      isv;
-  Set<Foo>::CIterator          ics;
-  Set<Foo>::Iterator           is;
-  Map<Foo, Foo>::CIterator     icm;
-  Map<Foo, Foo>::Iterator      im;
-  HashSet<Foo>::CIterator      ichs;
-  HashSet<Foo>::Iterator       ihs;
-  HashMap<Foo, Foo>::CIterator ichm;
-  HashMap<Foo, Foo>::Iterator  ihtm;
+  Chain<Foo>::CIterator            icl;
+  Chain<Foo>::Iterator             il;
+  DChain<Foo>::CIterator           icdl;
+  DChain<Foo>::Iterator            idl;
+  List<Foo>::CIterator             icv;
+  List<Foo>::Iterator              iv;
+  SList<Foo, 1>::CIterator         icsv;
+  SList<Foo, 1>::Iterator          isv;
+  Set<Foo>::CIterator              ics;
+  Set<Foo>::Iterator               is;
+  Map<Foo, Foo>::CIterator         icm;
+  Map<Foo, Foo>::Iterator          im;
+  HashSet<Foo>::CIterator          ichs;
+  HashSet<Foo>::Iterator           ihs;
+  HashMap<Foo, Foo>::CIterator     ichm;
+  HashMap<Foo, Foo>::Iterator      ihtm;
+  FlatHashSet<Foo>::CIterator      icfs;
+  FlatHashSet<Foo>::Iterator       ifs;
+  FlatHashMap<Foo, Foo>::CIterator icfm;
+  FlatHashMap<Foo, Foo>::Iterator  ifm;
 
-  List<Foo*>::Iterator         invalid;
+  List<Foo*>::Iterator             invalid;
 
   DChain<Foo> l;
   List<Foo> v;
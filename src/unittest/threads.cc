@@ -0,0 +1,286 @@
+/*
+ * liboz - OpenZone Core Library.
+ *
+ * Copyright © 2002-2014 Davorin Učakar
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software in
+ *    a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/**
+ * @file unittest/threads.cc
+ */
+
+#include "unittest.hh"
+
+using namespace oz;
+
+static const int N_ELEMS     = 200000;
+static const int N_PRODUCERS = 4;
+static const int N_ROUNDS    = 10000;
+static const int N_PHASES    = 1000;
+
+static SPSCQueue<int, 1024>  spscQueue;
+static MPSCQueue<int, 256>   mpscQueue;
+static Event                 pingEvent;
+static Event                 pongEvent;
+static int                   pingCounter = 0;
+static volatile int          nArrived    = 0;
+static Barrier               barrier(N_PRODUCERS);
+static int                   slots[N_PRODUCERS];
+static volatile int          nSerial     = 0;
+
+static void spscProducerMain(void*)
+{
+  for (int i = 0; i < N_ELEMS; ++i) {
+    while (!spscQueue.push(i)) {
+      Time::usleep(1);
+    }
+  }
+}
+
+static void mpscProducerMain(void* data)
+{
+  int producer = int(reinterpret_cast<size_t>(data));
+
+  for (int i = 0; i < N_ELEMS / N_PRODUCERS; ++i) {
+    while (!mpscQueue.push(producer << 24 | i)) {
+      Time::usleep(1);
+    }
+  }
+}
+
+static void pongMain(void*)
+{
+  for (int i = 0; i < N_ROUNDS; ++i) {
+    pingEvent.wait();
+    ++pingCounter;
+    pongEvent.set();
+  }
+}
+
+static void latchMain(void* data)
+{
+  Latch* latch = static_cast<Latch*>(data);
+
+  __atomic_add_fetch(&nArrived, 1, __ATOMIC_RELAXED);
+  latch->countDown();
+}
+
+static void barrierMain(void* data)
+{
+  int index = int(reinterpret_cast<size_t>(data));
+
+  for (int phase = 0; phase < N_PHASES; ++phase) {
+    slots[index] = phase;
+
+    if (barrier.arriveAndWait()) {
+      __atomic_add_fetch(&nSerial, 1, __ATOMIC_RELAXED);
+    }
+
+    for (int i = 0; i < N_PRODUCERS; ++i) {
+      OZ_CHECK(slots[i] == phase);
+    }
+
+    barrier.arriveAndWait();
+  }
+}
+
+static void testSPSCQueue()
+{
+  Log() << "+ SPSCQueue";
+
+  SPSCQueue<Foo, 4> queue;
+  Foo               foo;
+
+  // Elements must only be moved through the queue.
+  Foo::allowCopy = false;
+
+  OZ_CHECK(queue.capacity() == 4);
+  OZ_CHECK(queue.isEmpty());
+  OZ_CHECK(!queue.pop(&foo));
+
+  for (int i = 0; i < 4; ++i) {
+    OZ_CHECK(queue.push(Foo(i)));
+  }
+  OZ_CHECK(!queue.push(Foo(4)));
+  OZ_CHECK(queue.length() == 4);
+
+  for (int i = 0; i < 6; ++i) {
+    OZ_CHECK(queue.pop(&foo) && foo.value == i);
+    OZ_CHECK(queue.push(Foo(i + 4)));
+  }
+  for (int i = 6; i < 10; ++i) {
+    OZ_CHECK(queue.pop(&foo) && foo.value == i);
+  }
+  OZ_CHECK(queue.isEmpty());
+
+  Foo::allowCopy = true;
+
+  Thread producer("producer", spscProducerMain);
+
+  for (int i = 0; i < N_ELEMS; ++i) {
+    int value;
+
+    while (!spscQueue.pop(&value)) {
+      Time::usleep(1);
+    }
+    OZ_CHECK(value == i);
+  }
+
+  producer.join();
+  OZ_CHECK(spscQueue.isEmpty());
+}
+
+static void testMPSCQueue()
+{
+  Log() << "+ MPSCQueue";
+
+  MPSCQueue<Foo, 4> queue;
+  Foo               foo;
+
+  // Elements must only be moved through the queue.
+  Foo::allowCopy = false;
+
+  OZ_CHECK(queue.capacity() == 4);
+  OZ_CHECK(!queue.pop(&foo));
+
+  for (int i = 0; i < 4; ++i) {
+    OZ_CHECK(queue.push(Foo(i)));
+  }
+  OZ_CHECK(!queue.push(Foo(4)));
+
+  for (int i = 0; i < 6; ++i) {
+    OZ_CHECK(queue.pop(&foo) && foo.value == i);
+    OZ_CHECK(queue.push(Foo(i + 4)));
+  }
+  for (int i = 6; i < 10; ++i) {
+    OZ_CHECK(queue.pop(&foo) && foo.value == i);
+  }
+  OZ_CHECK(queue.isEmpty());
+
+  Foo::allowCopy = true;
+
+  Thread producers[N_PRODUCERS];
+  int    nextValues[N_PRODUCERS] = {};
+
+  for (int i = 0; i < N_PRODUCERS; ++i) {
+    producers[i] = Thread("producer", mpscProducerMain, reinterpret_cast<void*>(size_t(i)));
+  }
+
+  // Elements from a single producer must arrive in order.
+  for (int i = 0; i < N_ELEMS / N_PRODUCERS * N_PRODUCERS; ++i) {
+    int value;
+
+    while (!mpscQueue.pop(&value)) {
+      Time::usleep(1);
+    }
+
+    int producer = value >> 24;
+
+    OZ_CHECK(0 <= producer && producer < N_PRODUCERS);
+    OZ_CHECK((value & 0xffffff) == nextValues[producer]);
+
+    ++nextValues[producer];
+  }
+
+  for (Thread& producer : producers) {
+    producer.join();
+  }
+  OZ_CHECK(mpscQueue.isEmpty());
+}
+
+static void testEvent()
+{
+  Log() << "+ Event";
+
+  Event event;
+
+  OZ_CHECK(!event.tryWait());
+  event.set();
+  event.set();
+  OZ_CHECK(event.tryWait());
+  OZ_CHECK(!event.tryWait());
+  event.set();
+  event.wait();
+  OZ_CHECK(!event.tryWait());
+
+  // Non-atomic counter is only consistent if events order memory correctly.
+  Thread pong("pong", pongMain);
+
+  for (int i = 0; i < N_ROUNDS; ++i) {
+    OZ_CHECK(pingCounter == i);
+
+    pingEvent.set();
+    pongEvent.wait();
+  }
+
+  pong.join();
+  OZ_CHECK(pingCounter == N_ROUNDS);
+}
+
+static void testLatch()
+{
+  Log() << "+ Latch";
+
+  Latch latch(N_PRODUCERS);
+  Latch openLatch(0);
+
+  OZ_CHECK(!latch.isOpen());
+  OZ_CHECK(openLatch.isOpen());
+  openLatch.wait();
+
+  Thread threads[N_PRODUCERS];
+
+  for (Thread& thread : threads) {
+    thread = Thread("latch", latchMain, &latch);
+  }
+
+  latch.wait();
+  OZ_CHECK(latch.isOpen());
+  OZ_CHECK(nArrived == N_PRODUCERS);
+
+  for (Thread& thread : threads) {
+    thread.join();
+  }
+}
+
+static void testBarrier()
+{
+  Log() << "+ Barrier";
+
+  Thread threads[N_PRODUCERS];
+
+  for (int i = 0; i < N_PRODUCERS; ++i) {
+    threads[i] = Thread("barrier", barrierMain, reinterpret_cast<void*>(size_t(i)));
+  }
+  for (Thread& thread : threads) {
+    thread.join();
+  }
+
+  OZ_CHECK(nSerial == N_PHASES);
+}
+
+void test_threads()
+{
+  Log() << "+ threads";
+
+  testSPSCQueue();
+  testMPSCQueue();
+  testEvent();
+  testLatch();
+  testBarrier();
+}
@@ -51,11 +51,23 @@ int main()
   test_common();
   test_iterables();
   test_arrays();
+  test_FlatHashSet();
+  test_PerfectHash();
+  test_Jobs();
+  test_Arena();
+  test_threads();
 
 #ifdef OZ_ALLOCATOR
   test_Alloc();
 #endif
 
+  test_RenderQueue();
+  test_OcclusionBuffer();
+  test_TerraLOD();
+  test_VoicePool();
+  test_MusicRing();
+  test_GlyphAtlas();
+
   Log() << (hasPassed ? "Unittest PASSED" : "Unittest FAILED");
   return EXIT_SUCCESS;
 }
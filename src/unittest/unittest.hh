@@ -162,7 +162,19 @@ struct Foo
 void test_common();
 void test_iterables();
 void test_arrays();
+void test_FlatHashSet();
+void test_PerfectHash();
+void test_Jobs();
+void test_Arena();
+void test_threads();
 
 void test_Alloc();
 
+void test_RenderQueue();
+void test_OcclusionBuffer();
+void test_TerraLOD();
+void test_VoicePool();
+void test_MusicRing();
+void test_GlyphAtlas();
+
 int main();